@@ -10,8 +10,10 @@ import type {
   AuthSession,
   ChildProfile,
   MissionData,
+  ProgressDelta,
   QuestionData,
 } from '../types';
+import { sendAuthSession } from './unreal-bridge';
 
 // ============================================
 // Configuration
@@ -76,7 +78,9 @@ class SuperfamilyAPI {
     try {
       const sessionJson = await AsyncStorage.getItem(STORAGE_KEYS.AUTH_SESSION);
       if (sessionJson) {
-        this.authSession = JSON.parse(sessionJson);
+        const session: AuthSession = JSON.parse(sessionJson);
+        this.authSession = session;
+        sendAuthSession(session);
       }
     } catch (error) {
       console.error('Failed to load auth session:', error);
@@ -95,6 +99,7 @@ class SuperfamilyAPI {
         STORAGE_KEYS.AUTH_SESSION,
         JSON.stringify(this.authSession)
       );
+      sendAuthSession(response.data);
 
       return { success: true, data: response.data };
     } catch (error) {
@@ -120,6 +125,7 @@ class SuperfamilyAPI {
         STORAGE_KEYS.AUTH_SESSION,
         JSON.stringify(this.authSession)
       );
+      sendAuthSession(response.data);
 
       return true;
     } catch {
@@ -172,6 +178,9 @@ class SuperfamilyAPI {
     }
   }
 
+  /**
+   * @deprecated Overwrites progress made on other devices; use exchangeProgress
+   */
   async syncProgress(
     childId: string,
     progress: ChildProfile
@@ -184,6 +193,25 @@ class SuperfamilyAPI {
     }
   }
 
+  /**
+   * Post this device's progress delta and get back what the device is missing
+   */
+  async exchangeProgress(
+    childId: string,
+    deviceId: string,
+    delta: ProgressDelta
+  ): Promise<ApiResponse<ProgressDelta>> {
+    try {
+      const response = await this.client.post<ProgressDelta>(
+        `/profiles/${childId}/sync/delta`,
+        { deviceId, delta }
+      );
+      return { success: true, data: response.data };
+    } catch (error) {
+      return this.handleError(error);
+    }
+  }
+
   // ============================================
   // Questions (Strapi CMS)
   // ============================================
@@ -230,35 +258,6 @@ class SuperfamilyAPI {
     }
   }
 
-  async submitMissionPhoto(
-    missionId: string,
-    childId: string,
-    photoUri: string
-  ): Promise<ApiResponse<{ photoUrl: string }>> {
-    try {
-      const formData = new FormData();
-      formData.append('missionId', missionId);
-      formData.append('childId', childId);
-      formData.append('photo', {
-        uri: photoUri,
-        type: 'image/jpeg',
-        name: 'mission_photo.jpg',
-      } as unknown as Blob);
-
-      const response = await this.client.post<{ photoUrl: string }>(
-        '/missions/photo',
-        formData,
-        {
-          headers: { 'Content-Type': 'multipart/form-data' },
-        }
-      );
-
-      return { success: true, data: response.data };
-    } catch (error) {
-      return this.handleError(error);
-    }
-  }
-
   async approveMission(
     missionId: string,
     childId: string,
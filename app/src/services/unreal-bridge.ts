@@ -5,10 +5,19 @@
 
 import { NativeModules, NativeEventEmitter, Platform } from 'react-native';
 import type {
+  AuthSession,
+  ChildIdsMigratedData,
   RNUEMessage,
   RNUEMessageType,
   LevelCompletedData,
   LevelFailedData,
+  MissionData,
+  PhotoUploadProgressData,
+  ProfileDeltaData,
+  ProfileSnapshotData,
+  ProgressDelta,
+  ProgressSyncDeltaData,
+  StartupTimingsData,
 } from '../types';
 
 // Native module interface (will be implemented in native code)
@@ -35,14 +44,37 @@ const bridgeEmitter = NativeModules.SuperfamilyBridge
 // Message Builders
 // ============================================
 
-function buildMessage(type: RNUEMessageType, payload: object = {}): RNUEMessage {
+function buildMessage(
+  type: RNUEMessageType,
+  payload: object = {},
+  correlationId?: string
+): RNUEMessage {
   return {
     type,
     payload: JSON.stringify(payload),
-    correlationId: `rn-${Date.now()}-${Math.random().toString(36).substr(2, 9)}`,
+    correlationId:
+      correlationId || `rn-${Date.now()}-${Math.random().toString(36).substr(2, 9)}`,
   };
 }
 
+// UE5 replays unanswered mission requests with their original correlation ID.
+// A replay of a request still open here is dropped; a replay of one already
+// answered gets the same answer again, in case the first was lost.
+const openRequests: Set<string> = new Set();
+const answeredRequests: Map<string, RNUEMessage> = new Map();
+const MAX_ANSWERED_REQUESTS = 64;
+
+function sendAnswer(message: RNUEMessage, requestId?: string): void {
+  if (requestId) {
+    openRequests.delete(requestId);
+    answeredRequests.set(requestId, message);
+    if (answeredRequests.size > MAX_ANSWERED_REQUESTS) {
+      answeredRequests.delete(answeredRequests.keys().next().value as string);
+    }
+  }
+  NativeBridge.sendMessage(JSON.stringify(message));
+}
+
 // ============================================
 // Outgoing Messages (React Native -> UE5)
 // ============================================
@@ -72,23 +104,26 @@ export function resumeGame(): void {
 }
 
 /**
- * Send captured photo for mission verification
+ * Send captured photo for mission verification; requestId is the
+ * correlationId of the MissionPhotoRequired request being answered
  */
-export function sendPhotoCaptured(missionId: string, photoPath: string): void {
-  const message = buildMessage('PhotoCaptured', { missionId, photoPath });
-  NativeBridge.sendMessage(JSON.stringify(message));
+export function sendPhotoCaptured(missionId: string, photoPath: string, requestId?: string): void {
+  const message = buildMessage('PhotoCaptured', { missionId, photoPath }, requestId);
+  sendAnswer(message, requestId);
 }
 
 /**
- * Send parent approval/rejection for a mission
+ * Send parent approval/rejection for a mission; requestId is the
+ * correlationId of the approval request being answered
  */
 export function sendParentApproval(
   missionId: string,
   approved: boolean,
-  comment?: string
+  comment?: string,
+  requestId?: string
 ): void {
-  const message = buildMessage('ParentApproval', { missionId, approved, comment });
-  NativeBridge.sendMessage(JSON.stringify(message));
+  const message = buildMessage('ParentApproval', { missionId, approved, comment }, requestId);
+  sendAnswer(message, requestId);
 }
 
 /**
@@ -99,6 +134,50 @@ export function selectProfile(childId: string): void {
   NativeBridge.sendMessage(JSON.stringify(message));
 }
 
+/**
+ * Ask UE5 for a full profile snapshot (after a missed delta)
+ */
+export function requestProfileSnapshot(childId: string): void {
+  const message = buildMessage('RequestProfileSnapshot', { childId });
+  NativeBridge.sendMessage(JSON.stringify(message));
+}
+
+/**
+ * Hand the backend's progress sync reply to UE5
+ */
+export function sendProgressSyncReceived(childId: string, delta: ProgressDelta): void {
+  const message = buildMessage('ProgressSyncReceived', { childId, delta });
+  NativeBridge.sendMessage(JSON.stringify(message));
+}
+
+// Last catalog sent, handed to every new game session
+let missionCatalog: MissionData[] | null = null;
+
+/**
+ * Hand the backend's mission catalog to UE5 (after apiService.getMissions).
+ * UE5 keeps per-child mission state across catalog updates; the catalog is
+ * sent again whenever the game reports ready.
+ */
+export function sendMissionCatalog(missions: MissionData[]): void {
+  missionCatalog = missions;
+  const message = buildMessage('MissionCatalogUpdated', { missions });
+  NativeBridge.sendMessage(JSON.stringify(message));
+}
+
+// Last access token sent, handed to every new game session
+let accessToken: string | null = null;
+
+/**
+ * Hand the access token to UE5, which uploads mission photos itself. The API
+ * service calls this on startup, login and token refresh; UE5 waits for a
+ * token before uploading and again whenever the backend rejects the one it has.
+ */
+export function sendAuthSession(session: AuthSession): void {
+  accessToken = session.accessToken;
+  const message = buildMessage('AuthSessionUpdated', { accessToken: session.accessToken });
+  NativeBridge.sendMessage(JSON.stringify(message));
+}
+
 /**
  * Send settings changes
  */
@@ -155,21 +234,48 @@ export function onLevelFailed(callback: MessageCallback<LevelFailedData>): () =>
 }
 
 /**
- * Listen for mission photo required events
+ * Listen for mission photo required events; answer with sendPhotoCaptured
+ * and the request's correlationId
  */
 export function onMissionPhotoRequired(
-  callback: MessageCallback<{ missionId: string }>
+  callback: MessageCallback<{ missionId: string; correlationId: string }>
 ): () => void {
   return onMessage('MissionPhotoRequired', callback);
 }
 
 /**
- * Listen for game ready events
+ * Listen for parent approval requests; answer with sendParentApproval and
+ * the request's correlationId
+ */
+export function onParentApprovalRequired(
+  callback: MessageCallback<{ missionId: string; photoUrl: string; correlationId: string }>
+): () => void {
+  return onMessage('MissionCompleted', callback);
+}
+
+/**
+ * Listen for mission photo upload progress
+ */
+export function onPhotoUploadProgress(
+  callback: MessageCallback<PhotoUploadProgressData>
+): () => void {
+  return onMessage('PhotoUploadProgress', callback);
+}
+
+/**
+ * Listen for game ready events; the payload has the boot timings so far
  */
-export function onGameReady(callback: MessageCallback<void>): () => void {
+export function onGameReady(callback: MessageCallback<StartupTimingsData>): () => void {
   return onMessage('GameReady', callback);
 }
 
+/**
+ * Listen for the full boot timings, sent once stages still running at GameReady are done
+ */
+export function onStartupTimings(callback: MessageCallback<StartupTimingsData>): () => void {
+  return onMessage('StartupTimings', callback);
+}
+
 /**
  * Listen for profile update events
  */
@@ -179,16 +285,114 @@ export function onProfileUpdated(
   return onMessage('ProfileDataUpdated', callback);
 }
 
+/**
+ * Listen for full profile snapshots
+ */
+export function onProfileSnapshot(
+  callback: MessageCallback<ProfileSnapshotData>
+): () => void {
+  return onMessage('ProfileSnapshot', callback);
+}
+
+// Last applied sequence per child, scoped to the game session epoch
+const profileSequences: Map<string, { epoch: string; sequence: number }> = new Map();
+
+// Children with a snapshot request in flight, and when it was sent
+const pendingSnapshots: Map<string, number> = new Map();
+
+// Ask again if a requested snapshot hasn't arrived by then
+const SNAPSHOT_REQUEST_TIMEOUT_MS = 5000;
+
+/**
+ * Listen for profile deltas. Deltas are only delivered in order; on a gap or
+ * a new game session a snapshot is requested and delivered via onProfileSnapshot.
+ * Only one snapshot is requested at a time per child, and deltas for that
+ * child are dropped until it arrives (the snapshot includes them).
+ */
+export function onProfileDelta(
+  callback: MessageCallback<ProfileDeltaData>
+): () => void {
+  const unsubscribeSnapshot = onMessage<ProfileSnapshotData>('ProfileSnapshot', (snapshot) => {
+    pendingSnapshots.delete(snapshot.childId);
+    profileSequences.set(snapshot.childId, {
+      epoch: snapshot.epoch,
+      sequence: snapshot.sequence,
+    });
+  });
+
+  const unsubscribeDelta = onMessage<ProfileDeltaData>('ProfileDelta', (delta) => {
+    const requestedAt = pendingSnapshots.get(delta.childId);
+    if (requestedAt !== undefined) {
+      if (Date.now() - requestedAt < SNAPSHOT_REQUEST_TIMEOUT_MS) {
+        return;
+      }
+      pendingSnapshots.delete(delta.childId);
+    }
+
+    const last = profileSequences.get(delta.childId);
+    if (!last || last.epoch !== delta.epoch || delta.sequence !== last.sequence + 1) {
+      pendingSnapshots.set(delta.childId, Date.now());
+      requestProfileSnapshot(delta.childId);
+      return;
+    }
+    last.sequence = delta.sequence;
+    callback(delta);
+  });
+
+  return () => {
+    unsubscribeSnapshot();
+    unsubscribeDelta();
+  };
+}
+
+/**
+ * Listen for progress changes to exchange with the backend
+ * (apiService.exchangeProgress, then sendProgressSyncReceived with the reply)
+ */
+export function onProgressSyncDelta(
+  callback: MessageCallback<ProgressSyncDeltaData>
+): () => void {
+  return onMessage('ProgressSyncDelta', callback);
+}
+
+/**
+ * Listen for legacy child IDs the game re-keyed while loading its save; data
+ * stored under a legacyId belongs to the childId from now on
+ */
+export function onChildIdsMigrated(
+  callback: MessageCallback<ChildIdsMigratedData>
+): () => void {
+  return onMessage('ChildIdsMigrated', callback);
+}
+
 // ============================================
 // Native Event Handling
 // ============================================
 
+// Requests UE5 may replay after a restart or reconnect
+function isMissionRequest(type: RNUEMessageType): boolean {
+  return type === 'MissionPhotoRequired' || type === 'MissionCompleted';
+}
+
 // Handle incoming messages from native
 function handleNativeMessage(event: { message: string }): void {
   try {
     const message: RNUEMessage = JSON.parse(event.message);
     const payload = message.payload ? JSON.parse(message.payload) : {};
 
+    if (isMissionRequest(message.type) && message.correlationId) {
+      const answer = answeredRequests.get(message.correlationId);
+      if (answer) {
+        NativeBridge.sendMessage(JSON.stringify(answer));
+        return;
+      }
+      if (openRequests.has(message.correlationId)) {
+        return;
+      }
+      openRequests.add(message.correlationId);
+      payload.correlationId = message.correlationId;
+    }
+
     const callbacks = listeners.get(message.type);
     if (callbacks) {
       callbacks.forEach((callback) => callback(payload));
@@ -203,6 +407,17 @@ if (bridgeEmitter) {
   bridgeEmitter.addListener('onUnrealMessage', handleNativeMessage);
 }
 
+// A new game session starts without the mission catalog or a token
+onMessage('GameReady', () => {
+  if (missionCatalog) {
+    sendMissionCatalog(missionCatalog);
+  }
+  if (accessToken) {
+    const message = buildMessage('AuthSessionUpdated', { accessToken });
+    NativeBridge.sendMessage(JSON.stringify(message));
+  }
+});
+
 // ============================================
 // Utility Functions
 // ============================================
@@ -234,13 +449,24 @@ export default {
   sendParentApproval,
   selectProfile,
   updateSettings,
+  requestProfileSnapshot,
+  sendProgressSyncReceived,
+  sendMissionCatalog,
+  sendAuthSession,
   // Incoming
   onMessage,
   onLevelCompleted,
   onLevelFailed,
   onMissionPhotoRequired,
+  onPhotoUploadProgress,
+  onParentApprovalRequired,
   onGameReady,
+  onStartupTimings,
   onProfileUpdated,
+  onProfileSnapshot,
+  onProfileDelta,
+  onProgressSyncDelta,
+  onChildIdsMigrated,
   // Utility
   isGameReady,
   getPlatformInfo,
@@ -75,6 +75,21 @@ export interface SubjectProgress {
   averageResponseTime: number;
 }
 
+export interface ResponseTimeHistogram {
+  counts: number[]; // 16 buckets, upper edge 0.5 * 2^(i/2) seconds; last is open-ended
+  totalSeconds: number;
+}
+
+export interface SubjectStats {
+  questionsAnswered: number;
+  questionsCorrect: number;
+  responseTimes: ResponseTimeHistogram;
+}
+
+export interface SubjectProgressTable {
+  cells: SubjectStats[]; // subject * 4 + difficulty
+}
+
 export interface ChildProfile {
   childId: string;
   displayName: string;
@@ -85,7 +100,8 @@ export interface ChildProfile {
   currentStreak: number;
   lastPlayedDate: Date;
   levelProgress: Record<string, LevelProgress>; // "W1L1" format
-  subjectProgress: Record<string, SubjectProgress>;
+  subjects: SubjectProgressTable;
+  subjectProgress: Record<string, SubjectProgress>; // older saves only, empty once loaded
   completedMissions: string[];
   unlockedAchievements: string[];
 }
@@ -112,6 +128,12 @@ export type RNUEMessageType =
   | 'MissionCompleted'
   | 'ProfileDataUpdated'
   | 'PauseRequested'
+  | 'ProfileDelta'
+  | 'ProfileSnapshot'
+  | 'ProgressSyncDelta'
+  | 'StartupTimings'
+  | 'PhotoUploadProgress'
+  | 'ChildIdsMigrated'
   // React Native -> Game
   | 'StartLevel'
   | 'PauseGame'
@@ -119,7 +141,11 @@ export type RNUEMessageType =
   | 'PhotoCaptured'
   | 'ParentApproval'
   | 'ProfileSelected'
-  | 'SettingsChanged';
+  | 'SettingsChanged'
+  | 'RequestProfileSnapshot'
+  | 'ProgressSyncReceived'
+  | 'MissionCatalogUpdated'
+  | 'AuthSessionUpdated';
 
 export interface RNUEMessage {
   type: RNUEMessageType;
@@ -140,6 +166,99 @@ export interface LevelFailedData {
   levelId: number;
 }
 
+/**
+ * Mission photo upload progress; UE5 uploads the photo itself and may skip
+ * intermediate updates when the bridge is busy, never the final one
+ */
+export interface PhotoUploadProgressData {
+  missionId: string;
+  uploadedBytes: number;
+  totalBytes: number;
+}
+
+/**
+ * Boot stage timings, in ms since process start. GameReady carries the
+ * stages done so far; StartupTimings follows once every stage is done
+ * (only when some were still running at GameReady).
+ */
+export interface StartupStageTiming {
+  name: string;
+  startMs: number;
+  durationMs?: number; // absent while the stage is still running
+  succeeded?: boolean;
+}
+
+export interface StartupTimingsData {
+  bootStartMs: number;
+  gameReadyMs: number;
+  stages: StartupStageTiming[];
+}
+
+/**
+ * Profile sync payloads. Keys inside `profile`, `counters` and
+ * `levelProgress` follow Unreal's JSON struct naming (e.g. `totalXP`).
+ */
+export interface ProfileSyncHeader {
+  childId: string;
+  epoch: string; // changes every game session
+  sequence: number; // +1 per delta/snapshot within an epoch
+}
+
+export interface ProfileSnapshotData extends ProfileSyncHeader {
+  profile: Record<string, unknown>;
+}
+
+export interface ProfileDeltaData extends ProfileSyncHeader {
+  counters?: { coins?: number; totalXP?: number };
+  levelProgress?: Record<string, Record<string, unknown>>;
+  completedMissions?: string[];
+  unlockedAchievements?: string[];
+}
+
+/**
+ * Multi-device progress sync. Every element carries the device (`origin`)
+ * and that device's `version` of its last change; `vv` is the sender's
+ * version vector. Merging is idempotent, so deltas may be delivered twice.
+ */
+export interface ProgressDot {
+  origin: string;
+  version: number;
+}
+
+export interface ProgressDelta {
+  vv: Record<string, number>;
+  counters: Array<
+    ProgressDot & { counter: 'coins' | 'xp'; owner: string; added: number; removed: number }
+  >;
+  levels: Array<
+    ProgressDot & { level: string; completed: boolean; stars: number; highScore: number; coins: number }
+  >;
+  missions: Array<ProgressDot & { id: string }>;
+  achievements: Array<ProgressDot & { id: string }>;
+}
+
+/** Game -> RN: post to the backend, answer with ProgressSyncReceived */
+export interface ProgressSyncDeltaData {
+  childId: string;
+  deviceId: string;
+  delta: ProgressDelta;
+}
+
+/**
+ * Game -> RN: child IDs from saves made before they were GUIDs. Each legacy
+ * string now loads as the version 5 UUID of its UTF-8 bytes in namespace
+ * 8f7c1f0e-2b6a-4d3c-9e51-7a0b4c2d9e13, written as 32 uppercase hex digits.
+ */
+export interface ChildIdsMigratedData {
+  migrations: Array<{ legacyId: string; childId: string }>;
+}
+
+/** RN -> Game: the backend's reply, what this device is missing */
+export interface ProgressSyncReceivedData {
+  childId: string;
+  delta: ProgressDelta;
+}
+
 // ============================================
 // Navigation Types
 // ============================================
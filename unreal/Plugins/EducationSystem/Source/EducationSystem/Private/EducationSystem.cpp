@@ -0,0 +1,20 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "EducationSystem.h"
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY(LogEducationSystem);
+
+LLM_DEFINE_TAG(EducationSystem);
+
+void FEducationSystemModule::StartupModule()
+{
+	UE_LOG(LogEducationSystem, Log, TEXT("EducationSystem module starting up"));
+}
+
+void FEducationSystemModule::ShutdownModule()
+{
+	UE_LOG(LogEducationSystem, Log, TEXT("EducationSystem module shutting down"));
+}
+
+IMPLEMENT_MODULE(FEducationSystemModule, EducationSystem);
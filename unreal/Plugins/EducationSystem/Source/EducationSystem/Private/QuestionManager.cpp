@@ -0,0 +1,297 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "QuestionManager.h"
+#include "EducationSystem.h"
+#include "Core/SuperfamilyStats.h"
+#include "Gameplay/SuperfamilyVoiceOverSubsystem.h"
+#include "Engine/DataTable.h"
+#include "Dom/JsonObject.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "JsonObjectConverter.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+void UQuestionManager::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+}
+
+void UQuestionManager::Deinitialize()
+{
+	QuestionPool.Empty();
+	QuestionSlotByID.Empty();
+	++PoolGeneration;
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Question Loading
+// ============================================
+
+void UQuestionManager::LoadQuestionsFromDataTable(UDataTable* QuestionTable)
+{
+	LLM_SCOPE_BYTAG(EducationSystem);
+
+	const UScriptStruct* RowStruct = QuestionTable ? QuestionTable->GetRowStruct() : nullptr;
+	if (!RowStruct || !RowStruct->IsChildOf(FQuestionData::StaticStruct()))
+	{
+		UE_LOG(LogEducationSystem, Warning, TEXT("Question table %s does not have FQuestionData rows"), *GetNameSafe(QuestionTable));
+		return;
+	}
+
+	const TMap<FName, uint8*>& Rows = QuestionTable->GetRowMap();
+	QuestionPool.Reserve(QuestionPool.Num() + Rows.Num());
+
+	int32 Added = 0;
+	for (const TPair<FName, uint8*>& Row : Rows)
+	{
+		const FQuestionData* Question = reinterpret_cast<const FQuestionData*>(Row.Value);
+		if (!Question->QuestionID.IsValid())
+		{
+			UE_LOG(LogEducationSystem, Warning, TEXT("Question row %s in %s has no ID; skipping"), *Row.Key.ToString(), *QuestionTable->GetName());
+			continue;
+		}
+
+		QuestionPool.Add(*Question);
+		++Added;
+	}
+	++PoolGeneration;
+
+	UE_LOG(LogEducationSystem, Log, TEXT("Loaded %d questions from %s (%d in pool)"), Added, *QuestionTable->GetName(), QuestionPool.Num());
+}
+
+void UQuestionManager::LoadQuestionsFromCMS(const FString& Endpoint)
+{
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Endpoint);
+	Request->SetVerb(TEXT("GET"));
+	Request->SetHeader(TEXT("Accept"), TEXT("application/json"));
+
+	Request->OnProcessRequestComplete().BindWeakLambda(this, [this, Endpoint](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnected)
+	{
+		if (!bConnected || !Response.IsValid() || !EHttpResponseCodes::IsOk(Response->GetResponseCode()))
+		{
+			UE_LOG(LogEducationSystem, Warning, TEXT("Question CMS request to %s failed (%d)"), *Endpoint, Response.IsValid() ? Response->GetResponseCode() : 0);
+			return;
+		}
+
+		LLM_SCOPE_BYTAG(EducationSystem);
+
+		TSharedPtr<FJsonObject> Root;
+		TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(Response->GetContentAsString());
+		const TArray<TSharedPtr<FJsonValue>>* QuestionValues = nullptr;
+		if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid() || !Root->TryGetArrayField(TEXT("questions"), QuestionValues))
+		{
+			UE_LOG(LogEducationSystem, Warning, TEXT("Question CMS payload is not a { \"questions\": [...] } object"));
+			return;
+		}
+
+		TArray<FQuestionData> NewQuestions;
+		if (!FJsonObjectConverter::JsonArrayToUStruct(*QuestionValues, &NewQuestions))
+		{
+			UE_LOG(LogEducationSystem, Warning, TEXT("Question CMS payload has malformed questions"));
+			return;
+		}
+
+		NewQuestions.RemoveAll([](const FQuestionData& Question) { return !Question.QuestionID.IsValid(); });
+
+		// The CMS catalog is authoritative and replaces whatever was loaded before
+		QuestionPool = MoveTemp(NewQuestions);
+		++PoolGeneration;
+		UE_LOG(LogEducationSystem, Log, TEXT("Loaded %d questions from CMS"), QuestionPool.Num());
+	});
+
+	Request->ProcessRequest();
+}
+
+// ============================================
+// Question Retrieval
+// ============================================
+
+FQuestionData UQuestionManager::GetQuestion(EQuestionSubject Subject, EDifficultyLevel Difficulty)
+{
+	TArray<FQuestionData> Questions = GetQuestionSet(Subject, Difficulty, 1);
+	if (Questions.IsEmpty())
+	{
+		UE_LOG(LogEducationSystem, Warning, TEXT("No questions for subject %d at difficulty %d"), static_cast<int32>(Subject), static_cast<int32>(Difficulty));
+		return FQuestionData();
+	}
+	return MoveTemp(Questions[0]);
+}
+
+FQuestionData UQuestionManager::GetQuestionByID(const FQuestionId& QuestionID)
+{
+	const FQuestionData* Question = FindQuestion(QuestionID);
+	return Question ? *Question : FQuestionData();
+}
+
+TArray<FQuestionData> UQuestionManager::GetQuestionSet(EQuestionSubject Subject, EDifficultyLevel Difficulty, int32 Count)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyQuestionSet);
+	CSV_SCOPED_TIMING_STAT(Superfamily, QuestionSet);
+
+	TArray<int32> Candidates;
+	for (int32 Index = 0; Index < QuestionPool.Num(); ++Index)
+	{
+		if (QuestionPool[Index].Subject == Subject && QuestionPool[Index].Difficulty == Difficulty)
+		{
+			Candidates.Add(Index);
+		}
+	}
+
+	// Partial Fisher-Yates: only the first Count slots need to be shuffled
+	const int32 NumQuestions = FMath::Clamp(Count, 0, Candidates.Num());
+	TArray<FQuestionData> Questions;
+	Questions.Reserve(NumQuestions);
+	for (int32 Index = 0; Index < NumQuestions; ++Index)
+	{
+		Candidates.Swap(Index, FMath::RandRange(Index, Candidates.Num() - 1));
+		Questions.Add(QuestionPool[Candidates[Index]]);
+	}
+	return Questions;
+}
+
+void UQuestionManager::RequestQuestionSet(EQuestionSubject Subject, EDifficultyLevel Difficulty, int32 Count, TFunction<void(TArray<FQuestionData>&&)> OnReady)
+{
+	LLM_SCOPE_BYTAG(EducationSystem);
+
+	TArray<FQuestionData> Questions = GetQuestionSet(Subject, Difficulty, Count);
+
+	// Pool loading lives in CMS/DataTable callbacks; a set request is where its size matters
+	SET_MEMORY_STAT(STAT_SuperfamilyQuestionPoolMemory, QuestionPool.GetAllocatedSize());
+
+	// Voice-overs start streaming while the caller sets up the first question
+	if (USuperfamilyVoiceOverSubsystem* VoiceOver = GetGameInstance()->GetSubsystem<USuperfamilyVoiceOverSubsystem>())
+	{
+		VoiceOver->PrefetchQuestions(Questions);
+	}
+	OnReady(MoveTemp(Questions));
+}
+
+bool UQuestionManager::SubmitQuestionAnswer(const FQuestionId& QuestionID, int32 AnswerIndex, float ResponseTime)
+{
+	LLM_SCOPE_BYTAG(EducationSystem);
+	return SubmitAnswer(QuestionID, AnswerIndex, ResponseTime);
+}
+
+void UQuestionManager::AddQuestionPack(UDataTable* QuestionTable)
+{
+	LoadQuestionsFromDataTable(QuestionTable);
+}
+
+int64 UQuestionManager::GetBudgetedMemoryBytes() const
+{
+	// The pool is the source of truth for question IDs in progress data, so it is reported but never trimmed
+	int64 Bytes = QuestionPool.GetAllocatedSize() + SubjectAccuracy.GetAllocatedSize() + QuestionSlotByID.GetAllocatedSize();
+	for (const FQuestionData& Question : QuestionPool)
+	{
+		Bytes += Question.AudioCueID.GetAllocatedSize()
+			+ Question.ImageAssetPath.GetAllocatedSize() + Question.Answers.GetAllocatedSize();
+	}
+	return Bytes;
+}
+
+// ============================================
+// Answer Handling
+// ============================================
+
+bool UQuestionManager::SubmitAnswer(const FQuestionId& QuestionID, int32 AnswerIndex, float ResponseTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyQuestionAnswer);
+	CSV_SCOPED_TIMING_STAT(Superfamily, QuestionAnswer);
+
+	const FQuestionData* Question = FindQuestion(QuestionID);
+	if (!Question)
+	{
+		UE_LOG(LogEducationSystem, Warning, TEXT("Answer submitted for unknown question %s"), *QuestionID.ToString());
+		return false;
+	}
+
+	const bool bCorrect = AnswerIndex == Question->CorrectAnswerIndex;
+
+	++SessionQuestionsAnswered;
+	if (bCorrect)
+	{
+		++SessionQuestionsCorrect;
+		++CurrentStreak;
+		MaxStreak = FMath::Max(MaxStreak, CurrentStreak);
+	}
+	else
+	{
+		CurrentStreak = 0;
+	}
+
+	// Moving average so recent answers weigh most
+	float& Accuracy = SubjectAccuracy.FindOrAdd(Question->Subject, 0.5f);
+	Accuracy = FMath::Lerp(Accuracy, bCorrect ? 1.0f : 0.0f, 0.2f);
+
+	OnQuestionAnswered.Broadcast(QuestionID, bCorrect, ResponseTime);
+	OnStreakUpdated.Broadcast(CurrentStreak, MaxStreak);
+	return bCorrect;
+}
+
+bool UQuestionManager::IsAnswerCorrect(const FQuestionId& QuestionID, int32 AnswerIndex) const
+{
+	const FQuestionData* Question = FindQuestion(QuestionID);
+	return Question && AnswerIndex == Question->CorrectAnswerIndex;
+}
+
+// ============================================
+// Adaptive Difficulty
+// ============================================
+
+EDifficultyLevel UQuestionManager::GetRecommendedDifficulty(EQuestionSubject Subject) const
+{
+	const float* Accuracy = SubjectAccuracy.Find(Subject);
+	if (!Accuracy)
+	{
+		return EDifficultyLevel::Groep1;
+	}
+
+	if (*Accuracy >= 0.85f)
+	{
+		return EDifficultyLevel::Groep4;
+	}
+	if (*Accuracy >= 0.7f)
+	{
+		return EDifficultyLevel::Groep3;
+	}
+	if (*Accuracy >= 0.5f)
+	{
+		return EDifficultyLevel::Groep2;
+	}
+	return EDifficultyLevel::Groep1;
+}
+
+// ============================================
+// Statistics
+// ============================================
+
+float UQuestionManager::GetSessionAccuracy() const
+{
+	return SessionQuestionsAnswered > 0 ? static_cast<float>(SessionQuestionsCorrect) / SessionQuestionsAnswered : 0.0f;
+}
+
+// ============================================
+// Lookup
+// ============================================
+
+const FQuestionData* UQuestionManager::FindQuestion(const FQuestionId& QuestionID) const
+{
+	// Loaders bump the generation; the index catches up on the next lookup
+	if (IndexedGeneration != PoolGeneration)
+	{
+		QuestionSlotByID.Reset();
+		for (int32 Index = 0; Index < QuestionPool.Num(); ++Index)
+		{
+			QuestionSlotByID.Add(QuestionPool[Index].QuestionID, Index);
+		}
+		IndexedGeneration = PoolGeneration;
+	}
+
+	const int32* Slot = QuestionSlotByID.Find(QuestionID);
+	return Slot ? &QuestionPool[*Slot] : nullptr;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "QuestionProgressRelay.h"
+#include "QuestionManager.h"
+#include "Core/SuperfamilyEventBus.h"
+#include "Core/SuperfamilyGameInstance.h"
+
+void UQuestionProgressRelay::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	QuestionManager = Collection.InitializeDependency<UQuestionManager>();
+	if (QuestionManager)
+	{
+		QuestionManager->OnQuestionAnswered.AddDynamic(this, &UQuestionProgressRelay::HandleQuestionAnswered);
+		QuestionManager->OnStreakUpdated.AddDynamic(this, &UQuestionProgressRelay::HandleStreakUpdated);
+	}
+}
+
+void UQuestionProgressRelay::Deinitialize()
+{
+	if (QuestionManager)
+	{
+		QuestionManager->OnQuestionAnswered.RemoveAll(this);
+		QuestionManager->OnStreakUpdated.RemoveAll(this);
+		QuestionManager = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+void UQuestionProgressRelay::HandleQuestionAnswered(const FQuestionId& QuestionID, bool bCorrect, float ResponseTime)
+{
+	if (!QuestionManager)
+	{
+		return;
+	}
+
+	const FQuestionData Question = QuestionManager->GetQuestionByID(QuestionID);
+
+	if (USuperfamilyGameInstance* GI = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		GI->RecordAnswer(Question.Subject, Question.Difficulty, bCorrect, ResponseTime);
+	}
+
+	if (USuperfamilyEventBus* Events = GetGameInstance()->GetSubsystem<USuperfamilyEventBus>())
+	{
+		FQuestionAnsweredEvent Event;
+		Event.QuestionID = QuestionID;
+		Event.Subject = Question.Subject;
+		Event.Difficulty = Question.Difficulty;
+		Event.bCorrect = bCorrect;
+		Event.ResponseTime = ResponseTime;
+		Events->Publish(Event);
+	}
+}
+
+void UQuestionProgressRelay::HandleStreakUpdated(int32 CurrentStreak, int32 MaxStreak)
+{
+	if (USuperfamilyEventBus* Events = GetGameInstance()->GetSubsystem<USuperfamilyEventBus>())
+	{
+		FStreakUpdatedEvent Event;
+		Event.CurrentStreak = CurrentStreak;
+		Event.MaxStreak = MaxStreak;
+		Events->Publish(Event);
+	}
+}
@@ -0,0 +1,20 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Modules/ModuleManager.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogEducationSystem, Log, All);
+
+/** LLM tag for question catalogs and answer tracking */
+LLM_DECLARE_TAG_API(EducationSystem, EDUCATIONSYSTEM_API);
+
+class FEducationSystemModule : public IModuleInterface
+{
+public:
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+};
@@ -5,9 +5,11 @@
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Types/SuperfamilyTypes.h"
+#include "Core/MemoryBudgetClient.h"
+#include "Gameplay/QuestionSetProvider.h"
 #include "QuestionManager.generated.h"
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnQuestionAnswered, const FString&, QuestionID, bool, bCorrect, float, ResponseTime);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnQuestionAnswered, const FQuestionId&, QuestionID, bool, bCorrect, float, ResponseTime);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnStreakUpdated, int32, CurrentStreak, int32, MaxStreak);
 
 /**
@@ -15,7 +17,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnStreakUpdated, int32, CurrentStr
  * Handles question loading, retrieval, answer validation, and progress tracking
  */
 UCLASS()
-class EDUCATIONSYSTEM_API UQuestionManager : public UGameInstanceSubsystem
+class EDUCATIONSYSTEM_API UQuestionManager : public UGameInstanceSubsystem, public IQuestionSetProvider, public IMemoryBudgetClient
 {
 	GENERATED_BODY()
 
@@ -51,23 +53,34 @@ public:
 
 	/** Get a specific question by ID */
 	UFUNCTION(BlueprintCallable, Category = "Education")
-	FQuestionData GetQuestionByID(const FString& QuestionID);
+	FQuestionData GetQuestionByID(const FQuestionId& QuestionID);
 
 	/** Get multiple questions for a session */
 	UFUNCTION(BlueprintCallable, Category = "Education")
 	TArray<FQuestionData> GetQuestionSet(EQuestionSubject Subject, EDifficultyLevel Difficulty, int32 Count);
 
+	//~ Begin IQuestionSetProvider Interface
+	virtual void RequestQuestionSet(EQuestionSubject Subject, EDifficultyLevel Difficulty, int32 Count, TFunction<void(TArray<FQuestionData>&&)> OnReady) override;
+	virtual bool SubmitQuestionAnswer(const FQuestionId& QuestionID, int32 AnswerIndex, float ResponseTime) override;
+	virtual void AddQuestionPack(UDataTable* QuestionTable) override;
+	//~ End IQuestionSetProvider Interface
+
+	//~ Begin IMemoryBudgetClient Interface
+	virtual FName GetMemoryBudgetName() const override { return TEXT("Questions"); }
+	virtual int64 GetBudgetedMemoryBytes() const override;
+	//~ End IMemoryBudgetClient Interface
+
 	// ============================================
 	// Answer Handling
 	// ============================================
 
 	/** Submit an answer for a question */
 	UFUNCTION(BlueprintCallable, Category = "Education")
-	bool SubmitAnswer(const FString& QuestionID, int32 AnswerIndex, float ResponseTime);
+	bool SubmitAnswer(const FQuestionId& QuestionID, int32 AnswerIndex, float ResponseTime);
 
 	/** Check if an answer is correct without submitting */
 	UFUNCTION(BlueprintPure, Category = "Education")
-	bool IsAnswerCorrect(const FString& QuestionID, int32 AnswerIndex) const;
+	bool IsAnswerCorrect(const FQuestionId& QuestionID, int32 AnswerIndex) const;
 
 	// ============================================
 	// Adaptive Difficulty
@@ -108,6 +121,9 @@ protected:
 	UPROPERTY()
 	TArray<FQuestionData> QuestionPool;
 
+	/** Bumped by every write to QuestionPool so the ID index knows to rebuild */
+	uint32 PoolGeneration = 1;
+
 	/** Session statistics */
 	int32 SessionQuestionsAnswered = 0;
 	int32 SessionQuestionsCorrect = 0;
@@ -119,5 +135,9 @@ protected:
 
 private:
 	/** Find question by ID in pool */
-	const FQuestionData* FindQuestion(const FString& QuestionID) const;
+	const FQuestionData* FindQuestion(const FQuestionId& QuestionID) const;
+
+	/** Pool index of every question */
+	mutable TMap<FQuestionId, int32> QuestionSlotByID;
+	mutable uint32 IndexedGeneration = 0;
 };
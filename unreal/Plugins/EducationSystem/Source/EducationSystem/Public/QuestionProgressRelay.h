@@ -0,0 +1,37 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Types/SuperfamilyIds.h"
+#include "QuestionProgressRelay.generated.h"
+
+class UQuestionManager;
+
+/**
+ * Forwards answers and answer streaks from the question manager to the game,
+ * which can't see this plugin: answers go into the active child's subject
+ * table, and answers and streaks are published on the event bus.
+ */
+UCLASS()
+class EDUCATIONSYSTEM_API UQuestionProgressRelay : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+private:
+	UFUNCTION()
+	void HandleQuestionAnswered(const FQuestionId& QuestionID, bool bCorrect, float ResponseTime);
+
+	UFUNCTION()
+	void HandleStreakUpdated(int32 CurrentStreak, int32 MaxStreak);
+
+	UPROPERTY()
+	TObjectPtr<UQuestionManager> QuestionManager;
+};
@@ -0,0 +1,20 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "RNUEBridge.h"
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY(LogRNUEBridge);
+
+LLM_DEFINE_TAG(RNUEBridge);
+
+void FRNUEBridgeModule::StartupModule()
+{
+	UE_LOG(LogRNUEBridge, Log, TEXT("RNUEBridge module starting up"));
+}
+
+void FRNUEBridgeModule::ShutdownModule()
+{
+	UE_LOG(LogRNUEBridge, Log, TEXT("RNUEBridge module shutting down"));
+}
+
+IMPLEMENT_MODULE(FRNUEBridgeModule, RNUEBridge);
@@ -0,0 +1,521 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "RNUEBridgeSubsystem.h"
+#include "RNUEBridge.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+// Same group as Superfamily's SuperfamilyStats.h, which this module can't include
+DECLARE_STATS_GROUP(TEXT("Superfamily"), STATGROUP_Superfamily, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Bridge Enqueue"), STAT_RNUEBridgeEnqueue, STATGROUP_Superfamily);
+DECLARE_CYCLE_STAT(TEXT("Bridge Tick Lanes"), STAT_RNUEBridgeTickLanes, STATGROUP_Superfamily);
+DECLARE_CYCLE_STAT(TEXT("Bridge Receive"), STAT_RNUEBridgeReceive, STATGROUP_Superfamily);
+DECLARE_MEMORY_STAT(TEXT("Bridge Queued Messages"), STAT_RNUEBridgeQueuedMemory, STATGROUP_Superfamily);
+
+CSV_DEFINE_CATEGORY(RNUEBridge, true);
+
+namespace
+{
+	FString SerializeJsonObject(const TSharedRef<FJsonObject>& Object)
+	{
+		FString Output;
+		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Output);
+		FJsonSerializer::Serialize(Object, Writer);
+		return Output;
+	}
+
+	TSharedPtr<FJsonObject> ParseJsonObject(const FString& JSON)
+	{
+		TSharedPtr<FJsonObject> Object;
+		TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(JSON);
+		if (!FJsonSerializer::Deserialize(Reader, Object))
+		{
+			return nullptr;
+		}
+		return Object;
+	}
+
+	/** Budgets count what crosses the native transport, which carries UTF-8 */
+	int32 GetUTF8Size(const FString& String)
+	{
+		return FTCHARToUTF8(*String, String.Len()).Length();
+	}
+
+	FString MessageTypeToString(ERNUEMessageType Type)
+	{
+		return StaticEnum<ERNUEMessageType>()->GetNameStringByValue(static_cast<int64>(Type));
+	}
+}
+
+void URNUEBridgeSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &URNUEBridgeSubsystem::TickLanes));
+
+	UE_LOG(LogRNUEBridge, Log, TEXT("RNUE bridge initialized"));
+}
+
+void URNUEBridgeSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+
+	// Deliver whatever is still queued so the app sees the final state
+	for (FLane& Lane : OutgoingLanes)
+	{
+		DrainLane(Lane, MAX_int32);
+	}
+
+	NativeSendHandler.Unbind();
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Outgoing Messages (UE5 -> React Native)
+// ============================================
+
+void URNUEBridgeSubsystem::SendToReactNative(const FRNUEMessage& Message)
+{
+	EnqueueMessage(Message, GetDefaultPriority(Message.Type), false);
+}
+
+ERNUEEnqueueResult URNUEBridgeSubsystem::EnqueueMessage(const FRNUEMessage& Message, ERNUEMessagePriority Priority, bool bDroppable)
+{
+	LLM_SCOPE_BYTAG(RNUEBridge);
+	SCOPE_CYCLE_COUNTER(STAT_RNUEBridgeEnqueue);
+
+	FLane& Lane = OutgoingLanes[static_cast<int32>(Priority)];
+
+	if (Priority == ERNUEMessagePriority::Bulk && bDroppable && Lane.QueuedBytes >= BulkLaneHighWaterBytes)
+	{
+		++DroppedMessageCount;
+		return ERNUEEnqueueResult::Dropped;
+	}
+
+	TSharedRef<FJsonObject> Envelope = MakeShared<FJsonObject>();
+	Envelope->SetStringField(TEXT("type"), MessageTypeToString(Message.Type));
+	Envelope->SetStringField(TEXT("payload"), Message.Payload);
+	Envelope->SetStringField(TEXT("correlationId"), Message.CorrelationID.IsEmpty() ? GenerateCorrelationID() : Message.CorrelationID);
+
+	FQueuedMessage& Queued = Lane.Messages.AddDefaulted_GetRef();
+	Queued.MessageJSON = SerializeJsonObject(Envelope);
+	Queued.Bytes = GetUTF8Size(Queued.MessageJSON);
+	Queued.bDroppable = bDroppable;
+	Lane.QueuedBytes += Queued.Bytes;
+
+	if (Priority == ERNUEMessagePriority::Control)
+	{
+		// Control traffic goes out immediately unless this frame's control budget is spent
+		const int32 Budget = ControlLaneBytesPerFrame - ControlBytesThisFrame;
+		if (Budget > 0)
+		{
+			const int32 QueuedBefore = Lane.QueuedBytes;
+			DrainLane(Lane, Budget);
+			ControlBytesThisFrame += QueuedBefore - Lane.QueuedBytes;
+		}
+		return ERNUEEnqueueResult::Queued;
+	}
+
+	if (Lane.QueuedBytes > BulkLaneMaxBytes)
+	{
+		EvictDroppable(Lane);
+	}
+
+	UpdateBackpressure();
+	return bBulkUnderPressure ? ERNUEEnqueueResult::QueuedUnderPressure : ERNUEEnqueueResult::Queued;
+}
+
+int32 URNUEBridgeSubsystem::GetQueuedBytes(ERNUEMessagePriority Priority) const
+{
+	return OutgoingLanes[static_cast<int32>(Priority)].QueuedBytes;
+}
+
+int64 URNUEBridgeSubsystem::GetQueuedMemoryBytes() const
+{
+	int64 Bytes = IncomingBulk.GetAllocatedSize();
+	for (const FLane& Lane : OutgoingLanes)
+	{
+		Bytes += Lane.Messages.GetAllocatedSize();
+		for (const FQueuedMessage& Queued : Lane.Messages)
+		{
+			Bytes += Queued.MessageJSON.GetAllocatedSize();
+		}
+	}
+	for (const FIncomingMessage& Incoming : IncomingBulk)
+	{
+		Bytes += Incoming.Message.Payload.GetAllocatedSize() + Incoming.Message.CorrelationID.GetAllocatedSize();
+	}
+	return Bytes;
+}
+
+ERNUEMessagePriority URNUEBridgeSubsystem::GetDefaultPriority(ERNUEMessageType Type)
+{
+	switch (Type)
+	{
+	case ERNUEMessageType::GameReady:
+	case ERNUEMessageType::LevelCompleted:
+	case ERNUEMessageType::LevelFailed:
+	case ERNUEMessageType::PauseRequested:
+	case ERNUEMessageType::StartLevel:
+	case ERNUEMessageType::PauseGame:
+	case ERNUEMessageType::ResumeGame:
+	case ERNUEMessageType::ProfileSelected:
+	case ERNUEMessageType::SettingsChanged:
+		return ERNUEMessagePriority::Control;
+
+	default:
+		return ERNUEMessagePriority::Bulk;
+	}
+}
+
+void URNUEBridgeSubsystem::NotifyGameReady(const FString& StartupTimingsJSON)
+{
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::GameReady;
+	Message.Payload = StartupTimingsJSON.IsEmpty() ? TEXT("{}") : StartupTimingsJSON;
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::SendStartupTimings(const FString& StartupTimingsJSON)
+{
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::StartupTimings;
+	Message.Payload = StartupTimingsJSON;
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::NotifyLevelCompleted(int32 WorldID, int32 LevelID, int32 Stars, int32 XPEarned, int32 CoinsCollected)
+{
+	TSharedRef<FJsonObject> Payload = MakeShared<FJsonObject>();
+	Payload->SetNumberField(TEXT("worldId"), WorldID);
+	Payload->SetNumberField(TEXT("levelId"), LevelID);
+	Payload->SetNumberField(TEXT("stars"), Stars);
+	Payload->SetNumberField(TEXT("xpEarned"), XPEarned);
+	Payload->SetNumberField(TEXT("coinsCollected"), CoinsCollected);
+
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::LevelCompleted;
+	Message.Payload = SerializeJsonObject(Payload);
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::NotifyLevelFailed(int32 WorldID, int32 LevelID)
+{
+	TSharedRef<FJsonObject> Payload = MakeShared<FJsonObject>();
+	Payload->SetNumberField(TEXT("worldId"), WorldID);
+	Payload->SetNumberField(TEXT("levelId"), LevelID);
+
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::LevelFailed;
+	Message.Payload = SerializeJsonObject(Payload);
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::RequestPhotoCapture(const FString& MissionID, const FString& CorrelationID)
+{
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::MissionPhotoRequired;
+	Message.Payload = BuildPayload({ { TEXT("missionId"), MissionID } });
+	Message.CorrelationID = CorrelationID;
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::RequestParentApproval(const FString& MissionID, const FString& PhotoURL, const FString& CorrelationID)
+{
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::MissionCompleted;
+	Message.Payload = BuildPayload({ { TEXT("missionId"), MissionID }, { TEXT("photoUrl"), PhotoURL } });
+	Message.CorrelationID = CorrelationID;
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::NotifyPhotoUploadProgress(const FString& MissionID, int64 UploadedBytes, int64 TotalBytes)
+{
+	TSharedRef<FJsonObject> Payload = MakeShared<FJsonObject>();
+	Payload->SetStringField(TEXT("missionId"), MissionID);
+	Payload->SetNumberField(TEXT("uploadedBytes"), static_cast<double>(UploadedBytes));
+	Payload->SetNumberField(TEXT("totalBytes"), static_cast<double>(TotalBytes));
+
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::PhotoUploadProgress;
+	Message.Payload = SerializeJsonObject(Payload);
+	EnqueueMessage(Message, ERNUEMessagePriority::Bulk, UploadedBytes < TotalBytes);
+}
+
+void URNUEBridgeSubsystem::NotifyProfileUpdated(const FString& ChildID)
+{
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::ProfileDataUpdated;
+	Message.Payload = BuildPayload({ { TEXT("childId"), ChildID } });
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::SendProfileDelta(const FString& ChildID, const FString& DeltaJSON)
+{
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::ProfileDelta;
+	Message.Payload = DeltaJSON;
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::SendProfileSnapshot(const FString& ChildID, const FString& SnapshotJSON)
+{
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::ProfileSnapshot;
+	Message.Payload = SnapshotJSON;
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::SendProgressSyncDelta(const FString& ChildID, const FString& PayloadJSON)
+{
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::ProgressSyncDelta;
+	Message.Payload = PayloadJSON;
+	SendToReactNative(Message);
+}
+
+void URNUEBridgeSubsystem::SendChildIdsMigrated(const FString& MigrationsJSON)
+{
+	FRNUEMessage Message;
+	Message.Type = ERNUEMessageType::ChildIdsMigrated;
+	Message.Payload = MigrationsJSON;
+	SendToReactNative(Message);
+}
+
+// ============================================
+// Incoming Messages (React Native -> UE5)
+// ============================================
+
+void URNUEBridgeSubsystem::OnMessageFromReactNative(const FString& MessageJSON)
+{
+	LLM_SCOPE_BYTAG(RNUEBridge);
+	SCOPE_CYCLE_COUNTER(STAT_RNUEBridgeReceive);
+
+	FRNUEMessage Message;
+	if (!ParseMessage(MessageJSON, Message))
+	{
+		UE_LOG(LogRNUEBridge, Warning, TEXT("Failed to parse message from React Native: %s"), *MessageJSON);
+		return;
+	}
+
+	// Control messages never wait behind bulk traffic
+	if (GetDefaultPriority(Message.Type) == ERNUEMessagePriority::Control)
+	{
+		DispatchIncoming(Message);
+	}
+	else
+	{
+		FIncomingMessage& Incoming = IncomingBulk.AddDefaulted_GetRef();
+		Incoming.Message = MoveTemp(Message);
+		Incoming.Bytes = GetUTF8Size(MessageJSON);
+	}
+}
+
+void URNUEBridgeSubsystem::DispatchIncoming(const FRNUEMessage& Message)
+{
+	OnMessageReceived.Broadcast(Message);
+
+	TSharedPtr<FJsonObject> Payload = ParseJsonObject(Message.Payload);
+	if (!Payload.IsValid())
+	{
+		Payload = MakeShared<FJsonObject>();
+	}
+
+	switch (Message.Type)
+	{
+	case ERNUEMessageType::StartLevel:
+		OnLevelStartRequested.Broadcast(
+			static_cast<int32>(Payload->GetNumberField(TEXT("worldId"))),
+			static_cast<int32>(Payload->GetNumberField(TEXT("levelId"))),
+			Payload->GetStringField(TEXT("childId")));
+		break;
+
+	case ERNUEMessageType::PhotoCaptured:
+		OnPhotoReceived.Broadcast(Payload->GetStringField(TEXT("missionId")), Payload->GetStringField(TEXT("photoPath")), Message.CorrelationID);
+		break;
+
+	case ERNUEMessageType::ParentApproval:
+	{
+		FString Comment;
+		Payload->TryGetStringField(TEXT("comment"), Comment);
+		OnParentApprovalReceived.Broadcast(Payload->GetStringField(TEXT("missionId")), Payload->GetBoolField(TEXT("approved")), Comment, Message.CorrelationID);
+		break;
+	}
+
+	case ERNUEMessageType::RequestProfileSnapshot:
+		OnProfileSnapshotRequested.Broadcast(Payload->GetStringField(TEXT("childId")));
+		break;
+
+	default:
+		// Remaining messages are handled by OnMessageReceived listeners
+		break;
+	}
+}
+
+// ============================================
+// Lanes
+// ============================================
+
+bool URNUEBridgeSubsystem::TickLanes(float DeltaTime)
+{
+	LLM_SCOPE_BYTAG(RNUEBridge);
+	SCOPE_CYCLE_COUNTER(STAT_RNUEBridgeTickLanes);
+	CSV_SCOPED_TIMING_STAT(RNUEBridge, TickLanes);
+
+	ControlBytesThisFrame = 0;
+
+	// Control lane first: only non-empty if last frame's control budget overflowed
+	FLane& ControlLane = OutgoingLanes[static_cast<int32>(ERNUEMessagePriority::Control)];
+	const int32 ControlBefore = ControlLane.QueuedBytes;
+	DrainLane(ControlLane, ControlLaneBytesPerFrame);
+	ControlBytesThisFrame = ControlBefore - ControlLane.QueuedBytes;
+
+	DrainLane(OutgoingLanes[static_cast<int32>(ERNUEMessagePriority::Bulk)], BulkLaneBytesPerFrame);
+	UpdateBackpressure();
+
+	// Incoming bulk shares the same per-frame budget on the receiving side
+	int32 IncomingBytes = 0;
+	int32 IncomingCount = 0;
+	while (IncomingCount < IncomingBulk.Num() && (IncomingCount == 0 || IncomingBytes < BulkLaneBytesPerFrame))
+	{
+		IncomingBytes += IncomingBulk[IncomingCount].Bytes;
+		++IncomingCount;
+	}
+	if (IncomingCount > 0)
+	{
+		// Listeners may queue more incoming messages, so detach the batch first
+		TArray<FIncomingMessage> Batch(IncomingBulk.GetData(), IncomingCount);
+		IncomingBulk.RemoveAt(0, IncomingCount, EAllowShrinking::No);
+		for (const FIncomingMessage& Incoming : Batch)
+		{
+			DispatchIncoming(Incoming.Message);
+		}
+	}
+
+	SET_MEMORY_STAT(STAT_RNUEBridgeQueuedMemory, GetQueuedMemoryBytes());
+	CSV_CUSTOM_STAT(RNUEBridge, BulkQueuedBytes, GetQueuedBytes(ERNUEMessagePriority::Bulk), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(RNUEBridge, IncomingBulk, IncomingBulk.Num(), ECsvCustomStatOp::Set);
+
+	return true;
+}
+
+void URNUEBridgeSubsystem::DrainLane(FLane& Lane, int32 BudgetBytes)
+{
+	int32 SentBytes = 0;
+	int32 SentCount = 0;
+	while (SentCount < Lane.Messages.Num() && (SentCount == 0 || SentBytes < BudgetBytes))
+	{
+		const FQueuedMessage& Queued = Lane.Messages[SentCount];
+		if (SentCount > 0 && SentBytes + Queued.Bytes > BudgetBytes)
+		{
+			break;
+		}
+		DispatchToNative(Queued.MessageJSON);
+		SentBytes += Queued.Bytes;
+		++SentCount;
+	}
+
+	if (SentCount > 0)
+	{
+		Lane.Messages.RemoveAt(0, SentCount, EAllowShrinking::No);
+		Lane.QueuedBytes -= SentBytes;
+	}
+}
+
+void URNUEBridgeSubsystem::EvictDroppable(FLane& Lane)
+{
+	// Oldest droppable messages go first; required messages are never evicted
+	for (int32 Index = 0; Index < Lane.Messages.Num() && Lane.QueuedBytes > BulkLaneMaxBytes; )
+	{
+		if (Lane.Messages[Index].bDroppable)
+		{
+			Lane.QueuedBytes -= Lane.Messages[Index].Bytes;
+			Lane.Messages.RemoveAt(Index, 1, EAllowShrinking::No);
+			++DroppedMessageCount;
+		}
+		else
+		{
+			++Index;
+		}
+	}
+}
+
+void URNUEBridgeSubsystem::UpdateBackpressure()
+{
+	const int32 QueuedBytes = OutgoingLanes[static_cast<int32>(ERNUEMessagePriority::Bulk)].QueuedBytes;
+
+	// Hysteresis so producers don't flap around the threshold
+	const bool bUnderPressure = bBulkUnderPressure
+		? QueuedBytes > BulkLaneHighWaterBytes / 2
+		: QueuedBytes >= BulkLaneHighWaterBytes;
+
+	if (bUnderPressure != bBulkUnderPressure)
+	{
+		bBulkUnderPressure = bUnderPressure;
+		UE_LOG(LogRNUEBridge, Verbose, TEXT("Bulk lane backpressure %s (%d bytes queued)"), bUnderPressure ? TEXT("on") : TEXT("off"), QueuedBytes);
+		OnBackpressureChanged.Broadcast(bUnderPressure);
+	}
+}
+
+void URNUEBridgeSubsystem::DispatchToNative(const FString& MessageJSON)
+{
+	if (NativeSendHandler.IsBound())
+	{
+		NativeSendHandler.Execute(MessageJSON);
+	}
+	else
+	{
+		UE_LOG(LogRNUEBridge, Verbose, TEXT("[RNUE Mock] Sending to React Native: %s"), *MessageJSON);
+	}
+}
+
+// ============================================
+// Helpers
+// ============================================
+
+FString URNUEBridgeSubsystem::GenerateCorrelationID()
+{
+	return FString::Printf(TEXT("ue-%lld-%d"), FDateTime::UtcNow().ToUnixTimestamp(), ++CorrelationCounter);
+}
+
+bool URNUEBridgeSubsystem::ParseMessage(const FString& JSON, FRNUEMessage& OutMessage)
+{
+	TSharedPtr<FJsonObject> Envelope = ParseJsonObject(JSON);
+	if (!Envelope.IsValid())
+	{
+		return false;
+	}
+
+	FString TypeName;
+	if (!Envelope->TryGetStringField(TEXT("type"), TypeName))
+	{
+		return false;
+	}
+
+	const int64 TypeValue = StaticEnum<ERNUEMessageType>()->GetValueByNameString(TypeName);
+	if (TypeValue == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutMessage.Type = static_cast<ERNUEMessageType>(TypeValue);
+	Envelope->TryGetStringField(TEXT("payload"), OutMessage.Payload);
+	Envelope->TryGetStringField(TEXT("correlationId"), OutMessage.CorrelationID);
+	return true;
+}
+
+FString URNUEBridgeSubsystem::BuildPayload(const TMap<FString, FString>& Data)
+{
+	TSharedRef<FJsonObject> Payload = MakeShared<FJsonObject>();
+	for (const TPair<FString, FString>& Pair : Data)
+	{
+		Payload->SetStringField(Pair.Key, Pair.Value);
+	}
+	return SerializeJsonObject(Payload);
+}
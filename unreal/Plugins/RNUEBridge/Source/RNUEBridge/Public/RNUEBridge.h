@@ -0,0 +1,20 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Modules/ModuleManager.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogRNUEBridge, Log, All);
+
+/** LLM tag for bridge message queues and payload parsing */
+LLM_DECLARE_TAG_API(RNUEBridge, RNUEBRIDGE_API);
+
+class FRNUEBridgeModule : public IModuleInterface
+{
+public:
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+};
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
 #include "RNUEBridgeSubsystem.generated.h"
 
 /**
@@ -22,6 +23,12 @@ enum class ERNUEMessageType : uint8
 	MissionCompleted        UMETA(DisplayName = "Mission Completed"),
 	ProfileDataUpdated      UMETA(DisplayName = "Profile Data Updated"),
 	PauseRequested          UMETA(DisplayName = "Pause Requested"),
+	ProfileDelta            UMETA(DisplayName = "Profile Delta"),
+	ProfileSnapshot         UMETA(DisplayName = "Profile Snapshot"),
+	StartupTimings          UMETA(DisplayName = "Startup Timings"),
+	PhotoUploadProgress     UMETA(DisplayName = "Photo Upload Progress"),
+	ProgressSyncDelta       UMETA(DisplayName = "Progress Sync Delta"),
+	ChildIdsMigrated        UMETA(DisplayName = "Child IDs Migrated"),
 
 	// React Native -> Game
 	StartLevel              UMETA(DisplayName = "Start Level"),
@@ -30,7 +37,32 @@ enum class ERNUEMessageType : uint8
 	PhotoCaptured           UMETA(DisplayName = "Photo Captured"),
 	ParentApproval          UMETA(DisplayName = "Parent Approval"),
 	ProfileSelected         UMETA(DisplayName = "Profile Selected"),
-	SettingsChanged         UMETA(DisplayName = "Settings Changed")
+	SettingsChanged         UMETA(DisplayName = "Settings Changed"),
+	RequestProfileSnapshot  UMETA(DisplayName = "Request Profile Snapshot"),
+	MissionCatalogUpdated   UMETA(DisplayName = "Mission Catalog Updated"),
+	AuthSessionUpdated      UMETA(DisplayName = "Auth Session Updated"),
+	ProgressSyncReceived    UMETA(DisplayName = "Progress Sync Received")
+};
+
+/**
+ * Delivery lanes for bridge traffic, drained in this order every frame
+ */
+UENUM(BlueprintType)
+enum class ERNUEMessagePriority : uint8
+{
+	Control     UMETA(DisplayName = "Control"),    // Pause/resume and other interactive messages
+	Bulk        UMETA(DisplayName = "Bulk")        // Profile data, telemetry, mission payloads
+};
+
+/**
+ * Outcome of queueing a message on a lane
+ */
+UENUM(BlueprintType)
+enum class ERNUEEnqueueResult : uint8
+{
+	Queued              UMETA(DisplayName = "Queued"),
+	QueuedUnderPressure UMETA(DisplayName = "Queued (Backpressure)"),   // Producer should slow down
+	Dropped             UMETA(DisplayName = "Dropped")                  // Droppable message rejected
 };
 
 /**
@@ -55,14 +87,19 @@ struct RNUEBRIDGE_API FRNUEMessage
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnRNUEMessageReceived, const FRNUEMessage&, Message);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnLevelStartRequested, int32, WorldID, int32, LevelID, const FString&, ChildID);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPhotoReceived, const FString&, MissionID, const FString&, PhotoPath);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnParentApprovalReceived, const FString&, MissionID, bool, bApproved, const FString&, Comment);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPhotoReceived, const FString&, MissionID, const FString&, PhotoPath, const FString&, CorrelationID);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnParentApprovalReceived, const FString&, MissionID, bool, bApproved, const FString&, Comment, const FString&, CorrelationID);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnProfileSnapshotRequested, const FString&, ChildID);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnRNUEBackpressureChanged, bool, bUnderPressure);
+
+/** Bound by the platform glue (iOS/Android) to hand serialized messages to React Native */
+DECLARE_DELEGATE_OneParam(FRNUENativeSendDelegate, const FString& /* MessageJSON */);
 
 /**
  * Bridge subsystem for communication between Unreal Engine and React Native
  * Uses RNUE (React Native for Unreal Engine) pattern
  */
-UCLASS()
+UCLASS(Config = Game)
 class RNUEBRIDGE_API URNUEBridgeSubsystem : public UGameInstanceSubsystem
 {
 	GENERATED_BODY()
@@ -77,13 +114,43 @@ public:
 	// Outgoing Messages (UE5 -> React Native)
 	// ============================================
 
-	/** Send a message to React Native */
+	/** Send a message to React Native on its default lane */
 	UFUNCTION(BlueprintCallable, Category = "RNUE")
 	void SendToReactNative(const FRNUEMessage& Message);
 
-	/** Notify that the game is ready */
+	/**
+	 * Queue a message on an explicit lane
+	 * Droppable messages are rejected once the lane is above its high-water mark,
+	 * and are evicted first when the lane is full.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "RNUE")
-	void NotifyGameReady();
+	ERNUEEnqueueResult EnqueueMessage(const FRNUEMessage& Message, ERNUEMessagePriority Priority, bool bDroppable);
+
+	/** True while the bulk lane is above its high-water mark */
+	UFUNCTION(BlueprintPure, Category = "RNUE")
+	bool IsBulkLaneUnderPressure() const { return bBulkUnderPressure; }
+
+	/** Bytes waiting in a lane, as UTF-8 on the native transport */
+	UFUNCTION(BlueprintPure, Category = "RNUE")
+	int32 GetQueuedBytes(ERNUEMessagePriority Priority) const;
+
+	/** Memory held by queued messages in both directions */
+	int64 GetQueuedMemoryBytes() const;
+
+	/** Number of droppable messages discarded since startup */
+	UFUNCTION(BlueprintPure, Category = "RNUE")
+	int32 GetDroppedMessageCount() const { return DroppedMessageCount; }
+
+	/** Lane a message type uses when sent through SendToReactNative */
+	static ERNUEMessagePriority GetDefaultPriority(ERNUEMessageType Type);
+
+	/** Notify that the game is ready, with the startup timing breakdown as JSON */
+	UFUNCTION(BlueprintCallable, Category = "RNUE")
+	void NotifyGameReady(const FString& StartupTimingsJSON = TEXT(""));
+
+	/** Send the complete startup timing breakdown once boot work that didn't block GameReady is done */
+	UFUNCTION(BlueprintCallable, Category = "RNUE")
+	void SendStartupTimings(const FString& StartupTimingsJSON);
 
 	/** Notify level completion */
 	UFUNCTION(BlueprintCallable, Category = "RNUE")
@@ -93,18 +160,38 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "RNUE")
 	void NotifyLevelFailed(int32 WorldID, int32 LevelID);
 
-	/** Request photo capture for mission */
+	/** Request photo capture for mission; a replayed request reuses its CorrelationID so RN can drop the duplicate */
 	UFUNCTION(BlueprintCallable, Category = "RNUE")
-	void RequestPhotoCapture(const FString& MissionID);
+	void RequestPhotoCapture(const FString& MissionID, const FString& CorrelationID = TEXT(""));
 
-	/** Request parent approval for mission */
+	/** Request parent approval for mission; a replayed request reuses its CorrelationID so RN can drop the duplicate */
 	UFUNCTION(BlueprintCallable, Category = "RNUE")
-	void RequestParentApproval(const FString& MissionID, const FString& PhotoURL);
+	void RequestParentApproval(const FString& MissionID, const FString& PhotoURL, const FString& CorrelationID = TEXT(""));
+
+	/** Report how much of a mission photo has reached the backend; updates before the last may be dropped under backpressure */
+	UFUNCTION(BlueprintCallable, Category = "RNUE")
+	void NotifyPhotoUploadProgress(const FString& MissionID, int64 UploadedBytes, int64 TotalBytes);
 
 	/** Notify profile data has been updated */
 	UFUNCTION(BlueprintCallable, Category = "RNUE")
 	void NotifyProfileUpdated(const FString& ChildID);
 
+	/** Send the fields of a profile that changed since the previous sequence number */
+	UFUNCTION(BlueprintCallable, Category = "RNUE")
+	void SendProfileDelta(const FString& ChildID, const FString& DeltaJSON);
+
+	/** Send a complete profile, used on first sync and when RN detects a sequence gap */
+	UFUNCTION(BlueprintCallable, Category = "RNUE")
+	void SendProfileSnapshot(const FString& ChildID, const FString& SnapshotJSON);
+
+	/** Send progress changes for RN to exchange with the backend; the reply comes back as ProgressSyncReceived */
+	UFUNCTION(BlueprintCallable, Category = "RNUE")
+	void SendProgressSyncDelta(const FString& ChildID, const FString& PayloadJSON);
+
+	/** Send the pre-GUID child ID strings found in the save and the IDs they load as, for RN to re-key its data */
+	UFUNCTION(BlueprintCallable, Category = "RNUE")
+	void SendChildIdsMigrated(const FString& MigrationsJSON);
+
 	// ============================================
 	// Incoming Messages (React Native -> UE5)
 	// ============================================
@@ -125,15 +212,45 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "RNUE")
 	FOnLevelStartRequested OnLevelStartRequested;
 
-	/** Specific event: Photo received from camera */
+	/** Specific event: Photo received from camera; CorrelationID is the request's, empty if RN didn't echo it */
 	UPROPERTY(BlueprintAssignable, Category = "RNUE")
 	FOnPhotoReceived OnPhotoReceived;
 
-	/** Specific event: Parent approval received */
+	/** Specific event: Parent approval received; CorrelationID is the request's, empty if RN didn't echo it */
 	UPROPERTY(BlueprintAssignable, Category = "RNUE")
 	FOnParentApprovalReceived OnParentApprovalReceived;
 
+	/** Specific event: RN lost track of profile deltas and wants a full snapshot */
+	UPROPERTY(BlueprintAssignable, Category = "RNUE")
+	FOnProfileSnapshotRequested OnProfileSnapshotRequested;
+
+	/** Bulk lane crossed its high-water mark (true) or drained below half of it (false) */
+	UPROPERTY(BlueprintAssignable, Category = "RNUE")
+	FOnRNUEBackpressureChanged OnBackpressureChanged;
+
+	/** Native transport to React Native; messages are only logged while unbound */
+	FRNUENativeSendDelegate NativeSendHandler;
+
+	/** True once the platform glue has bound NativeSendHandler */
+	bool IsNativeTransportBound() const { return NativeSendHandler.IsBound(); }
+
 protected:
+	/** Bytes of control traffic delivered per frame (each lane always delivers at least one message) */
+	UPROPERTY(Config)
+	int32 ControlLaneBytesPerFrame = 65536;
+
+	/** Bytes of bulk traffic delivered per frame, in each direction */
+	UPROPERTY(Config)
+	int32 BulkLaneBytesPerFrame = 16384;
+
+	/** Queued bulk bytes above which producers see backpressure and droppable messages are rejected */
+	UPROPERTY(Config)
+	int32 BulkLaneHighWaterBytes = 262144;
+
+	/** Queued bulk bytes above which droppable messages are evicted to make room */
+	UPROPERTY(Config)
+	int32 BulkLaneMaxBytes = 1048576;
+
 	/** Generate a unique correlation ID */
 	FString GenerateCorrelationID();
 
@@ -144,6 +261,60 @@ protected:
 	FString BuildPayload(const TMap<FString, FString>& Data);
 
 private:
+	struct FQueuedMessage
+	{
+		FString MessageJSON;
+
+		/** UTF-8 size of MessageJSON, measured once when queued */
+		int32 Bytes = 0;
+		bool bDroppable = false;
+	};
+
+	struct FIncomingMessage
+	{
+		FRNUEMessage Message;
+
+		/** UTF-8 size of the message as received */
+		int32 Bytes = 0;
+	};
+
+	struct FLane
+	{
+		TArray<FQueuedMessage> Messages;
+		int32 QueuedBytes = 0;
+	};
+
+	/** Drain lanes within their per-frame budgets */
+	bool TickLanes(float DeltaTime);
+
+	/** Deliver up to BudgetBytes from a lane (always at least one message) */
+	void DrainLane(FLane& Lane, int32 BudgetBytes);
+
+	/** Evict droppable messages from the bulk lane until it fits BulkLaneMaxBytes */
+	void EvictDroppable(FLane& Lane);
+
+	void UpdateBackpressure();
+
+	/** Hand a serialized message to the native transport */
+	void DispatchToNative(const FString& MessageJSON);
+
+	/** Route a parsed incoming message to the specific delegates */
+	void DispatchIncoming(const FRNUEMessage& Message);
+
 	/** Counter for correlation IDs */
 	int32 CorrelationCounter = 0;
+
+	/** Outgoing lanes indexed by ERNUEMessagePriority */
+	FLane OutgoingLanes[2];
+
+	/** Incoming bulk messages waiting for the game thread budget; control messages skip this */
+	TArray<FIncomingMessage> IncomingBulk;
+
+	bool bBulkUnderPressure = false;
+	int32 DroppedMessageCount = 0;
+
+	/** Control bytes delivered since the last lane tick */
+	int32 ControlBytesThisFrame = 0;
+
+	FTSTicker::FDelegateHandle TickHandle;
 };
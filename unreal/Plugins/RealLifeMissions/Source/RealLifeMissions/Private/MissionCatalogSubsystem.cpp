@@ -0,0 +1,452 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "MissionCatalogSubsystem.h"
+#include "RealLifeMissions.h"
+#include "Core/SuperfamilyGameInstance.h"
+#include "Gameplay/SuperfamilyVoiceOverSubsystem.h"
+#include "Dom/JsonObject.h"
+#include "JsonObjectConverter.h"
+#include "RNUEBridgeSubsystem.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+void UMissionCatalogSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (URNUEBridgeSubsystem* Bridge = Collection.InitializeDependency<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnMessageReceived.AddDynamic(this, &UMissionCatalogSubsystem::HandleBridgeMessage);
+	}
+
+	if (USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		MissionRecordedHandle = GameInstance->OnMissionRecorded.AddUObject(this, &UMissionCatalogSubsystem::HandleMissionRecorded);
+		ProfilesAppliedHandle = GameInstance->OnProfilesApplied.AddUObject(this, &UMissionCatalogSubsystem::HandleProfilesApplied);
+	}
+}
+
+void UMissionCatalogSubsystem::Deinitialize()
+{
+	if (URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnMessageReceived.RemoveDynamic(this, &UMissionCatalogSubsystem::HandleBridgeMessage);
+	}
+
+	if (USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		GameInstance->OnMissionRecorded.Remove(MissionRecordedHandle);
+		GameInstance->OnProfilesApplied.Remove(ProfilesAppliedHandle);
+	}
+
+	ChildStates.Empty();
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Catalog
+// ============================================
+
+void UMissionCatalogSubsystem::RefreshCatalog(const TArray<FMissionData>& NewMissions)
+{
+	LLM_SCOPE_BYTAG(RealLifeMissions);
+
+	TBitArray<> Seen(false, Missions.Num());
+	int32 Added = 0;
+	int32 Changed = 0;
+
+	for (const FMissionData& Mission : NewMissions)
+	{
+		if (!Mission.MissionID.IsValid())
+		{
+			continue;
+		}
+
+		const int32 NewBucket = GetBucket(Mission.Category, Mission.MinAge);
+
+		if (const int32* ExistingSlot = SlotByID.Find(Mission.MissionID))
+		{
+			const int32 Slot = *ExistingSlot;
+			if (Seen[Slot])
+			{
+				UE_LOG(LogRealLifeMissions, Warning, TEXT("Mission %s listed twice in the catalog; keeping the first"), *Mission.MissionID.ToString());
+				continue;
+			}
+			Seen[Slot] = true;
+
+			if (RetiredSlots[Slot] || SlotBuckets[Slot] != NewBucket)
+			{
+				UpdateSlotForChildren(Slot, NewBucket, false);
+				++Changed;
+			}
+			Missions[Slot] = Mission;
+			continue;
+		}
+
+		const int32 Slot = Missions.Add(Mission);
+		SlotBuckets.Add(static_cast<uint8>(NewBucket));
+		RetiredSlots.Add(false);
+		Seen.Add(true);
+		SlotByID.Add(Mission.MissionID, Slot);
+		AddSlotToChildren(Slot);
+		++Added;
+	}
+
+	int32 Retired = 0;
+	for (int32 Slot = 0; Slot < Missions.Num(); ++Slot)
+	{
+		if (!Seen[Slot] && !RetiredSlots[Slot])
+		{
+			UpdateSlotForChildren(Slot, SlotBuckets[Slot], true);
+			++Retired;
+		}
+	}
+
+	UE_LOG(LogRealLifeMissions, Log, TEXT("Mission catalog refreshed: %d missions (%d new, %d moved, %d retired)"), GetMissionCount(), Added, Changed, Retired);
+	OnCatalogRefreshed.Broadcast(GetMissionCount());
+}
+
+bool UMissionCatalogSubsystem::RefreshCatalogFromJSON(const FString& CatalogJSON)
+{
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(CatalogJSON);
+	const TArray<TSharedPtr<FJsonValue>>* MissionValues = nullptr;
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid() || !Root->TryGetArrayField(TEXT("missions"), MissionValues))
+	{
+		UE_LOG(LogRealLifeMissions, Warning, TEXT("Mission catalog payload is not a { \"missions\": [...] } object"));
+		return false;
+	}
+
+	TArray<FMissionData> NewMissions;
+	if (!FJsonObjectConverter::JsonArrayToUStruct(*MissionValues, &NewMissions))
+	{
+		UE_LOG(LogRealLifeMissions, Warning, TEXT("Mission catalog payload has malformed missions"));
+		return false;
+	}
+
+	RefreshCatalog(NewMissions);
+	return true;
+}
+
+bool UMissionCatalogSubsystem::FindMission(const FMissionId& MissionID, FMissionData& OutMission) const
+{
+	const int32* Slot = SlotByID.Find(MissionID);
+	if (!Slot || RetiredSlots[*Slot])
+	{
+		return false;
+	}
+
+	OutMission = Missions[*Slot];
+	return true;
+}
+
+int32 UMissionCatalogSubsystem::GetBucket(EMissionCategory Category, EDifficultyLevel MinAge)
+{
+	const int32 CategoryIndex = FMath::Clamp(static_cast<int32>(Category), 0, NumCategories - 1);
+	const int32 AgeIndex = FMath::Clamp(static_cast<int32>(MinAge), 0, NumAgeGroups - 1);
+	return CategoryIndex * NumAgeGroups + AgeIndex;
+}
+
+// ============================================
+// Per-Child Queries
+// ============================================
+
+TArray<FMissionData> UMissionCatalogSubsystem::GetAvailableMissions(const FChildId& ChildID, EMissionCategory Category)
+{
+	TArray<FMissionData> Result;
+	const FChildMissionState* State = GetChildState(ChildID);
+	if (!State)
+	{
+		return Result;
+	}
+
+	// Buckets of this category for every age up to the child's
+	const int32 FirstBucket = GetBucket(Category, EDifficultyLevel::Groep1);
+	const int32 LastBucket = FirstBucket + State->MaxAgeGroup;
+
+	int32 NumResults = 0;
+	for (int32 Bucket = FirstBucket; Bucket <= LastBucket; ++Bucket)
+	{
+		NumResults += State->Available[Bucket].Num();
+	}
+
+	Result.Reserve(NumResults);
+	for (int32 Bucket = FirstBucket; Bucket <= LastBucket; ++Bucket)
+	{
+		for (const int32 Slot : State->Available[Bucket])
+		{
+			Result.Add(Missions[Slot]);
+		}
+	}
+	return Result;
+}
+
+TArray<FMissionData> UMissionCatalogSubsystem::GetInProgressMissions(const FChildId& ChildID)
+{
+	TArray<FMissionData> Result;
+	if (const FChildMissionState* State = GetChildState(ChildID))
+	{
+		for (TConstSetBitIterator<> It(State->InProgress); It; ++It)
+		{
+			if (!RetiredSlots[It.GetIndex()])
+			{
+				Result.Add(Missions[It.GetIndex()]);
+			}
+		}
+	}
+	return Result;
+}
+
+bool UMissionCatalogSubsystem::IsMissionCompleted(const FChildId& ChildID, const FMissionId& MissionID)
+{
+	return GetMissionStatus(ChildID, MissionID) == EMissionStatus::Completed;
+}
+
+EMissionStatus UMissionCatalogSubsystem::GetMissionStatus(const FChildId& ChildID, const FMissionId& MissionID)
+{
+	const FChildMissionState* State = GetChildState(ChildID);
+	if (!State)
+	{
+		return EMissionStatus::Available;
+	}
+
+	const int32* Slot = SlotByID.Find(MissionID);
+	if (!Slot)
+	{
+		return State->UnknownCompleted.Contains(MissionID) ? EMissionStatus::Completed : EMissionStatus::Available;
+	}
+
+	if (State->Completed[*Slot])
+	{
+		return EMissionStatus::Completed;
+	}
+	return State->InProgress[*Slot] ? EMissionStatus::InProgress : EMissionStatus::Available;
+}
+
+// ============================================
+// Active Child
+// ============================================
+
+bool UMissionCatalogSubsystem::StartMission(const FMissionId& MissionID)
+{
+	const USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	FChildMissionState* State = GameInstance ? GetChildState(GameInstance->GetActiveChildID()) : nullptr;
+	const int32* Slot = SlotByID.Find(MissionID);
+	if (!State || !Slot || RetiredSlots[*Slot] || State->Completed[*Slot])
+	{
+		return false;
+	}
+
+	State->InProgress[*Slot] = true;
+	RemoveAvailable(*State, *Slot);
+
+	// The instructions are read out next
+	if (USuperfamilyVoiceOverSubsystem* VoiceOver = GetGameInstance()->GetSubsystem<USuperfamilyVoiceOverSubsystem>())
+	{
+		VoiceOver->PrefetchMission(Missions[*Slot]);
+	}
+	return true;
+}
+
+void UMissionCatalogSubsystem::CompleteMission(const FMissionId& MissionID)
+{
+	// State follows through OnMissionRecorded, which also covers callers going to the game instance directly
+	if (USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		GameInstance->RecordMissionCompleted(MissionID);
+	}
+}
+
+void UMissionCatalogSubsystem::HandleMissionRecorded(const FChildId& ChildID, const FMissionId& MissionID)
+{
+	FChildMissionState* State = ChildStates.Find(ChildID);
+	if (!State)
+	{
+		// Built from the profile, which already has the mission, on first use
+		return;
+	}
+
+	const int32* Slot = SlotByID.Find(MissionID);
+	if (!Slot)
+	{
+		State->UnknownCompleted.Add(MissionID);
+		return;
+	}
+
+	State->Completed[*Slot] = true;
+	State->InProgress[*Slot] = false;
+	RemoveAvailable(*State, *Slot);
+}
+
+void UMissionCatalogSubsystem::HandleProfilesApplied(const FChildId& ChildID)
+{
+	TArray<FChildId> Rebuild;
+	if (!ChildID.IsValid())
+	{
+		ChildStates.GetKeys(Rebuild);
+	}
+	else if (ChildStates.Contains(ChildID))
+	{
+		Rebuild.Add(ChildID);
+	}
+
+	for (const FChildId& Child : Rebuild)
+	{
+		// In-progress missions aren't saved, so the profile can't bring them back
+		const TBitArray<> InProgress = MoveTemp(ChildStates[Child].InProgress);
+		ChildStates.Remove(Child);
+
+		// Completions and age group come from the profile now; gone if the profile is
+		FChildMissionState* State = GetChildState(Child);
+		if (!State)
+		{
+			continue;
+		}
+
+		for (TConstSetBitIterator<> It(InProgress); It; ++It)
+		{
+			const int32 Slot = It.GetIndex();
+			if (!State->Completed[Slot] && !RetiredSlots[Slot])
+			{
+				State->InProgress[Slot] = true;
+				RemoveAvailable(*State, Slot);
+			}
+		}
+	}
+}
+
+void UMissionCatalogSubsystem::HandleBridgeMessage(const FRNUEMessage& Message)
+{
+	if (Message.Type == ERNUEMessageType::MissionCatalogUpdated)
+	{
+		RefreshCatalogFromJSON(Message.Payload);
+	}
+}
+
+// ============================================
+// Child State
+// ============================================
+
+UMissionCatalogSubsystem::FChildMissionState* UMissionCatalogSubsystem::GetChildState(const FChildId& ChildID)
+{
+	if (FChildMissionState* Existing = ChildStates.Find(ChildID))
+	{
+		return Existing;
+	}
+
+	const USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	if (!GameInstance || !ChildID.IsValid())
+	{
+		return nullptr;
+	}
+
+	// Not cached while missing, so a profile that appears later (save still loading, new child) is picked up
+	const TArray<FChildProfile> Profiles = GameInstance->GetAllProfiles();
+	const FChildProfile* Profile = Profiles.FindByPredicate([&ChildID](const FChildProfile& Candidate) { return Candidate.ChildID == ChildID; });
+	if (!Profile)
+	{
+		return nullptr;
+	}
+
+	LLM_SCOPE_BYTAG(RealLifeMissions);
+
+	FChildMissionState& State = ChildStates.Add(ChildID);
+	State.MaxAgeGroup = FMath::Clamp(Profile->AgeGroup - 1, 0, NumAgeGroups - 1);
+	State.Completed.Init(false, Missions.Num());
+	State.InProgress.Init(false, Missions.Num());
+	State.AvailablePosition.Init(INDEX_NONE, Missions.Num());
+
+	for (const FMissionId& MissionID : Profile->CompletedMissions)
+	{
+		if (const int32* Slot = SlotByID.Find(MissionID))
+		{
+			State.Completed[*Slot] = true;
+		}
+		else
+		{
+			State.UnknownCompleted.Add(MissionID);
+		}
+	}
+
+	for (int32 Slot = 0; Slot < Missions.Num(); ++Slot)
+	{
+		if (!State.Completed[Slot] && !RetiredSlots[Slot])
+		{
+			AddAvailable(State, Slot);
+		}
+	}
+
+	return &State;
+}
+
+void UMissionCatalogSubsystem::AddAvailable(FChildMissionState& State, int32 Slot) const
+{
+	if (State.AvailablePosition[Slot] == INDEX_NONE)
+	{
+		State.AvailablePosition[Slot] = State.Available[SlotBuckets[Slot]].Add(Slot);
+	}
+}
+
+void UMissionCatalogSubsystem::RemoveAvailable(FChildMissionState& State, int32 Slot) const
+{
+	const int32 Position = State.AvailablePosition[Slot];
+	if (Position == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Swap-remove; the slot moved into the hole gets its new position
+	TArray<int32>& Bucket = State.Available[SlotBuckets[Slot]];
+	Bucket.RemoveAtSwap(Position, 1, EAllowShrinking::No);
+	if (Position < Bucket.Num())
+	{
+		State.AvailablePosition[Bucket[Position]] = Position;
+	}
+	State.AvailablePosition[Slot] = INDEX_NONE;
+}
+
+void UMissionCatalogSubsystem::AddSlotToChildren(int32 Slot)
+{
+	const FMissionId MissionID = Missions[Slot].MissionID;
+	for (TPair<FChildId, FChildMissionState>& Pair : ChildStates)
+	{
+		FChildMissionState& State = Pair.Value;
+		const bool bCompleted = State.UnknownCompleted.Remove(MissionID) > 0;
+
+		State.Completed.Add(bCompleted);
+		State.InProgress.Add(false);
+		State.AvailablePosition.Add(INDEX_NONE);
+		if (!bCompleted)
+		{
+			AddAvailable(State, Slot);
+		}
+	}
+}
+
+void UMissionCatalogSubsystem::UpdateSlotForChildren(int32 Slot, int32 NewBucket, bool bRetire)
+{
+	// Out of the old bucket before SlotBuckets changes
+	for (TPair<FChildId, FChildMissionState>& Pair : ChildStates)
+	{
+		RemoveAvailable(Pair.Value, Slot);
+	}
+
+	SlotBuckets[Slot] = static_cast<uint8>(NewBucket);
+	RetiredCount += (bRetire ? 1 : 0) - (RetiredSlots[Slot] ? 1 : 0);
+	RetiredSlots[Slot] = bRetire;
+
+	if (bRetire)
+	{
+		return;
+	}
+
+	for (TPair<FChildId, FChildMissionState>& Pair : ChildStates)
+	{
+		FChildMissionState& State = Pair.Value;
+		if (!State.Completed[Slot] && !State.InProgress[Slot])
+		{
+			AddAvailable(State, Slot);
+		}
+	}
+}
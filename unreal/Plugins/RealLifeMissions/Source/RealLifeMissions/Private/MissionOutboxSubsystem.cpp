@@ -0,0 +1,646 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "MissionOutboxSubsystem.h"
+#include "MissionCatalogSubsystem.h"
+#include "RealLifeMissions.h"
+#include "RNUEBridgeSubsystem.h"
+#include "Core/SuperfamilyBootSubsystem.h"
+#include "Core/SuperfamilyGameInstance.h"
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+const FName UMissionOutboxSubsystem::BootStage(TEXT("MissionOutbox"));
+
+namespace MissionOutbox
+{
+	/** Write lines to a file and fsync it; appends when bAppend, otherwise replaces the contents */
+	static bool WriteLinesDurably(const FString& Path, const TArray<FString>& Lines, bool bAppend)
+	{
+		FString Text;
+		for (const FString& Line : Lines)
+		{
+			Text += Line;
+			Text += TEXT("\n");
+		}
+
+		const FTCHARToUTF8 UTF8(*Text);
+		TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Path, bAppend));
+		return File.IsValid()
+			&& File->Write(reinterpret_cast<const uint8*>(UTF8.Get()), UTF8.Length())
+			&& File->Flush(true);
+	}
+
+	/** Replace the log with Lines: write and sync a temp file, then swap it in */
+	static bool RewriteLog(const FString& Path, const TArray<FString>& Lines)
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		const FString TempPath = Path + TEXT(".tmp");
+
+		if (!WriteLinesDurably(TempPath, Lines, false))
+		{
+			PlatformFile.DeleteFile(*TempPath);
+			return false;
+		}
+
+		// A crash between these two leaves only the temp file, which the loader picks up
+		if (PlatformFile.FileExists(*Path) && !PlatformFile.DeleteFile(*Path))
+		{
+			PlatformFile.DeleteFile(*TempPath);
+			return false;
+		}
+		return PlatformFile.MoveFile(*Path, *TempPath);
+	}
+
+	static bool ReadLog(const FString& Path, TArray<FString>& OutLines)
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		const FString TempPath = Path + TEXT(".tmp");
+
+		// Only the temp file: a rewrite crashed before the rename, so finish it
+		if (!PlatformFile.FileExists(*Path) && PlatformFile.FileExists(*TempPath) && !PlatformFile.MoveFile(*Path, *TempPath))
+		{
+			return FFileHelper::LoadFileToStringArray(OutLines, *TempPath);
+		}
+
+		if (PlatformFile.FileExists(*Path))
+		{
+			return FFileHelper::LoadFileToStringArray(OutLines, *Path);
+		}
+		return true;
+	}
+}
+
+void UMissionOutboxSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const FString Directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Missions"));
+	IFileManager::Get().MakeDirectory(*Directory, true);
+	LogPath = FPaths::Combine(Directory, TEXT("Outbox.jsonl"));
+
+	Collection.InitializeDependency<UMissionCatalogSubsystem>();
+
+	if (URNUEBridgeSubsystem* Bridge = Collection.InitializeDependency<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnPhotoReceived.AddDynamic(this, &UMissionOutboxSubsystem::HandlePhotoReceived);
+		Bridge->OnParentApprovalReceived.AddDynamic(this, &UMissionOutboxSubsystem::HandleParentApprovalReceived);
+		Bridge->OnProfileSnapshotRequested.AddDynamic(this, &UMissionOutboxSubsystem::HandleProfileSnapshotRequested);
+	}
+
+	// Needs the save (to restore in-progress missions on the active child) and the
+	// bridge (to replay); nothing waits on it
+	if (USuperfamilyBootSubsystem* Boot = Collection.InitializeDependency<USuperfamilyBootSubsystem>())
+	{
+		Boot->AddStage(BootStage, { USuperfamilyBootSubsystem::SaveDataStage, USuperfamilyBootSubsystem::BridgeStage },
+			[this](USuperfamilyBootSubsystem::FStageDone&& Done)
+		{
+			LoadAsync([this, Done = MoveTemp(Done)]()
+			{
+				ReplayPendingRequests();
+				Done(true);
+			});
+		}, false);
+	}
+
+	FlushHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &UMissionOutboxSubsystem::TickFlush), FMath::Max(0.05f, FlushIntervalSeconds));
+}
+
+void UMissionOutboxSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(FlushHandle);
+
+	if (URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnPhotoReceived.RemoveDynamic(this, &UMissionOutboxSubsystem::HandlePhotoReceived);
+		Bridge->OnParentApprovalReceived.RemoveDynamic(this, &UMissionOutboxSubsystem::HandleParentApprovalReceived);
+		Bridge->OnProfileSnapshotRequested.RemoveDynamic(this, &UMissionOutboxSubsystem::HandleProfileSnapshotRequested);
+	}
+
+	// Nothing recorded may be lost on a clean shutdown: finish the write in flight, then sync the rest here
+	if (bWriteInFlight)
+	{
+		FinishWrite(WriteFuture.Get());
+	}
+	if (PendingLines.Num() > 0 && !MissionOutbox::WriteLinesDurably(LogPath, PendingLines, true))
+	{
+		UE_LOG(LogRealLifeMissions, Error, TEXT("Mission outbox: %d transitions could not be written on shutdown"), PendingLines.Num());
+	}
+
+	PendingLines.Empty();
+	Entries.Empty();
+	SentThisSession.Empty();
+	DeferredUntilLoaded.Empty();
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Mission Flow
+// ============================================
+
+void UMissionOutboxSubsystem::StartMission(const FString& MissionID)
+{
+	USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	const FChildId ChildID = GameInstance ? GameInstance->GetActiveChildID() : FChildId();
+	if (MissionID.IsEmpty() || !ChildID.IsValid())
+	{
+		return;
+	}
+
+	if (const FMissionOutboxEntry* Existing = Entries.Find(MissionID))
+	{
+		if (Existing->ChildID == ChildID)
+		{
+			return;
+		}
+		UE_LOG(LogRealLifeMissions, Warning, TEXT("Mission %s is already in flight for another child; restarting it for %s"), *MissionID, *ChildID.ToString());
+	}
+
+	FMissionOutboxEntry Entry;
+	Entry.MissionID = MissionID;
+	Entry.ChildID = ChildID;
+	Entry.Status = EMissionStatus::InProgress;
+	Append(Entry);
+
+	if (UMissionCatalogSubsystem* Catalog = GetGameInstance()->GetSubsystem<UMissionCatalogSubsystem>())
+	{
+		Catalog->StartMission(FMissionId::FromString(MissionID));
+	}
+}
+
+void UMissionOutboxSubsystem::RequestPhotoCapture(const FString& MissionID)
+{
+	if (!Entries.Contains(MissionID))
+	{
+		StartMission(MissionID);
+	}
+
+	const FMissionOutboxEntry* Existing = Entries.Find(MissionID);
+	if (!Existing)
+	{
+		return;
+	}
+
+	// Asking again while a request is open resends it instead of opening a second one
+	if (Existing->PendingRequest == EMissionOutboxRequest::PhotoCapture)
+	{
+		SendRequest(*Existing);
+		return;
+	}
+
+	FMissionOutboxEntry Entry = *Existing;
+	Entry.Status = EMissionStatus::InProgress;
+	Entry.PendingRequest = EMissionOutboxRequest::PhotoCapture;
+	Entry.CorrelationID = FGuid::NewGuid().ToString(EGuidFormats::DigitsWithHyphensLower);
+	Append(Entry);
+	SendRequest(Entry);
+}
+
+void UMissionOutboxSubsystem::RequestParentApproval(const FString& MissionID, const FString& PhotoURL)
+{
+	const FMissionOutboxEntry* Existing = Entries.Find(MissionID);
+	if (!Existing || PhotoURL.IsEmpty())
+	{
+		UE_LOG(LogRealLifeMissions, Warning, TEXT("Parent approval requested for mission %s, which is not in flight"), *MissionID);
+		return;
+	}
+
+	if (Existing->PendingRequest == EMissionOutboxRequest::ParentApproval && Existing->PhotoURL == PhotoURL)
+	{
+		SendRequest(*Existing);
+		return;
+	}
+
+	FMissionOutboxEntry Entry = *Existing;
+	Entry.Status = EMissionStatus::PendingApproval;
+	Entry.PendingRequest = EMissionOutboxRequest::ParentApproval;
+	Entry.CorrelationID = FGuid::NewGuid().ToString(EGuidFormats::DigitsWithHyphensLower);
+	Entry.PhotoURL = PhotoURL;
+	Entry.ParentComment.Empty();
+	Append(Entry);
+	SendRequest(Entry);
+}
+
+void UMissionOutboxSubsystem::CompleteMission(const FString& MissionID)
+{
+	// Already completed (or never started): nothing to do, so a repeated call is harmless
+	const FMissionOutboxEntry* Existing = Entries.Find(MissionID);
+	if (!Existing)
+	{
+		return;
+	}
+
+	if (Existing->Status != EMissionStatus::Approved)
+	{
+		UE_LOG(LogRealLifeMissions, Warning, TEXT("Mission %s completed before parent approval"), *MissionID);
+		return;
+	}
+
+	// The profile records completions for the active child only
+	USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	if (!GameInstance || GameInstance->GetActiveChildID() != Existing->ChildID)
+	{
+		UE_LOG(LogRealLifeMissions, Log, TEXT("Mission %s belongs to child %s, who is not active; completing it later"), *MissionID, *Existing->ChildID.ToString());
+		return;
+	}
+
+	if (UMissionCatalogSubsystem* Catalog = GameInstance->GetSubsystem<UMissionCatalogSubsystem>())
+	{
+		Catalog->CompleteMission(FMissionId::FromString(MissionID));
+	}
+
+	FMissionOutboxEntry Entry = *Existing;
+	Entry.Status = EMissionStatus::Completed;
+	Entry.PendingRequest = EMissionOutboxRequest::None;
+	Entry.CorrelationID.Empty();
+	Append(Entry);
+}
+
+bool UMissionOutboxSubsystem::GetMissionEntry(const FString& MissionID, FMissionOutboxEntry& OutEntry) const
+{
+	if (const FMissionOutboxEntry* Found = Entries.Find(MissionID))
+	{
+		OutEntry = *Found;
+		return true;
+	}
+	return false;
+}
+
+TArray<FMissionOutboxEntry> UMissionOutboxSubsystem::GetMissionsInFlight() const
+{
+	TArray<FMissionOutboxEntry> Result;
+	Entries.GenerateValueArray(Result);
+	return Result;
+}
+
+void UMissionOutboxSubsystem::ReplayPendingRequests()
+{
+	if (!bLoaded)
+	{
+		return;
+	}
+
+	int32 Replayed = 0;
+	for (const TPair<FString, FMissionOutboxEntry>& Pair : Entries)
+	{
+		if (Pair.Value.PendingRequest != EMissionOutboxRequest::None && !SentThisSession.Contains(Pair.Value.CorrelationID))
+		{
+			SendRequest(Pair.Value);
+			++Replayed;
+		}
+	}
+
+	if (Replayed > 0)
+	{
+		UE_LOG(LogRealLifeMissions, Log, TEXT("Mission outbox: replayed %d pending requests"), Replayed);
+	}
+}
+
+// ============================================
+// Log
+// ============================================
+
+void UMissionOutboxSubsystem::LoadAsync(TFunction<void()> OnLoaded)
+{
+	TWeakObjectPtr<UMissionOutboxSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Path = LogPath, OnLoaded = MoveTemp(OnLoaded)]() mutable
+	{
+		TArray<FString> Lines;
+		if (!MissionOutbox::ReadLog(Path, Lines))
+		{
+			UE_LOG(LogRealLifeMissions, Error, TEXT("Mission outbox: could not read %s"), *Path);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Lines = MoveTemp(Lines), OnLoaded = MoveTemp(OnLoaded)]()
+		{
+			if (UMissionOutboxSubsystem* This = WeakThis.Get())
+			{
+				This->ApplyLoadedLines(Lines);
+				OnLoaded();
+			}
+		});
+	});
+}
+
+void UMissionOutboxSubsystem::ApplyLoadedLines(const TArray<FString>& Lines)
+{
+	LLM_SCOPE_BYTAG(RealLifeMissions);
+
+	const UEnum* StatusEnum = StaticEnum<EMissionStatus>();
+	const UEnum* RequestEnum = StaticEnum<EMissionOutboxRequest>();
+
+	TMap<FString, FMissionOutboxEntry> Loaded;
+	int32 Skipped = 0;
+
+	for (const FString& Line : Lines)
+	{
+		if (Line.IsEmpty())
+		{
+			continue;
+		}
+
+		// A line torn by a crash mid-write fails to parse and is dropped with the transition it held
+		TSharedPtr<FJsonObject> Object;
+		const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Line);
+		FMissionOutboxEntry Entry;
+		if (!FJsonSerializer::Deserialize(Reader, Object) || !Object.IsValid()
+			|| !Object->TryGetStringField(TEXT("missionId"), Entry.MissionID) || Entry.MissionID.IsEmpty())
+		{
+			++Skipped;
+			continue;
+		}
+
+		int64 Sequence = 0;
+		if (Object->TryGetNumberField(TEXT("seq"), Sequence))
+		{
+			NextSequence = FMath::Max(NextSequence, Sequence + 1);
+		}
+
+		const int64 Status = StatusEnum->GetValueByNameString(Object->GetStringField(TEXT("status")));
+		if (Status == INDEX_NONE)
+		{
+			++Skipped;
+			continue;
+		}
+		Entry.Status = static_cast<EMissionStatus>(Status);
+
+		if (Entry.Status == EMissionStatus::Completed)
+		{
+			Loaded.Remove(Entry.MissionID);
+			continue;
+		}
+
+		FString ChildID;
+		Object->TryGetStringField(TEXT("childId"), ChildID);
+		Entry.ChildID = FChildId::FromString(ChildID);
+		Object->TryGetStringField(TEXT("correlationId"), Entry.CorrelationID);
+		Object->TryGetStringField(TEXT("photoPath"), Entry.PhotoPath);
+		Object->TryGetStringField(TEXT("photoUrl"), Entry.PhotoURL);
+		Object->TryGetStringField(TEXT("comment"), Entry.ParentComment);
+
+		FString Request;
+		if (Object->TryGetStringField(TEXT("request"), Request))
+		{
+			const int64 RequestValue = RequestEnum->GetValueByNameString(Request);
+			Entry.PendingRequest = RequestValue != INDEX_NONE ? static_cast<EMissionOutboxRequest>(RequestValue) : EMissionOutboxRequest::None;
+		}
+
+		Loaded.Add(Entry.MissionID, MoveTemp(Entry));
+	}
+
+	LinesOnDisk = Lines.Num();
+
+	USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	const FChildId ActiveChildID = GameInstance ? GameInstance->GetActiveChildID() : FChildId();
+	UMissionCatalogSubsystem* Catalog = GetGameInstance()->GetSubsystem<UMissionCatalogSubsystem>();
+
+	// Transitions recorded this session, before the load finished, are newer than the file
+	for (TPair<FString, FMissionOutboxEntry>& Pair : Loaded)
+	{
+		if (Entries.Contains(Pair.Key))
+		{
+			continue;
+		}
+
+		if (Catalog && ActiveChildID.IsValid() && Pair.Value.ChildID == ActiveChildID)
+		{
+			Catalog->StartMission(FMissionId::FromString(Pair.Key));
+		}
+		Entries.Add(Pair.Key, MoveTemp(Pair.Value));
+	}
+
+	bLoaded = true;
+
+	UE_LOG(LogRealLifeMissions, Log, TEXT("Mission outbox: %d missions in flight from %d lines (%d unreadable)"), Entries.Num(), Lines.Num(), Skipped);
+
+	TArray<TFunction<void()>> Deferred = MoveTemp(DeferredUntilLoaded);
+	for (TFunction<void()>& Callback : Deferred)
+	{
+		Callback();
+	}
+}
+
+void UMissionOutboxSubsystem::Append(const FMissionOutboxEntry& Entry)
+{
+	PendingLines.Add(EntryToLine(Entry, NextSequence++));
+
+	if (Entry.Status == EMissionStatus::Completed)
+	{
+		Entries.Remove(Entry.MissionID);
+	}
+	else
+	{
+		Entries.Add(Entry.MissionID, Entry);
+	}
+
+	OnMissionChanged.Broadcast(Entry);
+}
+
+void UMissionOutboxSubsystem::SendRequest(const FMissionOutboxEntry& Entry)
+{
+	URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>();
+	if (!Bridge)
+	{
+		return;
+	}
+
+	SentThisSession.Add(Entry.CorrelationID);
+
+	switch (Entry.PendingRequest)
+	{
+	case EMissionOutboxRequest::PhotoCapture:
+		Bridge->RequestPhotoCapture(Entry.MissionID, Entry.CorrelationID);
+		break;
+	case EMissionOutboxRequest::ParentApproval:
+		Bridge->RequestParentApproval(Entry.MissionID, Entry.PhotoURL, Entry.CorrelationID);
+		break;
+	default:
+		break;
+	}
+}
+
+FString UMissionOutboxSubsystem::EntryToLine(const FMissionOutboxEntry& Entry, int64 Sequence)
+{
+	TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+	Object->SetNumberField(TEXT("seq"), static_cast<double>(Sequence));
+	Object->SetStringField(TEXT("missionId"), Entry.MissionID);
+	Object->SetStringField(TEXT("childId"), Entry.ChildID.ToString());
+	Object->SetStringField(TEXT("status"), StaticEnum<EMissionStatus>()->GetNameStringByValue(static_cast<int64>(Entry.Status)));
+
+	if (Entry.PendingRequest != EMissionOutboxRequest::None)
+	{
+		Object->SetStringField(TEXT("request"), StaticEnum<EMissionOutboxRequest>()->GetNameStringByValue(static_cast<int64>(Entry.PendingRequest)));
+		Object->SetStringField(TEXT("correlationId"), Entry.CorrelationID);
+	}
+	if (!Entry.PhotoPath.IsEmpty())
+	{
+		Object->SetStringField(TEXT("photoPath"), Entry.PhotoPath);
+	}
+	if (!Entry.PhotoURL.IsEmpty())
+	{
+		Object->SetStringField(TEXT("photoUrl"), Entry.PhotoURL);
+	}
+	if (!Entry.ParentComment.IsEmpty())
+	{
+		Object->SetStringField(TEXT("comment"), Entry.ParentComment);
+	}
+
+	FString Line;
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+	FJsonSerializer::Serialize(Object, Writer);
+	return Line;
+}
+
+bool UMissionOutboxSubsystem::TickFlush(float DeltaTime)
+{
+	// Appending before the load would make the line count (and so compaction) wrong
+	if (!bLoaded || bWriteInFlight)
+	{
+		return true;
+	}
+
+	const int32 TotalLines = LinesOnDisk + PendingLines.Num();
+	const bool bCompact = TotalLines > CompactAfterLines && TotalLines > 2 * Entries.Num();
+
+	if (bCompact || PendingLines.Num() > 0)
+	{
+		StartWrite(bCompact);
+	}
+	return true;
+}
+
+void UMissionOutboxSubsystem::StartWrite(bool bCompact)
+{
+	TArray<FString> Lines;
+	if (bCompact)
+	{
+		// The live state already includes every pending transition
+		Lines.Reserve(Entries.Num());
+		for (const TPair<FString, FMissionOutboxEntry>& Pair : Entries)
+		{
+			Lines.Add(EntryToLine(Pair.Value, NextSequence++));
+		}
+	}
+	else
+	{
+		Lines = PendingLines;
+	}
+
+	bWriteInFlight = true;
+	bInFlightCompaction = bCompact;
+	InFlightLines = Lines.Num();
+	InFlightPendingCovered = PendingLines.Num();
+
+	TWeakObjectPtr<UMissionOutboxSubsystem> WeakThis(this);
+	WriteFuture = Async(EAsyncExecution::ThreadPool, [WeakThis, Path = LogPath, Lines = MoveTemp(Lines), bCompact]()
+	{
+		const bool bSucceeded = bCompact
+			? MissionOutbox::RewriteLog(Path, Lines)
+			: MissionOutbox::WriteLinesDurably(Path, Lines, true);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, bSucceeded]()
+		{
+			// Deinitialize may have finished this write already
+			UMissionOutboxSubsystem* This = WeakThis.Get();
+			if (This && This->bWriteInFlight)
+			{
+				This->FinishWrite(bSucceeded);
+			}
+		});
+
+		return bSucceeded;
+	});
+}
+
+void UMissionOutboxSubsystem::FinishWrite(bool bSucceeded)
+{
+	bWriteInFlight = false;
+
+	if (!bSucceeded)
+	{
+		// The lines stay pending and go out with the next flush
+		UE_LOG(LogRealLifeMissions, Warning, TEXT("Mission outbox: %s of %d lines failed; retrying"),
+			bInFlightCompaction ? TEXT("compaction") : TEXT("write"), InFlightLines);
+		return;
+	}
+
+	PendingLines.RemoveAt(0, InFlightPendingCovered);
+	LinesOnDisk = bInFlightCompaction ? InFlightLines : LinesOnDisk + InFlightLines;
+}
+
+// ============================================
+// Bridge
+// ============================================
+
+bool UMissionOutboxSubsystem::IsAnswerToPending(const FMissionOutboxEntry& Entry, EMissionOutboxRequest Request, const FString& CorrelationID)
+{
+	if (Entry.PendingRequest != Request)
+	{
+		return false;
+	}
+
+	// An answer to a request since superseded (retried photo, new approval) is stale
+	if (!CorrelationID.IsEmpty() && CorrelationID != Entry.CorrelationID)
+	{
+		UE_LOG(LogRealLifeMissions, Verbose, TEXT("Mission %s: dropping answer to request %s, pending is %s"), *Entry.MissionID, *CorrelationID, *Entry.CorrelationID);
+		return false;
+	}
+	return true;
+}
+
+void UMissionOutboxSubsystem::HandlePhotoReceived(const FString& MissionID, const FString& PhotoPath, const FString& CorrelationID)
+{
+	if (!bLoaded)
+	{
+		DeferredUntilLoaded.Add([this, MissionID, PhotoPath, CorrelationID]() { HandlePhotoReceived(MissionID, PhotoPath, CorrelationID); });
+		return;
+	}
+
+	// Only answers the open request; a duplicate delivery after a replay finds none
+	const FMissionOutboxEntry* Existing = Entries.Find(MissionID);
+	if (!Existing || !IsAnswerToPending(*Existing, EMissionOutboxRequest::PhotoCapture, CorrelationID))
+	{
+		return;
+	}
+
+	FMissionOutboxEntry Entry = *Existing;
+	Entry.PendingRequest = EMissionOutboxRequest::None;
+	Entry.CorrelationID.Empty();
+	Entry.PhotoPath = PhotoPath;
+	Append(Entry);
+}
+
+void UMissionOutboxSubsystem::HandleParentApprovalReceived(const FString& MissionID, bool bApproved, const FString& Comment, const FString& CorrelationID)
+{
+	if (!bLoaded)
+	{
+		DeferredUntilLoaded.Add([this, MissionID, bApproved, Comment, CorrelationID]() { HandleParentApprovalReceived(MissionID, bApproved, Comment, CorrelationID); });
+		return;
+	}
+
+	const FMissionOutboxEntry* Existing = Entries.Find(MissionID);
+	if (!Existing || !IsAnswerToPending(*Existing, EMissionOutboxRequest::ParentApproval, CorrelationID))
+	{
+		return;
+	}
+
+	FMissionOutboxEntry Entry = *Existing;
+	Entry.Status = bApproved ? EMissionStatus::Approved : EMissionStatus::Rejected;
+	Entry.PendingRequest = EMissionOutboxRequest::None;
+	Entry.CorrelationID.Empty();
+	Entry.ParentComment = Comment;
+	Append(Entry);
+}
+
+void UMissionOutboxSubsystem::HandleProfileSnapshotRequested(const FString& ChildID)
+{
+	// RN asks for a snapshot when its side (re)connects; requests not yet sent this session go out now
+	ReplayPendingRequests();
+}
@@ -0,0 +1,302 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "MissionPhotoProcessing.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "ImageUtils.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+
+namespace MissionPhotoProcessing
+{
+	namespace
+	{
+		uint16 ReadU16(const uint8* Ptr, bool bLittleEndian)
+		{
+			return bLittleEndian
+				? uint16(Ptr[0] | (Ptr[1] << 8))
+				: uint16((Ptr[0] << 8) | Ptr[1]);
+		}
+
+		uint32 ReadU32(const uint8* Ptr, bool bLittleEndian)
+		{
+			return bLittleEndian
+				? uint32(Ptr[0] | (Ptr[1] << 8) | (Ptr[2] << 16) | (uint32(Ptr[3]) << 24))
+				: uint32((uint32(Ptr[0]) << 24) | (Ptr[1] << 16) | (Ptr[2] << 8) | Ptr[3]);
+		}
+
+		/** HEIF/HEIC containers start with an ISO-BMFF 'ftyp' box */
+		bool IsHeifContainer(const uint8* Data, int64 Size)
+		{
+			if (Size < 12 || FMemory::Memcmp(Data + 4, "ftyp", 4) != 0)
+			{
+				return false;
+			}
+			const char* Brands[] = { "heic", "heix", "hevc", "heim", "heis", "mif1", "msf1" };
+			for (const char* Brand : Brands)
+			{
+				if (FMemory::Memcmp(Data + 8, Brand, 4) == 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		IImageWrapperModule& GetImageWrapperModule()
+		{
+			// Loaded on the game thread by UMissionPhotoSubsystem::Initialize
+			return FModuleManager::GetModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+		}
+	}
+
+	FPhotoProbe ProbePhoto(const FString& MissionID, const FString& SourcePath)
+	{
+		FPhotoProbe Probe;
+		Probe.MissionID = MissionID;
+		Probe.SourcePath = SourcePath;
+
+		if (!FFileHelper::LoadFileToArray(Probe.CompressedData, *SourcePath))
+		{
+			Probe.Error = FString::Printf(TEXT("Could not read photo '%s'"), *SourcePath);
+			return Probe;
+		}
+
+		const uint8* Data = Probe.CompressedData.GetData();
+		const int64 Size = Probe.CompressedData.Num();
+
+		if (IsHeifContainer(Data, Size))
+		{
+			// ImageWrapper has no HEIF decoder; the app must hand over a JPEG
+			Probe.Error = TEXT("HEIC photos are not supported, capture as JPEG");
+			Probe.CompressedData.Empty();
+			return Probe;
+		}
+
+		IImageWrapperModule& ImageWrapperModule = GetImageWrapperModule();
+		const EImageFormat Format = ImageWrapperModule.DetectImageFormat(Data, Size);
+		if (Format == EImageFormat::Invalid)
+		{
+			Probe.Error = FString::Printf(TEXT("Unrecognized image format in '%s'"), *SourcePath);
+			Probe.CompressedData.Empty();
+			return Probe;
+		}
+
+		TSharedPtr<IImageWrapper> Wrapper = ImageWrapperModule.CreateImageWrapper(Format);
+		if (!Wrapper.IsValid() || !Wrapper->SetCompressed(Data, Size))
+		{
+			Probe.Error = FString::Printf(TEXT("Corrupt image header in '%s'"), *SourcePath);
+			Probe.CompressedData.Empty();
+			return Probe;
+		}
+
+		Probe.Width = Wrapper->GetWidth();
+		Probe.Height = Wrapper->GetHeight();
+
+		if (Format == EImageFormat::JPEG || Format == EImageFormat::GrayscaleJPEG)
+		{
+			Probe.Orientation = ReadJpegOrientation(Data, Size);
+		}
+
+		return Probe;
+	}
+
+	FPhotoOutput ProcessPhoto(FPhotoProbe&& Probe, const FPhotoSettings& Settings)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		FPhotoOutput Output;
+		Output.MissionID = Probe.MissionID;
+		Output.SourceWidth = Probe.Width;
+		Output.SourceHeight = Probe.Height;
+
+		IImageWrapperModule& ImageWrapperModule = GetImageWrapperModule();
+
+		// Full-resolution decode: this is the allocation the in-flight cap accounts for
+		TArray<FColor> UploadPixels;
+		FIntPoint UploadSize;
+		{
+			TArray64<uint8> DecodedBGRA;
+			{
+				const EImageFormat Format = ImageWrapperModule.DetectImageFormat(Probe.CompressedData.GetData(), Probe.CompressedData.Num());
+				TSharedPtr<IImageWrapper> Decoder = ImageWrapperModule.CreateImageWrapper(Format);
+				if (!Decoder.IsValid()
+					|| !Decoder->SetCompressed(Probe.CompressedData.GetData(), Probe.CompressedData.Num())
+					|| !Decoder->GetRaw(ERGBFormat::BGRA, 8, DecodedBGRA))
+				{
+					Output.Error = FString::Printf(TEXT("Failed to decode '%s'"), *Probe.SourcePath);
+					return Output;
+				}
+			}
+			Probe.CompressedData.Empty();
+
+			const TArrayView<const FColor> SourceView(reinterpret_cast<const FColor*>(DecodedBGRA.GetData()), Probe.Width * Probe.Height);
+
+			UploadSize = FitWithin(Probe.Width, Probe.Height, Settings.UploadMaxEdge);
+			UploadPixels.SetNumUninitialized(UploadSize.X * UploadSize.Y);
+			FImageUtils::ImageResize(Probe.Width, Probe.Height, SourceView, UploadSize.X, UploadSize.Y, UploadPixels, false, true);
+
+			// Full-resolution buffer is released here
+		}
+
+		// Rotate the already downscaled image, it is a fraction of the source size
+		ApplyOrientation(UploadPixels, UploadSize.X, UploadSize.Y, Probe.Orientation);
+
+		// Upload-size re-encode
+		{
+			TSharedPtr<IImageWrapper> Encoder = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
+			if (!Encoder.IsValid()
+				|| !Encoder->SetRaw(UploadPixels.GetData(), UploadPixels.Num() * sizeof(FColor), UploadSize.X, UploadSize.Y, ERGBFormat::BGRA, 8))
+			{
+				Output.Error = TEXT("Failed to prepare upload encoder");
+				return Output;
+			}
+
+			const TArray64<uint8>& Encoded = Encoder->GetCompressed(Settings.UploadJpegQuality);
+			Output.UploadFilePath = FPaths::Combine(Settings.UploadDirectory, FString::Printf(TEXT("%s_%s.jpg"), *Probe.MissionID, *FGuid::NewGuid().ToString(EGuidFormats::Digits)));
+			if (!FFileHelper::SaveArrayToFile(Encoded, *Output.UploadFilePath))
+			{
+				Output.Error = FString::Printf(TEXT("Could not write '%s'"), *Output.UploadFilePath);
+				Output.UploadFilePath.Empty();
+				return Output;
+			}
+		}
+
+		// Thumbnail from the oriented upload image
+		const FIntPoint ThumbSize = FitWithin(UploadSize.X, UploadSize.Y, Settings.ThumbnailMaxEdge);
+		Output.ThumbnailPixels.SetNumUninitialized(ThumbSize.X * ThumbSize.Y);
+		FImageUtils::ImageResize(UploadSize.X, UploadSize.Y, UploadPixels, ThumbSize.X, ThumbSize.Y, Output.ThumbnailPixels, false, true);
+		Output.ThumbnailWidth = ThumbSize.X;
+		Output.ThumbnailHeight = ThumbSize.Y;
+
+		Output.ProcessingSeconds = FPlatformTime::Seconds() - StartTime;
+		return Output;
+	}
+
+	uint8 ReadJpegOrientation(const uint8* Data, int64 Size)
+	{
+		if (Size < 4 || Data[0] != 0xFF || Data[1] != 0xD8)
+		{
+			return 1;
+		}
+
+		int64 Offset = 2;
+		while (Offset + 4 <= Size)
+		{
+			if (Data[Offset] != 0xFF)
+			{
+				return 1;
+			}
+
+			const uint8 Marker = Data[Offset + 1];
+			const int64 SegmentLength = (Data[Offset + 2] << 8) | Data[Offset + 3];
+
+			// Start of scan: no more metadata segments follow
+			if (Marker == 0xDA || SegmentLength < 2)
+			{
+				return 1;
+			}
+
+			const int64 SegmentStart = Offset + 4;
+			const int64 SegmentEnd = FMath::Min(Offset + 2 + SegmentLength, Size);
+
+			if (Marker == 0xE1 && SegmentEnd - SegmentStart >= 14 && FMemory::Memcmp(Data + SegmentStart, "Exif\0\0", 6) == 0)
+			{
+				const uint8* Tiff = Data + SegmentStart + 6;
+				const int64 TiffSize = SegmentEnd - SegmentStart - 6;
+
+				const bool bLittleEndian = Tiff[0] == 'I' && Tiff[1] == 'I';
+				if (!bLittleEndian && !(Tiff[0] == 'M' && Tiff[1] == 'M'))
+				{
+					return 1;
+				}
+
+				const int64 IfdOffset = ReadU32(Tiff + 4, bLittleEndian);
+				if (IfdOffset + 2 > TiffSize)
+				{
+					return 1;
+				}
+
+				const int32 EntryCount = ReadU16(Tiff + IfdOffset, bLittleEndian);
+				for (int32 Index = 0; Index < EntryCount; ++Index)
+				{
+					const int64 Entry = IfdOffset + 2 + Index * 12;
+					if (Entry + 12 > TiffSize)
+					{
+						return 1;
+					}
+
+					// 0x0112 = Orientation, stored as SHORT in the value field
+					if (ReadU16(Tiff + Entry, bLittleEndian) == 0x0112)
+					{
+						const uint16 Value = ReadU16(Tiff + Entry + 8, bLittleEndian);
+						return (Value >= 1 && Value <= 8) ? uint8(Value) : 1;
+					}
+				}
+				return 1;
+			}
+
+			Offset = Offset + 2 + SegmentLength;
+		}
+
+		return 1;
+	}
+
+	void ApplyOrientation(TArray<FColor>& Pixels, int32& Width, int32& Height, uint8 Orientation)
+	{
+		if (Orientation <= 1 || Orientation > 8)
+		{
+			return;
+		}
+
+		const int32 SrcW = Width;
+		const int32 SrcH = Height;
+		const bool bSwapsAxes = Orientation >= 5;
+		const int32 DstW = bSwapsAxes ? SrcH : SrcW;
+		const int32 DstH = bSwapsAxes ? SrcW : SrcH;
+
+		TArray<FColor> Oriented;
+		Oriented.SetNumUninitialized(Pixels.Num());
+
+		for (int32 SrcY = 0; SrcY < SrcH; ++SrcY)
+		{
+			for (int32 SrcX = 0; SrcX < SrcW; ++SrcX)
+			{
+				int32 DstX = SrcX;
+				int32 DstY = SrcY;
+				switch (Orientation)
+				{
+				case 2: DstX = SrcW - 1 - SrcX; DstY = SrcY; break;                 // Mirror horizontal
+				case 3: DstX = SrcW - 1 - SrcX; DstY = SrcH - 1 - SrcY; break;      // Rotate 180
+				case 4: DstX = SrcX; DstY = SrcH - 1 - SrcY; break;                 // Mirror vertical
+				case 5: DstX = SrcY; DstY = SrcX; break;                            // Transpose
+				case 6: DstX = SrcH - 1 - SrcY; DstY = SrcX; break;                 // Rotate 90 CW
+				case 7: DstX = SrcH - 1 - SrcY; DstY = SrcW - 1 - SrcX; break;      // Transverse
+				case 8: DstX = SrcY; DstY = SrcW - 1 - SrcX; break;                 // Rotate 90 CCW
+				default: break;
+				}
+				Oriented[DstY * DstW + DstX] = Pixels[SrcY * SrcW + SrcX];
+			}
+		}
+
+		Pixels = MoveTemp(Oriented);
+		Width = DstW;
+		Height = DstH;
+	}
+
+	FIntPoint FitWithin(int32 Width, int32 Height, int32 MaxEdge)
+	{
+		const int32 LongEdge = FMath::Max(Width, Height);
+		if (LongEdge <= MaxEdge || LongEdge <= 0)
+		{
+			return FIntPoint(Width, Height);
+		}
+
+		const float Scale = float(MaxEdge) / float(LongEdge);
+		return FIntPoint(
+			FMath::Max(1, FMath::RoundToInt(Width * Scale)),
+			FMath::Max(1, FMath::RoundToInt(Height * Scale)));
+	}
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Worker-thread helpers for mission photo ingestion.
+ * Nothing in here touches UObjects, so every function is safe to call from the thread pool.
+ */
+namespace MissionPhotoProcessing
+{
+	/** Result of reading a photo header without decoding the pixels */
+	struct FPhotoProbe
+	{
+		FString MissionID;
+		FString SourcePath;
+
+		/** Compressed file contents, kept so the decode stage doesn't hit the disk again */
+		TArray64<uint8> CompressedData;
+
+		int32 Width = 0;
+		int32 Height = 0;
+
+		/** EXIF orientation (1-8), 1 when absent */
+		uint8 Orientation = 1;
+
+		/** Empty on success */
+		FString Error;
+
+		/** Bytes the full-resolution BGRA decode will occupy */
+		int64 GetDecodedBytes() const { return int64(Width) * int64(Height) * 4; }
+	};
+
+	/** Output of the decode stage; only the thumbnail goes back to the game thread */
+	struct FPhotoOutput
+	{
+		FString MissionID;
+		FString UploadFilePath;
+
+		TArray<FColor> ThumbnailPixels;
+		int32 ThumbnailWidth = 0;
+		int32 ThumbnailHeight = 0;
+
+		int32 SourceWidth = 0;
+		int32 SourceHeight = 0;
+
+		double ProcessingSeconds = 0.0;
+
+		/** Empty on success */
+		FString Error;
+	};
+
+	struct FPhotoSettings
+	{
+		int32 ThumbnailMaxEdge = 256;
+		int32 UploadMaxEdge = 1600;
+		int32 UploadJpegQuality = 85;
+		FString UploadDirectory;
+	};
+
+	/** Read the file, detect the format and pull dimensions + EXIF orientation */
+	FPhotoProbe ProbePhoto(const FString& MissionID, const FString& SourcePath);
+
+	/** Decode, orient, downscale and re-encode a probed photo. Consumes Probe.CompressedData. */
+	FPhotoOutput ProcessPhoto(FPhotoProbe&& Probe, const FPhotoSettings& Settings);
+
+	/** Parse the EXIF orientation tag out of a JPEG stream (1 when absent or malformed) */
+	uint8 ReadJpegOrientation(const uint8* Data, int64 Size);
+
+	/** Apply an EXIF orientation in place; swaps Width/Height for the rotated cases */
+	void ApplyOrientation(TArray<FColor>& Pixels, int32& Width, int32& Height, uint8 Orientation);
+
+	/** Fit Width x Height inside MaxEdge preserving aspect ratio (never upscales) */
+	FIntPoint FitWithin(int32 Width, int32 Height, int32 MaxEdge);
+}
@@ -0,0 +1,240 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "MissionPhotoSubsystem.h"
+#include "MissionPhotoProcessing.h"
+#include "RealLifeMissions.h"
+#include "RNUEBridgeSubsystem.h"
+#include "Async/Async.h"
+#include "Engine/Texture2D.h"
+#include "IImageWrapperModule.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+using namespace MissionPhotoProcessing;
+
+void UMissionPhotoSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Module lookups are not safe from workers until the module is loaded once on the game thread
+	FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+	UploadDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MissionPhotos"));
+	IFileManager::Get().MakeDirectory(*UploadDirectory, true);
+
+	if (URNUEBridgeSubsystem* Bridge = Collection.InitializeDependency<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnPhotoReceived.AddDynamic(this, &UMissionPhotoSubsystem::HandlePhotoReceived);
+	}
+}
+
+void UMissionPhotoSubsystem::Deinitialize()
+{
+	if (URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnPhotoReceived.RemoveDynamic(this, &UMissionPhotoSubsystem::HandlePhotoReceived);
+	}
+
+	// In-flight workers hold only a weak pointer and drop their results
+	QueuedPhotos.Empty();
+	ProbedPhotos.Empty();
+	Thumbnails.Empty();
+
+	Super::Deinitialize();
+}
+
+void UMissionPhotoSubsystem::IngestPhoto(const FString& MissionID, const FString& PhotoPath)
+{
+	if (MissionID.IsEmpty() || PhotoPath.IsEmpty())
+	{
+		return;
+	}
+
+	QueuedPhotos.Add({ MissionID, PhotoPath });
+	DispatchWork();
+}
+
+UTexture2D* UMissionPhotoSubsystem::GetThumbnail(const FString& MissionID) const
+{
+	const TObjectPtr<UTexture2D>* Found = Thumbnails.Find(MissionID);
+	return Found ? Found->Get() : nullptr;
+}
+
+void UMissionPhotoSubsystem::ReleaseThumbnail(const FString& MissionID)
+{
+	Thumbnails.Remove(MissionID);
+}
+
+int64 UMissionPhotoSubsystem::GetBudgetedMemoryBytes() const
+{
+	int64 Bytes = DecodedBytesInFlight;
+	for (const TPair<FString, TObjectPtr<UTexture2D>>& Pair : Thumbnails)
+	{
+		if (Pair.Value)
+		{
+			Bytes += static_cast<int64>(Pair.Value->GetSizeX()) * Pair.Value->GetSizeY() * 4;
+		}
+	}
+	return Bytes;
+}
+
+int64 UMissionPhotoSubsystem::TrimMemory(int64 BytesToFree)
+{
+	// Map order is roughly ingestion order, so the oldest thumbnails go first.
+	// Widgets showing one keep it alive; GetThumbnail just stops returning it.
+	int64 Freed = 0;
+	for (auto It = Thumbnails.CreateIterator(); It && Freed < BytesToFree; ++It)
+	{
+		if (It->Value)
+		{
+			Freed += static_cast<int64>(It->Value->GetSizeX()) * It->Value->GetSizeY() * 4;
+		}
+		It.RemoveCurrent();
+	}
+	return Freed;
+}
+
+int32 UMissionPhotoSubsystem::GetPendingPhotoCount() const
+{
+	return QueuedPhotos.Num() + ProbedPhotos.Num() + ActiveProbes + ActiveDecodes;
+}
+
+void UMissionPhotoSubsystem::HandlePhotoReceived(const FString& MissionID, const FString& PhotoPath, const FString& CorrelationID)
+{
+	IngestPhoto(MissionID, PhotoPath);
+}
+
+void UMissionPhotoSubsystem::DispatchWork()
+{
+	check(IsInGameThread());
+
+	TWeakObjectPtr<UMissionPhotoSubsystem> WeakThis(this);
+
+	// Stage 1: read + header parse, cheap and bounded by MaxConcurrentProbes
+	while (QueuedPhotos.Num() > 0 && ActiveProbes < FMath::Max(1, MaxConcurrentProbes))
+	{
+		FQueuedPhoto Photo = QueuedPhotos[0];
+		QueuedPhotos.RemoveAt(0);
+		++ActiveProbes;
+
+		Async(EAsyncExecution::ThreadPool, [WeakThis, Photo]()
+		{
+			LLM_SCOPE_BYTAG(RealLifeMissions);
+			FPhotoProbe Probe = ProbePhoto(Photo.MissionID, Photo.PhotoPath);
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Probe = MoveTemp(Probe)]() mutable
+			{
+				if (UMissionPhotoSubsystem* This = WeakThis.Get())
+				{
+					This->OnProbeFinished(MoveTemp(Probe));
+				}
+			});
+		});
+	}
+
+	// Stage 2: full decode, admitted in order against the memory cap.
+	// A single photo larger than the cap still runs, but only on its own.
+	const int64 MaxBytesInFlight = int64(FMath::Max(1, MaxDecodedMegabytesInFlight)) * 1024 * 1024;
+	while (ProbedPhotos.Num() > 0)
+	{
+		const int64 Bytes = ProbedPhotos[0]->GetDecodedBytes();
+		if (ActiveDecodes > 0 && DecodedBytesInFlight + Bytes > MaxBytesInFlight)
+		{
+			break;
+		}
+
+		TSharedPtr<FPhotoProbe> Probe = ProbedPhotos[0];
+		ProbedPhotos.RemoveAt(0);
+		++ActiveDecodes;
+		DecodedBytesInFlight += Bytes;
+
+		FPhotoSettings Settings;
+		Settings.ThumbnailMaxEdge = ThumbnailMaxEdge;
+		Settings.UploadMaxEdge = UploadMaxEdge;
+		Settings.UploadJpegQuality = UploadJpegQuality;
+		Settings.UploadDirectory = UploadDirectory;
+
+		Async(EAsyncExecution::ThreadPool, [WeakThis, Probe, Settings, Bytes]()
+		{
+			LLM_SCOPE_BYTAG(RealLifeMissions);
+			FPhotoOutput Output = ProcessPhoto(MoveTemp(*Probe), Settings);
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Output = MoveTemp(Output), Bytes]() mutable
+			{
+				if (UMissionPhotoSubsystem* This = WeakThis.Get())
+				{
+					This->OnProcessFinished(MoveTemp(Output), Bytes);
+				}
+			});
+		});
+	}
+}
+
+void UMissionPhotoSubsystem::OnProbeFinished(FPhotoProbe&& Probe)
+{
+	--ActiveProbes;
+
+	if (!Probe.Error.IsEmpty())
+	{
+		UE_LOG(LogRealLifeMissions, Warning, TEXT("Photo for mission %s rejected: %s"), *Probe.MissionID, *Probe.Error);
+		OnPhotoFailed.Broadcast(Probe.MissionID, Probe.Error);
+	}
+	else
+	{
+		ProbedPhotos.Add(MakeShared<FPhotoProbe>(MoveTemp(Probe)));
+	}
+
+	DispatchWork();
+}
+
+void UMissionPhotoSubsystem::OnProcessFinished(FPhotoOutput&& Output, int64 ReservedBytes)
+{
+	LLM_SCOPE_BYTAG(RealLifeMissions);
+
+	--ActiveDecodes;
+	DecodedBytesInFlight -= ReservedBytes;
+
+	if (!Output.Error.IsEmpty())
+	{
+		UE_LOG(LogRealLifeMissions, Warning, TEXT("Photo for mission %s failed: %s"), *Output.MissionID, *Output.Error);
+		OnPhotoFailed.Broadcast(Output.MissionID, Output.Error);
+	}
+	else
+	{
+		FMissionPhotoResult Result;
+		Result.MissionID = Output.MissionID;
+		Result.Thumbnail = CreateThumbnailTexture(Output);
+		Result.UploadFilePath = Output.UploadFilePath;
+		Result.SourceSize = FIntPoint(Output.SourceWidth, Output.SourceHeight);
+		Result.ProcessingTime = static_cast<float>(Output.ProcessingSeconds);
+
+		Thumbnails.Add(Result.MissionID, Result.Thumbnail);
+
+		UE_LOG(LogRealLifeMissions, Log, TEXT("Photo for mission %s ingested in %.1f ms (%dx%d -> %dx%d thumbnail)"),
+			*Result.MissionID, Output.ProcessingSeconds * 1000.0, Output.SourceWidth, Output.SourceHeight, Output.ThumbnailWidth, Output.ThumbnailHeight);
+
+		OnPhotoReady.Broadcast(Result);
+	}
+
+	DispatchWork();
+}
+
+UTexture2D* UMissionPhotoSubsystem::CreateThumbnailTexture(const FPhotoOutput& Output) const
+{
+	UTexture2D* Texture = UTexture2D::CreateTransient(Output.ThumbnailWidth, Output.ThumbnailHeight, PF_B8G8R8A8);
+	if (!Texture)
+	{
+		return nullptr;
+	}
+
+	Texture->SRGB = true;
+	Texture->CompressionSettings = TC_EditorIcon;
+
+	FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
+	void* MipData = Mip.BulkData.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(MipData, Output.ThumbnailPixels.GetData(), Output.ThumbnailPixels.Num() * sizeof(FColor));
+	Mip.BulkData.Unlock();
+
+	Texture->UpdateResource();
+	return Texture;
+}
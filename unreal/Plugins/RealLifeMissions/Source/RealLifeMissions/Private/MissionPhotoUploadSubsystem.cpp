@@ -0,0 +1,1193 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "MissionPhotoUploadSubsystem.h"
+#include "MissionOutboxSubsystem.h"
+#include "MissionPhotoSubsystem.h"
+#include "RealLifeMissions.h"
+#include "RNUEBridgeSubsystem.h"
+#include "Core/SuperfamilyGameInstance.h"
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#if !UE_BUILD_SHIPPING
+#include "HAL/IConsoleManager.h"
+#include "HttpPath.h"
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#endif
+
+namespace MissionPhotoUpload
+{
+	static FString HashToString(const uint8 (&Hash)[FSHA1::DigestSize])
+	{
+		return BytesToHex(Hash, FSHA1::DigestSize).ToLower();
+	}
+
+	/** Hash a whole file and each of its chunks; runs on a worker */
+	static bool HashFile(const FString& Path, int32 ChunkSize, int64& OutSize, FString& OutFileHash, TArray<FString>& OutChunkHashes)
+	{
+		TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+		if (!Reader.IsValid() || Reader->TotalSize() <= 0)
+		{
+			return false;
+		}
+
+		OutSize = Reader->TotalSize();
+
+		FSHA1 FileHash;
+		TArray<uint8> Buffer;
+		Buffer.SetNumUninitialized(ChunkSize);
+
+		for (int64 Offset = 0; Offset < OutSize; Offset += ChunkSize)
+		{
+			const int32 Bytes = static_cast<int32>(FMath::Min<int64>(ChunkSize, OutSize - Offset));
+			Reader->Serialize(Buffer.GetData(), Bytes);
+			if (Reader->IsError())
+			{
+				return false;
+			}
+
+			FileHash.Update(Buffer.GetData(), Bytes);
+
+			uint8 ChunkHash[FSHA1::DigestSize];
+			FSHA1::HashBuffer(Buffer.GetData(), Bytes, ChunkHash);
+			OutChunkHashes.Add(HashToString(ChunkHash));
+		}
+
+		FileHash.Final();
+		uint8 Digest[FSHA1::DigestSize];
+		FileHash.GetHash(Digest);
+		OutFileHash = HashToString(Digest);
+		return true;
+	}
+
+	/** Read one chunk and check it still matches the hash taken when the upload started; runs on a worker */
+	static bool ReadChunk(const FString& Path, int64 Offset, int32 Bytes, const FString& ExpectedHash, TArray<uint8>& OutBytes)
+	{
+		TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+		if (!Reader.IsValid() || Reader->TotalSize() < Offset + Bytes)
+		{
+			return false;
+		}
+
+		OutBytes.SetNumUninitialized(Bytes);
+		Reader->Seek(Offset);
+		Reader->Serialize(OutBytes.GetData(), Bytes);
+		if (Reader->IsError())
+		{
+			return false;
+		}
+
+		uint8 Hash[FSHA1::DigestSize];
+		FSHA1::HashBuffer(OutBytes.GetData(), Bytes, Hash);
+		return HashToString(Hash) == ExpectedHash;
+	}
+
+	static FString ToJSON(const TSharedRef<FJsonObject>& Object)
+	{
+		FString JSON;
+		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&JSON);
+		FJsonSerializer::Serialize(Object, Writer);
+		return JSON;
+	}
+
+	static TSharedPtr<FJsonObject> ParseResponse(const FHttpResponsePtr& Response)
+	{
+		TSharedPtr<FJsonObject> Object;
+		if (Response.IsValid())
+		{
+			const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Response->GetContentAsString());
+			FJsonSerializer::Deserialize(Reader, Object);
+		}
+		return Object;
+	}
+
+	static bool IsSuccess(const FHttpResponsePtr& Response, bool bConnected)
+	{
+		return bConnected && Response.IsValid() && EHttpResponseCodes::IsOk(Response->GetResponseCode());
+	}
+
+	static void DeleteLocalFile(const FString& Path)
+	{
+		IFileManager::Get().Delete(*Path, false, false, true);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+namespace MissionPhotoUpload
+{
+	static constexpr uint32 DefaultStandInPort = 8021;
+
+	/**
+	 * In-memory upload backend serving the four upload routes under {URL}, so
+	 * the upload path can be exercised without the real server. Requests need
+	 * a bearer token; chunk and assembled-file hashes are checked like the
+	 * backend does.
+	 */
+	class FStandInServer
+	{
+	public:
+		~FStandInServer()
+		{
+			if (Router.IsValid() && RouteHandle.IsValid())
+			{
+				Router->UnbindRoute(RouteHandle);
+			}
+		}
+
+		bool Start(uint32 InPort)
+		{
+			Port = InPort;
+			Router = FHttpServerModule::Get().GetHttpRouter(Port, /* bFailOnBindFailure */ true);
+			if (!Router.IsValid())
+			{
+				return false;
+			}
+
+			RouteHandle = Router->BindRoute(FHttpPath(TEXT("/api")), EHttpServerRequestVerbs::VERB_GET | EHttpServerRequestVerbs::VERB_POST | EHttpServerRequestVerbs::VERB_PUT,
+				FHttpRequestHandler::CreateRaw(this, &FStandInServer::HandleRequest));
+			if (!RouteHandle.IsValid())
+			{
+				return false;
+			}
+
+			FHttpServerModule::Get().StartAllListeners();
+			return true;
+		}
+
+		FString GetURL() const
+		{
+			return FString::Printf(TEXT("http://127.0.0.1:%u/api"), Port);
+		}
+
+		/** Answer 401 to the token of the next request until a different one is sent */
+		bool bRevokeToken = false;
+
+		/** Flip a byte of the next chunk stored, so completing its upload fails the file hash */
+		bool bCorruptNext = false;
+
+	private:
+		struct FSession
+		{
+			int64 Size = 0;
+			int32 ChunkCount = 0;
+			FString FileHash;
+			TMap<int32, TArray<uint8>> Chunks;
+		};
+
+		bool HandleRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			OnComplete(Route(Request));
+			return true;
+		}
+
+		TUniquePtr<FHttpServerResponse> Route(const FHttpServerRequest& Request)
+		{
+			const TArray<FString>* Authorization = Request.Headers.Find(TEXT("Authorization"));
+			const FString Token = Authorization && Authorization->Num() > 0 && (*Authorization)[0].StartsWith(TEXT("Bearer ")) ? (*Authorization)[0].Mid(7) : FString();
+			if (bRevokeToken && !Token.IsEmpty())
+			{
+				RevokedToken = Token;
+				bRevokeToken = false;
+			}
+			if (Token.IsEmpty() || Token == RevokedToken)
+			{
+				return FHttpServerResponse::Error(EHttpServerResponseCodes::Denied);
+			}
+
+			// missions/photo/uploads[/{id}[/chunks/{n}|/complete]]
+			TArray<FString> Parts;
+			Request.RelativePath.GetPath().ParseIntoArray(Parts, TEXT("/"));
+			if (Parts.Num() < 3 || Parts[0] != TEXT("missions") || Parts[1] != TEXT("photo") || Parts[2] != TEXT("uploads"))
+			{
+				return FHttpServerResponse::Error(EHttpServerResponseCodes::NotFound);
+			}
+
+			if (Parts.Num() == 3 && Request.Verb == EHttpServerRequestVerbs::VERB_POST)
+			{
+				return Create(Request);
+			}
+
+			FSession* Session = Parts.Num() > 3 ? Sessions.Find(Parts[3]) : nullptr;
+			if (!Session)
+			{
+				return FHttpServerResponse::Error(EHttpServerResponseCodes::NotFound);
+			}
+
+			if (Parts.Num() == 4 && Request.Verb == EHttpServerRequestVerbs::VERB_GET)
+			{
+				TArray<TSharedPtr<FJsonValue>> Received;
+				for (const TPair<int32, TArray<uint8>>& Pair : Session->Chunks)
+				{
+					Received.Add(MakeShared<FJsonValueNumber>(Pair.Key));
+				}
+				TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+				Result->SetArrayField(TEXT("receivedChunks"), Received);
+				return FHttpServerResponse::Create(ToJSON(Result), TEXT("application/json"));
+			}
+			if (Parts.Num() == 6 && Parts[4] == TEXT("chunks") && Request.Verb == EHttpServerRequestVerbs::VERB_PUT)
+			{
+				return PutChunk(*Session, FCString::Atoi(*Parts[5]), Request);
+			}
+			if (Parts.Num() == 5 && Parts[4] == TEXT("complete") && Request.Verb == EHttpServerRequestVerbs::VERB_POST)
+			{
+				return Complete(Parts[3], *Session);
+			}
+			return FHttpServerResponse::Error(EHttpServerResponseCodes::NotFound);
+		}
+
+		static TSharedPtr<FJsonObject> ParseBody(const FHttpServerRequest& Request)
+		{
+			const FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Request.Body.GetData()), Request.Body.Num());
+			TSharedPtr<FJsonObject> Object;
+			FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(Text.Length(), Text.Get())), Object);
+			return Object;
+		}
+
+		TUniquePtr<FHttpServerResponse> Create(const FHttpServerRequest& Request)
+		{
+			const TSharedPtr<FJsonObject> Body = ParseBody(Request);
+			FSession Session;
+			double Size = 0.0;
+			if (!Body.IsValid() || !Body->TryGetNumberField(TEXT("size"), Size) || !Body->TryGetNumberField(TEXT("chunkCount"), Session.ChunkCount)
+				|| !Body->TryGetStringField(TEXT("sha1"), Session.FileHash) || Session.ChunkCount <= 0)
+			{
+				return FHttpServerResponse::Error(EHttpServerResponseCodes::BadRequest);
+			}
+			Session.Size = static_cast<int64>(Size);
+
+			const FString UploadID = FGuid::NewGuid().ToString(EGuidFormats::Digits).ToLower();
+			Sessions.Add(UploadID, MoveTemp(Session));
+
+			TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+			Result->SetStringField(TEXT("uploadId"), UploadID);
+			return FHttpServerResponse::Create(ToJSON(Result), TEXT("application/json"));
+		}
+
+		TUniquePtr<FHttpServerResponse> PutChunk(FSession& Session, int32 Index, const FHttpServerRequest& Request)
+		{
+			uint8 Hash[FSHA1::DigestSize];
+			FSHA1::HashBuffer(Request.Body.GetData(), Request.Body.Num(), Hash);
+			const TArray<FString>* Expected = Request.Headers.Find(TEXT("X-Content-SHA1"));
+			if (Index < 0 || Index >= Session.ChunkCount || !Expected || Expected->Num() == 0 || (*Expected)[0] != HashToString(Hash))
+			{
+				return FHttpServerResponse::Error(EHttpServerResponseCodes::BadRequest);
+			}
+
+			TArray<uint8>& Stored = Session.Chunks.Add(Index, Request.Body);
+			if (bCorruptNext && Stored.Num() > 0)
+			{
+				Stored[Stored.Num() / 2] ^= 0xFF;
+				bCorruptNext = false;
+				UE_LOG(LogRealLifeMissions, Display, TEXT("Stand-in upload server corrupted chunk %d"), Index);
+			}
+			return FHttpServerResponse::Create(FString(), TEXT("text/plain"));
+		}
+
+		TUniquePtr<FHttpServerResponse> Complete(const FString& UploadID, FSession& Session)
+		{
+			if (Session.Chunks.Num() != Session.ChunkCount)
+			{
+				return FHttpServerResponse::Error(EHttpServerResponseCodes::BadRequest);
+			}
+
+			FSHA1 FileHash;
+			int64 Size = 0;
+			for (int32 Index = 0; Index < Session.ChunkCount; ++Index)
+			{
+				const TArray<uint8>& Chunk = Session.Chunks[Index];
+				FileHash.Update(Chunk.GetData(), Chunk.Num());
+				Size += Chunk.Num();
+			}
+			FileHash.Final();
+			uint8 Digest[FSHA1::DigestSize];
+			FileHash.GetHash(Digest);
+
+			if (Size != Session.Size || HashToString(Digest) != Session.FileHash)
+			{
+				Sessions.Remove(UploadID);
+				return FHttpServerResponse::Error(EHttpServerResponseCodes::Conflict);
+			}
+
+			Sessions.Remove(UploadID);
+			UE_LOG(LogRealLifeMissions, Display, TEXT("Stand-in upload server received %s (%lld bytes)"), *UploadID, Size);
+
+			TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+			Result->SetStringField(TEXT("photoUrl"), GetURL() / TEXT("photos") / UploadID + TEXT(".jpg"));
+			return FHttpServerResponse::Create(ToJSON(Result), TEXT("application/json"));
+		}
+
+		uint32 Port = 0;
+		FString RevokedToken;
+		TMap<FString, FSession> Sessions;
+		TSharedPtr<IHttpRouter> Router;
+		FHttpRouteHandle RouteHandle;
+	};
+
+	static TUniquePtr<FStandInServer> GStandInServer;
+
+	static UMissionPhotoUploadSubsystem* GetSubsystem(UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		return GameInstance ? GameInstance->GetSubsystem<UMissionPhotoUploadSubsystem>() : nullptr;
+	}
+
+	/** Start the stand-in backend and point the subsystem at it */
+	static bool StartStandInServer(UMissionPhotoUploadSubsystem& Subsystem, uint32 Port)
+	{
+		GStandInServer = MakeUnique<FStandInServer>();
+		if (!GStandInServer->Start(Port))
+		{
+			UE_LOG(LogRealLifeMissions, Warning, TEXT("Could not start the stand-in upload server on port %u"), Port);
+			GStandInServer.Reset();
+			return false;
+		}
+
+		UE_LOG(LogRealLifeMissions, Display, TEXT("Stand-in upload server at %s"), *GStandInServer->GetURL());
+		Subsystem.SetUploadBaseURL(GStandInServer->GetURL());
+		return true;
+	}
+}
+
+#endif // !UE_BUILD_SHIPPING
+
+using namespace MissionPhotoUpload;
+
+int64 UMissionPhotoUploadSubsystem::FUpload::GetAcknowledgedBytes() const
+{
+	int64 Bytes = 0;
+	for (TConstSetBitIterator<> It(Acknowledged); It; ++It)
+	{
+		Bytes += GetChunkBytes(It.GetIndex());
+	}
+	return Bytes;
+}
+
+void UMissionPhotoUploadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ManifestDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Missions"), TEXT("Uploads"));
+	IFileManager::Get().MakeDirectory(*ManifestDirectory, true);
+
+	Collection.InitializeDependency<UMissionOutboxSubsystem>();
+
+	if (UMissionPhotoSubsystem* Photos = Collection.InitializeDependency<UMissionPhotoSubsystem>())
+	{
+		Photos->OnPhotoReady.AddDynamic(this, &UMissionPhotoUploadSubsystem::HandlePhotoReady);
+	}
+
+	if (URNUEBridgeSubsystem* Bridge = Collection.InitializeDependency<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnMessageReceived.AddDynamic(this, &UMissionPhotoUploadSubsystem::HandleBridgeMessage);
+	}
+
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UMissionPhotoUploadSubsystem::Tick), 0.05f);
+
+	LoadManifestsAsync();
+
+#if !UE_BUILD_SHIPPING
+	if (FParse::Param(FCommandLine::Get(), TEXT("SFUploadServer")))
+	{
+		uint32 Port = DefaultStandInPort;
+		FParse::Value(FCommandLine::Get(), TEXT("SFUploadServerPort="), Port);
+		StartStandInServer(*this, Port);
+	}
+#endif
+}
+
+void UMissionPhotoUploadSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+
+	if (UMissionPhotoSubsystem* Photos = GetGameInstance()->GetSubsystem<UMissionPhotoSubsystem>())
+	{
+		Photos->OnPhotoReady.RemoveDynamic(this, &UMissionPhotoUploadSubsystem::HandlePhotoReady);
+	}
+
+	if (URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnMessageReceived.RemoveDynamic(this, &UMissionPhotoUploadSubsystem::HandleBridgeMessage);
+	}
+
+	// Requests and workers still running hold only a weak pointer; the manifests carry the uploads into the next run
+	Uploads.Empty();
+
+#if !UE_BUILD_SHIPPING
+	GStandInServer.Reset();
+#endif
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Uploads
+// ============================================
+
+void UMissionPhotoUploadSubsystem::UploadPhoto(const FString& MissionID, const FString& FilePath)
+{
+	StartUpload(MissionID, FilePath, false);
+}
+
+void UMissionPhotoUploadSubsystem::StartUpload(const FString& MissionID, const FString& FilePath, bool bOwnsFile)
+{
+	if (MissionID.IsEmpty() || FilePath.IsEmpty())
+	{
+		return;
+	}
+
+	if (const TSharedPtr<FUpload> Existing = Uploads.FindRef(MissionID))
+	{
+		Abandon(Existing, TEXT("replaced by a newer photo"));
+	}
+
+	TSharedPtr<FUpload> Upload = MakeShared<FUpload>();
+	Upload->LocalID = FGuid::NewGuid();
+	Upload->MissionID = MissionID;
+	Upload->FilePath = FilePath;
+	Upload->bOwnsFile = bOwnsFile;
+	Upload->ChunkSize = FMath::Max(16, ChunkSizeKB) * 1024;
+
+	// The child who took the photo, which is not necessarily who is active by the time it is ingested
+	const UMissionOutboxSubsystem* Outbox = GetGameInstance()->GetSubsystem<UMissionOutboxSubsystem>();
+	FMissionOutboxEntry Entry;
+	if (Outbox && Outbox->GetMissionEntry(MissionID, Entry))
+	{
+		Upload->ChildID = Entry.ChildID.ToString();
+	}
+	else if (const USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		Upload->ChildID = GameInstance->GetActiveChildID().ToString();
+	}
+
+	Uploads.Add(MissionID, Upload);
+	StartHashing(Upload);
+}
+
+void UMissionPhotoUploadSubsystem::RetryFailedUploads()
+{
+	for (const TPair<FString, TSharedPtr<FUpload>>& Pair : Uploads)
+	{
+		FUpload& Upload = *Pair.Value;
+		if (Upload.State == EUploadState::Failed)
+		{
+			// The server knows best which chunks it has
+			Upload.State = Upload.UploadID.IsEmpty() ? EUploadState::Creating : EUploadState::Syncing;
+		}
+		Upload.ConsecutiveFailures = 0;
+		Upload.NextAttemptTime = 0.0;
+	}
+}
+
+void UMissionPhotoUploadSubsystem::SetAccessToken(const FString& InAccessToken)
+{
+	AccessToken = InAccessToken;
+
+	if (bAwaitingAuth)
+	{
+		UE_LOG(LogRealLifeMissions, Log, TEXT("Photo upload: new access token, resuming %d uploads"), Uploads.Num());
+	}
+	bAwaitingAuth = false;
+	RetryFailedUploads();
+}
+
+float UMissionPhotoUploadSubsystem::GetUploadProgress(const FString& MissionID) const
+{
+	const TSharedPtr<FUpload>* Found = Uploads.Find(MissionID);
+	if (!Found || (*Found)->FileSize <= 0)
+	{
+		return -1.0f;
+	}
+	return static_cast<float>(static_cast<double>((*Found)->GetAcknowledgedBytes()) / (*Found)->FileSize);
+}
+
+void UMissionPhotoUploadSubsystem::HandlePhotoReady(const FMissionPhotoResult& Result)
+{
+	// The encoded copy is ours; the photo RN took stays with RN
+	StartUpload(Result.MissionID, Result.UploadFilePath, true);
+}
+
+void UMissionPhotoUploadSubsystem::HandleBridgeMessage(const FRNUEMessage& Message)
+{
+	if (Message.Type != ERNUEMessageType::AuthSessionUpdated)
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> Payload;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Message.Payload);
+	FString Token;
+	if (FJsonSerializer::Deserialize(Reader, Payload) && Payload.IsValid() && Payload->TryGetStringField(TEXT("accessToken"), Token))
+	{
+		SetAccessToken(Token);
+	}
+}
+
+void UMissionPhotoUploadSubsystem::StartHashing(TSharedPtr<FUpload> Upload)
+{
+	Upload->State = EUploadState::Hashing;
+
+	TWeakObjectPtr<UMissionPhotoUploadSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Upload, Path = Upload->FilePath, ChunkSize = Upload->ChunkSize]()
+	{
+		int64 Size = 0;
+		FString FileHash;
+		TArray<FString> ChunkHashes;
+		const bool bHashed = HashFile(Path, ChunkSize, Size, FileHash, ChunkHashes);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Upload, bHashed, Size, FileHash = MoveTemp(FileHash), ChunkHashes = MoveTemp(ChunkHashes)]() mutable
+		{
+			UMissionPhotoUploadSubsystem* This = WeakThis.Get();
+			if (!This || !This->IsCurrent(Upload))
+			{
+				return;
+			}
+
+			if (!bHashed)
+			{
+				This->Abandon(Upload, TEXT("photo could not be read"));
+				This->OnUploadFailed.Broadcast(Upload->MissionID, TEXT("Photo could not be read"));
+				return;
+			}
+
+			Upload->FileSize = Size;
+			Upload->FileHash = MoveTemp(FileHash);
+			Upload->ChunkHashes = MoveTemp(ChunkHashes);
+			Upload->Acknowledged.Init(false, Upload->GetChunkCount());
+			Upload->InFlight.Init(false, Upload->GetChunkCount());
+			Upload->State = EUploadState::Creating;
+
+			This->SaveManifest(Upload);
+			This->ReportProgress(Upload);
+		});
+	});
+}
+
+bool UMissionPhotoUploadSubsystem::Tick(float DeltaTime)
+{
+	if (MaxKilobytesPerSecond > 0)
+	{
+		// Allow a burst of at most one second, or one chunk if chunks are bigger than that
+		const double Rate = MaxKilobytesPerSecond * 1024.0;
+		const double Burst = FMath::Max(Rate, FMath::Max(16, ChunkSizeKB) * 1024.0);
+		ByteTokens = FMath::Min(ByteTokens + Rate * DeltaTime, Burst);
+	}
+
+	Pump();
+	return true;
+}
+
+void UMissionPhotoUploadSubsystem::Pump()
+{
+	// Without a token every request would come back 401; RN sends one with AuthSessionUpdated
+	if (bAwaitingAuth || AccessToken.IsEmpty() || Uploads.Num() == 0)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	// Uploads are served in order rather than round-robin, so the first photo finishes as early as possible
+	for (const TPair<FString, TSharedPtr<FUpload>>& Pair : Uploads)
+	{
+		const TSharedPtr<FUpload>& Upload = Pair.Value;
+		if (Upload->bRequestInFlight || Upload->State == EUploadState::Hashing || Upload->State == EUploadState::Failed || Now < Upload->NextAttemptTime)
+		{
+			continue;
+		}
+
+		switch (Upload->State)
+		{
+		case EUploadState::Creating:
+			SendCreate(Upload);
+			break;
+
+		case EUploadState::Syncing:
+			SendStatus(Upload);
+			break;
+
+		case EUploadState::Uploading:
+		{
+			int32 Next = 0;
+			while (ChunksInFlight < FMath::Max(1, MaxConcurrentChunks) && (MaxKilobytesPerSecond <= 0 || ByteTokens > 0.0))
+			{
+				while (Next < Upload->GetChunkCount() && (Upload->Acknowledged[Next] || Upload->InFlight[Next]))
+				{
+					++Next;
+				}
+				if (Next >= Upload->GetChunkCount())
+				{
+					break;
+				}
+
+				ByteTokens -= Upload->GetChunkBytes(Next);
+				ReadAndSendChunk(Upload, Next);
+			}
+
+			if (Upload->ChunksInFlight == 0 && Upload->Acknowledged.CountSetBits() == Upload->GetChunkCount())
+			{
+				Upload->State = EUploadState::Finalizing;
+				SendComplete(Upload);
+			}
+			break;
+		}
+
+		case EUploadState::Finalizing:
+			SendComplete(Upload);
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+// ============================================
+// Requests
+// ============================================
+
+namespace MissionPhotoUpload
+{
+	static TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateRequest(const FString& BaseURL, const FString& Token, float Timeout, const FString& Verb, const FString& Path)
+	{
+		TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+		Request->SetURL(BaseURL / Path);
+		Request->SetVerb(Verb);
+		Request->SetTimeout(Timeout);
+		if (!Token.IsEmpty())
+		{
+			Request->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *Token));
+		}
+		return Request;
+	}
+}
+
+void UMissionPhotoUploadSubsystem::SendCreate(const TSharedPtr<FUpload>& Upload)
+{
+	TSharedRef<FJsonObject> Body = MakeShared<FJsonObject>();
+	Body->SetStringField(TEXT("missionId"), Upload->MissionID);
+	Body->SetStringField(TEXT("childId"), Upload->ChildID);
+	Body->SetNumberField(TEXT("size"), static_cast<double>(Upload->FileSize));
+	Body->SetNumberField(TEXT("chunkSize"), Upload->ChunkSize);
+	Body->SetNumberField(TEXT("chunkCount"), Upload->GetChunkCount());
+	Body->SetStringField(TEXT("sha1"), Upload->FileHash);
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = CreateRequest(UploadBaseURL, AccessToken, RequestTimeoutSeconds, TEXT("POST"), TEXT("missions/photo/uploads"));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	Request->SetContentAsString(ToJSON(Body));
+
+	Upload->bRequestInFlight = true;
+	Request->OnProcessRequestComplete().BindWeakLambda(this, [this, Upload](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnected)
+	{
+		Upload->bRequestInFlight = false;
+		if (!IsCurrent(Upload))
+		{
+			return;
+		}
+
+		const TSharedPtr<FJsonObject> Result = ParseResponse(Response);
+		FString UploadID;
+		if (!IsSuccess(Response, bConnected) || !Result.IsValid() || !Result->TryGetStringField(TEXT("uploadId"), UploadID) || UploadID.IsEmpty())
+		{
+			OnRequestFailed(Upload, TEXT("create"), Response.IsValid() ? Response->GetResponseCode() : 0);
+			return;
+		}
+
+		Upload->UploadID = UploadID;
+		Upload->ConsecutiveFailures = 0;
+		Upload->State = EUploadState::Uploading;
+		SaveManifest(Upload);
+	});
+	Request->ProcessRequest();
+}
+
+void UMissionPhotoUploadSubsystem::SendStatus(const TSharedPtr<FUpload>& Upload)
+{
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = CreateRequest(UploadBaseURL, AccessToken, RequestTimeoutSeconds, TEXT("GET"),
+		FString::Printf(TEXT("missions/photo/uploads/%s"), *Upload->UploadID));
+
+	Upload->bRequestInFlight = true;
+	Request->OnProcessRequestComplete().BindWeakLambda(this, [this, Upload](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnected)
+	{
+		Upload->bRequestInFlight = false;
+		if (!IsCurrent(Upload))
+		{
+			return;
+		}
+
+		const int32 Code = Response.IsValid() ? Response->GetResponseCode() : 0;
+		if (bConnected && (Code == EHttpResponseCodes::NotFound || Code == EHttpResponseCodes::Gone))
+		{
+			// The session expired on the server: start over
+			Upload->UploadID.Empty();
+			Upload->Acknowledged.Init(false, Upload->GetChunkCount());
+			Upload->State = EUploadState::Creating;
+			SaveManifest(Upload);
+			ReportProgress(Upload);
+			return;
+		}
+
+		const TSharedPtr<FJsonObject> Result = ParseResponse(Response);
+		const TArray<TSharedPtr<FJsonValue>>* Received = nullptr;
+		if (!IsSuccess(Response, bConnected) || !Result.IsValid() || !Result->TryGetArrayField(TEXT("receivedChunks"), Received))
+		{
+			OnRequestFailed(Upload, TEXT("status"), Code);
+			return;
+		}
+
+		Upload->Acknowledged.Init(false, Upload->GetChunkCount());
+		for (const TSharedPtr<FJsonValue>& Value : *Received)
+		{
+			const int32 Index = static_cast<int32>(Value->AsNumber());
+			if (Upload->Acknowledged.IsValidIndex(Index))
+			{
+				Upload->Acknowledged[Index] = true;
+			}
+		}
+
+		Upload->ConsecutiveFailures = 0;
+		Upload->State = EUploadState::Uploading;
+		SaveManifest(Upload);
+		ReportProgress(Upload);
+
+		UE_LOG(LogRealLifeMissions, Log, TEXT("Photo upload %s: resuming with %d of %d chunks on the server"),
+			*Upload->MissionID, Upload->Acknowledged.CountSetBits(), Upload->GetChunkCount());
+	});
+	Request->ProcessRequest();
+}
+
+void UMissionPhotoUploadSubsystem::ReadAndSendChunk(const TSharedPtr<FUpload>& Upload, int32 Index)
+{
+	Upload->InFlight[Index] = true;
+	++Upload->ChunksInFlight;
+	++ChunksInFlight;
+
+	TWeakObjectPtr<UMissionPhotoUploadSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Upload, Index, Path = Upload->FilePath, Offset = int64(Index) * Upload->ChunkSize,
+		Bytes = static_cast<int32>(Upload->GetChunkBytes(Index)), Hash = Upload->ChunkHashes[Index]]()
+	{
+		TArray<uint8> Data;
+		const bool bRead = ReadChunk(Path, Offset, Bytes, Hash, Data);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Upload, Index, bRead, Data = MoveTemp(Data)]() mutable
+		{
+			UMissionPhotoUploadSubsystem* This = WeakThis.Get();
+			if (!This)
+			{
+				return;
+			}
+
+			if (!bRead || !This->IsCurrent(Upload))
+			{
+				Upload->InFlight[Index] = false;
+				--Upload->ChunksInFlight;
+				--This->ChunksInFlight;
+
+				if (!bRead && This->IsCurrent(Upload))
+				{
+					This->Abandon(Upload, TEXT("photo changed or disappeared on disk"));
+					This->OnUploadFailed.Broadcast(Upload->MissionID, TEXT("Photo changed on disk"));
+				}
+				return;
+			}
+
+			This->SendChunk(Upload, Index, MoveTemp(Data));
+		});
+	});
+}
+
+void UMissionPhotoUploadSubsystem::SendChunk(const TSharedPtr<FUpload>& Upload, int32 Index, TArray<uint8>&& Bytes)
+{
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = CreateRequest(UploadBaseURL, AccessToken, RequestTimeoutSeconds, TEXT("PUT"),
+		FString::Printf(TEXT("missions/photo/uploads/%s/chunks/%d"), *Upload->UploadID, Index));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/octet-stream"));
+	Request->SetHeader(TEXT("X-Content-SHA1"), Upload->ChunkHashes[Index]);
+	Request->SetContent(MoveTemp(Bytes));
+
+	Request->OnProcessRequestComplete().BindWeakLambda(this, [this, Upload, Index](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnected)
+	{
+		Upload->InFlight[Index] = false;
+		--Upload->ChunksInFlight;
+		--ChunksInFlight;
+
+		if (!IsCurrent(Upload))
+		{
+			return;
+		}
+
+		const int32 Code = Response.IsValid() ? Response->GetResponseCode() : 0;
+		if (!IsSuccess(Response, bConnected))
+		{
+			if (bConnected && Code == EHttpResponseCodes::NotFound && Upload->State == EUploadState::Uploading)
+			{
+				Upload->State = EUploadState::Syncing;
+				return;
+			}
+			OnRequestFailed(Upload, FString::Printf(TEXT("chunk %d"), Index), Code);
+			return;
+		}
+
+		Upload->Acknowledged[Index] = true;
+		Upload->ConsecutiveFailures = 0;
+		SaveManifest(Upload);
+		ReportProgress(Upload);
+	});
+	Request->ProcessRequest();
+}
+
+void UMissionPhotoUploadSubsystem::SendComplete(const TSharedPtr<FUpload>& Upload)
+{
+	TSharedRef<FJsonObject> Body = MakeShared<FJsonObject>();
+	Body->SetStringField(TEXT("sha1"), Upload->FileHash);
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = CreateRequest(UploadBaseURL, AccessToken, RequestTimeoutSeconds, TEXT("POST"),
+		FString::Printf(TEXT("missions/photo/uploads/%s/complete"), *Upload->UploadID));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	Request->SetContentAsString(ToJSON(Body));
+
+	Upload->bRequestInFlight = true;
+	Request->OnProcessRequestComplete().BindWeakLambda(this, [this, Upload](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnected)
+	{
+		Upload->bRequestInFlight = false;
+		if (!IsCurrent(Upload))
+		{
+			return;
+		}
+
+		const int32 Code = Response.IsValid() ? Response->GetResponseCode() : 0;
+		const TSharedPtr<FJsonObject> Result = ParseResponse(Response);
+		FString PhotoURL;
+		if (IsSuccess(Response, bConnected) && Result.IsValid() && Result->TryGetStringField(TEXT("photoUrl"), PhotoURL) && !PhotoURL.IsEmpty())
+		{
+			const FString MissionID = Upload->MissionID;
+			UE_LOG(LogRealLifeMissions, Log, TEXT("Photo upload %s: done (%lld bytes in %d chunks)"), *MissionID, Upload->FileSize, Upload->GetChunkCount());
+
+			Abandon(Upload, FString());
+			OnUploadComplete.Broadcast(MissionID, PhotoURL);
+
+			if (UMissionOutboxSubsystem* Outbox = GetGameInstance()->GetSubsystem<UMissionOutboxSubsystem>())
+			{
+				Outbox->RequestParentApproval(MissionID, PhotoURL);
+			}
+			return;
+		}
+
+		if (bConnected && Code == EHttpResponseCodes::Conflict)
+		{
+			// The assembled file doesn't match its hash: send everything again in a new session, right away
+			UE_LOG(LogRealLifeMissions, Warning, TEXT("Photo upload %s: server rejected the assembled file, restarting"), *Upload->MissionID);
+			Upload->UploadID.Empty();
+			Upload->Acknowledged.Init(false, Upload->GetChunkCount());
+			Upload->State = EUploadState::Creating;
+			SaveManifest(Upload);
+			ReportProgress(Upload);
+			return;
+		}
+
+		if (bConnected && Code == EHttpResponseCodes::NotFound)
+		{
+			Upload->State = EUploadState::Syncing;
+		}
+		OnRequestFailed(Upload, TEXT("complete"), Code);
+	});
+	Request->ProcessRequest();
+}
+
+void UMissionPhotoUploadSubsystem::OnRequestFailed(const TSharedPtr<FUpload>& Upload, const FString& Reason, int32 ResponseCode)
+{
+	if (ResponseCode == EHttpResponseCodes::Denied || ResponseCode == EHttpResponseCodes::Forbidden)
+	{
+		// Not the upload's fault; everything waits for RN to send a fresh token
+		if (!bAwaitingAuth)
+		{
+			UE_LOG(LogRealLifeMissions, Warning, TEXT("Photo upload: access token rejected, waiting for a new one"));
+		}
+		bAwaitingAuth = true;
+		return;
+	}
+
+	++Upload->ConsecutiveFailures;
+
+	if (Upload->ConsecutiveFailures >= FMath::Max(1, MaxAttempts))
+	{
+		UE_LOG(LogRealLifeMissions, Warning, TEXT("Photo upload %s: %s failed (%d), pausing after %d attempts"),
+			*Upload->MissionID, *Reason, ResponseCode, Upload->ConsecutiveFailures);
+		Upload->State = EUploadState::Failed;
+		OnUploadFailed.Broadcast(Upload->MissionID, FString::Printf(TEXT("Upload failed (%d)"), ResponseCode));
+		return;
+	}
+
+	const double Backoff = FMath::Min(60.0, FMath::Pow(2.0, Upload->ConsecutiveFailures - 1));
+	Upload->NextAttemptTime = FPlatformTime::Seconds() + Backoff;
+
+	UE_LOG(LogRealLifeMissions, Log, TEXT("Photo upload %s: %s failed (%d), retrying in %.0fs"), *Upload->MissionID, *Reason, ResponseCode, Backoff);
+}
+
+void UMissionPhotoUploadSubsystem::Abandon(const TSharedPtr<FUpload>& Upload, const FString& Reason)
+{
+	if (!Reason.IsEmpty())
+	{
+		UE_LOG(LogRealLifeMissions, Log, TEXT("Photo upload %s: dropped, %s"), *Upload->MissionID, *Reason);
+	}
+
+	if (IsCurrent(Upload))
+	{
+		Uploads.Remove(Upload->MissionID);
+	}
+
+	// A write still in flight deletes the manifest once it lands
+	if (!Upload->bManifestWriteInFlight)
+	{
+		DeleteLocalFile(GetManifestPath(*Upload));
+	}
+
+	// Chunk reads still running fail their hash check and find the upload no longer current
+	if (Upload->bOwnsFile)
+	{
+		DeleteLocalFile(Upload->FilePath);
+	}
+}
+
+void UMissionPhotoUploadSubsystem::ReportProgress(const TSharedPtr<FUpload>& Upload)
+{
+	if (Upload->FileSize <= 0)
+	{
+		return;
+	}
+
+	const int64 Acknowledged = Upload->GetAcknowledgedBytes();
+	const int32 Percent = static_cast<int32>(Acknowledged * 100 / Upload->FileSize);
+	if (Percent == Upload->ReportedPercent)
+	{
+		return;
+	}
+	Upload->ReportedPercent = Percent;
+
+	OnUploadProgress.Broadcast(Upload->MissionID, static_cast<float>(static_cast<double>(Acknowledged) / Upload->FileSize));
+
+	if (URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>())
+	{
+		Bridge->NotifyPhotoUploadProgress(Upload->MissionID, Acknowledged, Upload->FileSize);
+	}
+}
+
+bool UMissionPhotoUploadSubsystem::IsCurrent(const TSharedPtr<FUpload>& Upload) const
+{
+	const TSharedPtr<FUpload>* Found = Uploads.Find(Upload->MissionID);
+	return Found && *Found == Upload;
+}
+
+// ============================================
+// Manifests
+// ============================================
+
+FString UMissionPhotoUploadSubsystem::GetManifestPath(const FUpload& Upload) const
+{
+	return FPaths::Combine(ManifestDirectory, Upload.LocalID.ToString(EGuidFormats::Digits) + TEXT(".json"));
+}
+
+void UMissionPhotoUploadSubsystem::SaveManifest(const TSharedPtr<FUpload>& Upload)
+{
+	if (Upload->bManifestWriteInFlight)
+	{
+		Upload->bManifestDirty = true;
+		return;
+	}
+
+	TSharedRef<FJsonObject> Manifest = MakeShared<FJsonObject>();
+	Manifest->SetStringField(TEXT("localId"), Upload->LocalID.ToString(EGuidFormats::Digits));
+	Manifest->SetStringField(TEXT("missionId"), Upload->MissionID);
+	Manifest->SetStringField(TEXT("childId"), Upload->ChildID);
+	Manifest->SetStringField(TEXT("file"), Upload->FilePath);
+	Manifest->SetBoolField(TEXT("ownsFile"), Upload->bOwnsFile);
+	Manifest->SetNumberField(TEXT("size"), static_cast<double>(Upload->FileSize));
+	Manifest->SetNumberField(TEXT("chunkSize"), Upload->ChunkSize);
+	Manifest->SetStringField(TEXT("sha1"), Upload->FileHash);
+	Manifest->SetStringField(TEXT("uploadId"), Upload->UploadID);
+
+	TArray<TSharedPtr<FJsonValue>> ChunkHashes;
+	for (const FString& Hash : Upload->ChunkHashes)
+	{
+		ChunkHashes.Add(MakeShared<FJsonValueString>(Hash));
+	}
+	Manifest->SetArrayField(TEXT("chunks"), ChunkHashes);
+
+	Upload->bManifestWriteInFlight = true;
+	Upload->bManifestDirty = false;
+
+	TWeakObjectPtr<UMissionPhotoUploadSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Upload, Path = GetManifestPath(*Upload), JSON = ToJSON(Manifest)]()
+	{
+		if (!FFileHelper::SaveStringToFile(JSON, *Path))
+		{
+			UE_LOG(LogRealLifeMissions, Warning, TEXT("Photo upload: could not write %s"), *Path);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Upload, Path]()
+		{
+			Upload->bManifestWriteInFlight = false;
+
+			UMissionPhotoUploadSubsystem* This = WeakThis.Get();
+			if (This && !This->IsCurrent(Upload))
+			{
+				DeleteLocalFile(Path);
+			}
+			else if (This && Upload->bManifestDirty)
+			{
+				This->SaveManifest(Upload);
+			}
+		});
+	});
+}
+
+void UMissionPhotoUploadSubsystem::LoadManifestsAsync()
+{
+	TWeakObjectPtr<UMissionPhotoUploadSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Directory = ManifestDirectory]()
+	{
+		TArray<TSharedPtr<FUpload>> Loaded;
+
+		TArray<FString> Files;
+		IFileManager::Get().FindFiles(Files, *FPaths::Combine(Directory, TEXT("*.json")), true, false);
+
+		for (const FString& File : Files)
+		{
+			const FString Path = FPaths::Combine(Directory, File);
+
+			FString JSON;
+			TSharedPtr<FJsonObject> Manifest;
+			TSharedPtr<FUpload> Upload = MakeShared<FUpload>();
+			const TArray<TSharedPtr<FJsonValue>>* ChunkHashes = nullptr;
+			double Size = 0.0;
+			int32 ChunkSize = 0;
+
+			const bool bParsed = FFileHelper::LoadFileToString(JSON, *Path)
+				&& FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(JSON), Manifest) && Manifest.IsValid()
+				&& FGuid::Parse(Manifest->GetStringField(TEXT("localId")), Upload->LocalID)
+				&& Manifest->TryGetStringField(TEXT("missionId"), Upload->MissionID)
+				&& Manifest->TryGetStringField(TEXT("file"), Upload->FilePath)
+				&& Manifest->TryGetNumberField(TEXT("size"), Size)
+				&& Manifest->TryGetNumberField(TEXT("chunkSize"), ChunkSize) && ChunkSize > 0
+				&& Manifest->TryGetStringField(TEXT("sha1"), Upload->FileHash)
+				&& Manifest->TryGetArrayField(TEXT("chunks"), ChunkHashes);
+
+			Manifest->TryGetBoolField(TEXT("ownsFile"), Upload->bOwnsFile);
+
+			// A photo that is gone or changed size since can't be resumed
+			if (!bParsed || IFileManager::Get().FileSize(*Upload->FilePath) != static_cast<int64>(Size))
+			{
+				UE_LOG(LogRealLifeMissions, Log, TEXT("Photo upload: discarding stale manifest %s"), *File);
+				DeleteLocalFile(Path);
+				if (bParsed && Upload->bOwnsFile)
+				{
+					DeleteLocalFile(Upload->FilePath);
+				}
+				continue;
+			}
+
+			Manifest->TryGetStringField(TEXT("childId"), Upload->ChildID);
+			Manifest->TryGetStringField(TEXT("uploadId"), Upload->UploadID);
+			Upload->FileSize = static_cast<int64>(Size);
+			Upload->ChunkSize = ChunkSize;
+			for (const TSharedPtr<FJsonValue>& Hash : *ChunkHashes)
+			{
+				Upload->ChunkHashes.Add(Hash->AsString());
+			}
+
+			Loaded.Add(Upload);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Loaded = MoveTemp(Loaded)]()
+		{
+			if (UMissionPhotoUploadSubsystem* This = WeakThis.Get())
+			{
+				for (const TSharedPtr<FUpload>& Upload : Loaded)
+				{
+					This->RestoreUpload(Upload);
+				}
+			}
+		});
+	});
+}
+
+void UMissionPhotoUploadSubsystem::RestoreUpload(TSharedPtr<FUpload> Upload)
+{
+	// A photo for this mission that came in during this run is newer
+	if (Uploads.Contains(Upload->MissionID))
+	{
+		DeleteLocalFile(GetManifestPath(*Upload));
+		if (Upload->bOwnsFile)
+		{
+			DeleteLocalFile(Upload->FilePath);
+		}
+		return;
+	}
+
+	Upload->Acknowledged.Init(false, Upload->GetChunkCount());
+	Upload->InFlight.Init(false, Upload->GetChunkCount());
+	Upload->State = Upload->UploadID.IsEmpty() ? EUploadState::Creating : EUploadState::Syncing;
+	Uploads.Add(Upload->MissionID, Upload);
+
+	UE_LOG(LogRealLifeMissions, Log, TEXT("Photo upload %s: resuming from a previous run"), *Upload->MissionID);
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorldAndArgs GMissionUploadServeCommand(
+	TEXT("sf.Upload.Serve"),
+	TEXT("Start the stand-in upload backend and send photo uploads to it. Same as -SFUploadServer. Usage: sf.Upload.Serve [Port]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UMissionPhotoUploadSubsystem* Subsystem = MissionPhotoUpload::GetSubsystem(World))
+		{
+			MissionPhotoUpload::StartStandInServer(*Subsystem, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : MissionPhotoUpload::DefaultStandInPort);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GMissionUploadSetTokenCommand(
+	TEXT("sf.Upload.SetToken"),
+	TEXT("Set the upload access token, as RN's AuthSessionUpdated does. Usage: sf.Upload.SetToken <Token>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UMissionPhotoUploadSubsystem* Subsystem = MissionPhotoUpload::GetSubsystem(World);
+		if (Subsystem && Args.Num() > 0)
+		{
+			Subsystem->SetAccessToken(Args[0]);
+		}
+	}));
+
+static FAutoConsoleCommand GMissionUploadRevokeTokenCommand(
+	TEXT("sf.Upload.RevokeToken"),
+	TEXT("Make the stand-in upload backend reject the current token until a new one is set"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (MissionPhotoUpload::GStandInServer.IsValid())
+		{
+			MissionPhotoUpload::GStandInServer->bRevokeToken = true;
+		}
+	}));
+
+static FAutoConsoleCommand GMissionUploadCorruptNextCommand(
+	TEXT("sf.Upload.CorruptNext"),
+	TEXT("Make the stand-in upload backend corrupt the next chunk it stores, so that upload's completion is rejected"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (MissionPhotoUpload::GStandInServer.IsValid())
+		{
+			MissionPhotoUpload::GStandInServer->bCorruptNext = true;
+		}
+	}));
+
+#endif // !UE_BUILD_SHIPPING
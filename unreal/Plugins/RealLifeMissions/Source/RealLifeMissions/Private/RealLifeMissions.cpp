@@ -0,0 +1,20 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "RealLifeMissions.h"
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY(LogRealLifeMissions);
+
+LLM_DEFINE_TAG(RealLifeMissions);
+
+void FRealLifeMissionsModule::StartupModule()
+{
+	UE_LOG(LogRealLifeMissions, Log, TEXT("RealLifeMissions module starting up"));
+}
+
+void FRealLifeMissionsModule::ShutdownModule()
+{
+	UE_LOG(LogRealLifeMissions, Log, TEXT("RealLifeMissions module shutting down"));
+}
+
+IMPLEMENT_MODULE(FRealLifeMissionsModule, RealLifeMissions);
@@ -0,0 +1,150 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/BitArray.h"
+#include "Types/SuperfamilyTypes.h"
+#include "MissionCatalogSubsystem.generated.h"
+
+struct FRNUEMessage;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMissionCatalogRefreshed, int32, NumMissions);
+
+/**
+ * Real-life mission catalog, indexed for per-child queries
+ * Every mission gets a slot that stays the same for the session, also across
+ * catalog refreshes, so per-child state is a completed and an in-progress
+ * bitset over slots. Each child also keeps, per (category, minimum age)
+ * bucket, the list of slots still available to them, so "available missions
+ * in category X" visits only the results and completing a mission is O(1).
+ *
+ * The catalog comes from the backend through RN (MissionCatalogUpdated) or
+ * RefreshCatalog. A refresh only touches the slots that changed; profiles are
+ * read when a child is first queried, and again after a save load or sync
+ * replaces them.
+ */
+UCLASS()
+class REALLIFEMISSIONS_API UMissionCatalogSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	// ============================================
+	// Catalog
+	// ============================================
+
+	/** Replace the catalog; missions absent from the new list are retired */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Catalog")
+	void RefreshCatalog(const TArray<FMissionData>& NewMissions);
+
+	/** Replace the catalog from a backend payload: { "missions": [ FMissionData... ] } */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Catalog")
+	bool RefreshCatalogFromJSON(const FString& CatalogJSON);
+
+	UFUNCTION(BlueprintCallable, Category = "Missions|Catalog")
+	bool FindMission(const FMissionId& MissionID, FMissionData& OutMission) const;
+
+	/** Missions in the current catalog (retired ones excluded) */
+	UFUNCTION(BlueprintPure, Category = "Missions|Catalog")
+	int32 GetMissionCount() const { return Missions.Num() - RetiredCount; }
+
+	// ============================================
+	// Per-Child Queries
+	// ============================================
+
+	/** Missions the child is old enough for in a category, neither completed nor in progress */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Catalog")
+	TArray<FMissionData> GetAvailableMissions(const FChildId& ChildID, EMissionCategory Category);
+
+	/** Missions the child has started this session and not completed */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Catalog")
+	TArray<FMissionData> GetInProgressMissions(const FChildId& ChildID);
+
+	UFUNCTION(BlueprintCallable, Category = "Missions|Catalog")
+	bool IsMissionCompleted(const FChildId& ChildID, const FMissionId& MissionID);
+
+	/** Available, InProgress or Completed; approval states live with RN */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Catalog")
+	EMissionStatus GetMissionStatus(const FChildId& ChildID, const FMissionId& MissionID);
+
+	// ============================================
+	// Active Child
+	// ============================================
+
+	/** Mark a mission as started by the active child */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Catalog")
+	bool StartMission(const FMissionId& MissionID);
+
+	/** Record a mission as completed by the active child (saved to the profile) */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Catalog")
+	void CompleteMission(const FMissionId& MissionID);
+
+	/** Fired after every catalog refresh */
+	UPROPERTY(BlueprintAssignable, Category = "Missions|Catalog")
+	FOnMissionCatalogRefreshed OnCatalogRefreshed;
+
+private:
+	static constexpr int32 NumCategories = static_cast<int32>(EMissionCategory::Leren) + 1;
+	static constexpr int32 NumAgeGroups = static_cast<int32>(EDifficultyLevel::Groep4) + 1;
+	static constexpr int32 NumBuckets = NumCategories * NumAgeGroups;
+
+	static int32 GetBucket(EMissionCategory Category, EDifficultyLevel MinAge);
+
+	/** Mission state of one child, indexed by slot */
+	struct FChildMissionState
+	{
+		/** Age group index the child can see missions up to */
+		int32 MaxAgeGroup = 0;
+
+		TBitArray<> Completed;
+		TBitArray<> InProgress;
+
+		/** Available slots per bucket, unordered */
+		TArray<int32> Available[NumBuckets];
+
+		/** Index of each slot in its Available bucket, INDEX_NONE if not available */
+		TArray<int32> AvailablePosition;
+
+		/** Completed mission IDs the catalog doesn't have (yet) */
+		TSet<FMissionId> UnknownCompleted;
+	};
+
+	/** State of a child, built from their profile on first use; null if there is no such profile */
+	FChildMissionState* GetChildState(const FChildId& ChildID);
+
+	void AddAvailable(FChildMissionState& State, int32 Slot) const;
+	void RemoveAvailable(FChildMissionState& State, int32 Slot) const;
+
+	/** Add a slot to every child's state, completed if their profile says so */
+	void AddSlotToChildren(int32 Slot);
+
+	/** Re-bucket a slot whose category, age or retired flag changed */
+	void UpdateSlotForChildren(int32 Slot, int32 NewBucket, bool bRetire);
+
+	void HandleMissionRecorded(const FChildId& ChildID, const FMissionId& MissionID);
+
+	/** Rebuild the states of re-applied profiles, keeping this session's in-progress missions */
+	void HandleProfilesApplied(const FChildId& ChildID);
+
+	UFUNCTION()
+	void HandleBridgeMessage(const FRNUEMessage& Message);
+
+	/** Missions by slot; retired missions keep their slot */
+	TArray<FMissionData> Missions;
+	TArray<uint8> SlotBuckets;
+	TBitArray<> RetiredSlots;
+	int32 RetiredCount = 0;
+
+	TMap<FMissionId, int32> SlotByID;
+	TMap<FChildId, FChildMissionState> ChildStates;
+
+	FDelegateHandle MissionRecordedHandle;
+	FDelegateHandle ProfilesAppliedHandle;
+};
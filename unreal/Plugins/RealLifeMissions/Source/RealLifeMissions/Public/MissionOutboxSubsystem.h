@@ -0,0 +1,183 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Async/Future.h"
+#include "Containers/Ticker.h"
+#include "Types/SuperfamilyTypes.h"
+#include "MissionOutboxSubsystem.generated.h"
+
+/**
+ * Request to RN a mission is waiting on
+ */
+UENUM(BlueprintType)
+enum class EMissionOutboxRequest : uint8
+{
+	None            UMETA(DisplayName = "None"),
+	PhotoCapture    UMETA(DisplayName = "Photo Capture"),
+	ParentApproval  UMETA(DisplayName = "Parent Approval")
+};
+
+/**
+ * Last recorded state of a mission in flight
+ */
+USTRUCT(BlueprintType)
+struct REALLIFEMISSIONS_API FMissionOutboxEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	FString MissionID;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	FChildId ChildID;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	EMissionStatus Status = EMissionStatus::InProgress;
+
+	/** Bridge request sent and not yet answered; replayed on reconnect */
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	EMissionOutboxRequest PendingRequest = EMissionOutboxRequest::None;
+
+	/** Correlation ID of the pending request, the same on every replay; RN echoes it on the answer */
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	FString CorrelationID;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	FString PhotoPath;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	FString PhotoURL;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	FString ParentComment;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMissionOutboxChanged, const FMissionOutboxEntry&, Entry);
+
+/**
+ * Durable record of missions in flight between the game and RN
+ * Every transition (started, photo requested and received, approval requested
+ * and answered, completed) appends the mission's new state as one JSON line to
+ * Saved/Missions/Outbox.jsonl. Appends are batched and written and fsynced on a
+ * worker, one batch at a time. After a restart the log is replayed (last line
+ * per mission wins) and requests RN never answered are sent again, once per
+ * session, with their original correlation IDs. RN drops a request it already
+ * has open and answers one it already answered with the same reply; here an
+ * answer is applied only if it carries the pending request's correlation ID.
+ * Completed missions are dropped, and the log is rewritten with just the live
+ * missions once it is mostly dead lines.
+ */
+UCLASS(Config = Game)
+class REALLIFEMISSIONS_API UMissionOutboxSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Boot stage that loads the log and replays pending requests */
+	static const FName BootStage;
+
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	// ============================================
+	// Mission Flow
+	// ============================================
+
+	/** The active child starts a mission */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Outbox")
+	void StartMission(const FString& MissionID);
+
+	/** Ask RN for a photo; also how a rejected mission is retried */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Outbox")
+	void RequestPhotoCapture(const FString& MissionID);
+
+	/** Ask RN for parent approval of an uploaded photo */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Outbox")
+	void RequestParentApproval(const FString& MissionID, const FString& PhotoURL);
+
+	/** Finish an approved mission: records it on the profile and drops it from the outbox */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Outbox")
+	void CompleteMission(const FString& MissionID);
+
+	UFUNCTION(BlueprintCallable, Category = "Missions|Outbox")
+	bool GetMissionEntry(const FString& MissionID, FMissionOutboxEntry& OutEntry) const;
+
+	UFUNCTION(BlueprintPure, Category = "Missions|Outbox")
+	TArray<FMissionOutboxEntry> GetMissionsInFlight() const;
+
+	/** Send unanswered requests not yet sent this session; called after boot and when RN asks for a snapshot */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Outbox")
+	void ReplayPendingRequests();
+
+	/** Fired on every recorded transition */
+	UPROPERTY(BlueprintAssignable, Category = "Missions|Outbox")
+	FOnMissionOutboxChanged OnMissionChanged;
+
+protected:
+	/** Appends are batched for this long before a write */
+	UPROPERTY(Config)
+	float FlushIntervalSeconds = 0.25f;
+
+	/** Rewrite the log once it has this many lines and most of them are superseded */
+	UPROPERTY(Config)
+	int32 CompactAfterLines = 256;
+
+private:
+	/** Read the log off the game thread and apply it */
+	void LoadAsync(TFunction<void()> OnLoaded);
+	void ApplyLoadedLines(const TArray<FString>& Lines);
+
+	/** Record an entry's new state (removed from memory when Completed) */
+	void Append(const FMissionOutboxEntry& Entry);
+	void SendRequest(const FMissionOutboxEntry& Entry);
+
+	bool TickFlush(float DeltaTime);
+	void StartWrite(bool bCompact);
+	void FinishWrite(bool bSucceeded);
+
+	UFUNCTION()
+	void HandlePhotoReceived(const FString& MissionID, const FString& PhotoPath, const FString& CorrelationID);
+
+	UFUNCTION()
+	void HandleParentApprovalReceived(const FString& MissionID, bool bApproved, const FString& Comment, const FString& CorrelationID);
+
+	/** True if an answer belongs to the entry's pending request of this kind */
+	static bool IsAnswerToPending(const FMissionOutboxEntry& Entry, EMissionOutboxRequest Request, const FString& CorrelationID);
+
+	UFUNCTION()
+	void HandleProfileSnapshotRequested(const FString& ChildID);
+
+	static FString EntryToLine(const FMissionOutboxEntry& Entry, int64 Sequence);
+
+	/** Missions in flight by ID */
+	TMap<FString, FMissionOutboxEntry> Entries;
+
+	/** Lines not yet on disk; a write removes the ones it covered once it is synced */
+	TArray<FString> PendingLines;
+
+	/** Lines in the file on disk, live or superseded */
+	int32 LinesOnDisk = 0;
+	int64 NextSequence = 1;
+
+	/** Correlation IDs sent to RN this session; a replay skips them */
+	TSet<FString> SentThisSession;
+
+	/** Bridge answers that arrived before the log was loaded */
+	TArray<TFunction<void()>> DeferredUntilLoaded;
+
+	bool bLoaded = false;
+
+	bool bWriteInFlight = false;
+	bool bInFlightCompaction = false;
+	int32 InFlightLines = 0;
+	int32 InFlightPendingCovered = 0;
+	TFuture<bool> WriteFuture;
+
+	FString LogPath;
+	FTSTicker::FDelegateHandle FlushHandle;
+};
@@ -0,0 +1,149 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Core/MemoryBudgetClient.h"
+#include "MissionPhotoSubsystem.generated.h"
+
+class UTexture2D;
+
+namespace MissionPhotoProcessing
+{
+	struct FPhotoProbe;
+	struct FPhotoOutput;
+}
+
+/**
+ * A mission photo that finished ingestion
+ */
+USTRUCT(BlueprintType)
+struct REALLIFEMISSIONS_API FMissionPhotoResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	FString MissionID;
+
+	/** Small, correctly oriented preview texture */
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	TObjectPtr<UTexture2D> Thumbnail = nullptr;
+
+	/** Downscaled JPEG ready for upload to the backend */
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	FString UploadFilePath;
+
+	/** Dimensions of the original camera photo */
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	FIntPoint SourceSize = FIntPoint::ZeroValue;
+
+	/** Worker time spent decoding, resizing and encoding */
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	float ProcessingTime = 0.0f;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMissionPhotoReady, const FMissionPhotoResult&, Result);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMissionPhotoFailed, const FString&, MissionID, const FString&, Reason);
+
+/**
+ * Ingests mission photos delivered by the RN bridge
+ * Decoding, orientation, downscaling and the upload re-encode all run on the thread pool;
+ * the game thread only creates the finished thumbnail texture.
+ */
+UCLASS(Config = Game)
+class REALLIFEMISSIONS_API UMissionPhotoSubsystem : public UGameInstanceSubsystem, public IMemoryBudgetClient
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	//~ Begin IMemoryBudgetClient Interface
+	virtual FName GetMemoryBudgetName() const override { return TEXT("Photos"); }
+	virtual int64 GetBudgetedMemoryBytes() const override;
+	virtual int64 TrimMemory(int64 BytesToFree) override;
+	//~ End IMemoryBudgetClient Interface
+
+	/** Queue a camera photo for ingestion (called automatically for bridge photos) */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Photo")
+	void IngestPhoto(const FString& MissionID, const FString& PhotoPath);
+
+	/** Get the thumbnail of an ingested photo, null if not (yet) available */
+	UFUNCTION(BlueprintPure, Category = "Missions|Photo")
+	UTexture2D* GetThumbnail(const FString& MissionID) const;
+
+	/** Drop a thumbnail once the UI no longer needs it */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Photo")
+	void ReleaseThumbnail(const FString& MissionID);
+
+	/** Number of photos queued or being processed */
+	UFUNCTION(BlueprintPure, Category = "Missions|Photo")
+	int32 GetPendingPhotoCount() const;
+
+	/** Fired on the game thread when a photo has been ingested */
+	UPROPERTY(BlueprintAssignable, Category = "Missions|Photo")
+	FOnMissionPhotoReady OnPhotoReady;
+
+	/** Fired on the game thread when a photo could not be ingested */
+	UPROPERTY(BlueprintAssignable, Category = "Missions|Photo")
+	FOnMissionPhotoFailed OnPhotoFailed;
+
+protected:
+	/** Longest edge of the preview texture in pixels */
+	UPROPERTY(Config)
+	int32 ThumbnailMaxEdge = 256;
+
+	/** Longest edge of the upload re-encode in pixels */
+	UPROPERTY(Config)
+	int32 UploadMaxEdge = 1600;
+
+	UPROPERTY(Config)
+	int32 UploadJpegQuality = 85;
+
+	/** Cap on full-resolution pixel memory decoded at the same time */
+	UPROPERTY(Config)
+	int32 MaxDecodedMegabytesInFlight = 96;
+
+	/** Number of photos read from disk ahead of the decode stage */
+	UPROPERTY(Config)
+	int32 MaxConcurrentProbes = 2;
+
+	/** Ingested thumbnails keyed by mission ID */
+	UPROPERTY()
+	TMap<FString, TObjectPtr<UTexture2D>> Thumbnails;
+
+private:
+	UFUNCTION()
+	void HandlePhotoReceived(const FString& MissionID, const FString& PhotoPath, const FString& CorrelationID);
+
+	/** Start as much queued work as the probe and memory limits allow */
+	void DispatchWork();
+
+	void OnProbeFinished(MissionPhotoProcessing::FPhotoProbe&& Probe);
+	void OnProcessFinished(MissionPhotoProcessing::FPhotoOutput&& Output, int64 ReservedBytes);
+
+	/** Create the transient thumbnail texture from worker pixels */
+	UTexture2D* CreateThumbnailTexture(const MissionPhotoProcessing::FPhotoOutput& Output) const;
+
+	struct FQueuedPhoto
+	{
+		FString MissionID;
+		FString PhotoPath;
+	};
+
+	/** Photos waiting to be read from disk */
+	TArray<FQueuedPhoto> QueuedPhotos;
+
+	/** Probed photos waiting for decode memory */
+	TArray<TSharedPtr<MissionPhotoProcessing::FPhotoProbe>> ProbedPhotos;
+
+	int32 ActiveProbes = 0;
+	int32 ActiveDecodes = 0;
+	int64 DecodedBytesInFlight = 0;
+
+	FString UploadDirectory;
+};
@@ -0,0 +1,210 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/BitArray.h"
+#include "Containers/Ticker.h"
+#include "MissionPhotoUploadSubsystem.generated.h"
+
+struct FMissionPhotoResult;
+struct FRNUEMessage;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMissionPhotoUploadProgress, const FString&, MissionID, float, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMissionPhotoUploaded, const FString&, MissionID, const FString&, PhotoURL);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMissionPhotoUploadFailed, const FString&, MissionID, const FString&, Reason);
+
+/**
+ * Uploads mission photos to the backend in chunks
+ * Every ingested photo is hashed (SHA-1, whole file and per chunk) and
+ * uploaded as a session against UploadBaseURL:
+ *
+ *   POST /missions/photo/uploads                    { missionId, childId, size, chunkSize, chunkCount, sha1 } -> { uploadId }
+ *   GET  /missions/photo/uploads/{id}               -> { receivedChunks: [index...] }
+ *   PUT  /missions/photo/uploads/{id}/chunks/{n}    chunk bytes, X-Content-SHA1 header; the server rejects a mismatch
+ *   POST /missions/photo/uploads/{id}/complete      { sha1 } -> { photoUrl }; the server checks the assembled file
+ *
+ * Several chunks are in flight at once, paced by a byte-rate cap. Each upload
+ * keeps a manifest in Saved/Missions/Uploads, so after a restart it asks the
+ * server which chunks arrived and sends only the rest. Progress goes to RN as
+ * PhotoUploadProgress; the finished photo URL goes to the mission outbox as
+ * the parent approval request. RN hands over its access token with
+ * AuthSessionUpdated; nothing is sent before it has. The encoded copy the
+ * photo subsystem wrote for an upload is deleted once the upload is done or
+ * dropped.
+ *
+ * Non-shipping builds have an in-process stand-in backend for these routes:
+ * -SFUploadServer or sf.Upload.Serve [Port].
+ */
+UCLASS(Config = Game)
+class REALLIFEMISSIONS_API UMissionPhotoUploadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	/** Upload a photo for a mission, leaving the file in place (ingested photos are uploaded automatically); replaces an earlier upload for it */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Upload")
+	void UploadPhoto(const FString& MissionID, const FString& FilePath);
+
+	/** Point uploads at another backend, such as the stand-in server */
+	void SetUploadBaseURL(const FString& URL) { UploadBaseURL = URL; }
+
+	/** Resume uploads that gave up after repeated failures */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Upload")
+	void RetryFailedUploads();
+
+	/** Access token sent with every request */
+	UFUNCTION(BlueprintCallable, Category = "Missions|Upload")
+	void SetAccessToken(const FString& InAccessToken);
+
+	/** Fraction of a photo the server has acknowledged, negative if it isn't uploading */
+	UFUNCTION(BlueprintPure, Category = "Missions|Upload")
+	float GetUploadProgress(const FString& MissionID) const;
+
+	UFUNCTION(BlueprintPure, Category = "Missions|Upload")
+	int32 GetActiveUploadCount() const { return Uploads.Num(); }
+
+	UPROPERTY(BlueprintAssignable, Category = "Missions|Upload")
+	FOnMissionPhotoUploadProgress OnUploadProgress;
+
+	UPROPERTY(BlueprintAssignable, Category = "Missions|Upload")
+	FOnMissionPhotoUploaded OnUploadComplete;
+
+	/** The upload is paused, not dropped; it resumes on retry, new credentials or the next launch */
+	UPROPERTY(BlueprintAssignable, Category = "Missions|Upload")
+	FOnMissionPhotoUploadFailed OnUploadFailed;
+
+protected:
+	/** Backend API root; point it at a local stand-in server for testing */
+	UPROPERTY(Config)
+	FString UploadBaseURL = TEXT("https://api.superfamily.nl/api");
+
+	UPROPERTY(Config)
+	int32 ChunkSizeKB = 256;
+
+	/** Chunk requests in flight across all uploads */
+	UPROPERTY(Config)
+	int32 MaxConcurrentChunks = 3;
+
+	/** Upload bandwidth cap, 0 for none */
+	UPROPERTY(Config)
+	int32 MaxKilobytesPerSecond = 512;
+
+	/** Consecutive failed requests before an upload pauses */
+	UPROPERTY(Config)
+	int32 MaxAttempts = 6;
+
+	UPROPERTY(Config)
+	float RequestTimeoutSeconds = 30.0f;
+
+private:
+	enum class EUploadState : uint8
+	{
+		Hashing,
+		Creating,
+		Syncing,
+		Uploading,
+		Finalizing,
+		Failed
+	};
+
+	struct FUpload
+	{
+		/** Names this upload's manifest, so a replaced upload's late writes can't clobber its successor's */
+		FGuid LocalID;
+
+		FString MissionID;
+		FString ChildID;
+		FString FilePath;
+
+		/** FilePath is our encoded copy, deleted with the upload */
+		bool bOwnsFile = false;
+
+		int64 FileSize = 0;
+		int32 ChunkSize = 0;
+		FString FileHash;
+		TArray<FString> ChunkHashes;
+
+		/** Server session, empty until created */
+		FString UploadID;
+
+		TBitArray<> Acknowledged;
+		TBitArray<> InFlight;
+		int32 ChunksInFlight = 0;
+
+		EUploadState State = EUploadState::Hashing;
+		bool bRequestInFlight = false;
+
+		int32 ConsecutiveFailures = 0;
+		double NextAttemptTime = 0.0;
+
+		/** Last progress sent to RN, in percent */
+		int32 ReportedPercent = -1;
+
+		/** Manifest writes run one at a time; a change during one schedules another */
+		bool bManifestWriteInFlight = false;
+		bool bManifestDirty = false;
+
+		int32 GetChunkCount() const { return ChunkHashes.Num(); }
+		int64 GetChunkBytes(int32 Index) const { return FMath::Min<int64>(ChunkSize, FileSize - int64(Index) * ChunkSize); }
+		int64 GetAcknowledgedBytes() const;
+	};
+
+	UFUNCTION()
+	void HandlePhotoReady(const FMissionPhotoResult& Result);
+
+	UFUNCTION()
+	void HandleBridgeMessage(const FRNUEMessage& Message);
+
+	void StartUpload(const FString& MissionID, const FString& FilePath, bool bOwnsFile);
+
+	/** Read manifests left by an earlier run */
+	void LoadManifestsAsync();
+	void RestoreUpload(TSharedPtr<FUpload> Upload);
+
+	void StartHashing(TSharedPtr<FUpload> Upload);
+
+	bool Tick(float DeltaTime);
+
+	/** Start whatever requests the state, concurrency and bandwidth limits allow */
+	void Pump();
+
+	void SendCreate(const TSharedPtr<FUpload>& Upload);
+	void SendStatus(const TSharedPtr<FUpload>& Upload);
+	void ReadAndSendChunk(const TSharedPtr<FUpload>& Upload, int32 Index);
+	void SendChunk(const TSharedPtr<FUpload>& Upload, int32 Index, TArray<uint8>&& Bytes);
+	void SendComplete(const TSharedPtr<FUpload>& Upload);
+
+	/** Back off after a failed request; pauses the upload once it keeps failing */
+	void OnRequestFailed(const TSharedPtr<FUpload>& Upload, const FString& Reason, int32 ResponseCode);
+
+	/** Drop an upload, its manifest and the file if it owns it */
+	void Abandon(const TSharedPtr<FUpload>& Upload, const FString& Reason);
+
+	void ReportProgress(const TSharedPtr<FUpload>& Upload);
+	void SaveManifest(const TSharedPtr<FUpload>& Upload);
+	FString GetManifestPath(const FUpload& Upload) const;
+
+	/** True while this upload is still the current one for its mission */
+	bool IsCurrent(const TSharedPtr<FUpload>& Upload) const;
+
+	TMap<FString, TSharedPtr<FUpload>> Uploads;
+
+	int32 ChunksInFlight = 0;
+
+	/** Bandwidth budget in bytes; may go negative by at most one chunk */
+	double ByteTokens = 0.0;
+
+	/** Requests wait while there is no token or the server rejects it, until RN sends a new one */
+	bool bAwaitingAuth = false;
+	FString AccessToken;
+
+	FString ManifestDirectory;
+	FTSTicker::FDelegateHandle TickHandle;
+};
@@ -0,0 +1,20 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Modules/ModuleManager.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogRealLifeMissions, Log, All);
+
+/** LLM tag for mission photos and thumbnails */
+LLM_DECLARE_TAG_API(RealLifeMissions, REALLIFEMISSIONS_API);
+
+class FRealLifeMissionsModule : public IModuleInterface
+{
+public:
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+};
@@ -0,0 +1,38 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class RealLifeMissions : ModuleRules
+{
+	public RealLifeMissions(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[]
+		{
+			"Core",
+			"CoreUObject",
+			"Engine"
+		});
+
+		PrivateDependencyModuleNames.AddRange(new string[]
+		{
+			"Json",
+			"JsonUtilities",
+			"ImageWrapper",
+			"ImageCore",
+			"RenderCore",
+			"HTTP",
+			"RNUEBridge"
+		});
+
+		// Depend on main game module for types
+		PrivateDependencyModuleNames.Add("Superfamily");
+
+		// Stand-in upload backend for exercising photo uploads
+		if (Target.Configuration != UnrealTargetConfiguration.Shipping)
+		{
+			PrivateDependencyModuleNames.Add("HTTPServer");
+		}
+	}
+}
@@ -0,0 +1,233 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Characters/SuperfamilyCharacterMovementComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+
+USuperfamilyCharacterMovementComponent::USuperfamilyCharacterMovementComponent()
+{
+	// Facing is set by the character, never by the movement component
+	bOrientRotationToMovement = false;
+	bUseControllerDesiredRotation = false;
+	RotationRate = FRotator::ZeroRotator;
+
+	// Side-scroller geometry: no stairs, only platforms
+	MaxStepHeight = 20.0f;
+
+	// Moving platforms carry the character along X and Z
+	bImpartBaseVelocityX = true;
+	bImpartBaseVelocityZ = true;
+
+	// Skip the floor check while standing still on a static floor
+	bAlwaysCheckFloor = false;
+
+	SetPlaneConstraintNormal(FVector(0.f, 1.f, 0.f));
+	SetPlaneConstraintEnabled(true);
+}
+
+bool USuperfamilyCharacterMovementComponent::IsInCoyoteTime() const
+{
+	return IsFalling()
+		&& LeftGroundTime >= 0.0f
+		&& GetWorld()->GetTimeSeconds() - LeftGroundTime <= CoyoteTime;
+}
+
+void USuperfamilyCharacterMovementComponent::BufferJump()
+{
+	JumpBufferedTime = GetWorld()->GetTimeSeconds();
+}
+
+bool USuperfamilyCharacterMovementComponent::ConsumeBufferedJump()
+{
+	const bool bBuffered = JumpBufferedTime >= 0.0f && GetWorld()->GetTimeSeconds() - JumpBufferedTime <= JumpBufferTime;
+	JumpBufferedTime = -1.0f;
+	return bBuffered;
+}
+
+void USuperfamilyCharacterMovementComponent::NotifyJumped()
+{
+	LeftGroundTime = -1.0f;
+	JumpBufferedTime = -1.0f;
+}
+
+void USuperfamilyCharacterMovementComponent::DropThroughPlatform()
+{
+	if (!IsMovingOnGround())
+	{
+		return;
+	}
+
+	UPrimitiveComponent* Floor = CurrentFloor.HitResult.GetComponent();
+	if (IsOneWayPlatform(Floor))
+	{
+		IgnorePlatform(Floor);
+		SetMovementMode(MOVE_Falling);
+	}
+}
+
+void USuperfamilyCharacterMovementComponent::ComputeFloorDist(const FVector& CapsuleLocation, float LineDistance, float SweepDistance, FFindFloorResult& OutFloorResult, float SweepRadius, const FHitResult* DownwardSweepResult) const
+{
+	// A blocking hit from the movement sweep is already as cheap as it gets
+	if (!bUseSimplifiedFloorCheck || (DownwardSweepResult && DownwardSweepResult->IsValidBlockingHit()))
+	{
+		Super::ComputeFloorDist(CapsuleLocation, LineDistance, SweepDistance, OutFloorResult, SweepRadius, DownwardSweepResult);
+		return;
+	}
+
+	OutFloorResult.Clear();
+
+	float PawnRadius, PawnHalfHeight;
+	CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleSize(PawnRadius, PawnHalfHeight);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SuperfamilyComputeFloorDist), false, CharacterOwner);
+	FCollisionResponseParams ResponseParam;
+	InitCollisionParams(QueryParams, ResponseParam);
+	const ECollisionChannel CollisionChannel = UpdatedComponent->GetCollisionObjectType();
+
+	const float TraceDistance = PawnHalfHeight + FMath::Max(LineDistance, SweepDistance);
+	const FVector TraceDelta(0.f, 0.f, -TraceDistance);
+
+	// Center first; the capsule edges along X only matter when the center hangs over a ledge.
+	// The Y axis is constrained, so there is nothing to probe in depth.
+	const float EdgeOffset = FMath::Min(SweepRadius, PawnRadius) * 0.9f;
+	const float Offsets[] = { 0.0f, EdgeOffset, -EdgeOffset };
+
+	FHitResult BestHit;
+	bool bBestWalkable = false;
+	for (const float Offset : Offsets)
+	{
+		const FVector Start = CapsuleLocation + FVector(Offset, 0.f, 0.f);
+
+		FHitResult Hit(1.f);
+		if (!GetWorld()->LineTraceSingleByChannel(Hit, Start, Start + TraceDelta, CollisionChannel, QueryParams, ResponseParam) || Hit.bStartPenetrating)
+		{
+			continue;
+		}
+
+		const bool bWalkable = IsWalkable(Hit);
+		if (!BestHit.bBlockingHit || (bWalkable && !bBestWalkable) || (bWalkable == bBestWalkable && Hit.Distance < BestHit.Distance))
+		{
+			BestHit = Hit;
+			bBestWalkable = bWalkable;
+		}
+
+		if (bWalkable && Offset == 0.0f)
+		{
+			break;
+		}
+	}
+
+	if (!BestHit.bBlockingHit)
+	{
+		return;
+	}
+
+	// The trace stands in for the sweep, so it is the sweep result; there is no separate line trace
+	const float FloorDist = FMath::Max(BestHit.Distance - PawnHalfHeight, 0.0f);
+	if (FloorDist <= FMath::Max(LineDistance, SweepDistance))
+	{
+		OutFloorResult.SetFromSweep(BestHit, FloorDist, bBestWalkable);
+	}
+}
+
+void USuperfamilyCharacterMovementComponent::PhysicsRotation(float DeltaTime)
+{
+	// Rotation is only ever a facing flip, handled by the character
+}
+
+void USuperfamilyCharacterMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	if (PreviousMovementMode == MOVE_Walking && MovementMode == MOVE_Falling)
+	{
+		// Walking off a ledge opens the coyote window; jumping does not
+		const bool bJumping = CharacterOwner && (CharacterOwner->bPressedJump || CharacterOwner->JumpCurrentCount > 0);
+		LeftGroundTime = bJumping ? -1.0f : GetWorld()->GetTimeSeconds();
+	}
+	else if (MovementMode == MOVE_Walking)
+	{
+		LeftGroundTime = -1.0f;
+	}
+}
+
+void USuperfamilyCharacterMovementComponent::PerformMovement(float DeltaTime)
+{
+	if (IgnoredPlatforms.Num() > 0)
+	{
+		RestoreClearedPlatforms();
+	}
+
+	if (IsFalling())
+	{
+		IgnorePlatformsInPath(DeltaTime);
+	}
+
+	Super::PerformMovement(DeltaTime);
+}
+
+bool USuperfamilyCharacterMovementComponent::IsOneWayPlatform(const UPrimitiveComponent* Component) const
+{
+	return Component && !OneWayPlatformTag.IsNone() && Component->ComponentHasTag(OneWayPlatformTag);
+}
+
+void USuperfamilyCharacterMovementComponent::IgnorePlatform(UPrimitiveComponent* Platform)
+{
+	if (UpdatedPrimitive && !IgnoredPlatforms.Contains(Platform))
+	{
+		UpdatedPrimitive->IgnoreComponentWhenMoving(Platform, true);
+		IgnoredPlatforms.Add(Platform);
+	}
+}
+
+void USuperfamilyCharacterMovementComponent::IgnorePlatformsInPath(float DeltaTime)
+{
+	if (OneWayPlatformTag.IsNone() || !UpdatedComponent || !CharacterOwner)
+	{
+		return;
+	}
+
+	// Everything the capsule could touch this move: its bounds grown by the move
+	const FBox CapsuleBox = UpdatedComponent->Bounds.GetBox();
+	const FBox PathBox = CapsuleBox + CapsuleBox.ShiftBy(Velocity * DeltaTime);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SuperfamilyOneWayPlatforms), false, CharacterOwner);
+	FCollisionResponseParams ResponseParam;
+	InitCollisionParams(QueryParams, ResponseParam);
+
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByChannel(Overlaps, PathBox.GetCenter(), FQuat::Identity, UpdatedComponent->GetCollisionObjectType(),
+		FCollisionShape::MakeBox(PathBox.GetExtent()), QueryParams, ResponseParam);
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		// One-way platforms only block a capsule that starts the move on or above their top
+		UPrimitiveComponent* Platform = Overlap.GetComponent();
+		if (IsOneWayPlatform(Platform) && CapsuleBox.Min.Z < Platform->Bounds.GetBox().Max.Z - KINDA_SMALL_NUMBER)
+		{
+			IgnorePlatform(Platform);
+		}
+	}
+}
+
+void USuperfamilyCharacterMovementComponent::RestoreClearedPlatforms()
+{
+	const FBox CapsuleBox = UpdatedComponent->Bounds.GetBox();
+
+	for (int32 Index = IgnoredPlatforms.Num() - 1; Index >= 0; --Index)
+	{
+		UPrimitiveComponent* Platform = IgnoredPlatforms[Index].Get();
+
+		// Collide again once the capsule is fully clear of the platform, above or below
+		if (!Platform || !CapsuleBox.Intersect(Platform->Bounds.GetBox()))
+		{
+			if (Platform && UpdatedPrimitive)
+			{
+				UpdatedPrimitive->IgnoreComponentWhenMoving(Platform, false);
+			}
+			IgnoredPlatforms.RemoveAtSwap(Index);
+		}
+	}
+}
@@ -0,0 +1,193 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Characters/SuperfamilyCharacterMovementComponent.h"
+#include "Characters/SuperfamilyPlayerCharacter.h"
+#include "Superfamily.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Compares per-character movement CPU cost of a stock ACharacter (default CMC, same tuning and
+ * plane constraint) against ASuperfamilyPlayerCharacter with the 2D floor check off and on. Run headless:
+ *   Superfamily -game -nullrhi -ExecCmds="sf.Movement.Benchmark 50 600"
+ */
+namespace SuperfamilyMovementBenchmark
+{
+	static const FVector BenchmarkOrigin(0.0f, 100000.0f, 10000.0f);
+	static constexpr float FixedDeltaTime = 1.0f / 60.0f;
+	static constexpr float LaneSpacing = 150.0f;
+
+	AStaticMeshActor* SpawnFloor(UWorld* World, int32 NumCharacters)
+	{
+		UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		if (!Cube)
+		{
+			return nullptr;
+		}
+
+		FActorSpawnParameters Params;
+		Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		// One long slab, one Y lane per character so capsules never touch each other
+		const float Depth = (NumCharacters + 2) * LaneSpacing;
+		const FVector Location = BenchmarkOrigin + FVector(0.0f, Depth * 0.5f - LaneSpacing, -50.0f);
+		AStaticMeshActor* Floor = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator, Params);
+		Floor->GetStaticMeshComponent()->SetStaticMesh(Cube);
+		Floor->SetActorScale3D(FVector(400.0f, Depth / 100.0f, 1.0f));
+		return Floor;
+	}
+
+	enum class EVariant : uint8
+	{
+		Stock,
+		CapsuleSweep,
+		Simplified
+	};
+
+	/** Copies the Superfamily pawn's capsule, movement tuning and plane constraint onto a stock character */
+	void ApplySuperfamilyTuning(ACharacter* Character)
+	{
+		const ASuperfamilyPlayerCharacter* Reference = GetDefault<ASuperfamilyPlayerCharacter>();
+		const UCharacterMovementComponent* From = Reference->GetCharacterMovement();
+		UCharacterMovementComponent* To = Character->GetCharacterMovement();
+
+		const UCapsuleComponent* Capsule = Reference->GetCapsuleComponent();
+		Character->GetCapsuleComponent()->SetCapsuleSize(Capsule->GetUnscaledCapsuleRadius(), Capsule->GetUnscaledCapsuleHalfHeight());
+
+		To->bOrientRotationToMovement = From->bOrientRotationToMovement;
+		To->RotationRate = From->RotationRate;
+		To->JumpZVelocity = From->JumpZVelocity;
+		To->AirControl = From->AirControl;
+		To->MaxWalkSpeed = From->MaxWalkSpeed;
+		To->MinAnalogWalkSpeed = From->MinAnalogWalkSpeed;
+		To->BrakingDecelerationWalking = From->BrakingDecelerationWalking;
+		To->BrakingDecelerationFalling = From->BrakingDecelerationFalling;
+		To->GravityScale = From->GravityScale;
+		To->MaxAcceleration = From->MaxAcceleration;
+		To->GroundFriction = From->GroundFriction;
+
+		To->SetPlaneConstraintNormal(From->GetPlaneConstraintNormal());
+		To->SetPlaneConstraintEnabled(From->GetPlaneConstraint().bConstrainToPlane);
+	}
+
+	/** Returns microseconds of movement CPU per character per frame */
+	double Run(UWorld* World, EVariant Variant, int32 NumCharacters, int32 NumFrames)
+	{
+		FActorSpawnParameters Params;
+		Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		TArray<ACharacter*> Characters;
+		for (int32 Index = 0; Index < NumCharacters; ++Index)
+		{
+			const FVector Location = BenchmarkOrigin + FVector(0.0f, Index * LaneSpacing, 100.0f);
+			ACharacter* Character = Variant == EVariant::Stock
+				? World->SpawnActor<ACharacter>(Location, FRotator::ZeroRotator, Params)
+				: World->SpawnActor<ASuperfamilyPlayerCharacter>(Location, FRotator::ZeroRotator, Params);
+			UCharacterMovementComponent* Movement = Character ? Character->GetCharacterMovement() : nullptr;
+			if (!Movement)
+			{
+				continue;
+			}
+
+			// Same capsule and tuning for every run; only the pawn and floor path differ. Driven manually without a controller.
+			if (USuperfamilyCharacterMovementComponent* SuperfamilyMovement = Cast<USuperfamilyCharacterMovementComponent>(Movement))
+			{
+				SuperfamilyMovement->bUseSimplifiedFloorCheck = Variant == EVariant::Simplified;
+			}
+			else
+			{
+				ApplySuperfamilyTuning(Character);
+			}
+			Movement->bRunPhysicsWithNoController = true;
+			Movement->SetComponentTickEnabled(false);
+			Character->SetActorTickEnabled(false);
+
+			Characters.Add(Character);
+		}
+
+		auto StepAll = [&Characters](int32 Frame)
+		{
+			for (int32 Index = 0; Index < Characters.Num(); ++Index)
+			{
+				ACharacter* Character = Characters[Index];
+
+				// Run back and forth with periodic jumps, staggered per character
+				const float Direction = ((Frame + Index * 7) / 120) % 2 == 0 ? 1.0f : -1.0f;
+				Character->AddMovementInput(FVector(1.0f, 0.0f, 0.0f), Direction);
+				if ((Frame + Index * 11) % 45 == 0)
+				{
+					Character->Jump();
+				}
+
+				Character->GetCharacterMovement()->TickComponent(FixedDeltaTime, LEVELTICK_All, nullptr);
+			}
+		};
+
+		// Let everyone land before timing
+		for (int32 Frame = 0; Frame < 30; ++Frame)
+		{
+			StepAll(Frame);
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			StepAll(Frame);
+		}
+		const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+		for (ACharacter* Character : Characters)
+		{
+			Character->Destroy();
+		}
+
+		const int32 Samples = FMath::Max(1, Characters.Num() * NumFrames);
+		return ElapsedSeconds * 1000000.0 / Samples;
+	}
+
+	void Execute(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World || !World->IsGameWorld())
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("sf.Movement.Benchmark needs a game world"));
+			return;
+		}
+
+		const int32 NumCharacters = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 50;
+		const int32 NumFrames = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 600;
+
+		AStaticMeshActor* Floor = SpawnFloor(World, NumCharacters);
+		if (!Floor)
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("sf.Movement.Benchmark could not load the floor mesh"));
+			return;
+		}
+
+		const double StockMicros = Run(World, EVariant::Stock, NumCharacters, NumFrames);
+		const double SweepMicros = Run(World, EVariant::CapsuleSweep, NumCharacters, NumFrames);
+		const double SimplifiedMicros = Run(World, EVariant::Simplified, NumCharacters, NumFrames);
+
+		Floor->Destroy();
+
+		UE_LOG(LogSuperfamily, Display, TEXT("Movement benchmark (%d characters, %d frames @ 60 Hz):"), NumCharacters, NumFrames);
+		UE_LOG(LogSuperfamily, Display, TEXT("  Stock ACharacter:           %.2f us/character/frame"), StockMicros);
+		UE_LOG(LogSuperfamily, Display, TEXT("  Capsule sweep floor check:  %.2f us/character/frame (%.0f%%)"),
+			SweepMicros, StockMicros > 0.0 ? SweepMicros / StockMicros * 100.0 : 0.0);
+		UE_LOG(LogSuperfamily, Display, TEXT("  2D line trace floor check:  %.2f us/character/frame (%.0f%%)"),
+			SimplifiedMicros, StockMicros > 0.0 ? SimplifiedMicros / StockMicros * 100.0 : 0.0);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GSuperfamilyMovementBenchmarkCommand(
+	TEXT("sf.Movement.Benchmark"),
+	TEXT("Compare movement CPU time of a stock ACharacter and the Superfamily pawn with the 2D floor check off and on; percentages are relative to stock. Usage: sf.Movement.Benchmark [NumCharacters=50] [NumFrames=600]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SuperfamilyMovementBenchmark::Execute));
+
+#endif // !UE_BUILD_SHIPPING
@@ -1,6 +1,10 @@
 // Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
 
 #include "Characters/SuperfamilyPlayerCharacter.h"
+#include "Superfamily.h"
+#include "Characters/SuperfamilyCharacterMovementComponent.h"
+#include "Core/SuperfamilyEventBus.h"
+#include "Gameplay/SuperfamilyInputReplaySubsystem.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
@@ -8,7 +12,8 @@
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 
-ASuperfamilyPlayerCharacter::ASuperfamilyPlayerCharacter()
+ASuperfamilyPlayerCharacter::ASuperfamilyPlayerCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USuperfamilyCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -117,10 +122,64 @@ void ASuperfamilyPlayerCharacter::Move2D(float AxisValue)
 
 void ASuperfamilyPlayerCharacter::PerformJump()
 {
+	// The jump itself happens on the next movement tick; OnJumped reports it
 	if (CanJump())
 	{
 		Jump();
-		OnPlayerJumped.Broadcast();
+	}
+	else if (USuperfamilyCharacterMovementComponent* Movement = GetSuperfamilyMovement())
+	{
+		// Too early: jump as soon as we land
+		Movement->BufferJump();
+	}
+}
+
+USuperfamilyCharacterMovementComponent* ASuperfamilyPlayerCharacter::GetSuperfamilyMovement() const
+{
+	return Cast<USuperfamilyCharacterMovementComponent>(GetCharacterMovement());
+}
+
+bool ASuperfamilyPlayerCharacter::CanJumpInternal_Implementation() const
+{
+	if (Super::CanJumpInternal_Implementation())
+	{
+		return true;
+	}
+
+	// Coyote time: first jump is still allowed shortly after walking off a ledge. CheckJumpInput
+	// counts a first jump while falling before asking, so the count is 1 by then
+	const USuperfamilyCharacterMovementComponent* Movement = GetSuperfamilyMovement();
+	return Movement && JumpCurrentCount <= 1 && !bWasJumping && Movement->IsInCoyoteTime();
+}
+
+void ASuperfamilyPlayerCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
+{
+	// Jump state is reset by Super once grounded, so the buffered jump goes after it
+	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
+
+	USuperfamilyCharacterMovementComponent* Movement = GetSuperfamilyMovement();
+	if (Movement && Movement->IsMovingOnGround() && Movement->ConsumeBufferedJump())
+	{
+		PerformJump();
+	}
+}
+
+void ASuperfamilyPlayerCharacter::OnJumped_Implementation()
+{
+	Super::OnJumped_Implementation();
+
+	if (USuperfamilyCharacterMovementComponent* Movement = GetSuperfamilyMovement())
+	{
+		Movement->NotifyJumped();
+	}
+
+	OnPlayerJumped.Broadcast();
+
+	if (USuperfamilyEventBus* Events = GetGameInstance() ? GetGameInstance()->GetSubsystem<USuperfamilyEventBus>() : nullptr)
+	{
+		FPlayerJumpedEvent Event;
+		Event.Location = GetActorLocation();
+		Events->Publish(Event);
 	}
 }
 
@@ -128,25 +187,52 @@ void ASuperfamilyPlayerCharacter::CollectCoin(int32 Value)
 {
 	SessionCoins += Value;
 	OnCoinCollected.Broadcast(SessionCoins);
+
+	// Achievements and other native listeners take coins from the bus, once per frame
+	if (USuperfamilyEventBus* Events = GetGameInstance() ? GetGameInstance()->GetSubsystem<USuperfamilyEventBus>() : nullptr)
+	{
+		FCoinCollectedEvent Event;
+		Event.Amount = Value;
+		Event.SessionTotal = SessionCoins;
+		Events->Publish(Event);
+	}
 }
 
 void ASuperfamilyPlayerCharacter::HandleMoveInput(const FInputActionValue& Value)
 {
 	// Get movement value (1D axis for left/right)
 	float MovementValue = Value.Get<float>();
-	Move2D(MovementValue);
+	if (RouteInput(EInputReplayAction::Move, MovementValue))
+	{
+		Move2D(MovementValue);
+	}
 }
 
 void ASuperfamilyPlayerCharacter::HandleJumpInput()
 {
-	PerformJump();
+	if (RouteInput(EInputReplayAction::Jump))
+	{
+		PerformJump();
+	}
 }
 
 void ASuperfamilyPlayerCharacter::HandleInteractInput()
 {
+	if (!RouteInput(EInputReplayAction::Interact))
+	{
+		return;
+	}
+
 	// Interaction will be implemented via Blueprint for flexibility
 	// This is a placeholder for C++ interaction logic if needed
-	UE_LOG(LogTemp, Verbose, TEXT("Interact input received"));
+	UE_LOG(LogSuperfamily, Verbose, TEXT("Interact input received"));
+}
+
+bool ASuperfamilyPlayerCharacter::RouteInput(EInputReplayAction Action, float Value) const
+{
+	const UWorld* World = GetWorld();
+	USuperfamilyInputReplaySubsystem* Replay = World ? World->GetSubsystem<USuperfamilyInputReplaySubsystem>() : nullptr;
+	return !Replay || Replay->FilterInput(this, Action, Value);
 }
 
 void ASuperfamilyPlayerCharacter::UpdateFacingDirection(float MoveDirection)
@@ -0,0 +1,73 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyAchievementSet.h"
+#include "Superfamily.h"
+
+#if WITH_EDITOR
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+const FPrimaryAssetType USuperfamilyAchievementSet::PrimaryAssetType(TEXT("AchievementSet"));
+
+FString FAchievementDefinition::GetCounterKey() const
+{
+	switch (Event)
+	{
+	case EAchievementEvent::CoinCollected:
+		return TEXT("Coins");
+	case EAchievementEvent::LevelCompleted:
+		return FString::Printf(TEXT("Levels/W%d/S%d"), WorldID, MinStars);
+	case EAchievementEvent::QuestionAnswered:
+		return FString::Printf(TEXT("Answers/%s/%s"),
+			bAnySubject ? TEXT("Any") : *StaticEnum<EQuestionSubject>()->GetNameStringByValue(static_cast<int64>(Subject)),
+			bCorrectAnswersOnly ? TEXT("Correct") : TEXT("All"));
+	case EAchievementEvent::StreakUpdated:
+		return TEXT("BestStreak");
+	case EAchievementEvent::MissionCompleted:
+		return TEXT("Missions");
+	default:
+		return FString();
+	}
+}
+
+FPrimaryAssetId USuperfamilyAchievementSet::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+#if WITH_EDITOR
+
+void USuperfamilyAchievementSet::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	AssignStableIndices();
+
+	Super::PreSave(ObjectSaveContext);
+}
+
+void USuperfamilyAchievementSet::AssignStableIndices()
+{
+	TSet<int32> Used;
+	for (const FAchievementDefinition& Achievement : Achievements)
+	{
+		NextStableIndex = FMath::Max(NextStableIndex, Achievement.StableIndex + 1);
+	}
+
+	for (FAchievementDefinition& Achievement : Achievements)
+	{
+		// Duplicating an entry in the editor copies its index; the copy gets a new one
+		bool bAlreadyUsed = false;
+		if (Achievement.StableIndex != INDEX_NONE)
+		{
+			Used.Add(Achievement.StableIndex, &bAlreadyUsed);
+		}
+
+		if (Achievement.StableIndex == INDEX_NONE || bAlreadyUsed)
+		{
+			Achievement.StableIndex = NextStableIndex++;
+			Used.Add(Achievement.StableIndex);
+			UE_LOG(LogSuperfamily, Log, TEXT("Achievement %s gets stable index %d"), *Achievement.AchievementID.ToString(), Achievement.StableIndex);
+		}
+	}
+}
+
+#endif
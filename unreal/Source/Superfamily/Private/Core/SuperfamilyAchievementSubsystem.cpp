@@ -0,0 +1,497 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyAchievementSubsystem.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyBootSubsystem.h"
+#include "Core/SuperfamilyEventBus.h"
+#include "Core/SuperfamilyGameInstance.h"
+#include "Core/SuperfamilyStats.h"
+#include "Engine/AssetManager.h"
+
+const FName USuperfamilyAchievementSubsystem::BootStage(TEXT("Achievements"));
+
+bool USuperfamilyAchievementSubsystem::FCounter::Matches(const FEventContext& Context) const
+{
+	switch (Event)
+	{
+	case EAchievementEvent::LevelCompleted:
+		// A level already counted at its previous best doesn't count again
+		return (WorldID == 0 || WorldID == Context.WorldID) && Context.Stars >= MinStars && Context.PreviousStars < MinStars;
+	case EAchievementEvent::QuestionAnswered:
+		return (!bCorrectOnly || Context.bCorrect) && (bAnySubject || Subject == Context.Subject);
+	default:
+		return true;
+	}
+}
+
+void USuperfamilyAchievementSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (USuperfamilyBootSubsystem* Boot = Collection.InitializeDependency<USuperfamilyBootSubsystem>())
+	{
+		Boot->AddStage(BootStage, {}, [this](USuperfamilyBootSubsystem::FStageDone&& Done)
+		{
+			FSoftObjectPath SetPath = AchievementSet.ToSoftObjectPath();
+			if (SetPath.IsNull() && UAssetManager::IsInitialized())
+			{
+				TArray<FSoftObjectPath> SetPaths;
+				UAssetManager::Get().GetPrimaryAssetPathList(USuperfamilyAchievementSet::PrimaryAssetType, SetPaths);
+				if (SetPaths.Num() > 0)
+				{
+					SetPath = SetPaths[0];
+				}
+			}
+
+			auto FinishLoad = [this, SetPath, Done = MoveTemp(Done)]()
+			{
+				const USuperfamilyAchievementSet* Set = Cast<USuperfamilyAchievementSet>(SetPath.ResolveObject());
+				if (Set)
+				{
+					Compile(*Set);
+				}
+				else
+				{
+					UE_LOG(LogSuperfamily, Warning, TEXT("No achievement set found; achievements are not evaluated"));
+					PendingEvents.Empty();
+				}
+				Done(Set != nullptr);
+			};
+
+			if (SetPath.IsNull() || !UAssetManager::IsInitialized())
+			{
+				FinishLoad();
+				return;
+			}
+
+			SetHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(SetPath, FStreamableDelegate::CreateWeakLambda(this, FinishLoad));
+			if (!SetHandle.IsValid())
+			{
+				FinishLoad();
+			}
+		}, false);
+	}
+
+	if (USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		LevelRecordedHandle = GameInstance->OnLevelRecorded.AddUObject(this, &USuperfamilyAchievementSubsystem::HandleLevelRecorded);
+		MissionRecordedHandle = GameInstance->OnMissionRecorded.AddUObject(this, &USuperfamilyAchievementSubsystem::HandleMissionRecorded);
+		ProfilesAppliedHandle = GameInstance->OnProfilesApplied.AddUObject(this, &USuperfamilyAchievementSubsystem::HandleProfilesApplied);
+	}
+
+	if (USuperfamilyEventBus* Events = Collection.InitializeDependency<USuperfamilyEventBus>())
+	{
+		Events->Subscribe(this, &USuperfamilyAchievementSubsystem::HandleCoinEvents);
+		Events->Subscribe(this, &USuperfamilyAchievementSubsystem::HandleQuestionEvents);
+		Events->Subscribe(this, &USuperfamilyAchievementSubsystem::HandleStreakEvents);
+	}
+}
+
+void USuperfamilyAchievementSubsystem::Deinitialize()
+{
+	if (USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		GameInstance->OnLevelRecorded.Remove(LevelRecordedHandle);
+		GameInstance->OnMissionRecorded.Remove(MissionRecordedHandle);
+		GameInstance->OnProfilesApplied.Remove(ProfilesAppliedHandle);
+	}
+
+	if (USuperfamilyEventBus* Events = GetGameInstance()->GetSubsystem<USuperfamilyEventBus>())
+	{
+		Events->UnsubscribeAll(this);
+	}
+
+	if (SetHandle.IsValid())
+	{
+		SetHandle->CancelHandle();
+		SetHandle.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Compilation
+// ============================================
+
+void USuperfamilyAchievementSubsystem::Compile(const USuperfamilyAchievementSet& Set)
+{
+	LLM_SCOPE_BYTAG(Superfamily);
+
+	Achievements.Reset();
+	Counters.Reset();
+	AchievementByID.Reset();
+	for (TArray<int32>& Subscribers : CountersByEvent)
+	{
+		Subscribers.Reset();
+	}
+
+	TMap<FString, int32> CounterByKey;
+
+	for (const FAchievementDefinition& Definition : Set.GetAchievements())
+	{
+		if (Definition.AchievementID.IsNone() || Definition.StableIndex == INDEX_NONE)
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Achievement %s has no ID or stable index (resave %s); skipped"),
+				*Definition.AchievementID.ToString(), *Set.GetName());
+			continue;
+		}
+		if (AchievementByID.Contains(Definition.AchievementID))
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Achievement %s defined twice; keeping the first"), *Definition.AchievementID.ToString());
+			continue;
+		}
+
+		const FString Key = Definition.GetCounterKey();
+		int32* CounterIndex = CounterByKey.Find(Key);
+		if (!CounterIndex)
+		{
+			FCounter& Counter = Counters.AddDefaulted_GetRef();
+			Counter.Key = Key;
+			Counter.Event = Definition.Event;
+			Counter.WorldID = Definition.WorldID;
+			Counter.MinStars = Definition.MinStars;
+			Counter.bCorrectOnly = Definition.bCorrectAnswersOnly;
+			Counter.bAnySubject = Definition.bAnySubject;
+			Counter.Subject = Definition.Subject;
+
+			CountersByEvent[static_cast<int32>(Definition.Event)].Add(Counters.Num() - 1);
+			CounterIndex = &CounterByKey.Add(Key, Counters.Num() - 1);
+		}
+
+		FCompiledAchievement& Achievement = Achievements.AddDefaulted_GetRef();
+		Achievement.AchievementID = Definition.AchievementID;
+		Achievement.DisplayName = Definition.DisplayName;
+		Achievement.StableIndex = Definition.StableIndex;
+		Achievement.Threshold = FMath::Max(1, Definition.Threshold);
+		Achievement.Counter = *CounterIndex;
+
+		Counters[*CounterIndex].Achievements.Add(Achievements.Num() - 1);
+		AchievementByID.Add(Definition.AchievementID, Achievements.Num() - 1);
+	}
+
+	for (FCounter& Counter : Counters)
+	{
+		Counter.Achievements.Sort([this](int32 A, int32 B)
+		{
+			return Achievements[A].Threshold < Achievements[B].Threshold;
+		});
+	}
+
+	bCompiled = true;
+	ActiveState = FChildState();
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Compiled %d achievements into %d counters"), Achievements.Num(), Counters.Num());
+
+	TArray<FPendingEvent> Pending = MoveTemp(PendingEvents);
+	for (const FPendingEvent& Event : Pending)
+	{
+		ProcessEvent(Event.Event, Event.Context, Event.Amount);
+	}
+}
+
+USuperfamilyAchievementSubsystem::FChildState* USuperfamilyAchievementSubsystem::GetActiveState()
+{
+	USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	if (!GameInstance)
+	{
+		return nullptr;
+	}
+
+	const FChildId& ChildID = GameInstance->GetActiveChildID();
+	if (!ChildID.IsValid())
+	{
+		return nullptr;
+	}
+	if (ActiveState.ChildID == ChildID)
+	{
+		return &ActiveState;
+	}
+
+	// Rebuilt only when the active child changes
+	const FChildProfile Profile = GameInstance->GetActiveProfile();
+	FChildState& State = ActiveState;
+	State = FChildState();
+	State.ChildID = Profile.ChildID;
+	State.Values.SetNumZeroed(Counters.Num());
+	State.NextAchievement.SetNumZeroed(Counters.Num());
+
+	for (int32 Word = 0; Word < Profile.AchievementBits.Num(); ++Word)
+	{
+		for (uint32 Bits = Profile.AchievementBits[Word]; Bits; Bits &= Bits - 1)
+		{
+			const int32 Index = Word * 32 + FMath::CountTrailingZeros(Bits);
+			if (State.Unlocked.Num() <= Index)
+			{
+				State.Unlocked.Add(false, Index + 1 - State.Unlocked.Num());
+			}
+			State.Unlocked[Index] = true;
+		}
+	}
+
+	// Unlocks merged in from another device only carry the ID
+	for (const FString& UnlockedID : Profile.UnlockedAchievements)
+	{
+		const int32* AchievementIndex = AchievementByID.Find(FName(*UnlockedID));
+		const int32 Index = AchievementIndex ? Achievements[*AchievementIndex].StableIndex : INDEX_NONE;
+		if (Index != INDEX_NONE)
+		{
+			if (State.Unlocked.Num() <= Index)
+			{
+				State.Unlocked.Add(false, Index + 1 - State.Unlocked.Num());
+			}
+			State.Unlocked[Index] = true;
+		}
+	}
+
+	// Saves from before counters existed: levels and missions already on the profile are a lower bound
+	TArray<TPair<int32, int32>> CompletedLevels;
+	for (const TPair<FLevelKey, FLevelProgress>& Pair : Profile.LevelProgress)
+	{
+		if (Pair.Value.bCompleted)
+		{
+			CompletedLevels.Emplace(Pair.Key.GetWorldID(), Pair.Value.StarsEarned);
+		}
+	}
+
+	for (int32 CounterIndex = 0; CounterIndex < Counters.Num(); ++CounterIndex)
+	{
+		const FCounter& Counter = Counters[CounterIndex];
+		int32 Value = Profile.AchievementCounters.FindRef(Counter.Key);
+
+		if (Counter.Event == EAchievementEvent::MissionCompleted)
+		{
+			Value = FMath::Max(Value, Profile.CompletedMissions.Num());
+		}
+		else if (Counter.Event == EAchievementEvent::LevelCompleted)
+		{
+			int32 Distinct = 0;
+			for (const TPair<int32, int32>& Level : CompletedLevels)
+			{
+				FEventContext Context;
+				Context.WorldID = Level.Key;
+				Context.Stars = Level.Value;
+				Distinct += Counter.Matches(Context) ? 1 : 0;
+			}
+			Value = FMath::Max(Value, Distinct);
+		}
+
+		State.Values[CounterIndex] = Value;
+	}
+
+	// Also unlocks achievements added to the set after the child already reached them
+	for (int32 CounterIndex = 0; CounterIndex < Counters.Num(); ++CounterIndex)
+	{
+		AdvanceCounter(State, CounterIndex);
+	}
+
+	return &ActiveState;
+}
+
+// ============================================
+// Events
+// ============================================
+
+void USuperfamilyAchievementSubsystem::NotifyCoinsCollected(int32 Amount)
+{
+	if (Amount > 0)
+	{
+		ProcessEvent(EAchievementEvent::CoinCollected, FEventContext(), Amount);
+	}
+}
+
+void USuperfamilyAchievementSubsystem::NotifyQuestionAnswered(EQuestionSubject Subject, bool bCorrect)
+{
+	FEventContext Context;
+	Context.Subject = Subject;
+	Context.bCorrect = bCorrect;
+	ProcessEvent(EAchievementEvent::QuestionAnswered, Context, 1);
+}
+
+void USuperfamilyAchievementSubsystem::NotifyStreakUpdated(int32 Streak)
+{
+	if (Streak > 0)
+	{
+		ProcessEvent(EAchievementEvent::StreakUpdated, FEventContext(), Streak);
+	}
+}
+
+void USuperfamilyAchievementSubsystem::HandleLevelRecorded(const FChildId& ChildID, int32 WorldID, int32 LevelID, int32 Stars, int32 PreviousStars)
+{
+	const USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	if (!GameInstance || ChildID != GameInstance->GetActiveChildID() || Stars <= PreviousStars)
+	{
+		return;
+	}
+
+	FEventContext Context;
+	Context.WorldID = WorldID;
+	Context.Stars = Stars;
+	Context.PreviousStars = PreviousStars;
+	ProcessEvent(EAchievementEvent::LevelCompleted, Context, 1);
+}
+
+void USuperfamilyAchievementSubsystem::HandleMissionRecorded(const FChildId& ChildID, const FMissionId& MissionID)
+{
+	const USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	if (!GameInstance || ChildID != GameInstance->GetActiveChildID())
+	{
+		return;
+	}
+
+	// The profile already has the mission, and a rebuilt state counts it, so the total is set rather than added to
+	ProcessEvent(EAchievementEvent::MissionCompleted, FEventContext(), GameInstance->GetActiveProfile().CompletedMissions.Num());
+}
+
+void USuperfamilyAchievementSubsystem::HandleProfilesApplied(const FChildId& ChildID)
+{
+	if (!ChildID.IsValid() || ChildID == ActiveState.ChildID)
+	{
+		ActiveState = FChildState();
+	}
+}
+
+void USuperfamilyAchievementSubsystem::HandleCoinEvents(TConstArrayView<FCoinCollectedEvent> Events)
+{
+	int32 Amount = 0;
+	for (const FCoinCollectedEvent& Event : Events)
+	{
+		Amount += Event.Amount;
+	}
+	NotifyCoinsCollected(Amount);
+}
+
+void USuperfamilyAchievementSubsystem::HandleQuestionEvents(TConstArrayView<FQuestionAnsweredEvent> Events)
+{
+	for (const FQuestionAnsweredEvent& Event : Events)
+	{
+		NotifyQuestionAnswered(Event.Subject, Event.bCorrect);
+	}
+}
+
+void USuperfamilyAchievementSubsystem::HandleStreakEvents(TConstArrayView<FStreakUpdatedEvent> Events)
+{
+	// Streak counters keep the best value, so the frame's best is all that matters
+	int32 BestStreak = 0;
+	for (const FStreakUpdatedEvent& Event : Events)
+	{
+		BestStreak = FMath::Max(BestStreak, Event.CurrentStreak);
+	}
+	NotifyStreakUpdated(BestStreak);
+}
+
+void USuperfamilyAchievementSubsystem::ProcessEvent(EAchievementEvent Event, const FEventContext& Context, int32 Amount)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyAchievementEvent);
+
+	if (!bCompiled)
+	{
+		PendingEvents.Add({ Event, Context, Amount });
+		return;
+	}
+
+	const TArray<int32>& Subscribers = CountersByEvent[static_cast<int32>(Event)];
+	if (Subscribers.Num() == 0)
+	{
+		return;
+	}
+
+	FChildState* State = GetActiveState();
+	USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	if (!State || !GameInstance)
+	{
+		return;
+	}
+
+	for (const int32 CounterIndex : Subscribers)
+	{
+		const FCounter& Counter = Counters[CounterIndex];
+		if (!Counter.Matches(Context))
+		{
+			continue;
+		}
+
+		// Streak and mission counters keep the best total; everything else accumulates
+		int32& Value = State->Values[CounterIndex];
+		const bool bKeepsBest = Event == EAchievementEvent::StreakUpdated || Event == EAchievementEvent::MissionCompleted;
+		const int32 NewValue = bKeepsBest ? FMath::Max(Value, Amount) : Value + Amount;
+		if (NewValue == Value)
+		{
+			continue;
+		}
+
+		Value = NewValue;
+		GameInstance->SetAchievementCounter(Counter.Key, Value);
+		AdvanceCounter(*State, CounterIndex);
+	}
+}
+
+void USuperfamilyAchievementSubsystem::AdvanceCounter(FChildState& State, int32 CounterIndex)
+{
+	const FCounter& Counter = Counters[CounterIndex];
+	const int32 Value = State.Values[CounterIndex];
+	int32& Next = State.NextAchievement[CounterIndex];
+
+	USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+
+	while (Counter.Achievements.IsValidIndex(Next) && Achievements[Counter.Achievements[Next]].Threshold <= Value)
+	{
+		const FCompiledAchievement& Achievement = Achievements[Counter.Achievements[Next]];
+		++Next;
+
+		if (State.Unlocked.IsValidIndex(Achievement.StableIndex) && State.Unlocked[Achievement.StableIndex])
+		{
+			continue;
+		}
+
+		if (State.Unlocked.Num() <= Achievement.StableIndex)
+		{
+			State.Unlocked.Add(false, Achievement.StableIndex + 1 - State.Unlocked.Num());
+		}
+		State.Unlocked[Achievement.StableIndex] = true;
+
+		if (GameInstance && GameInstance->UnlockAchievementByIndex(Achievement.StableIndex, Achievement.AchievementID.ToString()))
+		{
+			UE_LOG(LogSuperfamily, Log, TEXT("Achievement unlocked: %s"), *Achievement.AchievementID.ToString());
+			OnAchievementUnlocked.Broadcast(Achievement.AchievementID, Achievement.DisplayName);
+		}
+	}
+}
+
+// ============================================
+// Queries
+// ============================================
+
+bool USuperfamilyAchievementSubsystem::IsAchievementUnlocked(FName AchievementID) const
+{
+	const int32* Index = AchievementByID.Find(AchievementID);
+	if (!Index)
+	{
+		return false;
+	}
+
+	// Only the active child's state is kept; it is built by the first event or progress query
+	const int32 StableIndex = Achievements[*Index].StableIndex;
+	return ActiveState.Unlocked.IsValidIndex(StableIndex) && ActiveState.Unlocked[StableIndex];
+}
+
+bool USuperfamilyAchievementSubsystem::GetAchievementProgress(FName AchievementID, int32& OutValue, int32& OutThreshold)
+{
+	const int32* Index = AchievementByID.Find(AchievementID);
+	const FChildState* State = Index ? GetActiveState() : nullptr;
+	if (!State)
+	{
+		return false;
+	}
+
+	const FCompiledAchievement& Achievement = Achievements[*Index];
+	OutValue = State->Values[Achievement.Counter];
+	OutThreshold = Achievement.Threshold;
+	return true;
+}
+
+int32 USuperfamilyAchievementSubsystem::GetStableIndex(FName AchievementID) const
+{
+	const int32* Index = AchievementByID.Find(AchievementID);
+	return Index ? Achievements[*Index].StableIndex : INDEX_NONE;
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyAssetManager.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyLevelCatalog.h"
+#include "Core/SuperfamilyWorldContentSubsystem.h"
+
+void USuperfamilyAssetManager::PostInitialAssetScan()
+{
+	Super::PostInitialAssetScan();
+
+	// Chunks only matter to the cook; the editor and the game leave every map where it is
+	if (IsRunningCookCommandlet())
+	{
+		AssignWorldChunks();
+	}
+}
+
+void USuperfamilyAssetManager::AssignWorldChunks()
+{
+	TArray<FSoftObjectPath> CatalogPaths;
+	GetPrimaryAssetPathList(USuperfamilyLevelCatalog::PrimaryAssetType, CatalogPaths);
+	USuperfamilyLevelCatalog* Catalog = CatalogPaths.Num() > 0 ? Cast<USuperfamilyLevelCatalog>(CatalogPaths[0].TryLoad()) : nullptr;
+	if (!Catalog)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("No level catalog to assign world chunks from; every world cooks into the install"));
+		return;
+	}
+
+#if WITH_EDITOR
+	// The catalog is rebuilt when it is cooked, so assign from the maps that will be in it
+	Catalog->RebuildFromMaps();
+#endif
+
+	const USuperfamilyWorldContentSubsystem* WorldContent = GetDefault<USuperfamilyWorldContentSubsystem>();
+
+	int32 AssignedMaps = 0;
+	for (const FLevelCatalogEntry& Entry : Catalog->GetEntries())
+	{
+		const int32 ChunkId = WorldContent->GetWorldChunkId(Entry.WorldID);
+		if (ChunkId == 0 || Entry.Map.IsNull())
+		{
+			continue;
+		}
+
+		// Above the catalog's own rule (Priority=-1), which would otherwise pull every map into chunk 0
+		FPrimaryAssetRules Rules;
+		Rules.ChunkId = ChunkId;
+		Rules.Priority = 1;
+		Rules.CookRule = EPrimaryAssetCookRule::AlwaysCook;
+		SetPrimaryAssetRules(FPrimaryAssetId(MapType, FName(*Entry.Map.GetLongPackageName())), Rules);
+		++AssignedMaps;
+	}
+
+	UE_LOG(LogSuperfamily, Display, TEXT("Assigned %d maps to world content chunks"), AssignedMaps);
+}
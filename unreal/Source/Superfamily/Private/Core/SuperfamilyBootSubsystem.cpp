@@ -0,0 +1,498 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyBootSubsystem.h"
+#include "Superfamily.h"
+#include "Algo/AllOf.h"
+#include "Algo/NoneOf.h"
+#include "Core/SuperfamilyStats.h"
+#include "Dom/JsonObject.h"
+#include "Engine/AssetManager.h"
+#include "Engine/DataTable.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "Gameplay/QuestionSetProvider.h"
+#include "RNUEBridgeSubsystem.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+const FName USuperfamilyBootSubsystem::SaveDataStage(TEXT("SaveData"));
+const FName USuperfamilyBootSubsystem::ProfileSyncStage(TEXT("ProfileSync"));
+const FName USuperfamilyBootSubsystem::LevelCatalogStage(TEXT("LevelCatalog"));
+const FName USuperfamilyBootSubsystem::QuestionsStage(TEXT("Questions"));
+const FName USuperfamilyBootSubsystem::BridgeStage(TEXT("Bridge"));
+const FName USuperfamilyBootSubsystem::MainMenuStage(TEXT("MainMenu"));
+
+namespace SuperfamilyBoot
+{
+	/** Milliseconds since process start */
+	float ToProcessMs(double Time)
+	{
+		return static_cast<float>((Time - GStartTime) * 1000.0);
+	}
+}
+
+void USuperfamilyBootSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Collection.InitializeDependency<URNUEBridgeSubsystem>();
+
+	// Questions aren't needed until a level asks for a set, so they don't hold up the menu
+	AddStage(QuestionsStage, {}, [this](FStageDone&& Done) { RunQuestionsStage(MoveTemp(Done)); }, false);
+	AddStage(BridgeStage, {}, [this](FStageDone&& Done) { RunBridgeStage(MoveTemp(Done)); });
+	AddStage(MainMenuStage, {}, nullptr);
+}
+
+void USuperfamilyBootSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(GameReadyTimeoutHandle);
+	FTSTicker::GetCoreTicker().RemoveTicker(BridgeHandshakeHandle);
+
+	if (QuestionPackHandle.IsValid())
+	{
+		QuestionPackHandle->CancelHandle();
+		QuestionPackHandle.Reset();
+	}
+
+	Stages.Reset();
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Stages
+// ============================================
+
+void USuperfamilyBootSubsystem::AddStage(FName Stage, TArray<FName> Dependencies, FStageRunner Runner, bool bBlocksGameReady)
+{
+	if (!ensureMsgf(!FindStage(Stage), TEXT("Boot stage %s registered twice"), *Stage.ToString()))
+	{
+		return;
+	}
+
+	FStage& NewStage = Stages.AddDefaulted_GetRef();
+	NewStage.Name = Stage;
+	NewStage.Dependencies = MoveTemp(Dependencies);
+	NewStage.bExternal = !Runner;
+	NewStage.Runner = MoveTemp(Runner);
+	NewStage.bBlocksGameReady = bBlocksGameReady;
+
+	if (bStarted)
+	{
+		StartReadyStages();
+	}
+}
+
+void USuperfamilyBootSubsystem::Start()
+{
+	if (bStarted)
+	{
+		return;
+	}
+
+	bStarted = true;
+	BootStartTime = FPlatformTime::Seconds();
+
+	for (FStage& Stage : Stages)
+	{
+		Stage.Dependencies.RemoveAll([this, &Stage](FName Dependency)
+		{
+			if (FindStage(Dependency))
+			{
+				return false;
+			}
+			UE_LOG(LogSuperfamily, Warning, TEXT("Boot stage %s depends on unknown stage %s"), *Stage.Name.ToString(), *Dependency.ToString());
+			return true;
+		});
+	}
+
+	if (GameReadyTimeoutSeconds > 0.0f)
+	{
+		GameReadyTimeoutHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &USuperfamilyBootSubsystem::TickGameReadyTimeout), GameReadyTimeoutSeconds);
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Boot started %.0f ms after launch with %d stages"), SuperfamilyBoot::ToProcessMs(BootStartTime), Stages.Num());
+
+	StartReadyStages();
+}
+
+void USuperfamilyBootSubsystem::CompleteStage(FName Stage, bool bSucceeded)
+{
+	FStage* Found = FindStage(Stage);
+	if (!Found || Found->State == EStageState::Done)
+	{
+		return;
+	}
+
+	// Completed before its dependencies were: it still counts from boot start
+	if (Found->State == EStageState::Waiting)
+	{
+		Found->State = EStageState::Running;
+		Found->StartTime = bStarted ? BootStartTime : FPlatformTime::Seconds();
+	}
+
+	FinishStage(Stage, bSucceeded);
+}
+
+bool USuperfamilyBootSubsystem::IsStageComplete(FName Stage) const
+{
+	const FStage* Found = FindStage(Stage);
+	return Found && Found->State == EStageState::Done;
+}
+
+void USuperfamilyBootSubsystem::CallWhenStageComplete(FName Stage, TFunction<void()> Callback)
+{
+	FStage* Found = FindStage(Stage);
+	if (!Found || Found->State == EStageState::Done)
+	{
+		Callback();
+		return;
+	}
+
+	Found->OnComplete.Add(MoveTemp(Callback));
+}
+
+TArray<FBootStageTiming> USuperfamilyBootSubsystem::GetStageTimings() const
+{
+	TArray<FBootStageTiming> Timings;
+	for (const FStage& Stage : Stages)
+	{
+		if (Stage.State == EStageState::Waiting)
+		{
+			continue;
+		}
+
+		FBootStageTiming& Timing = Timings.AddDefaulted_GetRef();
+		Timing.Stage = Stage.Name;
+		Timing.StartMs = SuperfamilyBoot::ToProcessMs(Stage.StartTime);
+		Timing.bSucceeded = Stage.bSucceeded;
+		if (Stage.State == EStageState::Done)
+		{
+			Timing.DurationMs = static_cast<float>((Stage.EndTime - Stage.StartTime) * 1000.0);
+		}
+	}
+	return Timings;
+}
+
+USuperfamilyBootSubsystem::FStage* USuperfamilyBootSubsystem::FindStage(FName Stage)
+{
+	return Stages.FindByPredicate([Stage](const FStage& Candidate) { return Candidate.Name == Stage; });
+}
+
+const USuperfamilyBootSubsystem::FStage* USuperfamilyBootSubsystem::FindStage(FName Stage) const
+{
+	return Stages.FindByPredicate([Stage](const FStage& Candidate) { return Candidate.Name == Stage; });
+}
+
+void USuperfamilyBootSubsystem::StartReadyStages()
+{
+	// By index: a runner may register more stages or finish synchronously
+	for (int32 Index = 0; Index < Stages.Num(); ++Index)
+	{
+		if (Stages[Index].State != EStageState::Waiting)
+		{
+			continue;
+		}
+
+		const bool bDependenciesDone = Algo::AllOf(Stages[Index].Dependencies, [this](FName Dependency)
+		{
+			const FStage* Found = FindStage(Dependency);
+			return !Found || Found->State == EStageState::Done;
+		});
+
+		if (bDependenciesDone)
+		{
+			RunStage(Index);
+		}
+	}
+
+	// With no runner in flight, a stage that only waits on other waiting stages is
+	// in or behind a dependency cycle and would stall the boot until the GameReady
+	// timeout. Stages completed from outside are left to whoever completes them.
+	const bool bAnyRunning = Stages.ContainsByPredicate([](const FStage& Stage) { return Stage.State == EStageState::Running && !Stage.bExternal; });
+	const int32 StalledIndex = Stages.IndexOfByPredicate([this](const FStage& Stage)
+	{
+		return Stage.State == EStageState::Waiting && Algo::NoneOf(Stage.Dependencies, [this](FName Dependency)
+		{
+			const FStage* Found = FindStage(Dependency);
+			return Found && Found->State == EStageState::Running;
+		});
+	});
+	if (!bAnyRunning && StalledIndex != INDEX_NONE)
+	{
+		UE_LOG(LogSuperfamily, Error, TEXT("Boot stage %s is waiting on a dependency cycle; starting it anyway"), *Stages[StalledIndex].Name.ToString());
+		RunStage(StalledIndex);
+	}
+}
+
+void USuperfamilyBootSubsystem::RunStage(int32 Index)
+{
+	FStage& Stage = Stages[Index];
+	Stage.State = EStageState::Running;
+	Stage.StartTime = FPlatformTime::Seconds();
+
+	if (!Stage.Runner)
+	{
+		return;
+	}
+
+	// The runner only runs once; moving it out keeps it alive if Stages reallocates under it
+	FStageRunner Runner = MoveTemp(Stage.Runner);
+	const FName StageName = Stage.Name;
+
+	TWeakObjectPtr<USuperfamilyBootSubsystem> WeakThis(this);
+	Runner([WeakThis, StageName](bool bSucceeded)
+	{
+		check(IsInGameThread());
+		if (USuperfamilyBootSubsystem* This = WeakThis.Get())
+		{
+			This->FinishStage(StageName, bSucceeded);
+		}
+	});
+}
+
+void USuperfamilyBootSubsystem::FinishStage(FName StageName, bool bSucceeded)
+{
+	FStage* Stage = FindStage(StageName);
+	if (!Stage || Stage->State != EStageState::Running)
+	{
+		return;
+	}
+
+	Stage->State = EStageState::Done;
+	Stage->bSucceeded = bSucceeded;
+	Stage->EndTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Boot stage %s %s in %.1f ms"),
+		*StageName.ToString(), bSucceeded ? TEXT("done") : TEXT("failed"), (Stage->EndTime - Stage->StartTime) * 1000.0);
+	CSV_EVENT(Superfamily, TEXT("Boot %s"), *StageName.ToString());
+
+	TArray<TFunction<void()>> Callbacks = MoveTemp(Stage->OnComplete);
+	for (TFunction<void()>& Callback : Callbacks)
+	{
+		Callback();
+	}
+
+	if (bStarted)
+	{
+		StartReadyStages();
+		CheckProgress();
+	}
+}
+
+// ============================================
+// GameReady
+// ============================================
+
+void USuperfamilyBootSubsystem::CheckProgress()
+{
+	if (!IsGameReady())
+	{
+		const bool bBlockingDone = !Stages.ContainsByPredicate([](const FStage& Stage)
+		{
+			return Stage.bBlocksGameReady && Stage.State != EStageState::Done;
+		});
+
+		if (bBlockingDone)
+		{
+			SendGameReady(false);
+		}
+		return;
+	}
+
+	const bool bAllDone = !Stages.ContainsByPredicate([](const FStage& Stage) { return Stage.State != EStageState::Done; });
+	if (bAllDone && !bAllStagesReported)
+	{
+		bAllStagesReported = true;
+		LogTimings(TEXT("Boot finished"));
+
+		if (URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>())
+		{
+			Bridge->SendStartupTimings(BuildTimingsJSON());
+		}
+	}
+}
+
+void USuperfamilyBootSubsystem::SendGameReady(bool bTimedOut)
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(GameReadyTimeoutHandle);
+	GameReadyTimeoutHandle.Reset();
+
+	GameReadyMs = SuperfamilyBoot::ToProcessMs(FPlatformTime::Seconds());
+
+	if (bTimedOut)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Blocking boot stages still running after %.0fs; sending GameReady anyway"), GameReadyTimeoutSeconds);
+	}
+	LogTimings(TEXT("GameReady"));
+	CSV_EVENT(Superfamily, TEXT("GameReady"));
+
+	// When nothing is left, the GameReady payload is already the full breakdown
+	bAllStagesReported = !Stages.ContainsByPredicate([](const FStage& Stage) { return Stage.State != EStageState::Done; });
+
+	if (URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>())
+	{
+		Bridge->NotifyGameReady(BuildTimingsJSON());
+	}
+
+	OnGameReady.Broadcast();
+}
+
+bool USuperfamilyBootSubsystem::TickGameReadyTimeout(float DeltaTime)
+{
+	GameReadyTimeoutHandle.Reset();
+	if (!IsGameReady())
+	{
+		SendGameReady(true);
+	}
+	return false;
+}
+
+void USuperfamilyBootSubsystem::LogTimings(const TCHAR* Milestone) const
+{
+	UE_LOG(LogSuperfamily, Log, TEXT("%s at %.0f ms (engine start to boot: %.0f ms)"),
+		Milestone, SuperfamilyBoot::ToProcessMs(FPlatformTime::Seconds()), SuperfamilyBoot::ToProcessMs(BootStartTime));
+
+	for (const FBootStageTiming& Timing : GetStageTimings())
+	{
+		if (Timing.DurationMs < 0.0f)
+		{
+			UE_LOG(LogSuperfamily, Log, TEXT("  %-14s +%6.0f ms  still running"), *Timing.Stage.ToString(), Timing.StartMs);
+		}
+		else
+		{
+			UE_LOG(LogSuperfamily, Log, TEXT("  %-14s +%6.0f ms  %6.1f ms%s"),
+				*Timing.Stage.ToString(), Timing.StartMs, Timing.DurationMs, Timing.bSucceeded ? TEXT("") : TEXT("  (failed)"));
+		}
+	}
+}
+
+FString USuperfamilyBootSubsystem::BuildTimingsJSON() const
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("bootStartMs"), SuperfamilyBoot::ToProcessMs(BootStartTime));
+	Root->SetNumberField(TEXT("gameReadyMs"), GameReadyMs);
+
+	TArray<TSharedPtr<FJsonValue>> StageValues;
+	for (const FBootStageTiming& Timing : GetStageTimings())
+	{
+		TSharedRef<FJsonObject> StageObject = MakeShared<FJsonObject>();
+		StageObject->SetStringField(TEXT("name"), Timing.Stage.ToString());
+		StageObject->SetNumberField(TEXT("startMs"), Timing.StartMs);
+		if (Timing.DurationMs >= 0.0f)
+		{
+			StageObject->SetNumberField(TEXT("durationMs"), Timing.DurationMs);
+			StageObject->SetBoolField(TEXT("succeeded"), Timing.bSucceeded);
+		}
+		StageValues.Add(MakeShared<FJsonValueObject>(StageObject));
+	}
+	Root->SetArrayField(TEXT("stages"), StageValues);
+
+	FString JSON;
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&JSON);
+	FJsonSerializer::Serialize(Root, Writer);
+	return JSON;
+}
+
+// ============================================
+// Built-in Stages
+// ============================================
+
+void USuperfamilyBootSubsystem::RunQuestionsStage(FStageDone&& Done)
+{
+	TArray<FSoftObjectPath> PackPaths;
+	for (const TSoftObjectPtr<UDataTable>& Pack : QuestionPacks)
+	{
+		if (!Pack.IsNull())
+		{
+			PackPaths.Add(Pack.ToSoftObjectPath());
+		}
+	}
+
+	if (PackPaths.Num() == 0 || !UAssetManager::IsInitialized())
+	{
+		Done(true);
+		return;
+	}
+
+	// The callback may run before RequestAsyncLoad returns, so it resolves the paths rather than reading the handle
+	QuestionPackHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(PackPaths,
+		FStreamableDelegate::CreateWeakLambda(this, [this, PackPaths, Done]()
+		{
+			LLM_SCOPE_BYTAG(Superfamily);
+
+			IQuestionSetProvider* Provider = nullptr;
+			for (UGameInstanceSubsystem* Subsystem : GetGameInstance()->GetSubsystemArray<UGameInstanceSubsystem>())
+			{
+				Provider = Cast<IQuestionSetProvider>(Subsystem);
+				if (Provider)
+				{
+					break;
+				}
+			}
+
+			int32 PacksAdded = 0;
+			for (const FSoftObjectPath& Path : PackPaths)
+			{
+				UDataTable* Pack = Cast<UDataTable>(Path.ResolveObject());
+				if (Pack && Provider)
+				{
+					Provider->AddQuestionPack(Pack);
+					++PacksAdded;
+				}
+			}
+
+			if (PacksAdded < PackPaths.Num())
+			{
+				UE_LOG(LogSuperfamily, Warning, TEXT("Added %d of %d question packs%s"), PacksAdded, PackPaths.Num(), Provider ? TEXT("") : TEXT(" (no question provider)"));
+			}
+
+			// The provider copies the rows into its pool; the tables can go
+			if (QuestionPackHandle.IsValid())
+			{
+				QuestionPackHandle->ReleaseHandle();
+				QuestionPackHandle.Reset();
+			}
+
+			Done(PacksAdded > 0);
+		}));
+
+	if (!QuestionPackHandle.IsValid())
+	{
+		// Finishing twice is harmless if the callback already ran
+		Done(false);
+	}
+	else if (QuestionPackHandle->HasLoadCompleted())
+	{
+		QuestionPackHandle->ReleaseHandle();
+		QuestionPackHandle.Reset();
+	}
+}
+
+void USuperfamilyBootSubsystem::RunBridgeStage(FStageDone&& Done)
+{
+	// Only the mobile platform glue binds the native transport; elsewhere messages are logged
+#if PLATFORM_IOS || PLATFORM_ANDROID
+	const double HandshakeStart = FPlatformTime::Seconds();
+	BridgeHandshakeHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this, HandshakeStart, Done = MoveTemp(Done)](float)
+	{
+		// GameReady sent before the transport is bound would never reach RN
+		const URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>();
+		const bool bBound = Bridge && Bridge->IsNativeTransportBound();
+		if (!bBound && FPlatformTime::Seconds() - HandshakeStart < BridgeHandshakeTimeoutSeconds)
+		{
+			return true;
+		}
+
+		if (!bBound)
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("RN transport not bound after %.1fs"), BridgeHandshakeTimeoutSeconds);
+		}
+		BridgeHandshakeHandle.Reset();
+		Done(bBound);
+		return false;
+	}));
+#else
+	Done(true);
+#endif
+}
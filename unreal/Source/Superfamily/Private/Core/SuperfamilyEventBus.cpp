@@ -0,0 +1,125 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyEventBus.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyStats.h"
+
+#if !UE_BUILD_SHIPPING
+#include "Characters/SuperfamilyPlayerCharacter.h"
+#include "Core/SuperfamilyEventBusBenchmark.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/StrongObjectPtr.h"
+#endif
+
+void USuperfamilyEventBus::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	RelayToBlueprint<FCoinCollectedEvent>(OnCoinCollectedEvents);
+	RelayToBlueprint<FPlayerJumpedEvent>(OnPlayerJumpedEvents);
+	RelayToBlueprint<FQuestionAnsweredEvent>(OnQuestionAnsweredEvents);
+	RelayToBlueprint<FStreakUpdatedEvent>(OnStreakUpdatedEvents);
+
+	// Core ticker rather than a world tick, so events keep flowing between maps
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &USuperfamilyEventBus::Tick));
+}
+
+void USuperfamilyEventBus::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+
+	for (TUniquePtr<FSuperfamilyEventChannelBase>& Channel : Channels)
+	{
+		Channel.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+void USuperfamilyEventBus::UnsubscribeAll(const void* Object)
+{
+	for (TUniquePtr<FSuperfamilyEventChannelBase>& Channel : Channels)
+	{
+		if (Channel.IsValid())
+		{
+			Channel->RemoveAll(Object);
+		}
+	}
+}
+
+bool USuperfamilyEventBus::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyEventDispatch);
+
+	int32 Dispatched = 0;
+	for (TUniquePtr<FSuperfamilyEventChannelBase>& Channel : Channels)
+	{
+		if (Channel.IsValid())
+		{
+			Dispatched += Channel->Dispatch();
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_SuperfamilyEventsDispatched, Dispatched);
+	return true;
+}
+
+#if !UE_BUILD_SHIPPING
+
+namespace SuperfamilyEventBus
+{
+	/** Per-event cost of the coin delegate on the player character against a bus channel with the same listeners */
+	static void Benchmark(const TArray<FString>& Args)
+	{
+		const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+		const int32 NumListeners = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 4;
+		const int32 EventsPerFrame = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 4;
+
+		// A channel of its own, so the benchmark's coins don't reach the real subscribers
+		FOnCoinCollected Delegate;
+		TSuperfamilyEventChannel<FCoinCollectedEvent> Channel;
+		TArray<TStrongObjectPtr<USuperfamilyEventBenchmarkListener>> Listeners;
+		for (int32 Index = 0; Index < NumListeners; ++Index)
+		{
+			USuperfamilyEventBenchmarkListener* Listener = NewObject<USuperfamilyEventBenchmarkListener>();
+			Listeners.Emplace(Listener);
+			Delegate.AddDynamic(Listener, &USuperfamilyEventBenchmarkListener::HandleCoinCollected);
+			Channel.OnEvents().AddUObject(Listener, &USuperfamilyEventBenchmarkListener::HandleCoinEvents);
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Delegate.Broadcast(Index);
+		}
+		const double DelegateSeconds = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		FCoinCollectedEvent Event;
+		Event.Amount = 1;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Event.SessionTotal = Index;
+			Channel.Publish(Event);
+			if ((Index + 1) % EventsPerFrame == 0)
+			{
+				Channel.Dispatch();
+			}
+		}
+		Channel.Dispatch();
+		const double BusSeconds = FPlatformTime::Seconds() - StartTime;
+
+		const double DelegateNs = DelegateSeconds * 1e9 / Count;
+		const double BusNs = BusSeconds * 1e9 / Count;
+		UE_LOG(LogSuperfamily, Display, TEXT("Event benchmark: %d coin events, %d listeners"), Count, NumListeners);
+		UE_LOG(LogSuperfamily, Display, TEXT("  Dynamic delegate:          %8.1f ns/event"), DelegateNs);
+		UE_LOG(LogSuperfamily, Display, TEXT("  Event bus (%3d per frame): %8.1f ns/event (%.1fx)"), EventsPerFrame, BusNs, BusNs > 0.0 ? DelegateNs / BusNs : 0.0);
+	}
+}
+
+static FAutoConsoleCommand GSuperfamilyEventsBenchmarkCommand(
+	TEXT("sf.Events.Benchmark"),
+	TEXT("Compare per-event cost of a dynamic delegate broadcast with the event bus. Usage: sf.Events.Benchmark [Count] [Listeners] [EventsPerFrame]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&SuperfamilyEventBus::Benchmark));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,35 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Core/SuperfamilyEventBus.h"
+#include "SuperfamilyEventBusBenchmark.generated.h"
+
+/**
+ * Coin listener for sf.Events.Benchmark: the same work behind a dynamic
+ * delegate (one call per event) and a bus subscription (one call per batch)
+ */
+UCLASS(Transient)
+class USuperfamilyEventBenchmarkListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION()
+	void HandleCoinCollected(int32 NewTotal)
+	{
+		Total += NewTotal;
+	}
+
+	void HandleCoinEvents(TConstArrayView<FCoinCollectedEvent> Events)
+	{
+		for (const FCoinCollectedEvent& Event : Events)
+		{
+			Total += Event.SessionTotal;
+		}
+	}
+
+	int64 Total = 0;
+};
@@ -1,8 +1,18 @@
 // Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
 
 #include "Core/SuperfamilyGameInstance.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyAchievementSubsystem.h"
+#include "Core/SuperfamilyBootSubsystem.h"
+#include "Core/SuperfamilyProgressSyncSubsystem.h"
+#include "Core/SuperfamilyStats.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/SaveGame.h"
+#include "RNUEBridgeSubsystem.h"
+#include "Dom/JsonObject.h"
+#include "JsonObjectConverter.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
 
 // Forward declare save game class (will be implemented later)
 UCLASS()
@@ -33,12 +43,41 @@ USuperfamilyGameInstance::USuperfamilyGameInstance()
 
 void USuperfamilyGameInstance::Init()
 {
+	LLM_SCOPE_BYTAG(Superfamily);
+
 	Super::Init();
 
-	// Try to load existing save
-	LoadGame();
+	// New epoch per session: RN requests a snapshot whenever it sees a different one
+	SyncEpoch = FGuid::NewGuid();
+
+	if (URNUEBridgeSubsystem* Bridge = GetSubsystem<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnProfileSnapshotRequested.AddDynamic(this, &USuperfamilyGameInstance::HandleProfileSnapshotRequested);
+	}
+
+	// Subsystems registered their stages during Super::Init; add ours and start the boot
+	if (USuperfamilyBootSubsystem* Boot = GetSubsystem<USuperfamilyBootSubsystem>())
+	{
+		Boot->AddStage(USuperfamilyBootSubsystem::SaveDataStage, {}, [this](USuperfamilyBootSubsystem::FStageDone&& Done)
+		{
+			LoadGameAsync(MoveTemp(Done));
+		});
+
+		// RN shows the active profile as soon as the game is ready, so it goes out before GameReady
+		Boot->AddStage(USuperfamilyBootSubsystem::ProfileSyncStage, { USuperfamilyBootSubsystem::SaveDataStage, USuperfamilyBootSubsystem::BridgeStage },
+			[this](USuperfamilyBootSubsystem::FStageDone&& Done)
+			{
+				if (ActiveChildID.IsValid())
+				{
+					SendProfileSnapshot(ActiveChildID);
+				}
+				Done(true);
+			});
+
+		Boot->Start();
+	}
 
-	UE_LOG(LogTemp, Log, TEXT("Superfamily GameInstance initialized"));
+	UE_LOG(LogSuperfamily, Log, TEXT("Superfamily GameInstance initialized"));
 }
 
 void USuperfamilyGameInstance::Shutdown()
@@ -46,6 +85,8 @@ void USuperfamilyGameInstance::Shutdown()
 	// Auto-save on shutdown
 	SaveGame();
 
+	FlushProfileDeltas();
+
 	Super::Shutdown();
 }
 
@@ -64,7 +105,7 @@ FChildProfile USuperfamilyGameInstance::GetActiveProfile() const
 	return FChildProfile();
 }
 
-bool USuperfamilyGameInstance::SetActiveProfile(const FString& ChildID)
+bool USuperfamilyGameInstance::SetActiveProfile(const FChildId& ChildID)
 {
 	if (CurrentSaveGame)
 	{
@@ -91,13 +132,19 @@ TArray<FChildProfile> USuperfamilyGameInstance::GetAllProfiles() const
 
 bool USuperfamilyGameInstance::CreateProfile(const FString& DisplayName, int32 AgeGroup)
 {
+	if (bSaveLoadPending)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Can't create a profile while the save is still loading"));
+		return false;
+	}
+
 	if (!CurrentSaveGame)
 	{
 		CurrentSaveGame = Cast<USuperFamilySaveGame>(UGameplayStatics::CreateSaveGameObject(USuperFamilySaveGame::StaticClass()));
 	}
 
 	FChildProfile NewProfile;
-	NewProfile.ChildID = FGuid::NewGuid().ToString();
+	NewProfile.ChildID = FChildId::NewId();
 	NewProfile.DisplayName = DisplayName;
 	NewProfile.AgeGroup = FMath::Clamp(AgeGroup, 1, 4);
 	NewProfile.TotalXP = 0;
@@ -113,34 +160,148 @@ bool USuperfamilyGameInstance::CreateProfile(const FString& DisplayName, int32 A
 		ActiveChildID = NewProfile.ChildID;
 	}
 
-	return SaveGame();
+	const bool bSaved = SaveGame();
+
+	// RN has nothing to apply deltas to yet
+	SendProfileSnapshot(NewProfile.ChildID);
+
+	return bSaved;
 }
 
 bool USuperfamilyGameInstance::SaveGame()
 {
-	if (CurrentSaveGame)
+	LLM_SCOPE_BYTAG(Superfamily);
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilySaveGame);
+	CSV_SCOPED_TIMING_STAT(Superfamily, SaveGame);
+
+	if (!CurrentSaveGame || bSaveLoadPending)
 	{
-		CurrentSaveGame->LastModified = FDateTime::UtcNow();
-		return UGameplayStatics::SaveGameToSlot(CurrentSaveGame, SaveSlotName, 0);
+		return false;
 	}
-	return false;
+
+	CurrentSaveGame->LastModified = FDateTime::UtcNow();
+
+	// Same as SaveGameToSlot, split so the serialized size can be reported
+	TArray<uint8> SaveData;
+	if (!UGameplayStatics::SaveGameToMemory(CurrentSaveGame, SaveData))
+	{
+		return false;
+	}
+	SaveDataBytes = SaveData.Num();
+	SET_MEMORY_STAT(STAT_SuperfamilySaveDataMemory, SaveDataBytes);
+
+	const bool bSaved = UGameplayStatics::SaveDataToSlot(SaveData, SaveSlotName, 0);
+	CSV_EVENT(Superfamily, TEXT("SaveWritten %d bytes%s"), SaveData.Num(), bSaved ? TEXT("") : TEXT(" (failed)"));
+
+	// Sync replicas must not fall behind the profiles they were seeded from
+	if (USuperfamilyProgressSyncSubsystem* ProgressSync = GetSubsystem<USuperfamilyProgressSyncSubsystem>())
+	{
+		ProgressSync->SaveState();
+	}
+
+	return bSaved;
 }
 
 bool USuperfamilyGameInstance::LoadGame()
 {
-	if (UGameplayStatics::DoesSaveGameExist(SaveSlotName, 0))
+	LLM_SCOPE_BYTAG(Superfamily);
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyLoadGame);
+	CSV_SCOPED_TIMING_STAT(Superfamily, LoadGame);
+
+	// Supersedes an async load still in flight
+	++SaveLoadSerial;
+	bSaveLoadPending = false;
+
+	// Same as LoadGameFromSlot, split so the serialized size can be reported
+	const bool bSaveExists = UGameplayStatics::DoesSaveGameExist(SaveSlotName, 0);
+	TArray<uint8> SaveData;
+	USaveGame* LoadedGame = nullptr;
+	if (bSaveExists && UGameplayStatics::LoadDataFromSlot(SaveData, SaveSlotName, 0))
+	{
+		SaveDataBytes = SaveData.Num();
+		SET_MEMORY_STAT(STAT_SuperfamilySaveDataMemory, SaveDataBytes);
+		LoadedGame = UGameplayStatics::LoadGameFromMemory(SaveData);
+	}
+	return ApplyLoadedSave(bSaveExists, LoadedGame);
+}
+
+void USuperfamilyGameInstance::LoadGameAsync(TFunction<void(bool)> OnLoaded)
+{
+	bSaveLoadPending = true;
+	const uint32 Serial = ++SaveLoadSerial;
+
+	// The engine reads on a worker and deserializes on the game thread
+	UGameplayStatics::AsyncLoadGameFromSlot(SaveSlotName, 0, FAsyncLoadGameFromSlotDelegate::CreateWeakLambda(this,
+		[this, Serial, OnLoaded = MoveTemp(OnLoaded)](const FString& SlotName, const int32 UserIndex, USaveGame* LoadedGame)
+		{
+			// A synchronous LoadGame since then has already replaced the save
+			if (Serial != SaveLoadSerial)
+			{
+				OnLoaded(CurrentSaveGame != nullptr);
+				return;
+			}
+
+			LLM_SCOPE_BYTAG(Superfamily);
+			SCOPE_CYCLE_COUNTER(STAT_SuperfamilyLoadGame);
+			CSV_SCOPED_TIMING_STAT(Superfamily, LoadGame);
+
+			// Nothing loaded: either there is no save yet or it couldn't be read
+			const bool bSaveExists = LoadedGame || UGameplayStatics::DoesSaveGameExist(SaveSlotName, 0);
+
+			bSaveLoadPending = false;
+			OnLoaded(ApplyLoadedSave(bSaveExists, LoadedGame));
+		}));
+}
+
+bool USuperfamilyGameInstance::ApplyLoadedSave(bool bSaveExists, USaveGame* LoadedGame)
+{
+	if (!bSaveExists)
+	{
+		// Create new save game
+		CurrentSaveGame = Cast<USuperFamilySaveGame>(UGameplayStatics::CreateSaveGameObject(USuperFamilySaveGame::StaticClass()));
+		OnProfilesApplied.Broadcast(FChildId());
+		return true;
+	}
+
+	CurrentSaveGame = Cast<USuperFamilySaveGame>(LoadedGame);
+
+	// Child IDs were strings before they became GUIDs; those load as name-based GUIDs RN has to re-key to
+	const TMap<FString, FChildId> LegacyChildIDs = FChildId::TakeLegacyConversions();
+	if (LegacyChildIDs.Num() > 0)
+	{
+		SendChildIdMigrations(LegacyChildIDs);
+	}
+
+	if (CurrentSaveGame)
 	{
-		CurrentSaveGame = Cast<USuperFamilySaveGame>(UGameplayStatics::LoadGameFromSlot(SaveSlotName, 0));
-		if (CurrentSaveGame && CurrentSaveGame->ChildProfiles.Num() > 0)
+		for (FChildProfile& Profile : CurrentSaveGame->ChildProfiles)
+		{
+			// Only a profile saved without any ID gets a fresh one
+			if (!Profile.ChildID.IsValid())
+			{
+				Profile.ChildID = FChildId::NewId();
+				UE_LOG(LogSuperfamily, Warning, TEXT("Profile %s had no child ID; assigned %s"), *Profile.DisplayName, *Profile.ChildID.ToString());
+			}
+
+			// Per-subject totals from before the subject table; their response times were only an average
+			for (const TPair<FString, FSubjectProgress>& Pair : Profile.SubjectProgress)
+			{
+				FSubjectStats& Stats = Profile.Subjects.Get(Pair.Value.Subject, Pair.Value.CurrentLevel);
+				Stats.QuestionsAnswered += Pair.Value.QuestionsAnswered;
+				Stats.QuestionsCorrect += Pair.Value.QuestionsCorrect;
+			}
+			Profile.SubjectProgress.Empty();
+		}
+
+		if (CurrentSaveGame->ChildProfiles.Num() > 0)
 		{
 			ActiveChildID = CurrentSaveGame->ChildProfiles[0].ChildID;
 		}
-		return CurrentSaveGame != nullptr;
 	}
 
-	// Create new save game
-	CurrentSaveGame = Cast<USuperFamilySaveGame>(UGameplayStatics::CreateSaveGameObject(USuperFamilySaveGame::StaticClass()));
-	return true;
+	// State built from the previous profiles is stale, whether or not this load succeeded
+	OnProfilesApplied.Broadcast(FChildId());
+	return CurrentSaveGame != nullptr;
 }
 
 bool USuperfamilyGameInstance::DoesSaveExist() const
@@ -170,8 +331,21 @@ void USuperfamilyGameInstance::RecordLevelCompletion(int32 WorldID, int32 LevelI
 		return;
 	}
 
-	FString LevelKey = GetLevelKey(WorldID, LevelID);
+	const FLevelKey LevelKey(WorldID, LevelID);
+
+	if (USuperfamilyProgressSyncSubsystem* ProgressSync = GetSubsystem<USuperfamilyProgressSyncSubsystem>())
+	{
+		FProgressLevelBest Result;
+		Result.bCompleted = true;
+		Result.Stars = Stars;
+		Result.HighScore = Score;
+		Result.Coins = Coins;
+		ProgressSync->RecordLevel(*ActiveProfile, LevelKey, Result);
+		ProgressSync->RecordCounter(*ActiveProfile, EProgressCounter::Coins, Coins);
+	}
+
 	FLevelProgress& Progress = ActiveProfile->LevelProgress.FindOrAdd(LevelKey);
+	const int32 PreviousStars = Progress.bCompleted ? Progress.StarsEarned : INDEX_NONE;
 
 	Progress.bCompleted = true;
 	Progress.StarsEarned = FMath::Max(Progress.StarsEarned, Stars);
@@ -181,6 +355,10 @@ void USuperfamilyGameInstance::RecordLevelCompletion(int32 WorldID, int32 LevelI
 	// Add coins to total
 	ActiveProfile->Coins += Coins;
 
+	FProfileSyncState& SyncState = MarkProfileDirty(ActiveChildID, EProfileSyncField::Coins);
+	SyncState.DirtyLevels.Add(LevelKey);
+	OnLevelRecorded.Broadcast(ActiveChildID, WorldID, LevelID, Stars, PreviousStars);
+
 	SaveGame();
 }
 
@@ -195,8 +373,7 @@ FLevelProgress USuperfamilyGameInstance::GetLevelProgress(int32 WorldID, int32 L
 	{
 		if (Profile.ChildID == ActiveChildID)
 		{
-			FString LevelKey = GetLevelKey(WorldID, LevelID);
-			if (const FLevelProgress* Progress = Profile.LevelProgress.Find(LevelKey))
+			if (const FLevelProgress* Progress = Profile.LevelProgress.Find(FLevelKey(WorldID, LevelID)))
 			{
 				return *Progress;
 			}
@@ -230,6 +407,108 @@ bool USuperfamilyGameInstance::IsLevelUnlocked(int32 WorldID, int32 LevelID) con
 	return PrevProgress.bCompleted;
 }
 
+void USuperfamilyGameInstance::RecordMissionCompleted(const FMissionId& MissionID)
+{
+	FChildProfile* ActiveProfile = FindProfile(ActiveChildID);
+	if (!ActiveProfile || !MissionID.IsValid() || ActiveProfile->CompletedMissions.Contains(MissionID))
+	{
+		return;
+	}
+
+	if (USuperfamilyProgressSyncSubsystem* ProgressSync = GetSubsystem<USuperfamilyProgressSyncSubsystem>())
+	{
+		ProgressSync->RecordMission(*ActiveProfile, MissionID);
+	}
+
+	ActiveProfile->CompletedMissions.Add(MissionID);
+	MarkProfileDirty(ActiveChildID).NewMissions.Add(MissionID);
+	OnMissionRecorded.Broadcast(ActiveChildID, MissionID);
+
+	SaveGame();
+}
+
+void USuperfamilyGameInstance::UnlockAchievement(const FString& AchievementID)
+{
+	FChildProfile* ActiveProfile = FindProfile(ActiveChildID);
+	if (!ActiveProfile || AchievementID.IsEmpty() || ActiveProfile->UnlockedAchievements.Contains(AchievementID))
+	{
+		return;
+	}
+
+	if (USuperfamilyProgressSyncSubsystem* ProgressSync = GetSubsystem<USuperfamilyProgressSyncSubsystem>())
+	{
+		ProgressSync->RecordAchievement(*ActiveProfile, AchievementID);
+	}
+
+	ActiveProfile->UnlockedAchievements.Add(AchievementID);
+	MarkProfileDirty(ActiveChildID).NewAchievements.Add(AchievementID);
+
+	SaveGame();
+}
+
+bool USuperfamilyGameInstance::UnlockAchievementByIndex(int32 StableIndex, const FString& AchievementID)
+{
+	FChildProfile* ActiveProfile = FindProfile(ActiveChildID);
+	if (!ActiveProfile || StableIndex < 0)
+	{
+		return false;
+	}
+
+	const int32 Word = StableIndex / 32;
+	const uint32 Mask = 1u << (StableIndex % 32);
+	if (ActiveProfile->AchievementBits.Num() <= Word)
+	{
+		ActiveProfile->AchievementBits.SetNumZeroed(Word + 1);
+	}
+	if (ActiveProfile->AchievementBits[Word] & Mask)
+	{
+		return false;
+	}
+
+	if (USuperfamilyProgressSyncSubsystem* ProgressSync = GetSubsystem<USuperfamilyProgressSyncSubsystem>())
+	{
+		ProgressSync->RecordAchievement(*ActiveProfile, AchievementID);
+	}
+
+	ActiveProfile->AchievementBits[Word] |= Mask;
+	ActiveProfile->UnlockedAchievements.AddUnique(AchievementID);
+	MarkProfileDirty(ActiveChildID).NewAchievements.Add(AchievementID);
+
+	SaveGame();
+	return true;
+}
+
+void USuperfamilyGameInstance::SetAchievementCounter(const FString& CounterKey, int32 Value)
+{
+	if (FChildProfile* ActiveProfile = FindProfile(ActiveChildID))
+	{
+		ActiveProfile->AchievementCounters.Add(CounterKey, Value);
+	}
+}
+
+void USuperfamilyGameInstance::RecordAnswer(EQuestionSubject Subject, EDifficultyLevel Difficulty, bool bCorrect, float ResponseTime)
+{
+	if (FChildProfile* ActiveProfile = FindProfile(ActiveChildID))
+	{
+		ActiveProfile->Subjects.RecordAnswer(Subject, Difficulty, bCorrect, ResponseTime);
+	}
+}
+
+float USuperfamilyGameInstance::GetResponseTimePercentile(EQuestionSubject Subject, float Percentile) const
+{
+	if (CurrentSaveGame)
+	{
+		for (const FChildProfile& Profile : CurrentSaveGame->ChildProfiles)
+		{
+			if (Profile.ChildID == ActiveChildID)
+			{
+				return Profile.Subjects.GetSubjectTotal(Subject).ResponseTimes.GetPercentile(Percentile);
+			}
+		}
+	}
+	return 0.0f;
+}
+
 void USuperfamilyGameInstance::AddXP(int32 Amount)
 {
 	if (!CurrentSaveGame || Amount <= 0)
@@ -241,7 +520,13 @@ void USuperfamilyGameInstance::AddXP(int32 Amount)
 	{
 		if (Profile.ChildID == ActiveChildID)
 		{
+			if (USuperfamilyProgressSyncSubsystem* ProgressSync = GetSubsystem<USuperfamilyProgressSyncSubsystem>())
+			{
+				ProgressSync->RecordCounter(Profile, EProgressCounter::XP, Amount);
+			}
+
 			Profile.TotalXP += Amount;
+			MarkProfileDirty(ActiveChildID, EProfileSyncField::TotalXP);
 			SaveGame();
 			return;
 		}
@@ -259,7 +544,13 @@ void USuperfamilyGameInstance::AddCoins(int32 Amount)
 	{
 		if (Profile.ChildID == ActiveChildID)
 		{
+			if (USuperfamilyProgressSyncSubsystem* ProgressSync = GetSubsystem<USuperfamilyProgressSyncSubsystem>())
+			{
+				ProgressSync->RecordCounter(Profile, EProgressCounter::Coins, Amount);
+			}
+
 			Profile.Coins += Amount;
+			MarkProfileDirty(ActiveChildID, EProfileSyncField::Coins);
 			SaveGame();
 			return;
 		}
@@ -279,7 +570,13 @@ bool USuperfamilyGameInstance::SpendCoins(int32 Amount)
 		{
 			if (Profile.Coins >= Amount)
 			{
+				if (USuperfamilyProgressSyncSubsystem* ProgressSync = GetSubsystem<USuperfamilyProgressSyncSubsystem>())
+				{
+					ProgressSync->RecordCounter(Profile, EProgressCounter::Coins, -Amount);
+				}
+
 				Profile.Coins -= Amount;
+				MarkProfileDirty(ActiveChildID, EProfileSyncField::Coins);
 				SaveGame();
 				return true;
 			}
@@ -299,7 +596,315 @@ int32 USuperfamilyGameInstance::GetXP() const
 	return GetActiveProfile().TotalXP;
 }
 
-FString USuperfamilyGameInstance::GetLevelKey(int32 WorldID, int32 LevelID)
+FChildProfile* USuperfamilyGameInstance::FindProfile(const FChildId& ChildID)
+{
+	if (!CurrentSaveGame)
+	{
+		return nullptr;
+	}
+
+	for (FChildProfile& Profile : CurrentSaveGame->ChildProfiles)
+	{
+		if (Profile.ChildID == ChildID)
+		{
+			return &Profile;
+		}
+	}
+	return nullptr;
+}
+
+// ============================================
+// Settings
+// ============================================
+
+void USuperfamilyGameInstance::SetAudioCulture(const FString& Culture)
+{
+	if (Culture.IsEmpty() || Culture == AudioCulture)
+	{
+		return;
+	}
+
+	AudioCulture = Culture;
+	OnAudioCultureChanged.Broadcast(AudioCulture);
+}
+
+// ============================================
+// Profile Sync
+// ============================================
+
+USuperfamilyGameInstance::FProfileSyncState& USuperfamilyGameInstance::MarkProfileDirty(const FChildId& ChildID, EProfileSyncField Fields)
+{
+	FProfileSyncState& State = ProfileSyncStates.FindOrAdd(ChildID);
+	State.DirtyFields |= Fields;
+
+	// Coalesce every change made this frame into a single delta
+	if (!DeltaFlushHandle.IsValid())
+	{
+		DeltaFlushHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float)
+		{
+			// Keep coalescing while the bridge's bulk lane is backed up
+			const URNUEBridgeSubsystem* Bridge = GetSubsystem<URNUEBridgeSubsystem>();
+			if (Bridge && Bridge->IsBulkLaneUnderPressure())
+			{
+				return true;
+			}
+
+			DeltaFlushHandle.Reset();
+			FlushProfileDeltas();
+			return false;
+		}));
+	}
+
+	return State;
+}
+
+void USuperfamilyGameInstance::FlushProfileDeltas()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyProfileSync);
+	CSV_SCOPED_TIMING_STAT(Superfamily, ProfileSync);
+
+	if (DeltaFlushHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(DeltaFlushHandle);
+		DeltaFlushHandle.Reset();
+	}
+
+	URNUEBridgeSubsystem* Bridge = GetSubsystem<URNUEBridgeSubsystem>();
+	if (!Bridge)
+	{
+		return;
+	}
+
+	for (TPair<FChildId, FProfileSyncState>& Pair : ProfileSyncStates)
+	{
+		const FChildProfile* Profile = FindProfile(Pair.Key);
+		if (!Profile)
+		{
+			Pair.Value.ClearChanges();
+			continue;
+		}
+
+		FString DeltaJSON;
+		if (BuildProfileDelta(*Profile, Pair.Value, DeltaJSON))
+		{
+			Bridge->SendProfileDelta(Pair.Key.ToString(), DeltaJSON);
+		}
+	}
+}
+
+void USuperfamilyGameInstance::SendProfileSnapshot(const FChildId& ChildID)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyProfileSync);
+	CSV_SCOPED_TIMING_STAT(Superfamily, ProfileSync);
+
+	const FChildProfile* Profile = FindProfile(ChildID);
+	URNUEBridgeSubsystem* Bridge = GetSubsystem<URNUEBridgeSubsystem>();
+	if (!Profile || !Bridge)
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> ProfileObject = FJsonObjectConverter::UStructToJsonObject(*Profile);
+	if (!ProfileObject.IsValid())
+	{
+		return;
+	}
+
+	// A snapshot supersedes any pending changes for this profile
+	FProfileSyncState& State = ProfileSyncStates.FindOrAdd(ChildID);
+	State.ClearChanges();
+	++State.Sequence;
+
+	TSharedRef<FJsonObject> Snapshot = MakeShared<FJsonObject>();
+	Snapshot->SetStringField(TEXT("childId"), ChildID.ToString());
+	Snapshot->SetStringField(TEXT("epoch"), SyncEpoch.ToString(EGuidFormats::Digits));
+	Snapshot->SetNumberField(TEXT("sequence"), State.Sequence);
+	Snapshot->SetObjectField(TEXT("profile"), ProfileObject);
+
+	FString SnapshotJSON;
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&SnapshotJSON);
+	FJsonSerializer::Serialize(Snapshot, Writer);
+
+	Bridge->SendProfileSnapshot(ChildID.ToString(), SnapshotJSON);
+}
+
+void USuperfamilyGameInstance::ApplySyncedProgress(const FChildId& ChildID, const FProgressCrdt& Progress, const FProgressChangeSet& Changes)
+{
+	FChildProfile* Profile = FindProfile(ChildID);
+	if (!Profile || Changes.IsEmpty())
+	{
+		return;
+	}
+
+	// Concurrent spends on two devices can take the merged balance below zero
+	EProfileSyncField Fields = EProfileSyncField::None;
+	if (Changes.bCounterChanged[static_cast<int32>(EProgressCounter::Coins)])
+	{
+		Profile->Coins = static_cast<int32>(FMath::Clamp<int64>(Progress.GetCounter(EProgressCounter::Coins), 0, MAX_int32));
+		Fields |= EProfileSyncField::Coins;
+	}
+	if (Changes.bCounterChanged[static_cast<int32>(EProgressCounter::XP)])
+	{
+		Profile->TotalXP = static_cast<int32>(FMath::Clamp<int64>(Progress.GetCounter(EProgressCounter::XP), 0, MAX_int32));
+		Fields |= EProfileSyncField::TotalXP;
+	}
+
+	FProfileSyncState& SyncState = MarkProfileDirty(ChildID, Fields);
+
+	for (const FLevelKey& LevelKey : Changes.Levels)
+	{
+		if (const FProgressLevelBest* Best = Progress.FindLevel(LevelKey))
+		{
+			FLevelProgress& LevelProgress = Profile->LevelProgress.FindOrAdd(LevelKey);
+			LevelProgress.bCompleted |= Best->bCompleted;
+			LevelProgress.StarsEarned = FMath::Max(LevelProgress.StarsEarned, Best->Stars);
+			LevelProgress.HighScore = FMath::Max(LevelProgress.HighScore, Best->HighScore);
+			LevelProgress.CoinsCollected = FMath::Max(LevelProgress.CoinsCollected, Best->Coins);
+			SyncState.DirtyLevels.Add(LevelKey);
+		}
+	}
+
+	TArray<FMissionId> AddedMissions;
+	for (const FMissionId& MissionID : Changes.Missions)
+	{
+		if (!Profile->CompletedMissions.Contains(MissionID))
+		{
+			Profile->CompletedMissions.Add(MissionID);
+			SyncState.NewMissions.Add(MissionID);
+			AddedMissions.Add(MissionID);
+		}
+	}
+
+	// Bits as well as IDs, so merged unlocks read the same as local ones
+	const USuperfamilyAchievementSubsystem* Achievements = GetSubsystem<USuperfamilyAchievementSubsystem>();
+	for (const FString& AchievementID : Changes.Achievements)
+	{
+		if (!Profile->UnlockedAchievements.Contains(AchievementID))
+		{
+			Profile->UnlockedAchievements.Add(AchievementID);
+			SyncState.NewAchievements.Add(AchievementID);
+		}
+
+		const int32 StableIndex = Achievements ? Achievements->GetStableIndex(FName(*AchievementID)) : INDEX_NONE;
+		if (StableIndex != INDEX_NONE)
+		{
+			const int32 Word = StableIndex / 32;
+			if (Profile->AchievementBits.Num() <= Word)
+			{
+				Profile->AchievementBits.SetNumZeroed(Word + 1);
+			}
+			Profile->AchievementBits[Word] |= 1u << (StableIndex % 32);
+		}
+	}
+
+	// After the loops: listeners may touch other profiles' sync state. State built
+	// from the profile is dropped first, so mission listeners see the merged profile
+	OnProfilesApplied.Broadcast(ChildID);
+	for (const FMissionId& MissionID : AddedMissions)
+	{
+		OnMissionRecorded.Broadcast(ChildID, MissionID);
+	}
+
+	SaveGame();
+}
+
+bool USuperfamilyGameInstance::BuildProfileDelta(const FChildProfile& Profile, FProfileSyncState& State, FString& OutJSON) const
+{
+	if (!State.HasChanges())
+	{
+		return false;
+	}
+
+	++State.Sequence;
+
+	TSharedRef<FJsonObject> Delta = MakeShared<FJsonObject>();
+	Delta->SetStringField(TEXT("childId"), Profile.ChildID.ToString());
+	Delta->SetStringField(TEXT("epoch"), SyncEpoch.ToString(EGuidFormats::Digits));
+	Delta->SetNumberField(TEXT("sequence"), State.Sequence);
+
+	// Counters carry absolute values so re-applying a delta is harmless
+	TSharedRef<FJsonObject> Counters = MakeShared<FJsonObject>();
+	if (EnumHasAnyFlags(State.DirtyFields, EProfileSyncField::Coins))
+	{
+		Counters->SetNumberField(TEXT("coins"), Profile.Coins);
+	}
+	if (EnumHasAnyFlags(State.DirtyFields, EProfileSyncField::TotalXP))
+	{
+		Counters->SetNumberField(TEXT("totalXP"), Profile.TotalXP);
+	}
+	if (Counters->Values.Num() > 0)
+	{
+		Delta->SetObjectField(TEXT("counters"), Counters);
+	}
+
+	if (State.DirtyLevels.Num() > 0)
+	{
+		TSharedRef<FJsonObject> Levels = MakeShared<FJsonObject>();
+		for (const FLevelKey& LevelKey : State.DirtyLevels)
+		{
+			if (const FLevelProgress* Progress = Profile.LevelProgress.Find(LevelKey))
+			{
+				Levels->SetObjectField(LevelKey.ToString(), FJsonObjectConverter::UStructToJsonObject(*Progress));
+			}
+		}
+		Delta->SetObjectField(TEXT("levelProgress"), Levels);
+	}
+
+	auto SetStringArray = [&Delta](const TCHAR* FieldName, const TArray<FString>& Values)
+	{
+		if (Values.Num() > 0)
+		{
+			TArray<TSharedPtr<FJsonValue>> JsonValues;
+			for (const FString& Value : Values)
+			{
+				JsonValues.Add(MakeShared<FJsonValueString>(Value));
+			}
+			Delta->SetArrayField(FieldName, JsonValues);
+		}
+	};
+
+	TArray<FString> NewMissionIDs;
+	for (const FMissionId& MissionID : State.NewMissions)
+	{
+		NewMissionIDs.Add(MissionID.ToString());
+	}
+	SetStringArray(TEXT("completedMissions"), NewMissionIDs);
+	SetStringArray(TEXT("unlockedAchievements"), State.NewAchievements);
+
+	State.ClearChanges();
+
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutJSON);
+	return FJsonSerializer::Serialize(Delta, Writer);
+}
+
+void USuperfamilyGameInstance::SendChildIdMigrations(const TMap<FString, FChildId>& LegacyChildIDs)
+{
+	URNUEBridgeSubsystem* Bridge = GetSubsystem<URNUEBridgeSubsystem>();
+	if (!Bridge)
+	{
+		return;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Migrations;
+	for (const TPair<FString, FChildId>& Pair : LegacyChildIDs)
+	{
+		TSharedRef<FJsonObject> Migration = MakeShared<FJsonObject>();
+		Migration->SetStringField(TEXT("legacyId"), Pair.Key);
+		Migration->SetStringField(TEXT("childId"), Pair.Value.ToString());
+		Migrations.Add(MakeShared<FJsonValueObject>(Migration));
+	}
+
+	TSharedRef<FJsonObject> Payload = MakeShared<FJsonObject>();
+	Payload->SetArrayField(TEXT("migrations"), Migrations);
+
+	FString PayloadJSON;
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&PayloadJSON);
+	FJsonSerializer::Serialize(Payload, Writer);
+
+	Bridge->SendChildIdsMigrated(PayloadJSON);
+}
+
+void USuperfamilyGameInstance::HandleProfileSnapshotRequested(const FString& ChildID)
 {
-	return FString::Printf(TEXT("W%dL%d"), WorldID, LevelID);
+	SendProfileSnapshot(FChildId::FromString(ChildID));
 }
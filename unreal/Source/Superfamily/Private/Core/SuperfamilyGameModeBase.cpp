@@ -1,7 +1,16 @@
 // Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
 
 #include "Core/SuperfamilyGameModeBase.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyBootSubsystem.h"
 #include "Core/SuperfamilyGameInstance.h"
+#include "Core/SuperfamilyLevelCatalogSubsystem.h"
+#include "Core/SuperfamilyStats.h"
+#include "Characters/SuperfamilyPlayerCharacter.h"
+#include "Gameplay/CollectibleFieldComponent.h"
+#include "EngineUtils.h"
+#include "Internationalization/Regex.h"
+#include "TimerManager.h"
 #include "Kismet/GameplayStatics.h"
 
 // ============================================
@@ -16,6 +25,16 @@ ASuperfamilyGameModeBase::ASuperfamilyGameModeBase()
 void ASuperfamilyGameModeBase::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Builds that start in a level never show the menu; the first map up is what GameReady waits for.
+	// The main menu completes it itself once the menu is up
+	if (!IsA<ASuperfamilyMainMenuGameMode>())
+	{
+		if (USuperfamilyBootSubsystem* Boot = GetGameInstance()->GetSubsystem<USuperfamilyBootSubsystem>())
+		{
+			Boot->CompleteStage(USuperfamilyBootSubsystem::MainMenuStage);
+		}
+	}
 }
 
 // ============================================
@@ -28,6 +47,16 @@ ASuperfamilyMainMenuGameMode::ASuperfamilyMainMenuGameMode()
 	DefaultPawnClass = nullptr;
 }
 
+void ASuperfamilyMainMenuGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (USuperfamilyBootSubsystem* Boot = GetGameInstance()->GetSubsystem<USuperfamilyBootSubsystem>())
+	{
+		Boot->CompleteStage(USuperfamilyBootSubsystem::MainMenuStage);
+	}
+}
+
 // ============================================
 // ASuperfamilyWorldMapGameMode
 // ============================================
@@ -52,43 +81,143 @@ void ASuperfamilyLevelGameMode::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Parse level name to get WorldID and LevelID
-	// Expected format: L_W01_Level05 or similar
-	FString LevelName = GetWorld()->GetMapName();
-	LevelName.RemoveFromStart(TEXT("UEDPIE_0_")); // Remove PIE prefix if present
+	LLM_SCOPE_BYTAG(Superfamily);
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyLevelSetup);
+	CSV_SCOPED_TIMING_STAT(Superfamily, LevelSetup);
+
+	USuperfamilyLevelCatalogSubsystem* LevelCatalog = GetGameInstance()->GetSubsystem<USuperfamilyLevelCatalogSubsystem>();
+	if (const FLevelCatalogEntry* Entry = LevelCatalog ? LevelCatalog->FindEntryForWorld(GetWorld()) : nullptr)
+	{
+		CatalogEntry = *Entry;
+		WorldID = Entry->WorldID;
+		LevelID = Entry->LevelID;
+	}
+	else
+	{
+		// Uncatalogued map (e.g. a test map): parse the name instead
+		// Format: L_W{World}_Level{Level} or L_W{World}_Level{Level}_Boss
+		const FString LevelName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+		FRegexPattern Pattern(TEXT("W(\\d+)_Level(\\d+)"));
+		FRegexMatcher Matcher(Pattern, LevelName);
+
+		if (Matcher.FindNext())
+		{
+			WorldID = FCString::Atoi(*Matcher.GetCaptureGroup(1));
+			LevelID = FCString::Atoi(*Matcher.GetCaptureGroup(2));
+		}
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Level started: World %d, Level %d"), WorldID, LevelID);
+	CSV_EVENT(Superfamily, TEXT("LevelStart W%dL%d"), WorldID, LevelID);
+
+	if (bManageActorTicks)
+	{
+		if (USuperfamilyTickManager* TickManager = GetWorld()->GetSubsystem<USuperfamilyTickManager>())
+		{
+			TickManager->Activate(TickBudget);
+		}
+	}
+
+	if (ActorPools.Num() > 0)
+	{
+		if (USuperfamilyActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<USuperfamilyActorPoolSubsystem>())
+		{
+			Pool->Prewarm(ActorPools);
+		}
+	}
+
+	if (bStreamLevelChunks && Streaming.Chunks.Num() > 0)
+	{
+		if (USuperfamilyLevelStreamingSubsystem* LevelStreaming = GetWorld()->GetSubsystem<USuperfamilyLevelStreamingSubsystem>())
+		{
+			LevelStreaming->Activate(Streaming);
+		}
+	}
+
+	// Load the next level in the background while this one is played
+	if (LevelCatalog && CatalogEntry.IsSet())
+	{
+		LevelCatalog->PrefetchNextLevel(CatalogEntry.GetValue());
+	}
+}
 
-	// Extract world and level numbers from name
-	// Format: L_W{World}_Level{Level} or L_W{World}_Level{Level}_Boss
-	FRegexPattern Pattern(TEXT("W(\\d+)_Level(\\d+)"));
-	FRegexMatcher Matcher(Pattern, LevelName);
+bool ASuperfamilyLevelGameMode::GetCatalogEntry(FLevelCatalogEntry& OutEntry) const
+{
+	if (!CatalogEntry.IsSet())
+	{
+		return false;
+	}
+
+	OutEntry = CatalogEntry.GetValue();
+	return true;
+}
+
+void ASuperfamilyLevelGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USuperfamilyTickManager* TickManager = GetWorld()->GetSubsystem<USuperfamilyTickManager>())
+	{
+		TickManager->Deactivate();
+	}
 
-	if (Matcher.FindNext())
+	if (USuperfamilyLevelStreamingSubsystem* LevelStreaming = GetWorld()->GetSubsystem<USuperfamilyLevelStreamingSubsystem>())
 	{
-		WorldID = FCString::Atoi(*Matcher.GetCaptureGroup(1));
-		LevelID = FCString::Atoi(*Matcher.GetCaptureGroup(2));
+		LevelStreaming->Deactivate();
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("Level started: World %d, Level %d"), WorldID, LevelID);
+	Super::EndPlay(EndPlayReason);
 }
 
 void ASuperfamilyLevelGameMode::OnLevelCompleted(int32 Stars, int32 Score)
 {
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyLevelResult);
+	CSV_SCOPED_TIMING_STAT(Superfamily, LevelResult);
+	CSV_EVENT(Superfamily, TEXT("LevelEnd W%dL%d completed"), WorldID, LevelID);
+
 	USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
 	if (GameInstance)
 	{
-		// Get coins collected from player character
-		// (This will be expanded when player character is fully implemented)
-		int32 CoinsCollected = 0;
+		const ASuperfamilyPlayerCharacter* Player = Cast<ASuperfamilyPlayerCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+		const int32 CoinsCollected = Player ? Player->GetSessionCoins() : 0;
 
 		GameInstance->RecordLevelCompletion(WorldID, LevelID, Stars, Score, CoinsCollected);
+
+		// The results screen is the boss's loading time
+		if (bPrepareNextBoss && !CatalogEntry.IsSet())
+		{
+			if (UBossEncounterPreloader* Preloader = GameInstance->GetSubsystem<UBossEncounterPreloader>())
+			{
+				Preloader->Prepare(NextBossEncounter);
+			}
+		}
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("Level completed: %d stars, %d score"), Stars, Score);
+	UE_LOG(LogSuperfamily, Log, TEXT("Level completed: %d stars, %d score"), Stars, Score);
+
+	OnLevelEnded.Broadcast(true);
+}
+
+void ASuperfamilyLevelGameMode::GetLevelCoinCounts(int32& Collected, int32& Total) const
+{
+	Collected = 0;
+	Total = 0;
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		TInlineComponentArray<UCollectibleFieldComponent*> Fields(*It);
+		for (const UCollectibleFieldComponent* Field : Fields)
+		{
+			Collected += Field->GetCollectedCoins();
+			Total += Field->GetTotalCoins();
+		}
+	}
 }
 
 void ASuperfamilyLevelGameMode::OnLevelFailed()
 {
-	UE_LOG(LogTemp, Log, TEXT("Level failed"));
+	UE_LOG(LogSuperfamily, Log, TEXT("Level failed"));
+	CSV_EVENT(Superfamily, TEXT("LevelEnd W%dL%d failed"), WorldID, LevelID);
+
+	OnLevelEnded.Broadcast(false);
 
 	// Respawn or return to world map - will be implemented in Blueprint
 }
@@ -102,3 +231,118 @@ ASuperfamilyBossGameMode::ASuperfamilyBossGameMode()
 	TotalQuestions = 5;
 	CurrentQuestionIndex = 0;
 }
+
+void ASuperfamilyBossGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (CatalogEntry.IsSet())
+	{
+		TotalQuestions = CatalogEntry->BossQuestionCount;
+	}
+
+	UBossEncounterPreloader* Preloader = GetGameInstance()->GetSubsystem<UBossEncounterPreloader>();
+	if (!Preloader)
+	{
+		StartEncounter();
+		return;
+	}
+
+	// Usually already prepared during the previous level's results screen
+	const FBossEncounterRequest Request = MakeEncounterRequest();
+	Preloader->Prepare(Request);
+	if (Preloader->IsPrepared(Request))
+	{
+		StartEncounter();
+		return;
+	}
+
+	LoadGateStartTime = FPlatformTime::Seconds();
+	Preloader->OnPrepared.AddDynamic(this, &ASuperfamilyBossGameMode::HandleEncounterPrepared);
+	GetWorldTimerManager().SetTimer(LoadGateTimer, this, &ASuperfamilyBossGameMode::HandleEncounterPrepared, MaxLoadGateSeconds, false);
+}
+
+void ASuperfamilyBossGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(LoadGateTimer);
+
+	if (UBossEncounterPreloader* Preloader = GetGameInstance()->GetSubsystem<UBossEncounterPreloader>())
+	{
+		Preloader->OnPrepared.RemoveDynamic(this, &ASuperfamilyBossGameMode::HandleEncounterPrepared);
+		Preloader->Release();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FBossEncounterRequest ASuperfamilyBossGameMode::MakeEncounterRequest() const
+{
+	// Must match what the previous level prefetched from the catalog
+	if (CatalogEntry.IsSet())
+	{
+		return USuperfamilyLevelCatalogSubsystem::MakeBossRequest(CatalogEntry.GetValue());
+	}
+
+	FBossEncounterRequest Request;
+	Request.WorldID = WorldID;
+	Request.Subject = BossSubject;
+	Request.Difficulty = BossDifficulty;
+	Request.QuestionCount = TotalQuestions;
+	return Request;
+}
+
+bool ASuperfamilyBossGameMode::GetCurrentQuestion(FQuestionData& OutQuestion) const
+{
+	const UBossEncounterPreloader* Preloader = GetGameInstance()->GetSubsystem<UBossEncounterPreloader>();
+	const FQuestionData* Question = Preloader ? Preloader->GetQuestion(CurrentQuestionIndex) : nullptr;
+	if (!Question)
+	{
+		return false;
+	}
+
+	OutQuestion = *Question;
+	return true;
+}
+
+bool ASuperfamilyBossGameMode::AdvanceQuestion()
+{
+	if (CurrentQuestionIndex + 1 >= TotalQuestions)
+	{
+		return false;
+	}
+
+	++CurrentQuestionIndex;
+	CSV_EVENT(Superfamily, TEXT("QuestionShown %d/%d"), CurrentQuestionIndex + 1, TotalQuestions);
+	return true;
+}
+
+void ASuperfamilyBossGameMode::HandleEncounterPrepared()
+{
+	if (bEncounterStarted)
+	{
+		return;
+	}
+
+	const float WaitSeconds = static_cast<float>(FPlatformTime::Seconds() - LoadGateStartTime);
+	UBossEncounterPreloader* Preloader = GetGameInstance()->GetSubsystem<UBossEncounterPreloader>();
+	if (Preloader && !Preloader->IsPrepared(MakeEncounterRequest()))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Boss load gate timed out after %.1fs; starting with content still loading"), WaitSeconds);
+	}
+	else
+	{
+		UE_LOG(LogSuperfamily, Log, TEXT("Boss load gate opened after %.2fs"), WaitSeconds);
+	}
+
+	StartEncounter();
+}
+
+void ASuperfamilyBossGameMode::StartEncounter()
+{
+	GetWorldTimerManager().ClearTimer(LoadGateTimer);
+
+	bEncounterStarted = true;
+	CurrentQuestionIndex = 0;
+	CSV_EVENT(Superfamily, TEXT("QuestionShown 1/%d"), TotalQuestions);
+	OnEncounterStarted.Broadcast();
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyLevelCatalog.h"
+#include "Superfamily.h"
+#include "Engine/World.h"
+#include "Internationalization/Regex.h"
+
+#if WITH_EDITOR
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+const FPrimaryAssetType USuperfamilyLevelCatalog::PrimaryAssetType(TEXT("LevelCatalog"));
+
+FPrimaryAssetId USuperfamilyLevelCatalog::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+const FLevelCatalogEntry* USuperfamilyLevelCatalog::FindEntry(int32 WorldID, int32 LevelID) const
+{
+	return Entries.FindByPredicate([WorldID, LevelID](const FLevelCatalogEntry& Entry)
+	{
+		return Entry.WorldID == WorldID && Entry.LevelID == LevelID;
+	});
+}
+
+const FLevelCatalogEntry* USuperfamilyLevelCatalog::FindEntryByPackage(const FString& PackageName) const
+{
+	const FString SearchName = UWorld::RemovePIEPrefix(PackageName);
+	return Entries.FindByPredicate([&SearchName](const FLevelCatalogEntry& Entry)
+	{
+		return Entry.Map.GetLongPackageName() == SearchName;
+	});
+}
+
+const FLevelCatalogEntry* USuperfamilyLevelCatalog::GetNextEntry(const FLevelCatalogEntry& Entry) const
+{
+	// Entry may be a copy, so find it by ID rather than by address
+	const int32 Index = Entries.IndexOfByPredicate([&Entry](const FLevelCatalogEntry& Candidate)
+	{
+		return Candidate.WorldID == Entry.WorldID && Candidate.LevelID == Entry.LevelID;
+	});
+	return Index != INDEX_NONE && Entries.IsValidIndex(Index + 1) ? &Entries[Index + 1] : nullptr;
+}
+
+#if WITH_EDITOR
+
+void USuperfamilyLevelCatalog::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	if (ObjectSaveContext.IsCooking())
+	{
+		RebuildFromMaps();
+	}
+
+	Super::PreSave(ObjectSaveContext);
+}
+
+void USuperfamilyLevelCatalog::RebuildFromMaps()
+{
+	if (MapsDirectory.Path.IsEmpty())
+	{
+		return;
+	}
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	TArray<FAssetData> MapAssets;
+	AssetRegistry.GetAssetsByPath(FName(*MapsDirectory.Path), MapAssets, true);
+
+	// Format: L_W{World}_Level{Level} or L_W{World}_Level{Level}_Boss
+	const FRegexPattern Pattern(TEXT("W(\\d+)_Level(\\d+)(_Boss)?"));
+
+	TArray<FLevelCatalogEntry> Rebuilt;
+	for (const FAssetData& Asset : MapAssets)
+	{
+		if (Asset.AssetClassPath != UWorld::StaticClass()->GetClassPathName())
+		{
+			continue;
+		}
+
+		FRegexMatcher Matcher(Pattern, Asset.AssetName.ToString());
+		if (!Matcher.FindNext())
+		{
+			continue;
+		}
+
+		const int32 WorldID = FCString::Atoi(*Matcher.GetCaptureGroup(1));
+		const int32 LevelID = FCString::Atoi(*Matcher.GetCaptureGroup(2));
+
+		// Keep authored data for levels that were already catalogued
+		const FLevelCatalogEntry* Existing = FindEntry(WorldID, LevelID);
+		FLevelCatalogEntry& Entry = Rebuilt.Add_GetRef(Existing ? *Existing : FLevelCatalogEntry());
+		Entry.WorldID = WorldID;
+		Entry.LevelID = LevelID;
+		Entry.Map = TSoftObjectPtr<UWorld>(Asset.GetSoftObjectPath());
+		Entry.bIsBoss = !Matcher.GetCaptureGroup(3).IsEmpty();
+	}
+
+	Rebuilt.Sort([](const FLevelCatalogEntry& A, const FLevelCatalogEntry& B)
+	{
+		return A.WorldID != B.WorldID ? A.WorldID < B.WorldID : A.LevelID < B.LevelID;
+	});
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Level catalog %s: %d levels (was %d)"), *GetName(), Rebuilt.Num(), Entries.Num());
+	Entries = MoveTemp(Rebuilt);
+}
+
+#endif // WITH_EDITOR
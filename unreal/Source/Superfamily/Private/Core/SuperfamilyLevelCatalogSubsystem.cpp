@@ -0,0 +1,296 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyLevelCatalogSubsystem.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyBootSubsystem.h"
+#include "Core/SuperfamilyStats.h"
+#include "Core/SuperfamilyWorldContentSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+
+void USuperfamilyLevelCatalogSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Loaded as a boot stage alongside the save and question packs instead of blocking Init
+	if (USuperfamilyBootSubsystem* Boot = Collection.InitializeDependency<USuperfamilyBootSubsystem>())
+	{
+		Boot->AddStage(USuperfamilyBootSubsystem::LevelCatalogStage, {}, [this](USuperfamilyBootSubsystem::FStageDone&& Done)
+		{
+			LoadCatalogAsync(MoveTemp(Done));
+		});
+	}
+
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &USuperfamilyLevelCatalogSubsystem::HandlePreLoadMap);
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &USuperfamilyLevelCatalogSubsystem::HandlePostLoadMap);
+}
+
+void USuperfamilyLevelCatalogSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	ReleasePrefetch();
+	TravelPackage = nullptr;
+	TravelWorld = nullptr;
+
+	if (CatalogHandle.IsValid())
+	{
+		CatalogHandle->CancelHandle();
+		CatalogHandle.Reset();
+	}
+
+	if (CurrentLevelContent.IsValid())
+	{
+		CurrentLevelContent->ReleaseHandle();
+		CurrentLevelContent.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+void USuperfamilyLevelCatalogSubsystem::LoadCatalogAsync(TFunction<void(bool)> OnLoaded)
+{
+	FSoftObjectPath CatalogPath = LevelCatalog.ToSoftObjectPath();
+	if (CatalogPath.IsNull() && UAssetManager::IsInitialized())
+	{
+		TArray<FSoftObjectPath> CatalogPaths;
+		UAssetManager::Get().GetPrimaryAssetPathList(USuperfamilyLevelCatalog::PrimaryAssetType, CatalogPaths);
+		if (CatalogPaths.Num() > 0)
+		{
+			CatalogPath = CatalogPaths[0];
+		}
+	}
+
+	auto FinishLoad = [this, CatalogPath, OnLoaded]()
+	{
+		Catalog = Cast<USuperfamilyLevelCatalog>(CatalogPath.ResolveObject());
+		if (!Catalog)
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("No level catalog found; level IDs fall back to map names and nothing is prefetched"));
+		}
+		OnLoaded(Catalog != nullptr);
+	};
+
+	if (CatalogPath.IsNull() || !UAssetManager::IsInitialized())
+	{
+		FinishLoad();
+		return;
+	}
+
+	CatalogHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(CatalogPath, FStreamableDelegate::CreateWeakLambda(this, FinishLoad));
+	if (!CatalogHandle.IsValid())
+	{
+		FinishLoad();
+	}
+}
+
+const USuperfamilyLevelCatalog* USuperfamilyLevelCatalogSubsystem::GetCatalog() const
+{
+	// A map opened directly (PIE, -game <map>) can begin play before the boot stage lands
+	if (!Catalog && CatalogHandle.IsValid() && CatalogHandle->IsLoadingInProgress())
+	{
+		CatalogHandle->WaitUntilComplete();
+		return Cast<USuperfamilyLevelCatalog>(CatalogHandle->GetLoadedAsset());
+	}
+	return Catalog;
+}
+
+const FLevelCatalogEntry* USuperfamilyLevelCatalogSubsystem::FindEntryForWorld(const UWorld* World) const
+{
+	const USuperfamilyLevelCatalog* LoadedCatalog = GetCatalog();
+	return LoadedCatalog && World ? LoadedCatalog->FindEntryByPackage(World->GetOutermost()->GetName()) : nullptr;
+}
+
+bool USuperfamilyLevelCatalogSubsystem::FindLevel(int32 WorldID, int32 LevelID, FLevelCatalogEntry& OutEntry) const
+{
+	const USuperfamilyLevelCatalog* LoadedCatalog = GetCatalog();
+	const FLevelCatalogEntry* Entry = LoadedCatalog ? LoadedCatalog->FindEntry(WorldID, LevelID) : nullptr;
+	if (!Entry)
+	{
+		return false;
+	}
+
+	OutEntry = *Entry;
+	return true;
+}
+
+bool USuperfamilyLevelCatalogSubsystem::GetNextLevel(int32 WorldID, int32 LevelID, FLevelCatalogEntry& OutEntry) const
+{
+	const USuperfamilyLevelCatalog* LoadedCatalog = GetCatalog();
+	const FLevelCatalogEntry* Entry = LoadedCatalog ? LoadedCatalog->FindEntry(WorldID, LevelID) : nullptr;
+	const FLevelCatalogEntry* Next = Entry ? LoadedCatalog->GetNextEntry(*Entry) : nullptr;
+	if (!Next)
+	{
+		return false;
+	}
+
+	OutEntry = *Next;
+	return true;
+}
+
+bool USuperfamilyLevelCatalogSubsystem::OpenLevel(int32 WorldID, int32 LevelID)
+{
+	const USuperfamilyLevelCatalog* LoadedCatalog = GetCatalog();
+	const FLevelCatalogEntry* Entry = LoadedCatalog ? LoadedCatalog->FindEntry(WorldID, LevelID) : nullptr;
+	if (!Entry || Entry->Map.IsNull())
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("World %d level %d is not in the level catalog"), WorldID, LevelID);
+		return false;
+	}
+
+	// A world past the install may still have to be downloaded; travel once it is mounted
+	USuperfamilyWorldContentSubsystem* WorldContent = GetGameInstance()->GetSubsystem<USuperfamilyWorldContentSubsystem>();
+	if (WorldContent && !WorldContent->IsWorldReady(WorldID))
+	{
+		WorldContent->RequestWorld(WorldID, [WeakThis = TWeakObjectPtr<USuperfamilyLevelCatalogSubsystem>(this), Map = Entry->Map, WorldID, LevelID](bool bReady)
+		{
+			if (!bReady)
+			{
+				UE_LOG(LogSuperfamily, Warning, TEXT("World %d level %d can't be opened: its content is not available"), WorldID, LevelID);
+			}
+			else if (USuperfamilyLevelCatalogSubsystem* This = WeakThis.Get())
+			{
+				UGameplayStatics::OpenLevelBySoftObjectPtr(This->GetGameInstance(), Map);
+			}
+		});
+		return true;
+	}
+
+	UGameplayStatics::OpenLevelBySoftObjectPtr(GetGameInstance(), Entry->Map);
+	return true;
+}
+
+FBossEncounterRequest USuperfamilyLevelCatalogSubsystem::MakeBossRequest(const FLevelCatalogEntry& Entry)
+{
+	FBossEncounterRequest Request;
+	Request.WorldID = Entry.WorldID;
+	Request.Subject = Entry.Subject;
+	Request.Difficulty = Entry.Difficulty;
+	Request.QuestionCount = Entry.BossQuestionCount;
+	return Request;
+}
+
+void USuperfamilyLevelCatalogSubsystem::PrefetchNextLevel(const FLevelCatalogEntry& Current)
+{
+	LLM_SCOPE_BYTAG(Superfamily);
+
+	const USuperfamilyLevelCatalog* LoadedCatalog = GetCatalog();
+	const FLevelCatalogEntry* Next = LoadedCatalog ? LoadedCatalog->GetNextEntry(Current) : nullptr;
+	if (!Next)
+	{
+		return;
+	}
+
+	ReleasePrefetch();
+	PrefetchStartTime = FPlatformTime::Seconds();
+
+	// A next world still downloading has no map or content to load yet
+	const USuperfamilyWorldContentSubsystem* WorldContent = GetGameInstance()->GetSubsystem<USuperfamilyWorldContentSubsystem>();
+	const bool bNextWorldReady = !WorldContent || WorldContent->IsWorldReady(Next->WorldID);
+
+	if (bNextWorldReady && Next->RequiredContent.Num() > 0)
+	{
+		PrefetchedContent = UAssetManager::GetStreamableManager().RequestAsyncLoad(Next->RequiredContent, FStreamableDelegate(), FStreamableManager::DefaultAsyncLoadPriority);
+	}
+
+	// A boss's questions come from the question provider, so prepare them through the boss preloader
+	if (Next->bIsBoss)
+	{
+		if (UBossEncounterPreloader* Preloader = GetGameInstance()->GetSubsystem<UBossEncounterPreloader>())
+		{
+			Preloader->Prepare(MakeBossRequest(*Next));
+		}
+	}
+
+	// PIE duplicates maps on open, so a prefetched package wouldn't be reused there
+	const UWorld* World = GetGameInstance()->GetWorld();
+	if (bPrefetchNextMap && bNextWorldReady && !Next->Map.IsNull() && World && !World->IsPlayInEditor())
+	{
+		PrefetchingPackageName = FName(*Next->Map.GetLongPackageName());
+		LoadPackageAsync(PrefetchingPackageName.ToString(),
+			FLoadPackageAsyncDelegate::CreateUObject(this, &USuperfamilyLevelCatalogSubsystem::HandleMapPackageLoaded));
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Prefetching world %d level %d (%d content assets%s)"),
+		Next->WorldID, Next->LevelID, Next->RequiredContent.Num(), Next->bIsBoss ? TEXT(", boss questions") : TEXT(""));
+}
+
+int64 USuperfamilyLevelCatalogSubsystem::GetBudgetedMemoryBytes() const
+{
+	// Only the prefetched content is measured; a map's size isn't known until its level is instanced
+	return PrefetchedContent.IsValid() ? GetLoadedAssetBytes(*PrefetchedContent) : 0;
+}
+
+int64 USuperfamilyLevelCatalogSubsystem::TrimMemory(int64 BytesToFree)
+{
+	if (!PrefetchedContent.IsValid() && !PrefetchedPackage && PrefetchingPackageName.IsNone())
+	{
+		return 0;
+	}
+
+	// The next transition loads normally instead
+	const int64 Bytes = GetBudgetedMemoryBytes();
+	ReleasePrefetch();
+	UE_LOG(LogSuperfamily, Log, TEXT("Dropped next-level prefetch to free memory"));
+	return Bytes;
+}
+
+void USuperfamilyLevelCatalogSubsystem::HandleMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+{
+	// Released or superseded while loading
+	if (PackageName != PrefetchingPackageName)
+	{
+		return;
+	}
+
+	if (Result != EAsyncLoadingResult::Succeeded || !LoadedPackage)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Prefetch of %s failed"), *PackageName.ToString());
+		return;
+	}
+
+	// Referencing the world keeps its level and actors alive through the travel GC
+	PrefetchedPackage = LoadedPackage;
+	PrefetchedWorld = UWorld::FindWorldInPackage(LoadedPackage);
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Prefetched %s in %.2fs"), *PackageName.ToString(), FPlatformTime::Seconds() - PrefetchStartTime);
+}
+
+void USuperfamilyLevelCatalogSubsystem::HandlePreLoadMap(const FString& MapName)
+{
+	// Hand over before the new level's BeginPlay starts prefetching the level after it.
+	// The prefetched content now belongs to the level being loaded.
+	if (CurrentLevelContent.IsValid())
+	{
+		CurrentLevelContent->ReleaseHandle();
+	}
+	CurrentLevelContent = MoveTemp(PrefetchedContent);
+
+	// The prefetched map must survive the travel GC; it is let go once the load is done
+	TravelPackage = PrefetchedPackage;
+	TravelWorld = PrefetchedWorld;
+	ReleasePrefetch();
+}
+
+void USuperfamilyLevelCatalogSubsystem::HandlePostLoadMap(UWorld* LoadedWorld)
+{
+	// Whether or not the prefetched map was the one opened, it is no longer ours to hold
+	TravelPackage = nullptr;
+	TravelWorld = nullptr;
+}
+
+void USuperfamilyLevelCatalogSubsystem::ReleasePrefetch()
+{
+	if (PrefetchedContent.IsValid())
+	{
+		PrefetchedContent->ReleaseHandle();
+		PrefetchedContent.Reset();
+	}
+
+	PrefetchedPackage = nullptr;
+	PrefetchedWorld = nullptr;
+	PrefetchingPackageName = NAME_None;
+}
@@ -0,0 +1,209 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyMemoryMonitor.h"
+#include "Superfamily.h"
+#include "Core/MemoryBudgetClient.h"
+#include "Core/SuperfamilyStats.h"
+#include "Engine/GameInstance.h"
+#include "Engine/Level.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/CoreDelegates.h"
+#include "RNUEBridgeSubsystem.h"
+
+const FName USuperfamilyMemoryMonitor::BridgeBudgetName(TEXT("Bridge"));
+
+int64 IMemoryBudgetClient::GetLoadedAssetBytes(const FStreamableHandle& Handle)
+{
+	TArray<UObject*> Assets;
+	Handle.GetLoadedAssets(Assets);
+
+	int64 Bytes = 0;
+	for (const UObject* Asset : Assets)
+	{
+		if (Asset)
+		{
+			Bytes += Asset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		}
+	}
+	return Bytes;
+}
+
+int64 IMemoryBudgetClient::GetLoadedLevelBytes(const ULevelStreaming& Streaming)
+{
+	// EstimatedTotal recurses through outered objects: the level, its actors and their components
+	const ULevel* Level = Streaming.GetLoadedLevel();
+	const UWorld* LevelWorld = Level ? Level->GetTypedOuter<UWorld>() : nullptr;
+	return LevelWorld ? LevelWorld->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal) : 0;
+}
+
+void USuperfamilyMemoryMonitor::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &USuperfamilyMemoryMonitor::Tick), FMath::Max(0.1f, CheckIntervalSeconds));
+	MemoryTrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddUObject(this, &USuperfamilyMemoryMonitor::HandlePlatformMemoryTrim);
+}
+
+void USuperfamilyMemoryMonitor::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimHandle);
+
+	Super::Deinitialize();
+}
+
+bool USuperfamilyMemoryMonitor::Tick(float DeltaTime)
+{
+	LLM_SCOPE_BYTAG(Superfamily);
+
+	if (LowMemoryAvailableMB > 0)
+	{
+		const uint64 AvailableMB = FPlatformMemory::GetStats().AvailablePhysical / (1024 * 1024);
+		const bool bLowMemory = AvailableMB < static_cast<uint64>(LowMemoryAvailableMB);
+
+		// Once per dip, so a device that stays low isn't trimmed every check
+		if (bLowMemory && !bLowMemoryTrimmed)
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Only %llu MB available; trimming all caches"), AvailableMB);
+			TrimAll();
+		}
+		bLowMemoryTrimmed = bLowMemory;
+	}
+
+	CheckBudgets();
+	return true;
+}
+
+void USuperfamilyMemoryMonitor::HandlePlatformMemoryTrim()
+{
+	UE_LOG(LogSuperfamily, Warning, TEXT("Platform requested a memory trim"));
+	TrimAll();
+}
+
+void USuperfamilyMemoryMonitor::CheckBudgets()
+{
+	TArray<IMemoryBudgetClient*> Clients;
+	GatherClients(Clients);
+
+	TMap<FName, int64> UsedBytes;
+	UsedBytes.Add(BridgeBudgetName, GetBridgeQueuedBytes());
+	for (const IMemoryBudgetClient* Client : Clients)
+	{
+		UsedBytes.FindOrAdd(Client->GetMemoryBudgetName()) += Client->GetBudgetedMemoryBytes();
+	}
+
+	Usage.Reset(UsedBytes.Num());
+	for (const TPair<FName, int64>& Pair : UsedBytes)
+	{
+		FMemoryBudgetUsage& BudgetUsage = Usage.AddDefaulted_GetRef();
+		BudgetUsage.Budget = Pair.Key;
+		BudgetUsage.UsedBytes = Pair.Value;
+
+		const int32* BudgetMB = BudgetsMB.Find(Pair.Key);
+		BudgetUsage.BudgetBytes = BudgetMB ? static_cast<int64>(*BudgetMB) * 1024 * 1024 : 0;
+
+		if (BudgetUsage.BudgetBytes <= 0 || BudgetUsage.UsedBytes <= BudgetUsage.BudgetBytes)
+		{
+			// Back under with some margin before warning again
+			if (BudgetUsage.UsedBytes < BudgetUsage.BudgetBytes * 9 / 10)
+			{
+				OverBudget.Remove(Pair.Key);
+			}
+			PublishUsage(BudgetUsage);
+			continue;
+		}
+
+		int64 Freed = 0;
+		for (IMemoryBudgetClient* Client : Clients)
+		{
+			if (Client->GetMemoryBudgetName() == Pair.Key && BudgetUsage.UsedBytes - Freed > BudgetUsage.BudgetBytes)
+			{
+				Freed += Client->TrimMemory(BudgetUsage.UsedBytes - Freed - BudgetUsage.BudgetBytes);
+			}
+		}
+
+		if (!OverBudget.Contains(Pair.Key))
+		{
+			OverBudget.Add(Pair.Key);
+			UE_LOG(LogSuperfamily, Warning, TEXT("Memory budget %s exceeded: %.1f MB of %.1f MB, trimmed %.1f MB"),
+				*Pair.Key.ToString(), BudgetUsage.UsedBytes / (1024.0 * 1024.0), BudgetUsage.BudgetBytes / (1024.0 * 1024.0), Freed / (1024.0 * 1024.0));
+		}
+
+		BudgetUsage.UsedBytes -= Freed;
+		PublishUsage(BudgetUsage);
+	}
+}
+
+void USuperfamilyMemoryMonitor::TrimAll()
+{
+	TArray<IMemoryBudgetClient*> Clients;
+	GatherClients(Clients);
+
+	int64 Freed = 0;
+	for (IMemoryBudgetClient* Client : Clients)
+	{
+		Freed += Client->TrimMemory(MAX_int64);
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Trimmed %.1f MB of cached memory"), Freed / (1024.0 * 1024.0));
+}
+
+void USuperfamilyMemoryMonitor::GatherClients(TArray<IMemoryBudgetClient*>& OutClients) const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	if (IMemoryBudgetClient* GameInstanceClient = Cast<IMemoryBudgetClient>(GameInstance))
+	{
+		OutClients.Add(GameInstanceClient);
+	}
+
+	for (UGameInstanceSubsystem* Subsystem : GameInstance->GetSubsystemArray<UGameInstanceSubsystem>())
+	{
+		if (IMemoryBudgetClient* Client = Cast<IMemoryBudgetClient>(Subsystem))
+		{
+			OutClients.Add(Client);
+		}
+	}
+
+	if (UWorld* World = GameInstance->GetWorld())
+	{
+		for (UWorldSubsystem* Subsystem : World->GetSubsystemArray<UWorldSubsystem>())
+		{
+			if (IMemoryBudgetClient* Client = Cast<IMemoryBudgetClient>(Subsystem))
+			{
+				OutClients.Add(Client);
+			}
+		}
+	}
+}
+
+int64 USuperfamilyMemoryMonitor::GetBridgeQueuedBytes() const
+{
+	// The bridge bounds its own queues, so it is measured but never asked to trim
+	const URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>();
+	if (!Bridge)
+	{
+		return 0;
+	}
+
+	return Bridge->GetQueuedMemoryBytes();
+}
+
+void USuperfamilyMemoryMonitor::PublishUsage(const FMemoryBudgetUsage& BudgetUsage)
+{
+#if STATS
+	TStatId* StatId = BudgetStats.Find(BudgetUsage.Budget);
+	if (!StatId)
+	{
+		StatId = &BudgetStats.Add(BudgetUsage.Budget,
+			FDynamicStats::CreateMemoryStatId<FStatGroup_STATGROUP_Superfamily>(FName(*FString::Printf(TEXT("Budget %s"), *BudgetUsage.Budget.ToString()))));
+	}
+	SET_MEMORY_STAT_FName(StatId->GetName(), BudgetUsage.UsedBytes);
+#endif
+
+#if CSV_PROFILER
+	FCsvProfiler::RecordCustomStat(BudgetUsage.Budget, CSV_CATEGORY_INDEX(Superfamily), static_cast<float>(BudgetUsage.UsedBytes / (1024.0 * 1024.0)), ECsvCustomStatOp::Set);
+#endif
+}
@@ -0,0 +1,707 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyProgressCrdt.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyStats.h"
+#include "Algo/BinarySearch.h"
+#include "Dom/JsonObject.h"
+
+namespace SuperfamilyProgressCrdt
+{
+	/** Compact once this many log entries are superseded and they outnumber the elements */
+	static constexpr int32 MinStaleEntriesToCompact = 64;
+
+	static const TCHAR* CounterNames[] = { TEXT("coins"), TEXT("xp") };
+	static_assert(UE_ARRAY_COUNT(CounterNames) == static_cast<int32>(EProgressCounter::Num), "Name every counter");
+
+	static bool ParseCounter(const FString& Name, EProgressCounter& OutCounter)
+	{
+		for (int32 Index = 0; Index < UE_ARRAY_COUNT(CounterNames); ++Index)
+		{
+			if (Name == CounterNames[Index])
+			{
+				OutCounter = static_cast<EProgressCounter>(Index);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static FString DeviceToString(const FGuid& Device)
+	{
+		return Device.IsValid() ? Device.ToString(EGuidFormats::Digits) : FString();
+	}
+
+	static FGuid DeviceFromString(const FString& String)
+	{
+		FGuid Device;
+		FGuid::Parse(String, Device);
+		return Device;
+	}
+
+	static void WriteDot(FJsonObject& Object, const FProgressDot& Dot)
+	{
+		Object.SetStringField(TEXT("origin"), DeviceToString(Dot.Device));
+		Object.SetNumberField(TEXT("version"), Dot.Version);
+	}
+
+	static bool ReadDot(const FJsonObject& Object, FProgressDot& OutDot)
+	{
+		FString Origin;
+		uint32 Version = 0;
+		if (!Object.TryGetStringField(TEXT("origin"), Origin) || !Object.TryGetNumberField(TEXT("version"), Version))
+		{
+			return false;
+		}
+		OutDot.Device = DeviceFromString(Origin);
+		OutDot.Version = Version;
+		return OutDot.Device.IsValid() && OutDot.Version > 0;
+	}
+
+	static int64 GetInt64Field(const FJsonObject& Object, const TCHAR* Field)
+	{
+		int64 Value = 0;
+		Object.TryGetNumberField(Field, Value);
+		return FMath::Max<int64>(Value, 0);
+	}
+
+	static int32 GetInt32Field(const FJsonObject& Object, const TCHAR* Field)
+	{
+		int32 Value = 0;
+		Object.TryGetNumberField(Field, Value);
+		return FMath::Max(Value, 0);
+	}
+}
+
+static FArchive& operator<<(FArchive& Ar, FProgressDot& Dot)
+{
+	Ar << Dot.Device;
+	Ar << Dot.Version;
+	return Ar;
+}
+
+// ============================================
+// FProgressVersionVector
+// ============================================
+
+void FProgressVersionVector::Add(const FProgressDot& Dot)
+{
+	uint32& Version = Versions.FindOrAdd(Dot.Device);
+	Version = FMath::Max(Version, Dot.Version);
+}
+
+void FProgressVersionVector::Merge(const FProgressVersionVector& Other)
+{
+	for (const TPair<FGuid, uint32>& Pair : Other.Versions)
+	{
+		Add(FProgressDot{ Pair.Key, Pair.Value });
+	}
+}
+
+TSharedRef<FJsonObject> FProgressVersionVector::ToJson() const
+{
+	TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+	for (const TPair<FGuid, uint32>& Pair : Versions)
+	{
+		Object->SetNumberField(SuperfamilyProgressCrdt::DeviceToString(Pair.Key), Pair.Value);
+	}
+	return Object;
+}
+
+FProgressVersionVector FProgressVersionVector::FromJson(const FJsonObject& Object)
+{
+	FProgressVersionVector Vector;
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Object.Values)
+	{
+		const FGuid Device = SuperfamilyProgressCrdt::DeviceFromString(Pair.Key);
+		uint32 Version = 0;
+		if (Device.IsValid() && Pair.Value.IsValid() && Pair.Value->TryGetNumber(Version) && Version > 0)
+		{
+			Vector.Add(FProgressDot{ Device, Version });
+		}
+	}
+	return Vector;
+}
+
+FArchive& operator<<(FArchive& Ar, FProgressVersionVector& Vector)
+{
+	Ar << Vector.Versions;
+	return Ar;
+}
+
+// ============================================
+// Local Changes
+// ============================================
+
+void FProgressCrdt::AddToCounter(EProgressCounter Counter, int64 Amount)
+{
+	if (Amount == 0)
+	{
+		return;
+	}
+
+	const int32 Slot = FindOrAddCounterEntry(Counter, LocalDevice);
+	FCounterEntry& Entry = CounterEntries[Slot];
+	if (Amount > 0)
+	{
+		Entry.Added += Amount;
+	}
+	else
+	{
+		Entry.Removed -= Amount;
+	}
+	CounterTotals[static_cast<int32>(Counter)] += Amount;
+
+	Stamp(EElementKind::Counter, Slot, NextLocalDot());
+}
+
+void FProgressCrdt::RaiseCounterBaseline(EProgressCounter Counter, int64 Value)
+{
+	const int32 Slot = FindOrAddCounterEntry(Counter, FGuid());
+	FCounterEntry& Entry = CounterEntries[Slot];
+	if (Value <= Entry.Added)
+	{
+		return;
+	}
+
+	CounterTotals[static_cast<int32>(Counter)] += Value - Entry.Added;
+	Entry.Added = Value;
+
+	Stamp(EElementKind::Counter, Slot, NextLocalDot());
+}
+
+void FProgressCrdt::RaiseCounterTotal(EProgressCounter Counter, int64 Value)
+{
+	const int64 Shortfall = Value - GetCounter(Counter);
+	if (Shortfall <= 0)
+	{
+		return;
+	}
+
+	const int32* Slot = CounterSlots[static_cast<int32>(Counter)].Find(FGuid());
+	RaiseCounterBaseline(Counter, (Slot ? CounterEntries[*Slot].Added : 0) + Shortfall);
+}
+
+bool FProgressCrdt::RecordLevel(const FLevelKey& Level, const FProgressLevelBest& Result)
+{
+	int32 Slot = LevelSlots.FindRef(Level, INDEX_NONE);
+	if (Slot == INDEX_NONE)
+	{
+		Slot = LevelEntries.Add(FLevelEntry{ Level });
+		LevelSlots.Add(Level, Slot);
+	}
+
+	FLevelEntry& Entry = LevelEntries[Slot];
+	if (Entry.Dot.Version > 0 && Entry.Best.Covers(Result))
+	{
+		return false;
+	}
+
+	Entry.Best.Join(Result);
+	Stamp(EElementKind::Level, Slot, NextLocalDot());
+	return true;
+}
+
+bool FProgressCrdt::AddMission(const FMissionId& MissionID)
+{
+	if (!MissionID.IsValid() || MissionSlots.Contains(MissionID))
+	{
+		return false;
+	}
+
+	const int32 Slot = MissionEntries.Add(FMissionEntry{ MissionID });
+	MissionSlots.Add(MissionID, Slot);
+	Stamp(EElementKind::Mission, Slot, NextLocalDot());
+	return true;
+}
+
+bool FProgressCrdt::AddAchievement(const FString& AchievementID)
+{
+	if (AchievementID.IsEmpty() || AchievementSlots.Contains(AchievementID))
+	{
+		return false;
+	}
+
+	const int32 Slot = AchievementEntries.Add(FAchievementEntry{ AchievementID });
+	AchievementSlots.Add(AchievementID, Slot);
+	Stamp(EElementKind::Achievement, Slot, NextLocalDot());
+	return true;
+}
+
+const FProgressLevelBest* FProgressCrdt::FindLevel(const FLevelKey& Level) const
+{
+	const int32* Slot = LevelSlots.Find(Level);
+	return Slot ? &LevelEntries[*Slot].Best : nullptr;
+}
+
+// ============================================
+// Sync
+// ============================================
+
+bool FProgressCrdt::HasChangesSince(const FProgressVersionVector& Since) const
+{
+	for (const TPair<FGuid, TArray<FLogEntry>>& Pair : Logs)
+	{
+		const TArray<FLogEntry>& Log = Pair.Value;
+		const uint32 SeenVersion = Since.Get(Pair.Key);
+		const int32 First = Algo::UpperBoundBy(Log, SeenVersion, &FLogEntry::Version);
+		for (int32 Index = First; Index < Log.Num(); ++Index)
+		{
+			if (GetDot(Log[Index].Kind, Log[Index].Slot) == FProgressDot{ Pair.Key, Log[Index].Version })
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+TSharedRef<FJsonObject> FProgressCrdt::BuildDelta(const FProgressVersionVector& Since) const
+{
+	using namespace SuperfamilyProgressCrdt;
+
+	TArray<TSharedPtr<FJsonValue>> Counters;
+	TArray<TSharedPtr<FJsonValue>> Levels;
+	TArray<TSharedPtr<FJsonValue>> Missions;
+	TArray<TSharedPtr<FJsonValue>> Achievements;
+
+	for (const TPair<FGuid, TArray<FLogEntry>>& Pair : Logs)
+	{
+		const TArray<FLogEntry>& Log = Pair.Value;
+		const int32 First = Algo::UpperBoundBy(Log, Since.Get(Pair.Key), &FLogEntry::Version);
+		for (int32 Index = First; Index < Log.Num(); ++Index)
+		{
+			const FLogEntry& Change = Log[Index];
+			const FProgressDot& Dot = GetDot(Change.Kind, Change.Slot);
+			if (Dot != FProgressDot{ Pair.Key, Change.Version })
+			{
+				// The element changed again; its newer dot is in a log too
+				continue;
+			}
+
+			TSharedRef<FJsonObject> Element = MakeShared<FJsonObject>();
+			WriteDot(*Element, Dot);
+
+			switch (Change.Kind)
+			{
+			case EElementKind::Counter:
+			{
+				const FCounterEntry& Entry = CounterEntries[Change.Slot];
+				Element->SetStringField(TEXT("counter"), CounterNames[static_cast<int32>(Entry.Counter)]);
+				Element->SetStringField(TEXT("owner"), DeviceToString(Entry.Owner));
+				Element->SetNumberField(TEXT("added"), Entry.Added);
+				Element->SetNumberField(TEXT("removed"), Entry.Removed);
+				Counters.Add(MakeShared<FJsonValueObject>(Element));
+				break;
+			}
+			case EElementKind::Level:
+			{
+				const FLevelEntry& Entry = LevelEntries[Change.Slot];
+				Element->SetStringField(TEXT("level"), Entry.Level.ToString());
+				Element->SetBoolField(TEXT("completed"), Entry.Best.bCompleted);
+				Element->SetNumberField(TEXT("stars"), Entry.Best.Stars);
+				Element->SetNumberField(TEXT("highScore"), Entry.Best.HighScore);
+				Element->SetNumberField(TEXT("coins"), Entry.Best.Coins);
+				Levels.Add(MakeShared<FJsonValueObject>(Element));
+				break;
+			}
+			case EElementKind::Mission:
+				Element->SetStringField(TEXT("id"), MissionEntries[Change.Slot].MissionID.ToString());
+				Missions.Add(MakeShared<FJsonValueObject>(Element));
+				break;
+			case EElementKind::Achievement:
+				Element->SetStringField(TEXT("id"), AchievementEntries[Change.Slot].AchievementID);
+				Achievements.Add(MakeShared<FJsonValueObject>(Element));
+				break;
+			}
+		}
+	}
+
+	TSharedRef<FJsonObject> Delta = MakeShared<FJsonObject>();
+	Delta->SetObjectField(TEXT("vv"), Seen.ToJson());
+	Delta->SetArrayField(TEXT("counters"), Counters);
+	Delta->SetArrayField(TEXT("levels"), Levels);
+	Delta->SetArrayField(TEXT("missions"), Missions);
+	Delta->SetArrayField(TEXT("achievements"), Achievements);
+	return Delta;
+}
+
+bool FProgressCrdt::MergeDelta(const FJsonObject& Delta, FProgressChangeSet& OutChanges)
+{
+	using namespace SuperfamilyProgressCrdt;
+
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyProgressMerge);
+
+	const TSharedPtr<FJsonObject>* VersionVector = nullptr;
+	if (!Delta.TryGetObjectField(TEXT("vv"), VersionVector))
+	{
+		return false;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Elements = nullptr;
+	FProgressDot Dot;
+
+	if (Delta.TryGetArrayField(TEXT("counters"), Elements))
+	{
+		for (const TSharedPtr<FJsonValue>& Value : *Elements)
+		{
+			const TSharedPtr<FJsonObject> Element = Value->AsObject();
+			EProgressCounter Counter;
+			if (!Element.IsValid() || !ReadDot(*Element, Dot) || Seen.Includes(Dot) || !ParseCounter(Element->GetStringField(TEXT("counter")), Counter))
+			{
+				continue;
+			}
+			MergeCounter(Counter, DeviceFromString(Element->GetStringField(TEXT("owner"))),
+				GetInt64Field(*Element, TEXT("added")), GetInt64Field(*Element, TEXT("removed")), Dot, OutChanges);
+		}
+	}
+
+	if (Delta.TryGetArrayField(TEXT("levels"), Elements))
+	{
+		for (const TSharedPtr<FJsonValue>& Value : *Elements)
+		{
+			const TSharedPtr<FJsonObject> Element = Value->AsObject();
+			if (!Element.IsValid() || !ReadDot(*Element, Dot) || Seen.Includes(Dot))
+			{
+				continue;
+			}
+
+			const FLevelKey Level = FLevelKey::FromString(Element->GetStringField(TEXT("level")));
+			if (!Level.IsValid())
+			{
+				continue;
+			}
+
+			FProgressLevelBest Best;
+			Best.bCompleted = Element->GetBoolField(TEXT("completed"));
+			Best.Stars = GetInt32Field(*Element, TEXT("stars"));
+			Best.HighScore = GetInt32Field(*Element, TEXT("highScore"));
+			Best.Coins = GetInt32Field(*Element, TEXT("coins"));
+			MergeLevel(Level, Best, Dot, OutChanges);
+		}
+	}
+
+	if (Delta.TryGetArrayField(TEXT("missions"), Elements))
+	{
+		for (const TSharedPtr<FJsonValue>& Value : *Elements)
+		{
+			const TSharedPtr<FJsonObject> Element = Value->AsObject();
+			if (!Element.IsValid() || !ReadDot(*Element, Dot) || Seen.Includes(Dot))
+			{
+				continue;
+			}
+
+			const FMissionId MissionID = FMissionId::FromString(Element->GetStringField(TEXT("id")));
+			if (MissionID.IsValid() && !MissionSlots.Contains(MissionID))
+			{
+				const int32 Slot = MissionEntries.Add(FMissionEntry{ MissionID });
+				MissionSlots.Add(MissionID, Slot);
+				Stamp(EElementKind::Mission, Slot, Dot);
+				OutChanges.Missions.Add(MissionID);
+			}
+		}
+	}
+
+	if (Delta.TryGetArrayField(TEXT("achievements"), Elements))
+	{
+		for (const TSharedPtr<FJsonValue>& Value : *Elements)
+		{
+			const TSharedPtr<FJsonObject> Element = Value->AsObject();
+			if (!Element.IsValid() || !ReadDot(*Element, Dot) || Seen.Includes(Dot))
+			{
+				continue;
+			}
+
+			const FString AchievementID = Element->GetStringField(TEXT("id"));
+			if (!AchievementID.IsEmpty() && !AchievementSlots.Contains(AchievementID))
+			{
+				const int32 Slot = AchievementEntries.Add(FAchievementEntry{ AchievementID });
+				AchievementSlots.Add(AchievementID, Slot);
+				Stamp(EElementKind::Achievement, Slot, Dot);
+				OutChanges.Achievements.Add(AchievementID);
+			}
+		}
+	}
+
+	// The delta held everything the sender had beyond what we had seen, so we have now seen what it has
+	Seen.Merge(FProgressVersionVector::FromJson(**VersionVector));
+
+	return true;
+}
+
+// ============================================
+// Elements
+// ============================================
+
+const FProgressDot& FProgressCrdt::GetDot(EElementKind Kind, int32 Slot) const
+{
+	switch (Kind)
+	{
+	case EElementKind::Counter:     return CounterEntries[Slot].Dot;
+	case EElementKind::Level:       return LevelEntries[Slot].Dot;
+	case EElementKind::Mission:     return MissionEntries[Slot].Dot;
+	default:                        return AchievementEntries[Slot].Dot;
+	}
+}
+
+FProgressDot& FProgressCrdt::GetDot(EElementKind Kind, int32 Slot)
+{
+	return const_cast<FProgressDot&>(AsConst(*this).GetDot(Kind, Slot));
+}
+
+void FProgressCrdt::Stamp(EElementKind Kind, int32 Slot, const FProgressDot& Dot)
+{
+	FProgressDot& ElementDot = GetDot(Kind, Slot);
+	if (ElementDot.Version > 0)
+	{
+		++StaleLogEntries;
+	}
+	ElementDot = Dot;
+	Seen.Add(Dot);
+
+	// Local changes append; merged ones usually do too, since peers send each device's changes in order
+	TArray<FLogEntry>& Log = Logs.FindOrAdd(Dot.Device);
+	const FLogEntry Change{ Dot.Version, Kind, Slot };
+	if (Log.Num() == 0 || Log.Last().Version < Dot.Version)
+	{
+		Log.Add(Change);
+	}
+	else
+	{
+		Log.Insert(Change, Algo::UpperBoundBy(Log, Dot.Version, &FLogEntry::Version));
+	}
+
+	if (StaleLogEntries >= SuperfamilyProgressCrdt::MinStaleEntriesToCompact
+		&& StaleLogEntries > CounterEntries.Num() + LevelEntries.Num() + MissionEntries.Num() + AchievementEntries.Num())
+	{
+		CompactLogs();
+	}
+}
+
+int32 FProgressCrdt::FindOrAddCounterEntry(EProgressCounter Counter, const FGuid& Owner)
+{
+	TMap<FGuid, int32>& Slots = CounterSlots[static_cast<int32>(Counter)];
+	if (const int32* Slot = Slots.Find(Owner))
+	{
+		return *Slot;
+	}
+
+	FCounterEntry Entry;
+	Entry.Counter = Counter;
+	Entry.Owner = Owner;
+	const int32 Slot = CounterEntries.Add(Entry);
+	Slots.Add(Owner, Slot);
+	return Slot;
+}
+
+void FProgressCrdt::MergeCounter(EProgressCounter Counter, const FGuid& Owner, int64 Added, int64 Removed, const FProgressDot& Dot, FProgressChangeSet& OutChanges)
+{
+	const int32 Slot = FindOrAddCounterEntry(Counter, Owner);
+	FCounterEntry& Entry = CounterEntries[Slot];
+
+	const int64 NewAdded = FMath::Max(Entry.Added, Added);
+	const int64 NewRemoved = FMath::Max(Entry.Removed, Removed);
+	if (Entry.Dot.Version > 0 && NewAdded == Entry.Added && NewRemoved == Entry.Removed)
+	{
+		return;
+	}
+
+	CounterTotals[static_cast<int32>(Counter)] += (NewAdded - Entry.Added) - (NewRemoved - Entry.Removed);
+	Entry.Added = NewAdded;
+	Entry.Removed = NewRemoved;
+	OutChanges.bCounterChanged[static_cast<int32>(Counter)] = true;
+
+	// Only the shared baseline can end up as a mix of both sides
+	const bool bTookRemote = NewAdded == Added && NewRemoved == Removed;
+	Stamp(EElementKind::Counter, Slot, bTookRemote ? Dot : NextLocalDot());
+}
+
+void FProgressCrdt::MergeLevel(const FLevelKey& Level, const FProgressLevelBest& Best, const FProgressDot& Dot, FProgressChangeSet& OutChanges)
+{
+	int32 Slot = LevelSlots.FindRef(Level, INDEX_NONE);
+	if (Slot == INDEX_NONE)
+	{
+		Slot = LevelEntries.Add(FLevelEntry{ Level });
+		LevelSlots.Add(Level, Slot);
+	}
+
+	FLevelEntry& Entry = LevelEntries[Slot];
+	if (Entry.Dot.Version > 0 && Entry.Best.Covers(Best))
+	{
+		return;
+	}
+
+	Entry.Best.Join(Best);
+	OutChanges.Levels.Add(Level);
+
+	// E.g. more stars here, a higher score there: the joined best is a new state
+	Stamp(EElementKind::Level, Slot, Best.Covers(Entry.Best) ? Dot : NextLocalDot());
+}
+
+void FProgressCrdt::CompactLogs()
+{
+	Logs.Reset();
+	StaleLogEntries = 0;
+
+	auto AddLive = [this](EElementKind Kind, int32 Slot, const FProgressDot& Dot)
+	{
+		Logs.FindOrAdd(Dot.Device).Add(FLogEntry{ Dot.Version, Kind, Slot });
+	};
+
+	for (int32 Slot = 0; Slot < CounterEntries.Num(); ++Slot)
+	{
+		AddLive(EElementKind::Counter, Slot, CounterEntries[Slot].Dot);
+	}
+	for (int32 Slot = 0; Slot < LevelEntries.Num(); ++Slot)
+	{
+		AddLive(EElementKind::Level, Slot, LevelEntries[Slot].Dot);
+	}
+	for (int32 Slot = 0; Slot < MissionEntries.Num(); ++Slot)
+	{
+		AddLive(EElementKind::Mission, Slot, MissionEntries[Slot].Dot);
+	}
+	for (int32 Slot = 0; Slot < AchievementEntries.Num(); ++Slot)
+	{
+		AddLive(EElementKind::Achievement, Slot, AchievementEntries[Slot].Dot);
+	}
+
+	for (TPair<FGuid, TArray<FLogEntry>>& Pair : Logs)
+	{
+		Algo::SortBy(Pair.Value, &FLogEntry::Version);
+	}
+}
+
+// ============================================
+// Persistence
+// ============================================
+
+void FProgressCrdt::Serialize(FArchive& Ar)
+{
+	uint8 Version = 1;
+	Ar << Version;
+	Ar << LocalDevice;
+	Ar << Seen;
+
+	int32 NumCounters = CounterEntries.Num();
+	Ar << NumCounters;
+	if (Ar.IsLoading())
+	{
+		CounterEntries.SetNum(FMath::Max(NumCounters, 0));
+	}
+	for (FCounterEntry& Entry : CounterEntries)
+	{
+		uint8 Counter = static_cast<uint8>(Entry.Counter);
+		Ar << Counter;
+		Entry.Counter = static_cast<EProgressCounter>(FMath::Min<uint8>(Counter, static_cast<uint8>(EProgressCounter::Num) - 1));
+		Ar << Entry.Owner;
+		Ar << Entry.Added;
+		Ar << Entry.Removed;
+		Ar << Entry.Dot;
+	}
+
+	int32 NumLevels = LevelEntries.Num();
+	Ar << NumLevels;
+	if (Ar.IsLoading())
+	{
+		LevelEntries.SetNum(FMath::Max(NumLevels, 0));
+	}
+	for (FLevelEntry& Entry : LevelEntries)
+	{
+		Entry.Level.Serialize(Ar);
+		Ar << Entry.Best.bCompleted;
+		Ar << Entry.Best.Stars;
+		Ar << Entry.Best.HighScore;
+		Ar << Entry.Best.Coins;
+		Ar << Entry.Dot;
+	}
+
+	int32 NumMissions = MissionEntries.Num();
+	Ar << NumMissions;
+	if (Ar.IsLoading())
+	{
+		MissionEntries.SetNum(FMath::Max(NumMissions, 0));
+	}
+	for (FMissionEntry& Entry : MissionEntries)
+	{
+		Entry.MissionID.Serialize(Ar);
+		Ar << Entry.Dot;
+	}
+
+	int32 NumAchievements = AchievementEntries.Num();
+	Ar << NumAchievements;
+	if (Ar.IsLoading())
+	{
+		AchievementEntries.SetNum(FMath::Max(NumAchievements, 0));
+	}
+	for (FAchievementEntry& Entry : AchievementEntries)
+	{
+		Ar << Entry.AchievementID;
+		Ar << Entry.Dot;
+	}
+
+	if (Ar.IsLoading())
+	{
+		// Indexes and totals are derived from the elements
+		for (TMap<FGuid, int32>& Slots : CounterSlots)
+		{
+			Slots.Reset();
+		}
+		for (int64& Total : CounterTotals)
+		{
+			Total = 0;
+		}
+		for (int32 Slot = 0; Slot < CounterEntries.Num(); ++Slot)
+		{
+			const FCounterEntry& Entry = CounterEntries[Slot];
+			CounterSlots[static_cast<int32>(Entry.Counter)].Add(Entry.Owner, Slot);
+			CounterTotals[static_cast<int32>(Entry.Counter)] += Entry.Added - Entry.Removed;
+		}
+
+		LevelSlots.Reset();
+		for (int32 Slot = 0; Slot < LevelEntries.Num(); ++Slot)
+		{
+			LevelSlots.Add(LevelEntries[Slot].Level, Slot);
+		}
+
+		MissionSlots.Reset();
+		for (int32 Slot = 0; Slot < MissionEntries.Num(); ++Slot)
+		{
+			MissionSlots.Add(MissionEntries[Slot].MissionID, Slot);
+		}
+
+		AchievementSlots.Reset();
+		for (int32 Slot = 0; Slot < AchievementEntries.Num(); ++Slot)
+		{
+			AchievementSlots.Add(AchievementEntries[Slot].AchievementID, Slot);
+		}
+
+		CompactLogs();
+	}
+}
+
+// ============================================
+// FProgressSyncLoopbackServer
+// ============================================
+
+TSharedRef<FJsonObject> FProgressSyncLoopbackServer::Exchange(const FChildId& ChildID, const FJsonObject& DeviceDelta)
+{
+	FProgressCrdt* Replica = Replicas.Find(ChildID);
+	if (!Replica)
+	{
+		Replica = &Replicas.Add(ChildID, FProgressCrdt(ServerDevice));
+	}
+
+	// What the device had seen before this exchange; everything it sent is included in it
+	const TSharedPtr<FJsonObject>* DeviceSeen = nullptr;
+	const FProgressVersionVector Since = DeviceDelta.TryGetObjectField(TEXT("vv"), DeviceSeen)
+		? FProgressVersionVector::FromJson(**DeviceSeen)
+		: FProgressVersionVector();
+
+	FProgressChangeSet Changes;
+	if (!Replica->MergeDelta(DeviceDelta, Changes))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Loopback sync server: malformed delta for %s"), *ChildID.ToString());
+	}
+
+	return Replica->BuildDelta(Since);
+}
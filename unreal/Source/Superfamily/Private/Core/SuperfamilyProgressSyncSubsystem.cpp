@@ -0,0 +1,632 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyProgressSyncSubsystem.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyBootSubsystem.h"
+#include "Core/SuperfamilyGameInstance.h"
+#include "Core/SuperfamilyStats.h"
+#include "RNUEBridgeSubsystem.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+const FName USuperfamilyProgressSyncSubsystem::BootStage(TEXT("ProgressSync"));
+
+namespace SuperfamilyProgressSync
+{
+	static constexpr uint8 StateFileVersion = 2;
+
+	static FString ToJsonString(const TSharedRef<FJsonObject>& Object)
+	{
+		FString JSON;
+		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&JSON);
+		FJsonSerializer::Serialize(Object, Writer);
+		return JSON;
+	}
+}
+
+void USuperfamilyProgressSyncSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	StatePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Sync"), TEXT("Progress.bin"));
+	LoadState();
+
+#if !UE_BUILD_SHIPPING
+	if (FParse::Param(FCommandLine::Get(), TEXT("SFSyncLoopback")))
+	{
+		LoopbackServer = MakeUnique<FProgressSyncLoopbackServer>();
+		UE_LOG(LogSuperfamily, Log, TEXT("Progress sync uses the loopback server"));
+	}
+#endif
+
+	if (URNUEBridgeSubsystem* Bridge = Collection.InitializeDependency<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnMessageReceived.AddDynamic(this, &USuperfamilyProgressSyncSubsystem::HandleBridgeMessage);
+	}
+
+	// Seeds every profile and exchanges once; nothing waits on the server
+	if (USuperfamilyBootSubsystem* Boot = Collection.InitializeDependency<USuperfamilyBootSubsystem>())
+	{
+		Boot->AddStage(BootStage, { USuperfamilyBootSubsystem::SaveDataStage, USuperfamilyBootSubsystem::BridgeStage },
+			[this](USuperfamilyBootSubsystem::FStageDone&& Done)
+		{
+			if (const USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+			{
+				for (const FChildProfile& Profile : GameInstance->GetAllProfiles())
+				{
+					FindOrSeedReplica(Profile);
+				}
+			}
+			SyncNow();
+			Done(true);
+		}, false);
+	}
+
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &USuperfamilyProgressSyncSubsystem::TickSync), 0.5f);
+}
+
+void USuperfamilyProgressSyncSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+	TickHandle.Reset();
+
+	if (URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnMessageReceived.RemoveDynamic(this, &USuperfamilyProgressSyncSubsystem::HandleBridgeMessage);
+	}
+
+	SaveState();
+	Replicas.Empty();
+	LoopbackServer.Reset();
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Local Changes
+// ============================================
+
+void USuperfamilyProgressSyncSubsystem::RecordCounter(const FChildProfile& Profile, EProgressCounter Counter, int64 Amount)
+{
+	FChildReplica& Replica = FindOrSeedReplica(Profile);
+	Replica.Progress.AddToCounter(Counter, Amount);
+	MarkChanged(Replica);
+}
+
+void USuperfamilyProgressSyncSubsystem::RecordLevel(const FChildProfile& Profile, const FLevelKey& Level, const FProgressLevelBest& Result)
+{
+	FChildReplica& Replica = FindOrSeedReplica(Profile);
+	if (Replica.Progress.RecordLevel(Level, Result))
+	{
+		MarkChanged(Replica);
+	}
+}
+
+void USuperfamilyProgressSyncSubsystem::RecordMission(const FChildProfile& Profile, const FMissionId& MissionID)
+{
+	FChildReplica& Replica = FindOrSeedReplica(Profile);
+	if (Replica.Progress.AddMission(MissionID))
+	{
+		MarkChanged(Replica);
+	}
+}
+
+void USuperfamilyProgressSyncSubsystem::RecordAchievement(const FChildProfile& Profile, const FString& AchievementID)
+{
+	FChildReplica& Replica = FindOrSeedReplica(Profile);
+	if (Replica.Progress.AddAchievement(AchievementID))
+	{
+		MarkChanged(Replica);
+	}
+}
+
+USuperfamilyProgressSyncSubsystem::FChildReplica& USuperfamilyProgressSyncSubsystem::FindOrSeedReplica(const FChildProfile& Profile)
+{
+	if (FChildReplica* Existing = Replicas.Find(Profile.ChildID))
+	{
+		return *Existing;
+	}
+
+	FChildReplica& Replica = Replicas.Add(Profile.ChildID);
+	Replica.Progress = FProgressCrdt(DeviceID);
+
+	// Sets and level bests join idempotently. The profile's totals may already be on the
+	// server under a device ID lost with Progress.bin, so they wait for its reply
+	Replica.bAwaitingBaseline = true;
+
+	for (const TPair<FLevelKey, FLevelProgress>& Pair : Profile.LevelProgress)
+	{
+		FProgressLevelBest Best;
+		Best.bCompleted = Pair.Value.bCompleted;
+		Best.Stars = Pair.Value.StarsEarned;
+		Best.HighScore = Pair.Value.HighScore;
+		Best.Coins = Pair.Value.CoinsCollected;
+		Replica.Progress.RecordLevel(Pair.Key, Best);
+	}
+	for (const FMissionId& MissionID : Profile.CompletedMissions)
+	{
+		Replica.Progress.AddMission(MissionID);
+	}
+	for (const FString& AchievementID : Profile.UnlockedAchievements)
+	{
+		Replica.Progress.AddAchievement(AchievementID);
+	}
+
+	MarkChanged(Replica);
+	return Replica;
+}
+
+void USuperfamilyProgressSyncSubsystem::MarkChanged(FChildReplica& Replica)
+{
+	Replica.bHasLocalChanges = true;
+	bStateDirty = true;
+
+	if (NextPushTime == 0.0)
+	{
+		NextPushTime = FPlatformTime::Seconds() + PushDelaySeconds;
+	}
+}
+
+const FProgressCrdt* USuperfamilyProgressSyncSubsystem::FindProgress(const FChildId& ChildID) const
+{
+	const FChildReplica* Replica = Replicas.Find(ChildID);
+	return Replica ? &Replica->Progress : nullptr;
+}
+
+// ============================================
+// Sync
+// ============================================
+
+void USuperfamilyProgressSyncSubsystem::SyncNow()
+{
+	NextPushTime = 0.0;
+	NextPollTime = FPlatformTime::Seconds() + PollIntervalSeconds;
+
+	for (TPair<FChildId, FChildReplica>& Pair : Replicas)
+	{
+		SendExchange(Pair.Key, Pair.Value);
+	}
+}
+
+bool USuperfamilyProgressSyncSubsystem::TickSync(float DeltaTime)
+{
+	// The boot stage makes the first exchange, once profiles are loaded and the bridge is up
+	const USuperfamilyBootSubsystem* Boot = GetGameInstance()->GetSubsystem<USuperfamilyBootSubsystem>();
+	if (Boot && !Boot->IsStageComplete(BootStage))
+	{
+		return true;
+	}
+
+	// Sync can wait while the bulk lane is backed up
+	const URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>();
+	if (Bridge && Bridge->IsBulkLaneUnderPressure())
+	{
+		return true;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now >= NextPollTime)
+	{
+		SyncNow();
+	}
+	else if (NextPushTime > 0.0 && Now >= NextPushTime)
+	{
+		NextPushTime = 0.0;
+		for (TPair<FChildId, FChildReplica>& Pair : Replicas)
+		{
+			if (Pair.Value.bHasLocalChanges)
+			{
+				SendExchange(Pair.Key, Pair.Value);
+			}
+		}
+	}
+
+	return true;
+}
+
+void USuperfamilyProgressSyncSubsystem::SendExchange(const FChildId& ChildID, FChildReplica& Replica)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SuperfamilyProfileSync);
+
+	// Everything the server hasn't acknowledged; sent again until it has, since merging is idempotent
+	TSharedRef<FJsonObject> Delta = Replica.Progress.BuildDelta(Replica.Acked);
+	Replica.bHasLocalChanges = false;
+
+	if (LoopbackServer)
+	{
+		ApplyServerDelta(ChildID, *LoopbackServer->Exchange(ChildID, *Delta));
+		return;
+	}
+
+	URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>();
+	if (!Bridge)
+	{
+		return;
+	}
+
+	TSharedRef<FJsonObject> Payload = MakeShared<FJsonObject>();
+	Payload->SetStringField(TEXT("childId"), ChildID.ToString());
+	Payload->SetStringField(TEXT("deviceId"), DeviceID.ToString(EGuidFormats::Digits));
+	Payload->SetObjectField(TEXT("delta"), Delta);
+
+	Bridge->SendProgressSyncDelta(ChildID.ToString(), SuperfamilyProgressSync::ToJsonString(Payload));
+}
+
+void USuperfamilyProgressSyncSubsystem::ApplyServerDelta(const FChildId& ChildID, const FJsonObject& Delta)
+{
+	USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+
+	FChildReplica* Replica = Replicas.Find(ChildID);
+	if (!Replica && GameInstance)
+	{
+		for (const FChildProfile& Profile : GameInstance->GetAllProfiles())
+		{
+			if (Profile.ChildID == ChildID)
+			{
+				Replica = &FindOrSeedReplica(Profile);
+				break;
+			}
+		}
+	}
+
+	if (!Replica)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Progress sync for unknown child %s ignored"), *ChildID.ToString());
+		return;
+	}
+
+	FProgressChangeSet Changes;
+	if (!Replica->Progress.MergeDelta(Delta, Changes))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Malformed progress sync delta for %s"), *ChildID.ToString());
+		return;
+	}
+
+	if (Replica->bAwaitingBaseline && GameInstance)
+	{
+		// Only what the server's counters don't cover; the profile isn't updated yet, so it still has its own totals
+		for (const FChildProfile& Profile : GameInstance->GetAllProfiles())
+		{
+			if (Profile.ChildID == ChildID)
+			{
+				Replica->Progress.RaiseCounterTotal(EProgressCounter::Coins, Profile.Coins);
+				Replica->Progress.RaiseCounterTotal(EProgressCounter::XP, Profile.TotalXP);
+				MarkChanged(*Replica);
+				break;
+			}
+		}
+		Replica->bAwaitingBaseline = false;
+	}
+
+	const TSharedPtr<FJsonObject>* ServerSeen = nullptr;
+	if (Delta.TryGetObjectField(TEXT("vv"), ServerSeen))
+	{
+		Replica->Acked.Merge(FProgressVersionVector::FromJson(**ServerSeen));
+	}
+	bStateDirty = true;
+
+	if (!Changes.IsEmpty() && GameInstance)
+	{
+		// Saves the game, and with it this state
+		GameInstance->ApplySyncedProgress(ChildID, Replica->Progress, Changes);
+	}
+}
+
+void USuperfamilyProgressSyncSubsystem::HandleBridgeMessage(const FRNUEMessage& Message)
+{
+	if (Message.Type != ERNUEMessageType::ProgressSyncReceived)
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> Payload;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Message.Payload);
+	const TSharedPtr<FJsonObject>* Delta = nullptr;
+	if (!FJsonSerializer::Deserialize(Reader, Payload) || !Payload.IsValid() || !Payload->TryGetObjectField(TEXT("delta"), Delta))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("ProgressSyncReceived without a delta"));
+		return;
+	}
+
+	ApplyServerDelta(FChildId::FromString(Payload->GetStringField(TEXT("childId"))), **Delta);
+}
+
+// ============================================
+// Persistence
+// ============================================
+
+bool USuperfamilyProgressSyncSubsystem::SaveState()
+{
+	if (!bStateDirty)
+	{
+		return true;
+	}
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint8 Version = SuperfamilyProgressSync::StateFileVersion;
+	Writer << Version;
+	Writer << DeviceID;
+
+	int32 NumReplicas = Replicas.Num();
+	Writer << NumReplicas;
+	for (TPair<FChildId, FChildReplica>& Pair : Replicas)
+	{
+		Pair.Key.Serialize(Writer);
+		Pair.Value.Progress.Serialize(Writer);
+		Writer << Pair.Value.Acked;
+		Writer << Pair.Value.bAwaitingBaseline;
+	}
+
+	// Replace the file only once the new one is complete
+	const FString TempPath = StatePath + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*StatePath, *TempPath, true))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Couldn't write %s"), *StatePath);
+		return false;
+	}
+
+	bStateDirty = false;
+	return true;
+}
+
+void USuperfamilyProgressSyncSubsystem::LoadState()
+{
+	TArray<uint8> Bytes;
+	if (FFileHelper::LoadFileToArray(Bytes, *StatePath, FILEREAD_Silent))
+	{
+		FMemoryReader Reader(Bytes);
+
+		uint8 Version = 0;
+		Reader << Version;
+		Reader << DeviceID;
+
+		int32 NumReplicas = 0;
+		Reader << NumReplicas;
+		for (int32 Index = 0; Index < NumReplicas && !Reader.IsError(); ++Index)
+		{
+			FChildId ChildID;
+			ChildID.Serialize(Reader);
+			FChildReplica& Replica = Replicas.Add(ChildID);
+			Replica.Progress.Serialize(Reader);
+			Reader << Replica.Acked;
+			Reader << Replica.bAwaitingBaseline;
+		}
+
+		if (Reader.IsError() || Version != SuperfamilyProgressSync::StateFileVersion)
+		{
+			// Profiles are reseeded against the server's counters, so nothing is counted twice
+			UE_LOG(LogSuperfamily, Warning, TEXT("Discarding unreadable progress sync state %s"), *StatePath);
+			Replicas.Empty();
+		}
+	}
+
+	if (!DeviceID.IsValid())
+	{
+		DeviceID = FGuid::NewGuid();
+		bStateDirty = true;
+	}
+}
+
+// ============================================
+// Simulation
+// ============================================
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Simulated devices playing one child against the loopback server, exchanging
+ * at random moments (and sometimes twice), then checking every device
+ * converged on the totals of all operations. Runs without a world:
+ *   sf.Sync.Simulate <Devices> <Rounds> [Seed]
+ */
+namespace SuperfamilyProgressSync
+{
+	struct FSimDevice
+	{
+		FProgressCrdt Progress;
+		FProgressVersionVector Acked;
+	};
+
+	static int32 CountElements(const FJsonObject& Delta)
+	{
+		int32 Count = 0;
+		for (const TCHAR* Field : { TEXT("counters"), TEXT("levels"), TEXT("missions"), TEXT("achievements") })
+		{
+			const TArray<TSharedPtr<FJsonValue>>* Elements = nullptr;
+			if (Delta.TryGetArrayField(Field, Elements))
+			{
+				Count += Elements->Num();
+			}
+		}
+		return Count;
+	}
+
+	static void Simulate(const TArray<FString>& Args)
+	{
+		const int32 NumDevices = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 3, 1, 32);
+		const int32 NumRounds = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 50, 1);
+		FRandomStream Random(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1);
+
+		const FChildId ChildID = FChildId::NewId();
+		FProgressSyncLoopbackServer Server;
+
+		TArray<FSimDevice> Devices;
+		for (int32 Index = 0; Index < NumDevices; ++Index)
+		{
+			Devices.Add(FSimDevice{ FProgressCrdt(FGuid::NewGuid()) });
+		}
+
+		// What every device should end up with
+		int64 ExpectedCounters[static_cast<int32>(EProgressCounter::Num)] = {};
+		TMap<FLevelKey, FProgressLevelBest> ExpectedLevels;
+		TSet<FString> ExpectedMissions;
+		TSet<FString> ExpectedAchievements;
+
+		int32 Operations = 0;
+		int32 Exchanges = 0;
+		int32 ElementsSent = 0;
+
+		auto Exchange = [&](FSimDevice& Device)
+		{
+			TSharedRef<FJsonObject> Delta = Device.Progress.BuildDelta(Device.Acked);
+			TSharedRef<FJsonObject> Reply = Server.Exchange(ChildID, *Delta);
+			ElementsSent += CountElements(*Delta) + CountElements(*Reply);
+			++Exchanges;
+
+			// Replies delivered twice must be harmless
+			const int32 Deliveries = Random.FRand() < 0.1f ? 2 : 1;
+			for (int32 Delivery = 0; Delivery < Deliveries; ++Delivery)
+			{
+				FProgressChangeSet Changes;
+				Device.Progress.MergeDelta(*Reply, Changes);
+			}
+
+			const TSharedPtr<FJsonObject>* ServerSeen = nullptr;
+			if (Reply->TryGetObjectField(TEXT("vv"), ServerSeen))
+			{
+				Device.Acked.Merge(FProgressVersionVector::FromJson(**ServerSeen));
+			}
+		};
+
+		for (int32 Round = 0; Round < NumRounds; ++Round)
+		{
+			for (FSimDevice& Device : Devices)
+			{
+				const int32 NumOperations = Random.RandRange(0, 3);
+				for (int32 Operation = 0; Operation < NumOperations; ++Operation)
+				{
+					++Operations;
+					switch (Random.RandRange(0, 4))
+					{
+					case 0:
+					{
+						const int64 Amount = Random.RandRange(1, 20);
+						Device.Progress.AddToCounter(EProgressCounter::Coins, Amount);
+						ExpectedCounters[static_cast<int32>(EProgressCounter::Coins)] += Amount;
+
+						// Spend only what this device believes is there, as the game does
+						const int64 Spend = FMath::Min<int64>(Random.RandRange(0, 10), Device.Progress.GetCounter(EProgressCounter::Coins));
+						Device.Progress.AddToCounter(EProgressCounter::Coins, -Spend);
+						ExpectedCounters[static_cast<int32>(EProgressCounter::Coins)] -= Spend;
+						break;
+					}
+					case 1:
+					{
+						const int64 Amount = Random.RandRange(1, 100);
+						Device.Progress.AddToCounter(EProgressCounter::XP, Amount);
+						ExpectedCounters[static_cast<int32>(EProgressCounter::XP)] += Amount;
+						break;
+					}
+					case 2:
+					{
+						const FLevelKey Level(Random.RandRange(1, 3), Random.RandRange(1, 10));
+						FProgressLevelBest Result;
+						Result.bCompleted = true;
+						Result.Stars = Random.RandRange(0, 3);
+						Result.HighScore = Random.RandRange(0, 5000);
+						Result.Coins = Random.RandRange(0, 50);
+						Device.Progress.RecordLevel(Level, Result);
+						ExpectedLevels.FindOrAdd(Level).Join(Result);
+						break;
+					}
+					case 3:
+					{
+						const FString MissionID = FString::Printf(TEXT("sim-mission-%d"), Random.RandRange(1, 40));
+						Device.Progress.AddMission(FMissionId::FromString(MissionID));
+						ExpectedMissions.Add(MissionID);
+						break;
+					}
+					default:
+					{
+						const FString AchievementID = FString::Printf(TEXT("sim-achievement-%d"), Random.RandRange(1, 40));
+						Device.Progress.AddAchievement(AchievementID);
+						ExpectedAchievements.Add(AchievementID);
+						break;
+					}
+					}
+				}
+			}
+
+			// Devices come online at random
+			for (FSimDevice& Device : Devices)
+			{
+				if (Random.FRand() < 0.5f)
+				{
+					Exchange(Device);
+				}
+			}
+		}
+
+		// Everyone pushes, then everyone pulls what the others pushed
+		for (int32 Pass = 0; Pass < 2; ++Pass)
+		{
+			for (FSimDevice& Device : Devices)
+			{
+				Exchange(Device);
+			}
+		}
+
+		int32 Mismatches = 0;
+		for (int32 Index = 0; Index < Devices.Num(); ++Index)
+		{
+			const FProgressCrdt& Progress = Devices[Index].Progress;
+			for (int32 Counter = 0; Counter < static_cast<int32>(EProgressCounter::Num); ++Counter)
+			{
+				if (Progress.GetCounter(static_cast<EProgressCounter>(Counter)) != ExpectedCounters[Counter])
+				{
+					UE_LOG(LogSuperfamily, Error, TEXT("Device %d: counter %d is %lld, expected %lld"),
+						Index, Counter, Progress.GetCounter(static_cast<EProgressCounter>(Counter)), ExpectedCounters[Counter]);
+					++Mismatches;
+				}
+			}
+			for (const TPair<FLevelKey, FProgressLevelBest>& Pair : ExpectedLevels)
+			{
+				const FProgressLevelBest* Best = Progress.FindLevel(Pair.Key);
+				if (!Best || !Best->Covers(Pair.Value) || !Pair.Value.Covers(*Best))
+				{
+					UE_LOG(LogSuperfamily, Error, TEXT("Device %d: level %s differs"), Index, *Pair.Key.ToString());
+					++Mismatches;
+				}
+			}
+			for (const FString& MissionID : ExpectedMissions)
+			{
+				if (!Progress.HasMission(FMissionId::FromString(MissionID)))
+				{
+					UE_LOG(LogSuperfamily, Error, TEXT("Device %d: mission %s missing"), Index, *MissionID);
+					++Mismatches;
+				}
+			}
+			for (const FString& AchievementID : ExpectedAchievements)
+			{
+				if (!Progress.HasAchievement(AchievementID))
+				{
+					UE_LOG(LogSuperfamily, Error, TEXT("Device %d: achievement %s missing"), Index, *AchievementID);
+					++Mismatches;
+				}
+			}
+		}
+
+		UE_LOG(LogSuperfamily, Display, TEXT("sf.Sync.Simulate: %d devices, %d operations, %d exchanges, %d elements sent: %s"),
+			NumDevices, Operations, Exchanges, ElementsSent, Mismatches == 0 ? TEXT("converged") : TEXT("DIVERGED"));
+	}
+}
+
+static FAutoConsoleCommand GSuperfamilySyncSimulateCommand(
+	TEXT("sf.Sync.Simulate"),
+	TEXT("Simulate devices syncing one child through the loopback server and check they converge. Usage: sf.Sync.Simulate <Devices> <Rounds> [Seed]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&SuperfamilyProgressSync::Simulate));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,309 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilySoakTestSubsystem.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyBootSubsystem.h"
+#include "Core/SuperfamilyGameModeBase.h"
+#include "Core/SuperfamilyLevelCatalogSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Gameplay/SuperfamilyAutoplayBot.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace SuperfamilySoakTest
+{
+	float GetUsedMemoryMB()
+	{
+		return static_cast<float>(FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+	}
+}
+
+bool USuperfamilySoakTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	FString Value;
+	return FParse::Param(FCommandLine::Get(), TEXT("SFSoak")) || FParse::Value(FCommandLine::Get(), TEXT("SFSoak="), Value);
+}
+
+void USuperfamilySoakTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Collection.InitializeDependency<USuperfamilyLevelCatalogSubsystem>();
+
+	// The catalog loads during boot
+	USuperfamilyBootSubsystem* Boot = Collection.InitializeDependency<USuperfamilyBootSubsystem>();
+	Boot->CallWhenStageComplete(USuperfamilyBootSubsystem::LevelCatalogStage, [WeakThis = TWeakObjectPtr<USuperfamilySoakTestSubsystem>(this)]()
+	{
+		if (USuperfamilySoakTestSubsystem* This = WeakThis.Get())
+		{
+			This->StartSoak();
+		}
+	});
+}
+
+void USuperfamilySoakTestSubsystem::StartSoak()
+{
+	USuperfamilyLevelCatalogSubsystem* LevelCatalog = GetGameInstance()->GetSubsystem<USuperfamilyLevelCatalogSubsystem>();
+	const USuperfamilyLevelCatalog* Catalog = LevelCatalog ? LevelCatalog->GetCatalog() : nullptr;
+	if (!Catalog)
+	{
+		UE_LOG(LogSuperfamily, Error, TEXT("Soak test needs a level catalog"));
+		return;
+	}
+
+	int32 OnlyWorldID = INDEX_NONE;
+	FParse::Value(FCommandLine::Get(), TEXT("SFSoak="), Iterations);
+	FParse::Value(FCommandLine::Get(), TEXT("SFSoakWorld="), OnlyWorldID);
+	Iterations = FMath::Max(1, Iterations);
+
+	for (const FLevelCatalogEntry& Entry : Catalog->GetEntries())
+	{
+		if (!Entry.Map.IsNull() && (OnlyWorldID == INDEX_NONE || Entry.WorldID == OnlyWorldID))
+		{
+			Levels.Add({ Entry.WorldID, Entry.LevelID, Entry.Map });
+		}
+	}
+
+	if (Levels.Num() == 0)
+	{
+		UE_LOG(LogSuperfamily, Error, TEXT("Soak test found no catalogued levels to play"));
+		return;
+	}
+
+	BaselineMemoryMB.Init(0.0f, Levels.Num());
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &USuperfamilySoakTestSubsystem::HandlePostLoadMap);
+	BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddUObject(this, &USuperfamilySoakTestSubsystem::HandleBeginFrame);
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &USuperfamilySoakTestSubsystem::HandleEndFrame);
+	PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &USuperfamilySoakTestSubsystem::HandlePreGarbageCollect);
+	PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &USuperfamilySoakTestSubsystem::HandlePostGarbageCollect);
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &USuperfamilySoakTestSubsystem::Tick));
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Soak test: %d levels x %d iterations"), Levels.Num(), Iterations);
+}
+
+void USuperfamilySoakTestSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGCHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGCHandle);
+
+	// Interrupted runs still report what they measured
+	if (Results.Num() > 0 && RunIndex < Levels.Num() * Iterations)
+	{
+		WriteReport();
+	}
+
+	Super::Deinitialize();
+}
+
+bool USuperfamilySoakTestSubsystem::Tick(float DeltaTime)
+{
+	const double Elapsed = FPlatformTime::Seconds() - StateStartTime;
+
+	switch (State)
+	{
+	case ESoakState::Idle:
+		// Boot map is up; start the first level
+		if (RunIndex == INDEX_NONE)
+		{
+			OpenNextLevel();
+		}
+		break;
+
+	case ESoakState::Loading:
+	case ESoakState::Playing:
+		if (Elapsed > RunTimeoutSeconds)
+		{
+			FinishRun(TEXT("TimedOut"));
+		}
+		break;
+
+	case ESoakState::Ended:
+		// Travel from a tick rather than from inside the game mode's level-ended broadcast
+		OpenNextLevel();
+		break;
+	}
+
+	return true;
+}
+
+void USuperfamilySoakTestSubsystem::OpenNextLevel()
+{
+	++RunIndex;
+	if (RunIndex >= Levels.Num() * Iterations)
+	{
+		State = ESoakState::Idle;
+		WriteReport();
+
+		const bool bAllCompleted = !Results.ContainsByPredicate([](const FSoakRunResult& Run) { return Run.Result != TEXT("Completed"); });
+		FPlatformMisc::RequestExitWithStatus(false, bAllCompleted ? 0 : 1, TEXT("SFSoak"));
+		return;
+	}
+
+	const FSoakLevel& Level = Levels[RunIndex % Levels.Num()];
+
+	Current = FSoakRunResult();
+	Current.Iteration = RunIndex / Levels.Num() + 1;
+	Current.WorldID = Level.WorldID;
+	Current.LevelID = Level.LevelID;
+	GameThreadFrameMs.Reset();
+
+	State = ESoakState::Loading;
+	StateStartTime = FPlatformTime::Seconds();
+
+	UGameplayStatics::OpenLevelBySoftObjectPtr(GetGameInstance(), Level.Map);
+}
+
+void USuperfamilySoakTestSubsystem::HandlePostLoadMap(UWorld* LoadedWorld)
+{
+	if (State != ESoakState::Loading || !LoadedWorld)
+	{
+		return;
+	}
+
+	const int32 LevelIndex = RunIndex % Levels.Num();
+	if (UWorld::RemovePIEPrefix(LoadedWorld->GetOutermost()->GetName()) != Levels[LevelIndex].Map.GetLongPackageName())
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	Current.LoadSeconds = static_cast<float>(Now - StateStartTime);
+
+	// The previous level was collected during the load, so this is the level's own footprint
+	Current.PostLoadMemoryMB = SuperfamilySoakTest::GetUsedMemoryMB();
+	Current.MemoryHighWaterMB = Current.PostLoadMemoryMB;
+	if (Current.Iteration == 1)
+	{
+		BaselineMemoryMB[LevelIndex] = Current.PostLoadMemoryMB;
+	}
+
+	ASuperfamilyLevelGameMode* GameMode = LoadedWorld->GetAuthGameMode<ASuperfamilyLevelGameMode>();
+	if (!GameMode)
+	{
+		UE_LOG(LogSuperfamily, Error, TEXT("Soak: world %d level %d has no level game mode"), Current.WorldID, Current.LevelID);
+		FinishRun(TEXT("Failed"));
+		return;
+	}
+
+	GameMode->OnLevelEnded.AddDynamic(this, &USuperfamilySoakTestSubsystem::HandleLevelEnded);
+	ASuperfamilyAutoplayBot::StartAutoplay(LoadedWorld);
+
+	State = ESoakState::Playing;
+	StateStartTime = Now;
+}
+
+void USuperfamilySoakTestSubsystem::HandleLevelEnded(bool bCompleted)
+{
+	if (State == ESoakState::Playing)
+	{
+		FinishRun(bCompleted ? TEXT("Completed") : TEXT("Failed"));
+	}
+}
+
+void USuperfamilySoakTestSubsystem::HandleBeginFrame()
+{
+	FrameStartTime = FPlatformTime::Seconds();
+}
+
+void USuperfamilySoakTestSubsystem::HandleEndFrame()
+{
+	if (State != ESoakState::Playing)
+	{
+		return;
+	}
+
+	// Begin to end of the engine tick on the game thread; with -nullrhi the render sync inside it is negligible
+	GameThreadFrameMs.Add(static_cast<float>((FPlatformTime::Seconds() - FrameStartTime) * 1000.0));
+
+	if (GameThreadFrameMs.Num() % FMath::Max(1, MemorySampleInterval) == 0)
+	{
+		Current.MemoryHighWaterMB = FMath::Max(Current.MemoryHighWaterMB, SuperfamilySoakTest::GetUsedMemoryMB());
+	}
+}
+
+void USuperfamilySoakTestSubsystem::HandlePreGarbageCollect()
+{
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void USuperfamilySoakTestSubsystem::HandlePostGarbageCollect()
+{
+	// Loading included: the travel GC is part of what a level transition costs
+	if (State != ESoakState::Loading && State != ESoakState::Playing)
+	{
+		return;
+	}
+
+	const float PauseMs = static_cast<float>((FPlatformTime::Seconds() - GCStartTime) * 1000.0);
+	++Current.GCCount;
+	Current.GCTotalMs += PauseMs;
+	Current.GCMaxMs = FMath::Max(Current.GCMaxMs, PauseMs);
+}
+
+void USuperfamilySoakTestSubsystem::FinishRun(const TCHAR* Result)
+{
+	if (State == ESoakState::Playing)
+	{
+		Current.PlaySeconds = static_cast<float>(FPlatformTime::Seconds() - StateStartTime);
+	}
+
+	Current.Result = Result;
+	Current.Frames = GameThreadFrameMs.Num();
+	Current.MemoryHighWaterMB = FMath::Max(Current.MemoryHighWaterMB, SuperfamilySoakTest::GetUsedMemoryMB());
+	if (Current.PostLoadMemoryMB > 0.0f)
+	{
+		Current.LeakGrowthMB = Current.PostLoadMemoryMB - BaselineMemoryMB[RunIndex % Levels.Num()];
+	}
+
+	if (GameThreadFrameMs.Num() > 0)
+	{
+		GameThreadFrameMs.Sort();
+		double Total = 0.0;
+		for (const float FrameMs : GameThreadFrameMs)
+		{
+			Total += FrameMs;
+		}
+		Current.GameThreadAverageMs = static_cast<float>(Total / GameThreadFrameMs.Num());
+		Current.GameThreadP95Ms = GameThreadFrameMs[FMath::Min(GameThreadFrameMs.Num() - 1, FMath::FloorToInt(GameThreadFrameMs.Num() * 0.95f))];
+		Current.GameThreadMaxMs = GameThreadFrameMs.Last();
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Soak %d/%d: world %d level %d %s in %.1fs, game thread avg %.2fms p95 %.2fms, %d GCs (max %.1fms), memory %.0fMB peak %.0fMB growth %+.1fMB"),
+		RunIndex + 1, Levels.Num() * Iterations, Current.WorldID, Current.LevelID, *Current.Result, Current.PlaySeconds,
+		Current.GameThreadAverageMs, Current.GameThreadP95Ms, Current.GCCount, Current.GCMaxMs,
+		Current.PostLoadMemoryMB, Current.MemoryHighWaterMB, Current.LeakGrowthMB);
+
+	Results.Add(MoveTemp(Current));
+	State = ESoakState::Ended;
+}
+
+void USuperfamilySoakTestSubsystem::WriteReport()
+{
+	FString Csv = TEXT("Iteration,WorldID,LevelID,Result,LoadSeconds,PlaySeconds,Frames,GameThreadAvgMs,GameThreadP95Ms,GameThreadMaxMs,GCCount,GCTotalMs,GCMaxMs,PostLoadMemoryMB,MemoryHighWaterMB,LeakGrowthMB\n");
+	for (const FSoakRunResult& Run : Results)
+	{
+		Csv += FString::Printf(TEXT("%d,%d,%d,%s,%.2f,%.2f,%d,%.3f,%.3f,%.3f,%d,%.2f,%.2f,%.1f,%.1f,%.1f\n"),
+			Run.Iteration, Run.WorldID, Run.LevelID, *Run.Result, Run.LoadSeconds, Run.PlaySeconds, Run.Frames,
+			Run.GameThreadAverageMs, Run.GameThreadP95Ms, Run.GameThreadMaxMs, Run.GCCount, Run.GCTotalMs, Run.GCMaxMs,
+			Run.PostLoadMemoryMB, Run.MemoryHighWaterMB, Run.LeakGrowthMB);
+	}
+
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("Soak") / FString::Printf(TEXT("Soak-%s.csv"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+	if (!FFileHelper::SaveStringToFile(Csv, *Filename))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Failed to write soak report to %s"), *Filename);
+		return;
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Soak report (%d runs) written to %s"), Results.Num(), *Filename);
+}
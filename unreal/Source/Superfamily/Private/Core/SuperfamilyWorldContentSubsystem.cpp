@@ -0,0 +1,1424 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Core/SuperfamilyWorldContentSubsystem.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyBootSubsystem.h"
+#include "Core/SuperfamilyGameInstance.h"
+#include "Core/SuperfamilyLevelCatalogSubsystem.h"
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "IPlatformFilePak.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/UObjectGlobals.h"
+
+#if !UE_BUILD_SHIPPING
+#include "HAL/IConsoleManager.h"
+#include "HttpPath.h"
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#endif
+
+const FName USuperfamilyWorldContentSubsystem::BootStage(TEXT("WorldContent"));
+
+namespace SuperfamilyWorldContent
+{
+	/** Pak order of downloaded chunks; above the install's paks like any other patch */
+	static constexpr uint32 ChunkPakOrder = 4;
+
+	static const TCHAR* ManifestFileName = TEXT("Manifest.json");
+	static const TCHAR* CacheIndexFileName = TEXT("Installed.json");
+
+	/** SHA-1 of a file, or empty if it can't be read or isn't ExpectedSize bytes; runs on a worker */
+	static FString HashFile(const FString& Path, int64 ExpectedSize)
+	{
+		TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+		if (!Reader.IsValid() || Reader->TotalSize() != ExpectedSize)
+		{
+			return FString();
+		}
+
+		FSHA1 Hash;
+		TArray<uint8> Buffer;
+		Buffer.SetNumUninitialized(1024 * 1024);
+		for (int64 Offset = 0; Offset < ExpectedSize; Offset += Buffer.Num())
+		{
+			const int32 Bytes = static_cast<int32>(FMath::Min<int64>(Buffer.Num(), ExpectedSize - Offset));
+			Reader->Serialize(Buffer.GetData(), Bytes);
+			if (Reader->IsError())
+			{
+				return FString();
+			}
+			Hash.Update(Buffer.GetData(), Bytes);
+		}
+		Hash.Final();
+
+		uint8 Digest[FSHA1::DigestSize];
+		Hash.GetHash(Digest);
+		return BytesToHex(Digest, FSHA1::DigestSize).ToLower();
+	}
+
+	static FPakPlatformFile* GetPakPlatformFile()
+	{
+		return static_cast<FPakPlatformFile*>(FPlatformFileManager::Get().FindPlatformFile(FPakPlatformFile::GetTypeName()));
+	}
+
+	static bool IsPakFile(const FString& FileName)
+	{
+		// The .utoc/.ucas of an IoStore chunk are mounted along with its .pak
+		return FPaths::GetExtension(FileName) == TEXT("pak");
+	}
+
+	/** Chunk of a pakchunkN file name (pakchunk3-Android.pak), or INDEX_NONE */
+	static int32 GetPakChunkId(const FString& FileName)
+	{
+		return FileName.Len() > 8 && FileName.StartsWith(TEXT("pakchunk")) && FChar::IsDigit(FileName[8]) ? FCString::Atoi(*FileName.RightChop(8)) : INDEX_NONE;
+	}
+
+	/** Chunks of the pakchunkN files mounted from outside CacheDirectory, i.e. by the install */
+	static TSet<int32> FindInstallChunks(const FString& CacheDirectory)
+	{
+		TSet<int32> ChunkIds;
+		FPakPlatformFile* PakPlatformFile = GetPakPlatformFile();
+		if (!PakPlatformFile)
+		{
+			return ChunkIds;
+		}
+
+		const FString FullCacheDirectory = FPaths::ConvertRelativePathToFull(CacheDirectory);
+		TArray<FString> PakPaths;
+		PakPlatformFile->GetMountedPakFilenames(PakPaths);
+		for (const FString& PakPath : PakPaths)
+		{
+			const int32 ChunkId = GetPakChunkId(FPaths::GetCleanFilename(PakPath));
+			if (ChunkId != INDEX_NONE && !FPaths::IsUnderDirectory(FPaths::ConvertRelativePathToFull(PakPath), FullCacheDirectory))
+			{
+				ChunkIds.Add(ChunkId);
+			}
+		}
+		return ChunkIds;
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+namespace SuperfamilyWorldContent
+{
+	static constexpr uint32 DefaultStandInPort = 8020;
+
+	/**
+	 * Serves the manifest's files as {URL}/{Platform}/{file}, with Range
+	 * support, so the download path can be exercised without the real server
+	 */
+	class FStandInServer
+	{
+	public:
+		~FStandInServer()
+		{
+			if (Router.IsValid() && RouteHandle.IsValid())
+			{
+				Router->UnbindRoute(RouteHandle);
+			}
+		}
+
+		bool Start(const FString& InDirectory, uint32 InPort)
+		{
+			Directory = InDirectory;
+			Port = InPort;
+			Router = FHttpServerModule::Get().GetHttpRouter(Port, /* bFailOnBindFailure */ true);
+			if (!Router.IsValid())
+			{
+				return false;
+			}
+
+			RouteHandle = Router->BindRoute(FHttpPath(TEXT("/content")), EHttpServerRequestVerbs::VERB_GET,
+				FHttpRequestHandler::CreateRaw(this, &FStandInServer::HandleRequest));
+			if (!RouteHandle.IsValid())
+			{
+				return false;
+			}
+
+			FHttpServerModule::Get().StartAllListeners();
+			return true;
+		}
+
+		FString GetURL() const
+		{
+			return FString::Printf(TEXT("http://127.0.0.1:%u/content"), Port);
+		}
+
+		/** Flip a byte of the next file served, to exercise verification */
+		bool bCorruptNext = false;
+
+		/** Path of every file the manifest lists, by name; the rest are looked up in the directory */
+		TMap<FString, FString> FilePaths;
+
+	private:
+		bool HandleRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			const FString FileName = FPaths::GetCleanFilename(Request.RelativePath.GetPath());
+
+			const FString* FilePath = FilePaths.Find(FileName);
+			TArray<uint8> Bytes;
+			if (FileName.IsEmpty() || !FFileHelper::LoadFileToArray(Bytes, FilePath ? **FilePath : *FPaths::Combine(Directory, FileName)))
+			{
+				OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::NotFound));
+				return true;
+			}
+
+			int64 Start = 0;
+			const TArray<FString>* Range = Request.Headers.Find(TEXT("Range"));
+			if (Range && Range->Num() > 0 && (*Range)[0].StartsWith(TEXT("bytes=")))
+			{
+				Start = FMath::Clamp<int64>(FCString::Atoi64(*(*Range)[0].Mid(6)), 0, Bytes.Num());
+			}
+
+			TArray<uint8> Body(Bytes.GetData() + Start, static_cast<int32>(Bytes.Num() - Start));
+			if (bCorruptNext && Body.Num() > 0 && FileName != ManifestFileName)
+			{
+				Body[Body.Num() / 2] ^= 0xFF;
+				bCorruptNext = false;
+				UE_LOG(LogSuperfamily, Display, TEXT("Stand-in content server corrupted %s"), *FileName);
+			}
+
+			TUniquePtr<FHttpServerResponse> Response = FHttpServerResponse::Create(MoveTemp(Body), TEXT("application/octet-stream"));
+			if (Start > 0)
+			{
+				Response->Code = EHttpServerResponseCodes::PartialContent;
+				Response->Headers.Add(TEXT("Content-Range"), { FString::Printf(TEXT("bytes %lld-%d/%d"), Start, Bytes.Num() - 1, Bytes.Num()) });
+			}
+			OnComplete(MoveTemp(Response));
+			return true;
+		}
+
+		FString Directory;
+		uint32 Port = 0;
+		TSharedPtr<IHttpRouter> Router;
+		FHttpRouteHandle RouteHandle;
+	};
+
+	static TUniquePtr<FStandInServer> GStandInServer;
+
+	/**
+	 * Write Manifest.json for the pakchunkN files under Directory (a cooked build's Paks
+	 * directory, or the HTTP chunk install data of one build version); returns the chunk count
+	 */
+	static int32 WriteManifest(const FString& Directory, TMap<FString, FString>* OutFilePaths = nullptr)
+	{
+		// Chunk install data keeps each chunk in a pakchunkN directory of its own
+		TArray<FString> Paths;
+		IFileManager::Get().FindFilesRecursive(Paths, *Directory, TEXT("pakchunk*"), true, false);
+		Paths.Sort();
+
+		TMap<int32, TArray<TSharedPtr<FJsonValue>>> Chunks;
+		for (const FString& Path : Paths)
+		{
+			// pakchunk3-Android.pak / .utoc / .ucas
+			const FString FileName = FPaths::GetCleanFilename(Path);
+			const int32 ChunkId = GetPakChunkId(FileName);
+			if (ChunkId <= 0)
+			{
+				continue;
+			}
+
+			const int64 Size = IFileManager::Get().FileSize(*Path);
+			if (OutFilePaths)
+			{
+				OutFilePaths->Add(FileName, Path);
+			}
+
+			TSharedRef<FJsonObject> FileObject = MakeShared<FJsonObject>();
+			FileObject->SetStringField(TEXT("name"), FileName);
+			FileObject->SetNumberField(TEXT("size"), static_cast<double>(Size));
+			FileObject->SetStringField(TEXT("sha1"), HashFile(Path, Size));
+			Chunks.FindOrAdd(ChunkId).Add(MakeShared<FJsonValueObject>(FileObject));
+		}
+		Chunks.KeySort(TLess<int32>());
+
+		TArray<TSharedPtr<FJsonValue>> ChunkValues;
+		for (TPair<int32, TArray<TSharedPtr<FJsonValue>>>& Pair : Chunks)
+		{
+			TSharedRef<FJsonObject> ChunkObject = MakeShared<FJsonObject>();
+			ChunkObject->SetNumberField(TEXT("chunkId"), Pair.Key);
+			ChunkObject->SetArrayField(TEXT("files"), Pair.Value);
+			ChunkValues.Add(MakeShared<FJsonValueObject>(ChunkObject));
+		}
+
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetStringField(TEXT("buildId"), FDateTime::UtcNow().ToIso8601());
+		Root->SetArrayField(TEXT("chunks"), ChunkValues);
+
+		FString JSON;
+		FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&JSON));
+		FFileHelper::SaveStringToFile(JSON, *FPaths::Combine(Directory, ManifestFileName));
+
+		UE_LOG(LogSuperfamily, Display, TEXT("Wrote world content manifest for %d chunks in %s"), Chunks.Num(), *Directory);
+		return Chunks.Num();
+	}
+
+	static USuperfamilyWorldContentSubsystem* GetSubsystem(UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		return GameInstance ? GameInstance->GetSubsystem<USuperfamilyWorldContentSubsystem>() : nullptr;
+	}
+
+	/** Serve Directory and point the subsystem at it */
+	static bool StartStandInServer(USuperfamilyWorldContentSubsystem& Subsystem, const FString& Directory, uint32 Port)
+	{
+		if (!IFileManager::Get().DirectoryExists(*Directory))
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("No content directory %s"), *Directory);
+			return false;
+		}
+
+		TMap<FString, FString> FilePaths;
+		WriteManifest(Directory, &FilePaths);
+
+		GStandInServer = MakeUnique<FStandInServer>();
+		GStandInServer->FilePaths = MoveTemp(FilePaths);
+		if (!GStandInServer->Start(Directory, Port))
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Could not start the stand-in content server on port %u"), Port);
+			GStandInServer.Reset();
+			return false;
+		}
+
+		UE_LOG(LogSuperfamily, Display, TEXT("Stand-in content server serving %s"), *Directory);
+		Subsystem.SetContentBaseURL(GStandInServer->GetURL());
+		return true;
+	}
+}
+
+#endif // !UE_BUILD_SHIPPING
+
+// ============================================
+// Lifetime
+// ============================================
+
+void USuperfamilyWorldContentSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	CacheDirectory = FPaths::Combine(FPaths::ProjectPersistentDownloadDir(), TEXT("WorldContent"));
+	bUsePakFiles = SuperfamilyWorldContent::GetPakPlatformFile() != nullptr;
+	InstallChunkIds = SuperfamilyWorldContent::FindInstallChunks(CacheDirectory);
+
+	Collection.InitializeDependency<USuperfamilyLevelCatalogSubsystem>();
+
+	// Not blocking: only a world past the install needs it, and OpenLevel waits for that world
+	if (USuperfamilyBootSubsystem* Boot = Collection.InitializeDependency<USuperfamilyBootSubsystem>())
+	{
+		Boot->AddStage(BootStage, { USuperfamilyBootSubsystem::SaveDataStage, USuperfamilyBootSubsystem::LevelCatalogStage },
+			[this](USuperfamilyBootSubsystem::FStageDone&& Done)
+		{
+			LoadCacheIndex();
+			FetchManifest();
+			UpdateWorldsForProgress();
+			Done(true);
+		}, false);
+	}
+
+	if (USuperfamilyGameInstance* GI = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		LevelRecordedHandle = GI->OnLevelRecorded.AddUObject(this, &USuperfamilyWorldContentSubsystem::HandleLevelRecorded);
+	}
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &USuperfamilyWorldContentSubsystem::HandlePostLoadMap);
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &USuperfamilyWorldContentSubsystem::Tick), 0.5f);
+
+#if !UE_BUILD_SHIPPING
+	FString StandInDirectory;
+	if (FParse::Value(FCommandLine::Get(), TEXT("SFContentServer="), StandInDirectory))
+	{
+		uint32 Port = SuperfamilyWorldContent::DefaultStandInPort;
+		FParse::Value(FCommandLine::Get(), TEXT("SFContentServerPort="), Port);
+		SuperfamilyWorldContent::StartStandInServer(*this, StandInDirectory, Port);
+	}
+#endif
+}
+
+void USuperfamilyWorldContentSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+	if (USuperfamilyGameInstance* GI = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		GI->OnLevelRecorded.Remove(LevelRecordedHandle);
+	}
+
+	// Partial files stay on disk and resume next launch
+	for (TPair<int32, FWorldChunk>& Pair : Worlds)
+	{
+		FWorldChunk& Chunk = Pair.Value;
+		++Chunk.Serial;
+		if (Chunk.Request.IsValid())
+		{
+			Chunk.Request->OnProcessRequestComplete().Unbind();
+			Chunk.Request->CancelRequest();
+			Chunk.Request.Reset();
+		}
+		if (Chunk.DownloadStream.IsValid())
+		{
+			Chunk.DownloadStream->Close();
+			Chunk.DownloadStream.Reset();
+		}
+	}
+
+#if !UE_BUILD_SHIPPING
+	SuperfamilyWorldContent::GStandInServer.Reset();
+#endif
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Worlds
+// ============================================
+
+int32 USuperfamilyWorldContentSubsystem::GetWorldChunkId(int32 WorldID) const
+{
+	return WorldID > BaseInstallWorlds ? WorldID : 0;
+}
+
+EWorldContentState USuperfamilyWorldContentSubsystem::GetWorldState(int32 WorldID) const
+{
+	const int32 ChunkId = GetWorldChunkId(WorldID);
+	if (ChunkId == 0 || !UsesChunks() || InstallChunkIds.Contains(ChunkId))
+	{
+		return EWorldContentState::Ready;
+	}
+
+	const FWorldChunk* Chunk = Worlds.Find(WorldID);
+	return Chunk ? Chunk->State : EWorldContentState::NotInstalled;
+}
+
+float USuperfamilyWorldContentSubsystem::GetWorldProgress(int32 WorldID) const
+{
+	if (IsWorldReady(WorldID))
+	{
+		return 1.0f;
+	}
+
+	const FWorldChunk* Chunk = Worlds.Find(WorldID);
+	const int64 TotalBytes = Chunk ? Chunk->GetTotalBytes() : 0;
+	if (TotalBytes <= 0)
+	{
+		return 0.0f;
+	}
+
+	int64 DoneBytes = Chunk->FileBytesReceived;
+	for (int32 Index = 0; Index < Chunk->FilesDone && Index < Chunk->Files.Num(); ++Index)
+	{
+		DoneBytes += Chunk->Files[Index].Size;
+	}
+	return FMath::Clamp(static_cast<float>(static_cast<double>(DoneBytes) / TotalBytes), 0.0f, 1.0f);
+}
+
+int64 USuperfamilyWorldContentSubsystem::FWorldChunk::GetTotalBytes() const
+{
+	int64 Bytes = 0;
+	for (const FChunkFile& File : Files)
+	{
+		Bytes += File.Size;
+	}
+	return Bytes;
+}
+
+void USuperfamilyWorldContentSubsystem::RequestWorld(int32 WorldID, TFunction<void(bool)> OnReady)
+{
+	if (IsWorldReady(WorldID))
+	{
+		if (OnReady)
+		{
+			OnReady(true);
+		}
+		return;
+	}
+
+	FWorldChunk& Chunk = FindOrAddChunk(WorldID);
+	if (OnReady)
+	{
+		Chunk.Waiters.Add(MoveTemp(OnReady));
+
+		// Someone is waiting on it now, so a world that gave up gets another round of attempts
+		if (Chunk.State == EWorldContentState::Failed)
+		{
+			Chunk.ConsecutiveFailures = 0;
+			Chunk.NextAttemptTime = 0.0;
+			SetState(Chunk, EWorldContentState::NotInstalled);
+		}
+	}
+
+	Chunk.bWanted = true;
+	Advance(Chunk);
+}
+
+bool USuperfamilyWorldContentSubsystem::EvictWorld(int32 WorldID)
+{
+	FWorldChunk* Chunk = Worlds.Find(WorldID);
+	if (!Chunk || (!Chunk->bInstalled && !Chunk->bBusy && Chunk->FilesDone == 0))
+	{
+		return false;
+	}
+
+	if (WorldID == LoadedWorldID)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Not evicting world %d while one of its maps is loaded"), WorldID);
+		return false;
+	}
+
+	++Chunk->Serial;
+	Chunk->bBusy = false;
+	Chunk->bWanted = false;
+	if (Chunk->Request.IsValid())
+	{
+		Chunk->Request->OnProcessRequestComplete().Unbind();
+		Chunk->Request->CancelRequest();
+		Chunk->Request.Reset();
+	}
+	if (Chunk->DownloadStream.IsValid())
+	{
+		Chunk->DownloadStream->Close();
+		Chunk->DownloadStream.Reset();
+	}
+
+	if (Chunk->bMounted && bUsePakFiles)
+	{
+		FPakPlatformFile* PakPlatformFile = SuperfamilyWorldContent::GetPakPlatformFile();
+		for (const FChunkFile& File : Chunk->Files)
+		{
+			if (SuperfamilyWorldContent::IsPakFile(File.Name) && !PakPlatformFile->Unmount(*GetFilePath(File)))
+			{
+				UE_LOG(LogSuperfamily, Warning, TEXT("Could not unmount %s"), *File.Name);
+			}
+		}
+	}
+	Chunk->bMounted = false;
+
+	const int64 Bytes = Chunk->GetTotalBytes();
+	DeleteChunkFiles(*Chunk);
+	SaveCacheIndex();
+	SetState(*Chunk, EWorldContentState::NotInstalled);
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Evicted world %d content (%.1f MB)"), WorldID, Bytes / (1024.0 * 1024.0));
+
+	TArray<TFunction<void(bool)>> Waiters = MoveTemp(Chunk->Waiters);
+	for (TFunction<void(bool)>& Waiter : Waiters)
+	{
+		Waiter(false);
+	}
+	return true;
+}
+
+void USuperfamilyWorldContentSubsystem::UpdateWorldsForProgress()
+{
+	if (!UsesChunks())
+	{
+		return;
+	}
+
+	const USuperfamilyGameInstance* GI = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	if (!GI)
+	{
+		return;
+	}
+
+	TSet<int32> Needed;
+	for (const FChildProfile& Profile : GI->GetAllProfiles())
+	{
+		CollectNeededWorlds(Profile, Needed);
+	}
+	if (LoadedWorldID > 0)
+	{
+		Needed.Add(LoadedWorldID);
+	}
+
+	for (int32 WorldID : Needed)
+	{
+		if (GetWorldChunkId(WorldID) == 0 || IsWorldReady(WorldID))
+		{
+			continue;
+		}
+
+		// A world that gave up waits for someone to ask for it again
+		FWorldChunk& Chunk = FindOrAddChunk(WorldID);
+		if (Chunk.State != EWorldContentState::Failed)
+		{
+			Chunk.bWanted = true;
+			Advance(Chunk);
+		}
+	}
+
+	// Worlds nobody is in or about to reach; the most recently played are kept for replaying
+	TArray<FWorldChunk*> Finished;
+	for (TPair<int32, FWorldChunk>& Pair : Worlds)
+	{
+		FWorldChunk& Chunk = Pair.Value;
+		if ((Chunk.bInstalled || Chunk.bWanted) && !Needed.Contains(Pair.Key) && Chunk.Waiters.Num() == 0)
+		{
+			Finished.Add(&Chunk);
+		}
+	}
+	Finished.Sort([](const FWorldChunk& A, const FWorldChunk& B) { return A.LastPlayed > B.LastPlayed; });
+
+	for (int32 Index = FMath::Max(0, KeepFinishedWorlds); Index < Finished.Num(); ++Index)
+	{
+		EvictWorld(Finished[Index]->WorldID);
+	}
+}
+
+void USuperfamilyWorldContentSubsystem::SetContentBaseURL(const FString& URL)
+{
+	ContentBaseURL = URL;
+	bStandInServer = true;
+
+	// The new server's build may differ; cached chunks are compared against its manifest
+	ManifestChunks.Reset();
+	ManifestBuildID.Reset();
+	bManifestLoaded = false;
+	bManifestFresh = false;
+	ManifestFailures = 0;
+	NextManifestAttemptTime = 0.0;
+
+	for (TPair<int32, FWorldChunk>& Pair : Worlds)
+	{
+		if (Pair.Value.State == EWorldContentState::Failed)
+		{
+			Pair.Value.ConsecutiveFailures = 0;
+			SetState(Pair.Value, EWorldContentState::NotInstalled);
+		}
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("World content now comes from %s"), *URL);
+
+	FetchManifest();
+
+	const USuperfamilyBootSubsystem* Boot = GetGameInstance()->GetSubsystem<USuperfamilyBootSubsystem>();
+	if (Boot && Boot->IsStageComplete(BootStage))
+	{
+		UpdateWorldsForProgress();
+	}
+}
+
+void USuperfamilyWorldContentSubsystem::DumpStatus() const
+{
+	static const UEnum* StateEnum = StaticEnum<EWorldContentState>();
+
+	UE_LOG(LogSuperfamily, Display, TEXT("World content: %s, %s, manifest %s%s"),
+		UsesChunks() ? *GetPlatformURL() : TEXT("uncooked (loose content)"),
+		bUsePakFiles ? TEXT("paks") : TEXT("no paks"),
+		bManifestLoaded ? *ManifestBuildID : TEXT("not loaded"),
+		bManifestLoaded && !bManifestFresh ? TEXT(" (cached)") : TEXT(""));
+
+	TArray<int32> WorldIDs;
+	Worlds.GetKeys(WorldIDs);
+	WorldIDs.Sort();
+	for (int32 WorldID : WorldIDs)
+	{
+		const FWorldChunk& Chunk = Worlds[WorldID];
+		UE_LOG(LogSuperfamily, Display, TEXT("  World %2d chunk %2d: %-12s %3.0f%% of %6.1f MB%s%s%s, failures %d, last played %s"),
+			WorldID, Chunk.ChunkId, *StateEnum->GetNameStringByValue(static_cast<int64>(Chunk.State)),
+			GetWorldProgress(WorldID) * 100.0f, Chunk.GetTotalBytes() / (1024.0 * 1024.0),
+			Chunk.bInstalled ? TEXT(", installed") : TEXT(""),
+			Chunk.bMounted ? TEXT(", mounted") : TEXT(""),
+			Chunk.bWanted ? TEXT(", wanted") : TEXT(""),
+			Chunk.ConsecutiveFailures,
+			Chunk.LastPlayed > 0 ? *FDateTime::FromUnixTimestamp(Chunk.LastPlayed).ToString() : TEXT("never"));
+	}
+}
+
+// ============================================
+// Download, check, mount
+// ============================================
+
+bool USuperfamilyWorldContentSubsystem::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (UsesChunks() && !bManifestFresh && !bManifestRequestInFlight && NextManifestAttemptTime > 0.0 && Now >= NextManifestAttemptTime)
+	{
+		FetchManifest();
+	}
+
+	// A world finishing runs its waiters, which may request others and grow the map
+	TArray<int32> WorldIDs;
+	Worlds.GetKeys(WorldIDs);
+	for (int32 WorldID : WorldIDs)
+	{
+		FWorldChunk* Chunk = Worlds.Find(WorldID);
+		if (Chunk && Chunk->bWanted)
+		{
+			Advance(*Chunk);
+		}
+	}
+	return true;
+}
+
+void USuperfamilyWorldContentSubsystem::Advance(FWorldChunk& Chunk)
+{
+	if (Chunk.bBusy || Chunk.bMounted || Chunk.State == EWorldContentState::Failed || FPlatformTime::Seconds() < Chunk.NextAttemptTime)
+	{
+		return;
+	}
+
+	// Staged with the install (a build that didn't leave the chunk out): nothing to download
+	if (InstallChunkIds.Contains(Chunk.ChunkId))
+	{
+		Chunk.bWanted = false;
+		Finish(Chunk, true);
+		return;
+	}
+
+	const TArray<FChunkFile>* ManifestFiles = FindManifestFiles(Chunk.ChunkId);
+
+	if (Chunk.bInstalled)
+	{
+		// Replaced on the server since it was downloaded; nothing of it is mounted yet, so fetch the new one
+		if (bManifestFresh && ManifestFiles && *ManifestFiles != Chunk.Files)
+		{
+			UE_LOG(LogSuperfamily, Log, TEXT("World %d content changed on the server; downloading it again"), Chunk.WorldID);
+			DeleteChunkFiles(Chunk);
+			SaveCacheIndex();
+		}
+		else if (IsVerifiedOnDisk(Chunk))
+		{
+			// Untouched since it passed; hashing hundreds of MB on every launch would hold the world back
+			HandleVerified(Chunk.WorldID, Chunk.Serial, true);
+			return;
+		}
+		else
+		{
+			StartVerify(Chunk);
+			return;
+		}
+	}
+
+	if (!ManifestFiles)
+	{
+		if (bManifestFresh)
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("World %d (chunk %d) is not on the content server"), Chunk.WorldID, Chunk.ChunkId);
+			Finish(Chunk, false);
+		}
+		// Otherwise waits for the manifest
+		return;
+	}
+
+	if (Chunk.Files != *ManifestFiles)
+	{
+		Chunk.Files = *ManifestFiles;
+		Chunk.FilesDone = 0;
+	}
+
+	SetState(Chunk, EWorldContentState::Downloading);
+	DownloadNextFile(Chunk);
+}
+
+void USuperfamilyWorldContentSubsystem::DownloadNextFile(FWorldChunk& Chunk)
+{
+	IFileManager& FileManager = IFileManager::Get();
+
+	// Files completed by an earlier run; verification catches any that aren't what they seem
+	while (Chunk.FilesDone < Chunk.Files.Num())
+	{
+		const FChunkFile& File = Chunk.Files[Chunk.FilesDone];
+		const FString FilePath = GetFilePath(File);
+		const FString PartPath = FilePath + TEXT(".part");
+		if (FileManager.FileSize(*FilePath) != File.Size
+			&& !(FileManager.FileSize(*PartPath) == File.Size && FileManager.Move(*FilePath, *PartPath, true)))
+		{
+			break;
+		}
+		++Chunk.FilesDone;
+	}
+
+	if (Chunk.FilesDone == Chunk.Files.Num())
+	{
+		StartVerify(Chunk);
+		return;
+	}
+
+	const FChunkFile& File = Chunk.Files[Chunk.FilesDone];
+	const FString PartPath = GetFilePath(File) + TEXT(".part");
+	FileManager.MakeDirectory(*CacheDirectory, true);
+
+	int64 ResumeFrom = FMath::Max<int64>(0, FileManager.FileSize(*PartPath));
+	if (ResumeFrom > File.Size)
+	{
+		FileManager.Delete(*PartPath);
+		ResumeFrom = 0;
+	}
+
+	Chunk.DownloadStream = MakeShareable(FileManager.CreateFileWriter(*PartPath, ResumeFrom > 0 ? FILEWRITE_Append : FILEWRITE_None));
+	if (!Chunk.DownloadStream.IsValid())
+	{
+		OnStepFailed(Chunk, FString::Printf(TEXT("writing %s"), *PartPath));
+		return;
+	}
+	Chunk.FileBytesReceived = ResumeFrom;
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(GetPlatformURL() / File.Name);
+	Request->SetVerb(TEXT("GET"));
+	Request->SetTimeout(RequestTimeoutSeconds);
+	if (ResumeFrom > 0)
+	{
+		Request->SetHeader(TEXT("Range"), FString::Printf(TEXT("bytes=%lld-"), ResumeFrom));
+	}
+
+	// Written straight to disk; a chunk is far too big to hold in memory
+	Request->SetResponseBodyReceiveStream(Chunk.DownloadStream.ToSharedRef());
+
+	const int32 WorldID = Chunk.WorldID;
+	const uint32 Serial = Chunk.Serial;
+	Request->OnRequestProgress64().BindWeakLambda(this, [this, WorldID, Serial, ResumeFrom](FHttpRequestPtr, uint64, uint64 BytesReceived)
+	{
+		FWorldChunk* Target = Worlds.Find(WorldID);
+		if (Target && Target->Serial == Serial)
+		{
+			Target->FileBytesReceived = ResumeFrom + static_cast<int64>(BytesReceived);
+		}
+	});
+	Request->OnProcessRequestComplete().BindWeakLambda(this, [this, WorldID, Serial](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnected)
+	{
+		HandleFileDownloaded(WorldID, Serial, bConnected && Response.IsValid(), Response.IsValid() ? Response->GetResponseCode() : 0);
+	});
+
+	Chunk.Request = Request;
+	Chunk.bBusy = true;
+	Request->ProcessRequest();
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Downloading %s for world %d%s"), *File.Name, WorldID,
+		ResumeFrom > 0 ? *FString::Printf(TEXT(" from byte %lld"), ResumeFrom) : TEXT(""));
+}
+
+void USuperfamilyWorldContentSubsystem::HandleFileDownloaded(int32 WorldID, uint32 Serial, bool bSucceeded, int32 ResponseCode)
+{
+	FWorldChunk* Chunk = Worlds.Find(WorldID);
+	if (!Chunk || Chunk->Serial != Serial)
+	{
+		return;
+	}
+
+	Chunk->bBusy = false;
+	Chunk->Request.Reset();
+	if (Chunk->DownloadStream.IsValid())
+	{
+		Chunk->DownloadStream->Close();
+		Chunk->DownloadStream.Reset();
+	}
+
+	const FChunkFile& File = Chunk->Files[Chunk->FilesDone];
+	const FString FilePath = GetFilePath(File);
+	const FString PartPath = FilePath + TEXT(".part");
+	const int64 PartSize = IFileManager::Get().FileSize(*PartPath);
+
+	if (!bSucceeded || !EHttpResponseCodes::IsOk(ResponseCode) || PartSize != File.Size)
+	{
+		// A lost connection keeps its bytes for the next attempt to resume; a bad answer doesn't
+		if (PartSize > File.Size || (bSucceeded && ResponseCode != 0))
+		{
+			IFileManager::Get().Delete(*PartPath);
+		}
+		OnStepFailed(*Chunk, FString::Printf(TEXT("download of %s (%d, %lld of %lld bytes)"), *File.Name, ResponseCode, PartSize, File.Size));
+		return;
+	}
+
+	if (!IFileManager::Get().Move(*FilePath, *PartPath, true))
+	{
+		OnStepFailed(*Chunk, FString::Printf(TEXT("moving %s into place"), *File.Name));
+		return;
+	}
+
+	++Chunk->FilesDone;
+	Chunk->FileBytesReceived = 0;
+	Chunk->ConsecutiveFailures = 0;
+	DownloadNextFile(*Chunk);
+}
+
+void USuperfamilyWorldContentSubsystem::StartVerify(FWorldChunk& Chunk)
+{
+	SetState(Chunk, EWorldContentState::Verifying);
+	Chunk.bBusy = true;
+
+	TArray<FString> Paths;
+	for (const FChunkFile& File : Chunk.Files)
+	{
+		Paths.Add(GetFilePath(File));
+	}
+
+	TWeakObjectPtr<USuperfamilyWorldContentSubsystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, WorldID = Chunk.WorldID, Serial = Chunk.Serial, Files = Chunk.Files, Paths = MoveTemp(Paths)]()
+	{
+		bool bVerified = Files.Num() > 0;
+		for (int32 Index = 0; Index < Files.Num() && bVerified; ++Index)
+		{
+			bVerified = SuperfamilyWorldContent::HashFile(Paths[Index], Files[Index].Size) == Files[Index].Hash;
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, WorldID, Serial, bVerified]()
+		{
+			if (USuperfamilyWorldContentSubsystem* This = WeakThis.Get())
+			{
+				This->HandleVerified(WorldID, Serial, bVerified);
+			}
+		});
+	});
+}
+
+bool USuperfamilyWorldContentSubsystem::IsVerifiedOnDisk(const FWorldChunk& Chunk) const
+{
+	IFileManager& FileManager = IFileManager::Get();
+	for (const FChunkFile& File : Chunk.Files)
+	{
+		const FString FilePath = GetFilePath(File);
+		if (File.VerifiedModTime == 0 || FileManager.FileSize(*FilePath) != File.Size
+			|| FileManager.GetTimeStamp(*FilePath).ToUnixTimestamp() != File.VerifiedModTime)
+		{
+			return false;
+		}
+	}
+	return Chunk.Files.Num() > 0;
+}
+
+void USuperfamilyWorldContentSubsystem::HandleVerified(int32 WorldID, uint32 Serial, bool bVerified)
+{
+	FWorldChunk* Chunk = Worlds.Find(WorldID);
+	if (!Chunk || Chunk->Serial != Serial)
+	{
+		return;
+	}
+
+	Chunk->bBusy = false;
+
+	if (!bVerified)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("World %d content failed its checksum; downloading it again"), WorldID);
+		DeleteChunkFiles(*Chunk);
+		SaveCacheIndex();
+		OnStepFailed(*Chunk, TEXT("checksum"));
+		return;
+	}
+
+	// Size and modification time stand in for the hash on later launches
+	bool bIndexChanged = false;
+	for (FChunkFile& File : Chunk->Files)
+	{
+		const int64 ModTime = IFileManager::Get().GetTimeStamp(*GetFilePath(File)).ToUnixTimestamp();
+		bIndexChanged |= File.VerifiedModTime != ModTime;
+		File.VerifiedModTime = ModTime;
+	}
+
+	if (!Chunk->bInstalled)
+	{
+		Chunk->bInstalled = true;
+		if (Chunk->LastPlayed == 0)
+		{
+			// Counts as just played, so a fresh download isn't the first finished world evicted
+			Chunk->LastPlayed = FDateTime::UtcNow().ToUnixTimestamp();
+		}
+		bIndexChanged = true;
+	}
+
+	if (bIndexChanged)
+	{
+		SaveCacheIndex();
+	}
+
+	if (!Mount(*Chunk))
+	{
+		DeleteChunkFiles(*Chunk);
+		SaveCacheIndex();
+		OnStepFailed(*Chunk, TEXT("mount"));
+		return;
+	}
+
+	Chunk->bMounted = true;
+	Chunk->ConsecutiveFailures = 0;
+
+	UE_LOG(LogSuperfamily, Log, TEXT("World %d content ready (%.1f MB)"), WorldID, Chunk->GetTotalBytes() / (1024.0 * 1024.0));
+	Finish(*Chunk, true);
+}
+
+bool USuperfamilyWorldContentSubsystem::Mount(FWorldChunk& Chunk)
+{
+	// Loose content served by a stand-in server in an uncooked build: nothing to mount
+	if (!bUsePakFiles)
+	{
+		return true;
+	}
+
+	FPakPlatformFile* PakPlatformFile = SuperfamilyWorldContent::GetPakPlatformFile();
+	bool bMountedAny = false;
+	for (const FChunkFile& File : Chunk.Files)
+	{
+		if (!SuperfamilyWorldContent::IsPakFile(File.Name))
+		{
+			continue;
+		}
+
+		if (!PakPlatformFile->Mount(*GetFilePath(File), SuperfamilyWorldContent::ChunkPakOrder))
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Could not mount %s"), *File.Name);
+			return false;
+		}
+		bMountedAny = true;
+	}
+	return bMountedAny;
+}
+
+void USuperfamilyWorldContentSubsystem::OnStepFailed(FWorldChunk& Chunk, const FString& Reason)
+{
+	++Chunk.ConsecutiveFailures;
+	if (Chunk.ConsecutiveFailures >= FMath::Max(1, MaxAttempts))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("World %d: %s failed, giving up after %d attempts"), Chunk.WorldID, *Reason, Chunk.ConsecutiveFailures);
+		Finish(Chunk, false);
+		return;
+	}
+
+	const double Backoff = FMath::Min(60.0, FMath::Pow(2.0, Chunk.ConsecutiveFailures - 1));
+	Chunk.NextAttemptTime = FPlatformTime::Seconds() + Backoff;
+	UE_LOG(LogSuperfamily, Log, TEXT("World %d: %s failed, retrying in %.0fs"), Chunk.WorldID, *Reason, Backoff);
+}
+
+void USuperfamilyWorldContentSubsystem::SetState(FWorldChunk& Chunk, EWorldContentState State)
+{
+	if (Chunk.State != State)
+	{
+		Chunk.State = State;
+		OnWorldStateChanged.Broadcast(Chunk.WorldID, State);
+	}
+}
+
+void USuperfamilyWorldContentSubsystem::Finish(FWorldChunk& Chunk, bool bReady)
+{
+	SetState(Chunk, bReady ? EWorldContentState::Ready : EWorldContentState::Failed);
+	if (!bReady)
+	{
+		Chunk.bWanted = false;
+	}
+
+	// A waiter may request or evict worlds, so run them off a copy
+	TArray<TFunction<void(bool)>> Waiters = MoveTemp(Chunk.Waiters);
+	for (TFunction<void(bool)>& Waiter : Waiters)
+	{
+		Waiter(bReady);
+	}
+}
+
+void USuperfamilyWorldContentSubsystem::DeleteChunkFiles(FWorldChunk& Chunk)
+{
+	IFileManager& FileManager = IFileManager::Get();
+	for (const FChunkFile& File : Chunk.Files)
+	{
+		const FString FilePath = GetFilePath(File);
+		FileManager.Delete(*FilePath, false, true, true);
+		FileManager.Delete(*(FilePath + TEXT(".part")), false, true, true);
+	}
+
+	Chunk.bInstalled = false;
+	Chunk.FilesDone = 0;
+	Chunk.FileBytesReceived = 0;
+}
+
+USuperfamilyWorldContentSubsystem::FWorldChunk& USuperfamilyWorldContentSubsystem::FindOrAddChunk(int32 WorldID)
+{
+	FWorldChunk& Chunk = Worlds.FindOrAdd(WorldID);
+	Chunk.WorldID = WorldID;
+	Chunk.ChunkId = GetWorldChunkId(WorldID);
+	return Chunk;
+}
+
+// ============================================
+// Progress
+// ============================================
+
+void USuperfamilyWorldContentSubsystem::CollectNeededWorlds(const FChildProfile& Profile, TSet<int32>& OutWorlds) const
+{
+	auto IsCompleted = [&Profile](int32 WorldID, int32 LevelID)
+	{
+		const FLevelProgress* Progress = Profile.LevelProgress.Find(FLevelKey(WorldID, LevelID));
+		return Progress && Progress->bCompleted;
+	};
+
+	// A world opens once the previous world's boss is beaten
+	int32 WorldID = 1;
+	while (IsWorldCatalogued(WorldID + 1) && IsCompleted(WorldID, GetBossLevelID(WorldID)))
+	{
+		++WorldID;
+	}
+	OutWorlds.Add(WorldID);
+
+	// Levels unlock one after another, so the next one to play follows the completed run
+	int32 NextLevelID = 1;
+	while (IsCompleted(WorldID, NextLevelID))
+	{
+		++NextLevelID;
+	}
+
+	if (IsWorldCatalogued(WorldID + 1) && GetBossLevelID(WorldID) - NextLevelID <= PrefetchLevelsBeforeBoss)
+	{
+		OutWorlds.Add(WorldID + 1);
+	}
+}
+
+int32 USuperfamilyWorldContentSubsystem::GetBossLevelID(int32 WorldID) const
+{
+	const USuperfamilyLevelCatalogSubsystem* LevelCatalog = GetGameInstance()->GetSubsystem<USuperfamilyLevelCatalogSubsystem>();
+	if (const USuperfamilyLevelCatalog* Catalog = LevelCatalog ? LevelCatalog->GetCatalog() : nullptr)
+	{
+		for (const FLevelCatalogEntry& Entry : Catalog->GetEntries())
+		{
+			if (Entry.WorldID == WorldID && Entry.bIsBoss)
+			{
+				return Entry.LevelID;
+			}
+		}
+	}
+
+	// Same assumption as USuperfamilyGameInstance::IsLevelUnlocked
+	return 10;
+}
+
+bool USuperfamilyWorldContentSubsystem::IsWorldCatalogued(int32 WorldID) const
+{
+	const USuperfamilyLevelCatalogSubsystem* LevelCatalog = GetGameInstance()->GetSubsystem<USuperfamilyLevelCatalogSubsystem>();
+	const USuperfamilyLevelCatalog* Catalog = LevelCatalog ? LevelCatalog->GetCatalog() : nullptr;
+	if (!Catalog)
+	{
+		// Without a catalog there is nothing to look ahead to
+		return false;
+	}
+
+	return Catalog->GetEntries().ContainsByPredicate([WorldID](const FLevelCatalogEntry& Entry) { return Entry.WorldID == WorldID; });
+}
+
+void USuperfamilyWorldContentSubsystem::HandlePostLoadMap(UWorld* LoadedWorld)
+{
+	const USuperfamilyLevelCatalogSubsystem* LevelCatalog = GetGameInstance()->GetSubsystem<USuperfamilyLevelCatalogSubsystem>();
+	const FLevelCatalogEntry* Entry = LevelCatalog ? LevelCatalog->FindEntryForWorld(LoadedWorld) : nullptr;
+	LoadedWorldID = Entry ? Entry->WorldID : 0;
+
+	if (FWorldChunk* Chunk = Worlds.Find(LoadedWorldID))
+	{
+		Chunk->LastPlayed = FDateTime::UtcNow().ToUnixTimestamp();
+		if (Chunk->bInstalled)
+		{
+			SaveCacheIndex();
+		}
+	}
+
+	// The previous map is gone, so the world it belonged to can be evicted now
+	UpdateWorldsForProgress();
+}
+
+void USuperfamilyWorldContentSubsystem::HandleLevelRecorded(const FChildId& ChildID, int32 WorldID, int32 LevelID, int32 Stars, int32 PreviousStars)
+{
+	UpdateWorldsForProgress();
+}
+
+// ============================================
+// Manifest and cache index
+// ============================================
+
+void USuperfamilyWorldContentSubsystem::FetchManifest()
+{
+	if (!UsesChunks() || bManifestRequestInFlight)
+	{
+		return;
+	}
+
+	bManifestRequestInFlight = true;
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(GetPlatformURL() / SuperfamilyWorldContent::ManifestFileName);
+	Request->SetVerb(TEXT("GET"));
+	Request->SetTimeout(RequestTimeoutSeconds);
+	Request->OnProcessRequestComplete().BindWeakLambda(this, [this](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnected)
+	{
+		bManifestRequestInFlight = false;
+
+		const bool bFetched = bConnected && Response.IsValid() && EHttpResponseCodes::IsOk(Response->GetResponseCode());
+		if (!bFetched || !ParseManifest(Response->GetContentAsString()))
+		{
+			++ManifestFailures;
+			const double Backoff = FMath::Min(300.0, 5.0 * FMath::Pow(2.0, ManifestFailures - 1));
+			NextManifestAttemptTime = FPlatformTime::Seconds() + Backoff;
+			UE_LOG(LogSuperfamily, Warning, TEXT("Could not fetch the world content manifest (%d), retrying in %.0fs%s"),
+				Response.IsValid() ? Response->GetResponseCode() : 0, Backoff, bManifestLoaded ? TEXT("; using the cached one") : TEXT(""));
+			return;
+		}
+
+		bManifestFresh = true;
+		ManifestFailures = 0;
+		FFileHelper::SaveStringToFile(Response->GetContentAsString(), *FPaths::Combine(CacheDirectory, SuperfamilyWorldContent::ManifestFileName));
+
+		UE_LOG(LogSuperfamily, Log, TEXT("World content manifest %s: %d chunks"), *ManifestBuildID, ManifestChunks.Num());
+	});
+	Request->ProcessRequest();
+}
+
+bool USuperfamilyWorldContentSubsystem::ParseManifest(const FString& JSON)
+{
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JSON);
+	const TArray<TSharedPtr<FJsonValue>>* ChunkValues = nullptr;
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid() || !Root->TryGetArrayField(TEXT("chunks"), ChunkValues))
+	{
+		return false;
+	}
+
+	TMap<int32, TArray<FChunkFile>> Chunks;
+	for (const TSharedPtr<FJsonValue>& Value : *ChunkValues)
+	{
+		const TSharedPtr<FJsonObject>* ChunkObject = nullptr;
+		int32 ChunkId = 0;
+		TArray<FChunkFile> Files;
+		if (Value->TryGetObject(ChunkObject) && (*ChunkObject)->TryGetNumberField(TEXT("chunkId"), ChunkId) && ReadFiles(**ChunkObject, Files))
+		{
+			Chunks.Add(ChunkId, MoveTemp(Files));
+		}
+	}
+
+	ManifestChunks = MoveTemp(Chunks);
+	ManifestBuildID = Root->GetStringField(TEXT("buildId"));
+	bManifestLoaded = true;
+	return true;
+}
+
+const TArray<USuperfamilyWorldContentSubsystem::FChunkFile>* USuperfamilyWorldContentSubsystem::FindManifestFiles(int32 ChunkId) const
+{
+	return bManifestLoaded ? ManifestChunks.Find(ChunkId) : nullptr;
+}
+
+void USuperfamilyWorldContentSubsystem::LoadCacheIndex()
+{
+	// Last session's manifest lets cached worlds be checked and downloads resume before the server answers
+	FString JSON;
+	if (FFileHelper::LoadFileToString(JSON, *FPaths::Combine(CacheDirectory, SuperfamilyWorldContent::ManifestFileName)) && !bManifestLoaded)
+	{
+		ParseManifest(JSON);
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	const TArray<TSharedPtr<FJsonValue>>* WorldValues = nullptr;
+	if (!FFileHelper::LoadFileToString(JSON, *FPaths::Combine(CacheDirectory, SuperfamilyWorldContent::CacheIndexFileName))
+		|| !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(JSON), Root) || !Root.IsValid()
+		|| !Root->TryGetArrayField(TEXT("worlds"), WorldValues))
+	{
+		return;
+	}
+
+	for (const TSharedPtr<FJsonValue>& Value : *WorldValues)
+	{
+		const TSharedPtr<FJsonObject>* WorldObject = nullptr;
+		int32 WorldID = 0;
+		int32 ChunkId = 0;
+		TArray<FChunkFile> Files;
+		if (!Value->TryGetObject(WorldObject) || !(*WorldObject)->TryGetNumberField(TEXT("worldId"), WorldID)
+			|| !(*WorldObject)->TryGetNumberField(TEXT("chunkId"), ChunkId) || !ReadFiles(**WorldObject, Files))
+		{
+			continue;
+		}
+
+		FWorldChunk& Chunk = FindOrAddChunk(WorldID);
+		Chunk.Files = MoveTemp(Files);
+
+		// Chunk layout changed with BaseInstallWorlds, or this build staged the chunk: the world now ships in the install
+		if (Chunk.ChunkId != ChunkId || InstallChunkIds.Contains(ChunkId))
+		{
+			DeleteChunkFiles(Chunk);
+			Worlds.Remove(WorldID);
+			continue;
+		}
+
+		Chunk.bInstalled = true;
+		Chunk.FilesDone = Chunk.Files.Num();
+		int64 LastPlayed = 0;
+		(*WorldObject)->TryGetNumberField(TEXT("lastPlayed"), LastPlayed);
+		Chunk.LastPlayed = LastPlayed;
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("World content cache: %d installed worlds"), WorldValues->Num());
+}
+
+void USuperfamilyWorldContentSubsystem::SaveCacheIndex() const
+{
+	TArray<TSharedPtr<FJsonValue>> WorldValues;
+	for (const TPair<int32, FWorldChunk>& Pair : Worlds)
+	{
+		const FWorldChunk& Chunk = Pair.Value;
+		if (!Chunk.bInstalled)
+		{
+			continue;
+		}
+
+		TSharedRef<FJsonObject> WorldObject = MakeShared<FJsonObject>();
+		WorldObject->SetNumberField(TEXT("worldId"), Chunk.WorldID);
+		WorldObject->SetNumberField(TEXT("chunkId"), Chunk.ChunkId);
+		WorldObject->SetNumberField(TEXT("lastPlayed"), static_cast<double>(Chunk.LastPlayed));
+		WorldObject->SetArrayField(TEXT("files"), WriteFiles(Chunk.Files));
+		WorldValues.Add(MakeShared<FJsonValueObject>(WorldObject));
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetArrayField(TEXT("worlds"), WorldValues);
+
+	FString JSON;
+	FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&JSON));
+	if (!FFileHelper::SaveStringToFile(JSON, *FPaths::Combine(CacheDirectory, SuperfamilyWorldContent::CacheIndexFileName)))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Could not save the world content cache index"));
+	}
+}
+
+bool USuperfamilyWorldContentSubsystem::ReadFiles(const FJsonObject& Object, TArray<FChunkFile>& OutFiles)
+{
+	const TArray<TSharedPtr<FJsonValue>>* FileValues = nullptr;
+	if (!Object.TryGetArrayField(TEXT("files"), FileValues))
+	{
+		return false;
+	}
+
+	for (const TSharedPtr<FJsonValue>& Value : *FileValues)
+	{
+		const TSharedPtr<FJsonObject>* FileObject = nullptr;
+		FChunkFile File;
+		if (!Value->TryGetObject(FileObject) || !(*FileObject)->TryGetStringField(TEXT("name"), File.Name)
+			|| !(*FileObject)->TryGetNumberField(TEXT("size"), File.Size) || !(*FileObject)->TryGetStringField(TEXT("sha1"), File.Hash))
+		{
+			return false;
+		}
+
+		// Only in the cache index
+		(*FileObject)->TryGetNumberField(TEXT("verified"), File.VerifiedModTime);
+
+		// Names come from the server and become paths in the cache directory
+		if (File.Name.IsEmpty() || File.Name != FPaths::GetCleanFilename(File.Name) || File.Name.Contains(TEXT("..")))
+		{
+			return false;
+		}
+		OutFiles.Add(MoveTemp(File));
+	}
+	return OutFiles.Num() > 0;
+}
+
+TArray<TSharedPtr<FJsonValue>> USuperfamilyWorldContentSubsystem::WriteFiles(const TArray<FChunkFile>& Files)
+{
+	TArray<TSharedPtr<FJsonValue>> FileValues;
+	for (const FChunkFile& File : Files)
+	{
+		TSharedRef<FJsonObject> FileObject = MakeShared<FJsonObject>();
+		FileObject->SetStringField(TEXT("name"), File.Name);
+		FileObject->SetNumberField(TEXT("size"), static_cast<double>(File.Size));
+		FileObject->SetStringField(TEXT("sha1"), File.Hash);
+		if (File.VerifiedModTime != 0)
+		{
+			FileObject->SetNumberField(TEXT("verified"), static_cast<double>(File.VerifiedModTime));
+		}
+		FileValues.Add(MakeShared<FJsonValueObject>(FileObject));
+	}
+	return FileValues;
+}
+
+FString USuperfamilyWorldContentSubsystem::GetFilePath(const FChunkFile& File) const
+{
+	return FPaths::Combine(CacheDirectory, File.Name);
+}
+
+FString USuperfamilyWorldContentSubsystem::GetPlatformURL() const
+{
+	return ContentBaseURL / FPlatformProperties::IniPlatformName();
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorldAndArgs GSuperfamilyContentServeCommand(
+	TEXT("sf.Content.Serve"),
+	TEXT("Serve a cooked build's pakchunk files (Paks or chunk install directory) as the content server. Same as -SFContentServer=<Dir>. Usage: sf.Content.Serve <Dir> [Port]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		USuperfamilyWorldContentSubsystem* Subsystem = SuperfamilyWorldContent::GetSubsystem(World);
+		if (Subsystem && Args.Num() > 0)
+		{
+			SuperfamilyWorldContent::StartStandInServer(*Subsystem, Args[0], Args.Num() > 1 ? FCString::Atoi(*Args[1]) : SuperfamilyWorldContent::DefaultStandInPort);
+		}
+	}));
+
+static FAutoConsoleCommand GSuperfamilyContentWriteManifestCommand(
+	TEXT("sf.Content.WriteManifest"),
+	TEXT("Write Manifest.json for the pakchunk files under a directory, for uploading to the content server. Usage: sf.Content.WriteManifest <Dir>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() > 0)
+		{
+			SuperfamilyWorldContent::WriteManifest(Args[0]);
+		}
+	}));
+
+static FAutoConsoleCommand GSuperfamilyContentCorruptNextCommand(
+	TEXT("sf.Content.CorruptNext"),
+	TEXT("Make the stand-in content server flip a byte of the next file it serves"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (SuperfamilyWorldContent::GStandInServer.IsValid())
+		{
+			SuperfamilyWorldContent::GStandInServer->bCorruptNext = true;
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld GSuperfamilyContentStatusCommand(
+	TEXT("sf.Content.Status"),
+	TEXT("Log the state of every known world's content"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const USuperfamilyWorldContentSubsystem* Subsystem = SuperfamilyWorldContent::GetSubsystem(World))
+		{
+			Subsystem->DumpStatus();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GSuperfamilyContentInstallCommand(
+	TEXT("sf.Content.Install"),
+	TEXT("Download and mount a world's content. Usage: sf.Content.Install <WorldID>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		USuperfamilyWorldContentSubsystem* Subsystem = SuperfamilyWorldContent::GetSubsystem(World);
+		if (Subsystem && Args.Num() > 0)
+		{
+			const int32 WorldID = FCString::Atoi(*Args[0]);
+			Subsystem->RequestWorld(WorldID, [WorldID](bool bReady)
+			{
+				UE_LOG(LogSuperfamily, Display, TEXT("World %d %s"), WorldID, bReady ? TEXT("is ready") : TEXT("could not be installed"));
+			});
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GSuperfamilyContentEvictCommand(
+	TEXT("sf.Content.Evict"),
+	TEXT("Unmount and delete a downloaded world's content. Usage: sf.Content.Evict <WorldID>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		USuperfamilyWorldContentSubsystem* Subsystem = SuperfamilyWorldContent::GetSubsystem(World);
+		if (Subsystem && Args.Num() > 0)
+		{
+			Subsystem->EvictWorld(FCString::Atoi(*Args[0]));
+		}
+	}));
+
+#endif // !UE_BUILD_SHIPPING
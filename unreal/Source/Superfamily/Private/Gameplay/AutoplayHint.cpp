@@ -0,0 +1,25 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Gameplay/AutoplayHint.h"
+#include "Components/BillboardComponent.h"
+#include "Components/SceneComponent.h"
+
+AAutoplayHint::AAutoplayHint(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryActorTick.bCanEverTick = false;
+	SetHidden(true);
+	SetCanBeDamaged(false);
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent->SetMobility(EComponentMobility::Static);
+
+#if WITH_EDITORONLY_DATA
+	Sprite = CreateEditorOnlyDefaultSubobject<UBillboardComponent>(TEXT("Sprite"));
+	if (Sprite)
+	{
+		Sprite->SetupAttachment(RootComponent);
+		Sprite->bIsScreenSizeScaled = true;
+	}
+#endif
+}
@@ -0,0 +1,197 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Gameplay/BossEncounterPreloader.h"
+#include "Gameplay/QuestionSetProvider.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyGameModeBase.h"
+#include "Core/SuperfamilyStats.h"
+#include "Gameplay/SuperfamilyVoiceOverSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "Misc/PackageName.h"
+
+void UBossEncounterPreloader::Deinitialize()
+{
+	Release();
+
+	Super::Deinitialize();
+}
+
+void UBossEncounterPreloader::Prepare(const FBossEncounterRequest& Request)
+{
+	LLM_SCOPE_BYTAG(Superfamily);
+
+	if ((bIsPreparing || bIsPrepared) && Request == CurrentRequest)
+	{
+		return;
+	}
+
+	Release();
+
+	CurrentRequest = Request;
+	bIsPreparing = true;
+	PrepareStartTime = FPlatformTime::Seconds();
+
+	IQuestionSetProvider* Provider = nullptr;
+	for (UGameInstanceSubsystem* Subsystem : GetGameInstance()->GetSubsystemArray<UGameInstanceSubsystem>())
+	{
+		if ((Provider = Cast<IQuestionSetProvider>(Subsystem)) != nullptr)
+		{
+			break;
+		}
+	}
+
+	if (!Provider)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("No question provider; boss encounter for world %d starts without questions"), Request.WorldID);
+		HandleQuestionsReceived(TArray<FQuestionData>());
+		return;
+	}
+
+	TWeakObjectPtr<UBossEncounterPreloader> WeakThis(this);
+	const int32 Serial = RequestSerial;
+	Provider->RequestQuestionSet(Request.Subject, Request.Difficulty, Request.QuestionCount,
+		[WeakThis, Serial](TArray<FQuestionData>&& InQuestions)
+		{
+			UBossEncounterPreloader* This = WeakThis.Get();
+			if (This && This->RequestSerial == Serial)
+			{
+				This->HandleQuestionsReceived(MoveTemp(InQuestions));
+			}
+		});
+}
+
+void UBossEncounterPreloader::Release()
+{
+	++RequestSerial;
+
+	for (const TSharedPtr<FStreamableHandle>& Handle : Handles)
+	{
+		if (Handle.IsValid())
+		{
+			Handle->ReleaseHandle();
+		}
+	}
+
+	Handles.Reset();
+	Questions.Reset();
+	Timings.Reset();
+	PendingQuestions = 0;
+	bIsPreparing = false;
+	bIsPrepared = false;
+}
+
+int64 UBossEncounterPreloader::GetBudgetedMemoryBytes() const
+{
+	int64 Bytes = Questions.GetAllocatedSize();
+	for (const TSharedPtr<FStreamableHandle>& Handle : Handles)
+	{
+		if (Handle.IsValid())
+		{
+			Bytes += GetLoadedAssetBytes(*Handle);
+		}
+	}
+	return Bytes;
+}
+
+int64 UBossEncounterPreloader::TrimMemory(int64 BytesToFree)
+{
+	// The fight's voice-over and images are in use; a set prepared ahead is simply prepared again at the boss
+	const UWorld* World = GetGameInstance()->GetWorld();
+	if (World && World->GetAuthGameMode<ASuperfamilyBossGameMode>())
+	{
+		return 0;
+	}
+
+	const int64 Bytes = GetBudgetedMemoryBytes();
+	Release();
+	return Bytes;
+}
+
+FSoftObjectPath UBossEncounterPreloader::GetAudioCuePath(const FString& AudioCueID) const
+{
+	const USuperfamilyVoiceOverSubsystem* VoiceOver = GetGameInstance()->GetSubsystem<USuperfamilyVoiceOverSubsystem>();
+	return VoiceOver ? VoiceOver->ResolveCue(AudioCueID).ToSoftObjectPath() : FSoftObjectPath();
+}
+
+void UBossEncounterPreloader::HandleQuestionsReceived(TArray<FQuestionData>&& InQuestions)
+{
+	LLM_SCOPE_BYTAG(Superfamily);
+
+	Questions = MoveTemp(InQuestions);
+	QuestionsReceivedTime = FPlatformTime::Seconds();
+
+	Timings.SetNum(Questions.Num());
+	Handles.SetNum(Questions.Num());
+
+	// One extra so completions that fire synchronously can't finish before every load is issued
+	PendingQuestions = Questions.Num() + 1;
+
+	FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+	for (int32 Index = 0; Index < Questions.Num(); ++Index)
+	{
+		const FQuestionData& Question = Questions[Index];
+		Timings[Index].QuestionID = Question.QuestionID;
+
+		TArray<FSoftObjectPath> AssetPaths;
+		const FSoftObjectPath AudioCuePath = Question.AudioCueID.IsEmpty() ? FSoftObjectPath() : GetAudioCuePath(Question.AudioCueID);
+		if (!AudioCuePath.IsNull())
+		{
+			AssetPaths.Add(AudioCuePath);
+		}
+
+		// Remote image URLs are fetched by the UI; only cooked assets can be preloaded here
+		if (!Question.ImageAssetPath.IsEmpty() && FPackageName::IsValidObjectPath(Question.ImageAssetPath))
+		{
+			AssetPaths.Add(FSoftObjectPath(Question.ImageAssetPath));
+		}
+
+		Timings[Index].AssetCount = AssetPaths.Num();
+		if (AssetPaths.Num() == 0)
+		{
+			--PendingQuestions;
+			continue;
+		}
+
+		Handles[Index] = Streamable.RequestAsyncLoad(MoveTemp(AssetPaths),
+			FStreamableDelegate::CreateUObject(this, &UBossEncounterPreloader::HandleQuestionAssetsLoaded, Index, RequestSerial),
+			FStreamableManager::AsyncLoadHighPriority);
+	}
+
+	--PendingQuestions;
+	FinishIfComplete();
+}
+
+void UBossEncounterPreloader::HandleQuestionAssetsLoaded(int32 QuestionIndex, int32 Serial)
+{
+	if (Serial != RequestSerial || !Timings.IsValidIndex(QuestionIndex))
+	{
+		return;
+	}
+
+	Timings[QuestionIndex].PrepareSeconds = static_cast<float>(FPlatformTime::Seconds() - QuestionsReceivedTime);
+	--PendingQuestions;
+	FinishIfComplete();
+}
+
+void UBossEncounterPreloader::FinishIfComplete()
+{
+	if (!bIsPreparing || PendingQuestions > 0)
+	{
+		return;
+	}
+
+	bIsPreparing = false;
+	bIsPrepared = true;
+
+	const double Now = FPlatformTime::Seconds();
+	UE_LOG(LogSuperfamily, Log, TEXT("Boss encounter for world %d prepared: %d questions in %.2fs (fetch %.2fs)"),
+		CurrentRequest.WorldID, Questions.Num(), Now - PrepareStartTime, QuestionsReceivedTime - PrepareStartTime);
+	for (const FBossQuestionTiming& Timing : Timings)
+	{
+		UE_LOG(LogSuperfamily, Log, TEXT("  %s: %d assets in %.2fs"), *Timing.QuestionID.ToString(), Timing.AssetCount, Timing.PrepareSeconds);
+	}
+
+	OnPrepared.Broadcast();
+}
@@ -0,0 +1,206 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Gameplay/CollectibleFieldComponent.h"
+#include "Characters/SuperfamilyPlayerCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "Kismet/GameplayStatics.h"
+
+UCollectibleFieldComponent::UCollectibleFieldComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	// Pickups come from the spatial hash, not from per-instance overlaps
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	SetCanEverAffectNavigation(false);
+	CastShadow = false;
+}
+
+void UCollectibleFieldComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const int32 NumInstances = GetInstanceCount();
+	CoinLocations.SetNumUninitialized(NumInstances);
+	OriginalTransforms.SetNumUninitialized(NumInstances);
+	for (int32 Index = 0; Index < NumInstances; ++Index)
+	{
+		FTransform WorldTransform;
+		GetInstanceTransform(Index, WorldTransform, true);
+		CoinLocations[Index] = WorldTransform.GetLocation();
+		GetInstanceTransform(Index, OriginalTransforms[Index], false);
+	}
+
+	CollectedFlags.Init(false, NumInstances);
+	CollectedCount = 0;
+
+	RebuildSpatialHash();
+}
+
+void UCollectibleFieldComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (CollectedCount == CoinLocations.Num())
+	{
+		return;
+	}
+
+	ASuperfamilyPlayerCharacter* Player = CachedPlayer.Get();
+	if (!Player)
+	{
+		Player = Cast<ASuperfamilyPlayerCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+		CachedPlayer = Player;
+		if (!Player)
+		{
+			return;
+		}
+	}
+
+	// Coins don't move, so a stationary player can't pick anything new up
+	const FVector PlayerLocation = Player->GetActorLocation();
+	if (PlayerLocation.Equals(LastQueryLocation, 0.1f))
+	{
+		return;
+	}
+	LastQueryLocation = PlayerLocation;
+
+	TArray<int32> Picked;
+	QueryPickups(Player, Picked);
+	if (Picked.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FVector> PickedLocations;
+	PickedLocations.Reserve(Picked.Num());
+	for (const int32 CoinIndex : Picked)
+	{
+		CollectedFlags[CoinIndex] = true;
+		PickedLocations.Add(CoinLocations[CoinIndex]);
+
+		const FVector& Location = CoinLocations[CoinIndex];
+		const uint64 Key = GetCellKey(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+		if (TArray<int32>* Cell = SpatialHash.Find(Key))
+		{
+			Cell->RemoveSingleSwap(CoinIndex, EAllowShrinking::No);
+		}
+	}
+	CollectedCount += Picked.Num();
+
+	HideInstances(Picked);
+
+	// One CollectCoin call per frame, however many coins were touched
+	Player->CollectCoin(CoinValue * Picked.Num());
+	OnCoinsCollected.Broadcast(PickedLocations);
+}
+
+int32 UCollectibleFieldComponent::AddCoin(const FVector& WorldLocation)
+{
+	const int32 Index = AddInstance(FTransform(WorldLocation), true);
+
+	FTransform LocalTransform;
+	GetInstanceTransform(Index, LocalTransform, false);
+	CoinLocations.Add(WorldLocation);
+	OriginalTransforms.Add(LocalTransform);
+	CollectedFlags.Add(false);
+
+	if (HasBegunPlay())
+	{
+		AddToSpatialHash(Index);
+	}
+	return Index;
+}
+
+void UCollectibleFieldComponent::ResetField()
+{
+	for (int32 Index = 0; Index < OriginalTransforms.Num(); ++Index)
+	{
+		if (CollectedFlags[Index])
+		{
+			UpdateInstanceTransform(Index, OriginalTransforms[Index], false, false, true);
+		}
+	}
+	MarkRenderStateDirty();
+
+	CollectedFlags.Init(false, CoinLocations.Num());
+	CollectedCount = 0;
+	LastQueryLocation = FVector(TNumericLimits<float>::Max());
+
+	RebuildSpatialHash();
+}
+
+void UCollectibleFieldComponent::RebuildSpatialHash()
+{
+	SpatialHash.Reset();
+	CellSize = FMath::Max(CellSize, 1.0f);
+
+	for (int32 Index = 0; Index < CoinLocations.Num(); ++Index)
+	{
+		if (!CollectedFlags[Index])
+		{
+			AddToSpatialHash(Index);
+		}
+	}
+}
+
+void UCollectibleFieldComponent::AddToSpatialHash(int32 CoinIndex)
+{
+	const FVector& Location = CoinLocations[CoinIndex];
+	const uint64 Key = GetCellKey(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+	SpatialHash.FindOrAdd(Key).Add(CoinIndex);
+}
+
+void UCollectibleFieldComponent::QueryPickups(const ASuperfamilyPlayerCharacter* Player, TArray<int32>& OutCoinIndices) const
+{
+	float CapsuleRadius, CapsuleHalfHeight;
+	Player->GetCapsuleComponent()->GetScaledCapsuleSize(CapsuleRadius, CapsuleHalfHeight);
+
+	// Capsule in XZ = vertical segment swept by a circle
+	const FVector Center = Player->GetActorLocation();
+	const float Reach = CapsuleRadius + PickupRadius;
+	const float ReachSquared = Reach * Reach;
+	const float SegmentHalf = FMath::Max(CapsuleHalfHeight - CapsuleRadius, 0.0f);
+
+	const int32 MinX = FMath::FloorToInt((Center.X - Reach) / CellSize);
+	const int32 MaxX = FMath::FloorToInt((Center.X + Reach) / CellSize);
+	const int32 MinZ = FMath::FloorToInt((Center.Z - SegmentHalf - Reach) / CellSize);
+	const int32 MaxZ = FMath::FloorToInt((Center.Z + SegmentHalf + Reach) / CellSize);
+
+	for (int32 CellX = MinX; CellX <= MaxX; ++CellX)
+	{
+		for (int32 CellZ = MinZ; CellZ <= MaxZ; ++CellZ)
+		{
+			const TArray<int32>* Cell = SpatialHash.Find(GetCellKey(CellX, CellZ));
+			if (!Cell)
+			{
+				continue;
+			}
+
+			for (const int32 CoinIndex : *Cell)
+			{
+				const FVector& Coin = CoinLocations[CoinIndex];
+				const float DeltaX = Coin.X - Center.X;
+				const float DeltaZ = Coin.Z - FMath::Clamp(Coin.Z, Center.Z - SegmentHalf, Center.Z + SegmentHalf);
+				if (DeltaX * DeltaX + DeltaZ * DeltaZ <= ReachSquared)
+				{
+					OutCoinIndices.Add(CoinIndex);
+				}
+			}
+		}
+	}
+}
+
+void UCollectibleFieldComponent::HideInstances(const TArray<int32>& CoinIndices)
+{
+	// Zero-scale instead of RemoveInstance keeps indices stable for the hash and ResetField
+	for (const int32 CoinIndex : CoinIndices)
+	{
+		FTransform Hidden = OriginalTransforms[CoinIndex];
+		Hidden.SetScale3D(FVector::ZeroVector);
+		UpdateInstanceTransform(CoinIndex, Hidden, false, false, true);
+	}
+	MarkRenderStateDirty();
+}
@@ -0,0 +1,264 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Gameplay/SuperfamilyActorPool.h"
+#include "Superfamily.h"
+#include "Components/ActorComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+bool USuperfamilyActorPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void USuperfamilyActorPoolSubsystem::Deinitialize()
+{
+	LogStats();
+
+	Pools.Reset();
+	InUseActors.Reset();
+
+	Super::Deinitialize();
+}
+
+void USuperfamilyActorPoolSubsystem::Prewarm(const TArray<FActorPoolConfig>& Configs)
+{
+	for (const FActorPoolConfig& Config : Configs)
+	{
+		// Level BeginPlay runs behind the loading screen, so a blocking class load is fine here
+		UClass* ActorClass = Config.ActorClass.LoadSynchronous();
+		if (!ActorClass)
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Actor pool class %s could not be loaded"), *Config.ActorClass.ToString());
+			continue;
+		}
+
+		PrewarmClass(ActorClass, Config.PrewarmCount, Config.MaxPooled);
+	}
+}
+
+void USuperfamilyActorPoolSubsystem::PrewarmClass(TSubclassOf<AActor> ActorClass, int32 Count, int32 MaxPooled)
+{
+	if (!ActorClass)
+	{
+		return;
+	}
+
+	FActorPool& Pool = Pools.FindOrAdd(ActorClass);
+	Pool.MaxPooled = MaxPooled;
+
+	// Reserve up front so acquire/release never grow the containers mid-level
+	const int32 Capacity = FMath::Max(Pool.Available.Num() + Count, MaxPooled);
+	Pool.Available.Reserve(Capacity);
+	InUseActors.Reserve(InUseActors.Num() + Capacity);
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if (AActor* Actor = SpawnPooledActor(ActorClass))
+		{
+			Park(Actor);
+			Pool.Available.Add(Actor);
+		}
+	}
+	Pool.Stats.Available = Pool.Available.Num();
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Actor pool %s: %d pre-warmed"), *ActorClass->GetName(), Pool.Available.Num());
+}
+
+AActor* USuperfamilyActorPoolSubsystem::Acquire(TSubclassOf<AActor> ActorClass, const FTransform& Transform)
+{
+	if (!ActorClass)
+	{
+		return nullptr;
+	}
+
+	FActorPool& Pool = Pools.FindOrAdd(ActorClass);
+
+	AActor* Actor = nullptr;
+	while (!Actor && Pool.Available.Num() > 0)
+	{
+		Actor = Pool.Available.Pop(EAllowShrinking::No);
+		if (!IsValid(Actor))
+		{
+			Actor = nullptr;
+		}
+	}
+
+	if (Actor)
+	{
+		++Pool.Stats.Hits;
+		Unpark(Actor, Transform);
+	}
+	else
+	{
+		++Pool.Stats.Misses;
+		Actor = SpawnPooledActor(ActorClass);
+		if (!Actor)
+		{
+			return nullptr;
+		}
+
+		Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+		if (Actor->Implements<UPooledActor>())
+		{
+			IPooledActor::Execute_OnAcquiredFromPool(Actor);
+		}
+	}
+
+	InUseActors.Add(Actor);
+	++Pool.Stats.InUse;
+	Pool.Stats.PeakInUse = FMath::Max(Pool.Stats.PeakInUse, Pool.Stats.InUse);
+	Pool.Stats.Available = Pool.Available.Num();
+	return Actor;
+}
+
+void USuperfamilyActorPoolSubsystem::Release(AActor* Actor)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	FActorPool* Pool = Pools.Find(Actor->GetClass());
+	if (InUseActors.Remove(Actor) == 0)
+	{
+		if (Pool && Pool->Available.Contains(Actor))
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("%s released to its pool twice"), *Actor->GetName());
+			return;
+		}
+
+		// Not from a pool: behave like a plain destroy
+		Actor->Destroy();
+		return;
+	}
+
+	check(Pool);
+	--Pool->Stats.InUse;
+
+	if (Pool->MaxPooled > 0 && Pool->Available.Num() >= Pool->MaxPooled)
+	{
+		Actor->Destroy();
+		return;
+	}
+
+	Park(Actor);
+	Pool->Available.Add(Actor);
+	Pool->Stats.Available = Pool->Available.Num();
+}
+
+FActorPoolStats USuperfamilyActorPoolSubsystem::GetStats(TSubclassOf<AActor> ActorClass) const
+{
+	const FActorPool* Pool = Pools.Find(ActorClass.Get());
+	return Pool ? Pool->Stats : FActorPoolStats();
+}
+
+void USuperfamilyActorPoolSubsystem::LogStats() const
+{
+	for (const TPair<TObjectPtr<UClass>, FActorPool>& Pair : Pools)
+	{
+		const FActorPoolStats& Stats = Pair.Value.Stats;
+		const int32 Requests = Stats.Hits + Stats.Misses;
+		UE_LOG(LogSuperfamily, Log, TEXT("Actor pool %s: %d acquires, %.0f%% hits, %d misses, peak %d in use, %d parked"),
+			Pair.Key ? *Pair.Key->GetName() : TEXT("None"), Requests,
+			Requests > 0 ? 100.0f * Stats.Hits / Requests : 100.0f, Stats.Misses, Stats.PeakInUse, Stats.Available);
+	}
+}
+
+AActor* USuperfamilyActorPoolSubsystem::SpawnPooledActor(UClass* ActorClass)
+{
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	Params.ObjectFlags |= RF_Transient;
+
+	AActor* Actor = GetWorld()->SpawnActor<AActor>(ActorClass, FTransform::Identity, Params);
+	if (Actor)
+	{
+		Actor->OnDestroyed.AddDynamic(this, &USuperfamilyActorPoolSubsystem::HandlePooledActorDestroyed);
+	}
+	return Actor;
+}
+
+void USuperfamilyActorPoolSubsystem::Park(AActor* Actor)
+{
+	if (Actor->Implements<UPooledActor>())
+	{
+		IPooledActor::Execute_OnReturnedToPool(Actor);
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+
+	// Stops effects, audio and projectile movement that start on their own
+	TInlineComponentArray<UActorComponent*> Components(Actor);
+	for (UActorComponent* Component : Components)
+	{
+		if (Component->bAutoActivate)
+		{
+			Component->Deactivate();
+		}
+	}
+}
+
+void USuperfamilyActorPoolSubsystem::Unpark(AActor* Actor, const FTransform& Transform)
+{
+	const AActor* Defaults = Actor->GetClass()->GetDefaultObject<AActor>();
+
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetActorHiddenInGame(Defaults->IsHidden());
+	Actor->SetActorEnableCollision(Defaults->GetActorEnableCollision());
+	Actor->SetActorTickEnabled(Defaults->PrimaryActorTick.bStartWithTickEnabled);
+
+	TInlineComponentArray<UActorComponent*> Components(Actor);
+	for (UActorComponent* Component : Components)
+	{
+		if (Component->bAutoActivate)
+		{
+			Component->Activate(true);
+		}
+	}
+
+	if (Actor->Implements<UPooledActor>())
+	{
+		IPooledActor::Execute_OnAcquiredFromPool(Actor);
+	}
+}
+
+void USuperfamilyActorPoolSubsystem::HandlePooledActorDestroyed(AActor* DestroyedActor)
+{
+	FActorPool* Pool = Pools.Find(DestroyedActor->GetClass());
+	if (!Pool)
+	{
+		return;
+	}
+
+	if (InUseActors.Remove(DestroyedActor) > 0)
+	{
+		--Pool->Stats.InUse;
+	}
+	else if (Pool->Available.RemoveSingleSwap(DestroyedActor, EAllowShrinking::No) > 0)
+	{
+		Pool->Stats.Available = Pool->Available.Num();
+	}
+}
+
+// ============================================
+// Console Commands
+// ============================================
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorld GSuperfamilyPoolStatsCommand(
+	TEXT("sf.Pool.Stats"),
+	TEXT("Log hit/miss rates for every actor pool in the current world"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const USuperfamilyActorPoolSubsystem* Pools = World ? World->GetSubsystem<USuperfamilyActorPoolSubsystem>() : nullptr)
+		{
+			Pools->LogStats();
+		}
+	}));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,329 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Gameplay/SuperfamilyAutoplayBot.h"
+#include "Superfamily.h"
+#include "Algo/Sort.h"
+#include "Characters/SuperfamilyPlayerCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "Core/SuperfamilyGameModeBase.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Gameplay/AutoplayHint.h"
+#include "Gameplay/QuestionSetProvider.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+
+namespace SuperfamilyAutoplay
+{
+	/** Below this horizontal speed a running character counts as not moving */
+	static constexpr float StuckSpeed = 10.0f;
+
+	/** Stalled this long against something the probes missed: try jumping */
+	static constexpr float StuckJumpSeconds = 0.3f;
+}
+
+ASuperfamilyAutoplayBot::ASuperfamilyAutoplayBot(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Steer before the character consumes its movement input
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+}
+
+ASuperfamilyAutoplayBot* ASuperfamilyAutoplayBot::StartAutoplay(UWorld* World)
+{
+	if (!World || !World->IsGameWorld())
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<ASuperfamilyAutoplayBot> It(World); It; ++It)
+	{
+		return *It;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	return World->SpawnActor<ASuperfamilyAutoplayBot>(SpawnParams);
+}
+
+bool ASuperfamilyAutoplayBot::IsAutoplayActive(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World && TActorIterator<ASuperfamilyAutoplayBot>(World);
+}
+
+void ASuperfamilyAutoplayBot::BeginPlay()
+{
+	Super::BeginPlay();
+
+	for (TActorIterator<AAutoplayHint> It(GetWorld()); It; ++It)
+	{
+		Hints.Add(*It);
+	}
+	Algo::SortBy(Hints, [](const AAutoplayHint* Hint) { return Hint->GetActorLocation().X; });
+	TriggeredHints.Init(false, Hints.Num());
+
+	AnswerStream.Initialize(GetTypeHash(UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName())));
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Autoplay started on %s (%d hints)"), *GetWorld()->GetMapName(), Hints.Num());
+}
+
+void ASuperfamilyAutoplayBot::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bFinished)
+	{
+		return;
+	}
+
+	ElapsedSeconds += DeltaSeconds;
+	if (ElapsedSeconds > LevelTimeoutSeconds)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Autoplay timed out after %.0fs"), ElapsedSeconds);
+		Finish(false);
+		return;
+	}
+
+	if (ASuperfamilyBossGameMode* BossMode = GetWorld()->GetAuthGameMode<ASuperfamilyBossGameMode>())
+	{
+		TickBoss(*BossMode, DeltaSeconds);
+		return;
+	}
+
+	ASuperfamilyPlayerCharacter* Character = Cast<ASuperfamilyPlayerCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if (!Character)
+	{
+		// Between death and respawn; count it as no progress
+		StuckSeconds += DeltaSeconds;
+		if (StuckSeconds > StuckTimeoutSeconds)
+		{
+			Finish(false);
+		}
+		return;
+	}
+
+	TickPlatforming(*Character, DeltaSeconds);
+}
+
+void ASuperfamilyAutoplayBot::TickPlatforming(ASuperfamilyPlayerCharacter& Character, float DeltaSeconds)
+{
+	bool bJump = ApplyHints(Character);
+	if (bFinished)
+	{
+		return;
+	}
+
+	if (WaitRemaining > 0.0f)
+	{
+		WaitRemaining -= DeltaSeconds;
+		StuckSeconds = 0.0f;
+		return;
+	}
+
+	Character.Move2D(Direction);
+
+	const UCharacterMovementComponent* Movement = Character.GetCharacterMovement();
+	if (!Movement || !Movement->IsMovingOnGround())
+	{
+		return;
+	}
+
+	if (FMath::Abs(Character.GetVelocity().X) < SuperfamilyAutoplay::StuckSpeed)
+	{
+		StuckSeconds += DeltaSeconds;
+		if (StuckSeconds > StuckTimeoutSeconds)
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Autoplay stuck at X=%.0f"), Character.GetActorLocation().X);
+			Finish(false);
+			return;
+		}
+	}
+	else
+	{
+		StuckSeconds = 0.0f;
+	}
+
+	bJump = bJump || StuckSeconds > SuperfamilyAutoplay::StuckJumpSeconds || IsPathBlocked(Character) || IsGapAhead(Character);
+	if (bJump)
+	{
+		Character.PerformJump();
+	}
+}
+
+void ASuperfamilyAutoplayBot::TickBoss(ASuperfamilyBossGameMode& BossMode, float DeltaSeconds)
+{
+	if (!BossMode.IsEncounterStarted())
+	{
+		return;
+	}
+
+	AnswerCooldown -= DeltaSeconds;
+	if (AnswerCooldown > 0.0f)
+	{
+		return;
+	}
+	AnswerCooldown = AnswerDelaySeconds;
+
+	// Without a prepared question there is nothing to answer, but the fight still moves on
+	FQuestionData Question;
+	if (BossMode.GetCurrentQuestion(Question))
+	{
+		AnswerQuestion(Question);
+	}
+
+	if (!BossMode.AdvanceQuestion())
+	{
+		Finish(true);
+	}
+}
+
+bool ASuperfamilyAutoplayBot::ApplyHints(const ASuperfamilyPlayerCharacter& Character)
+{
+	const float CharacterX = Character.GetActorLocation().X;
+	const float Radius = Character.GetCapsuleComponent()->GetScaledCapsuleRadius();
+
+	for (int32 Index = 0; Index < Hints.Num(); ++Index)
+	{
+		const AAutoplayHint* Hint = Hints[Index];
+		if (!Hint || TriggeredHints[Index])
+		{
+			continue;
+		}
+
+		// Distance still to go towards the hint; slightly negative if a fast frame overshot it
+		const float Ahead = (Hint->GetActorLocation().X - CharacterX) * Direction;
+		if (Ahead < -Radius || Ahead > Hint->TriggerDistance)
+		{
+			continue;
+		}
+
+		TriggeredHints[Index] = true;
+		switch (Hint->Action)
+		{
+		case EAutoplayHintAction::Jump:
+			return true;
+
+		case EAutoplayHintAction::Wait:
+			WaitRemaining = Hint->WaitSeconds;
+			break;
+
+		case EAutoplayHintAction::TurnAround:
+			Direction = -Direction;
+			break;
+
+		case EAutoplayHintAction::Goal:
+			Finish(true);
+			return false;
+		}
+	}
+
+	return false;
+}
+
+bool ASuperfamilyAutoplayBot::IsPathBlocked(const ASuperfamilyPlayerCharacter& Character) const
+{
+	const UCapsuleComponent* Capsule = Character.GetCapsuleComponent();
+	const FVector Location = Character.GetActorLocation();
+
+	// Knee height: anything taller than a step but low enough to jump over
+	const FVector Start = Location - FVector(0.0f, 0.0f, Capsule->GetScaledCapsuleHalfHeight() * 0.5f);
+	const FVector End = Start + FVector(Direction * (Capsule->GetScaledCapsuleRadius() + ProbeDistance), 0.0f, 0.0f);
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(AutoplayProbe), false, &Character);
+	return GetWorld()->LineTraceTestByChannel(Start, End, Capsule->GetCollisionObjectType(), Params);
+}
+
+bool ASuperfamilyAutoplayBot::IsGapAhead(const ASuperfamilyPlayerCharacter& Character) const
+{
+	const UCapsuleComponent* Capsule = Character.GetCapsuleComponent();
+	const FVector Location = Character.GetActorLocation();
+
+	const FVector Start = Location + FVector(Direction * (Capsule->GetScaledCapsuleRadius() + ProbeDistance), 0.0f, 0.0f);
+	const FVector End = Start - FVector(0.0f, 0.0f, Capsule->GetScaledCapsuleHalfHeight() + GapDepth);
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(AutoplayProbe), false, &Character);
+	return !GetWorld()->LineTraceTestByChannel(Start, End, Capsule->GetCollisionObjectType(), Params);
+}
+
+int32 ASuperfamilyAutoplayBot::AnswerQuestion(const FQuestionData& Question)
+{
+	const int32 NumAnswers = Question.Answers.Num();
+	int32 AnswerIndex = Question.CorrectAnswerIndex;
+	if (NumAnswers > 1 && AnswerStream.FRand() >= AnswerAccuracy)
+	{
+		// Any answer but the correct one
+		AnswerIndex = (Question.CorrectAnswerIndex + AnswerStream.RandRange(1, NumAnswers - 1)) % NumAnswers;
+	}
+
+	bool bCorrect = AnswerIndex == Question.CorrectAnswerIndex;
+	if (IQuestionSetProvider* Provider = FindQuestionProvider())
+	{
+		bCorrect = Provider->SubmitQuestionAnswer(Question.QuestionID, AnswerIndex, AnswerDelaySeconds);
+	}
+
+	++QuestionsAnswered;
+	QuestionsCorrect += bCorrect ? 1 : 0;
+	return AnswerIndex;
+}
+
+void ASuperfamilyAutoplayBot::Finish(bool bCompleted)
+{
+	bFinished = true;
+
+	ASuperfamilyLevelGameMode* GameMode = GetWorld()->GetAuthGameMode<ASuperfamilyLevelGameMode>();
+	if (!GameMode)
+	{
+		return;
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Autoplay %s world %d level %d in %.1fs (%d/%d questions correct)"),
+		bCompleted ? TEXT("completed") : TEXT("failed"), GameMode->WorldID, GameMode->LevelID, ElapsedSeconds, QuestionsCorrect, QuestionsAnswered);
+
+	if (!bCompleted)
+	{
+		GameMode->OnLevelFailed();
+		return;
+	}
+
+	// Stars follow answer accuracy, the way a player earns them
+	const float Accuracy = QuestionsAnswered > 0 ? static_cast<float>(QuestionsCorrect) / QuestionsAnswered : 1.0f;
+	const int32 Stars = 1 + FMath::RoundToInt(Accuracy * 2.0f);
+
+	const ASuperfamilyPlayerCharacter* Character = Cast<ASuperfamilyPlayerCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	GameMode->OnLevelCompleted(Stars, Character ? Character->GetSessionCoins() : 0);
+}
+
+IQuestionSetProvider* ASuperfamilyAutoplayBot::FindQuestionProvider() const
+{
+	const UGameInstance* GameInstance = GetGameInstance();
+	if (!GameInstance)
+	{
+		return nullptr;
+	}
+
+	for (UGameInstanceSubsystem* Subsystem : GameInstance->GetSubsystemArray<UGameInstanceSubsystem>())
+	{
+		if (IQuestionSetProvider* Provider = Cast<IQuestionSetProvider>(Subsystem))
+		{
+			return Provider;
+		}
+	}
+	return nullptr;
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorld GSuperfamilyAutoplayCommand(
+	TEXT("sf.Autoplay"),
+	TEXT("Let a bot play the current level to the end"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		ASuperfamilyAutoplayBot::StartAutoplay(World);
+	}));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,574 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Gameplay/SuperfamilyInputReplaySubsystem.h"
+#include "Superfamily.h"
+#include "Characters/SuperfamilyPlayerCharacter.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "InputActionValue.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace SuperfamilyInputReplay
+{
+	static constexpr uint32 FileMagic = 0x50524653; // "SFRP"
+	static constexpr int32 FileVersion = 1;
+
+	/** Command-line requests are honoured once per process, by the first matching world */
+	static bool bCommandLineHandled = false;
+
+	struct FFrameTimeSummary
+	{
+		float AverageMs = 0.0f;
+		float P95Ms = 0.0f;
+		float MaxMs = 0.0f;
+	};
+
+	FFrameTimeSummary Summarize(TArray<float> FrameTimes)
+	{
+		FFrameTimeSummary Summary;
+		if (FrameTimes.Num() == 0)
+		{
+			return Summary;
+		}
+
+		FrameTimes.Sort();
+		double Total = 0.0;
+		for (const float FrameMs : FrameTimes)
+		{
+			Total += FrameMs;
+		}
+		Summary.AverageMs = static_cast<float>(Total / FrameTimes.Num());
+		Summary.P95Ms = FrameTimes[FMath::Min(FrameTimes.Num() - 1, FMath::FloorToInt(FrameTimes.Num() * 0.95f))];
+		Summary.MaxMs = FrameTimes.Last();
+		return Summary;
+	}
+}
+
+// ============================================
+// FInputReplay
+// ============================================
+
+FArchive& operator<<(FArchive& Ar, FInputReplayEvent& Event)
+{
+	uint8 Action = static_cast<uint8>(Event.Action);
+	Ar << Event.Frame << Action << Event.Value;
+	Event.Action = static_cast<EInputReplayAction>(Action);
+	return Ar;
+}
+
+void FInputReplay::Serialize(FArchive& Ar)
+{
+	Ar << MapName << RandomSeed << FixedDeltaTime << NumFrames << Events;
+}
+
+bool FInputReplay::SaveToFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = SuperfamilyInputReplay::FileMagic;
+	int32 Version = SuperfamilyInputReplay::FileVersion;
+	Writer << Magic << Version;
+	Serialize(Writer);
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool FInputReplay::LoadFromFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Reader << Magic << Version;
+	if (Magic != SuperfamilyInputReplay::FileMagic || Version != SuperfamilyInputReplay::FileVersion)
+	{
+		return false;
+	}
+
+	Serialize(Reader);
+	return !Reader.IsError();
+}
+
+// ============================================
+// USuperfamilyInputReplaySubsystem
+// ============================================
+
+bool USuperfamilyInputReplaySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void USuperfamilyInputReplaySubsystem::Deinitialize()
+{
+	if (State == EInputReplayState::Recording)
+	{
+		StopRecording();
+	}
+	else if (State == EInputReplayState::Replaying)
+	{
+		StopReplay();
+	}
+
+	Super::Deinitialize();
+}
+
+void USuperfamilyInputReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (SuperfamilyInputReplay::bCommandLineHandled)
+	{
+		return;
+	}
+
+	FString Name;
+	if (FParse::Value(FCommandLine::Get(), TEXT("SFRecord="), Name))
+	{
+		SuperfamilyInputReplay::bCommandLineHandled = true;
+		StartRecording(Name);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("SFReplay="), Name))
+	{
+		// The boot map may come first; wait for the world the recording was made in
+		FInputReplay Header;
+		if (Header.LoadFromFile(GetReplayDirectory() / Name + TEXT(".sfreplay"))
+			&& Header.MapName != UWorld::RemovePIEPrefix(InWorld.GetMapName()))
+		{
+			return;
+		}
+
+		SuperfamilyInputReplay::bCommandLineHandled = true;
+		bExitWhenDone = FParse::Param(FCommandLine::Get(), TEXT("SFReplayExit"));
+		if (!StartReplay(Name) && bExitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false, TEXT("SFReplay"));
+		}
+	}
+}
+
+FString USuperfamilyInputReplaySubsystem::GetReplayDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Replays");
+}
+
+void USuperfamilyInputReplaySubsystem::StartRecording(const FString& Name)
+{
+	if (State != EInputReplayState::Idle || Name.IsEmpty())
+	{
+		return;
+	}
+
+	Replay = FInputReplay();
+	Replay.MapName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+	Replay.RandomSeed = static_cast<int32>(FPlatformTime::Cycles());
+	Replay.FixedDeltaTime = RecordingFixedDeltaTime;
+
+	FMath::RandInit(Replay.RandomSeed);
+	FMath::SRandInit(Replay.RandomSeed);
+	BeginFixedTimestep(Replay.FixedDeltaTime);
+
+	ActiveName = Name;
+	Frame = -1;
+	FrameMoveValue = 0.0f;
+	RecordedMoveValue = 0.0f;
+	State = EInputReplayState::Recording;
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Recording input replay '%s' on %s (seed %d)"), *Name, *Replay.MapName, Replay.RandomSeed);
+}
+
+void USuperfamilyInputReplaySubsystem::StopRecording()
+{
+	if (State != EInputReplayState::Recording)
+	{
+		return;
+	}
+
+	EndFixedTimestep();
+	State = EInputReplayState::Idle;
+	Replay.NumFrames = Frame + 1;
+
+	const FString Filename = GetReplayDirectory() / ActiveName + TEXT(".sfreplay");
+	if (Replay.SaveToFile(Filename))
+	{
+		UE_LOG(LogSuperfamily, Log, TEXT("Saved input replay: %d frames, %d events -> %s"), Replay.NumFrames, Replay.Events.Num(), *Filename);
+	}
+	else
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Failed to save input replay to %s"), *Filename);
+	}
+}
+
+bool USuperfamilyInputReplaySubsystem::StartReplay(const FString& Name)
+{
+	if (State != EInputReplayState::Idle)
+	{
+		return false;
+	}
+
+	const FString Filename = GetReplayDirectory() / Name + TEXT(".sfreplay");
+	if (!Replay.LoadFromFile(Filename))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Could not load input replay %s"), *Filename);
+		return false;
+	}
+
+	const FString MapName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+	if (Replay.MapName != MapName)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Input replay '%s' was recorded on %s, not %s; results will diverge"), *Name, *Replay.MapName, *MapName);
+	}
+
+	FMath::RandInit(Replay.RandomSeed);
+	FMath::SRandInit(Replay.RandomSeed);
+	BeginFixedTimestep(Replay.FixedDeltaTime);
+
+	ActiveName = Name;
+	Frame = -1;
+	NextEventIndex = 0;
+	ReplayMoveValue = 0.0f;
+	Metrics.Reset(Replay.NumFrames);
+	FrameStartTime = 0.0;
+	State = EInputReplayState::Replaying;
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Replaying input '%s': %d frames at %.4fs"), *Name, Replay.NumFrames, Replay.FixedDeltaTime);
+	return true;
+}
+
+void USuperfamilyInputReplaySubsystem::StopReplay()
+{
+	if (State != EInputReplayState::Replaying)
+	{
+		return;
+	}
+
+	EndFixedTimestep();
+	State = EInputReplayState::Idle;
+	WriteMetrics();
+
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false, TEXT("SFReplay"));
+	}
+}
+
+bool USuperfamilyInputReplaySubsystem::FilterInput(const ASuperfamilyPlayerCharacter* Character, EInputReplayAction Action, float Value)
+{
+	if (State == EInputReplayState::Idle || Character != GetPlayerCharacter())
+	{
+		return true;
+	}
+
+	if (State == EInputReplayState::Replaying)
+	{
+		return bInjecting;
+	}
+
+	// The move axis arrives every frame while held; only changes are written, at frame end
+	if (Action == EInputReplayAction::Move)
+	{
+		FrameMoveValue = Value;
+	}
+	else
+	{
+		Replay.Events.Add({ FMath::Max(Frame, 0), Action, Value });
+	}
+	return true;
+}
+
+ASuperfamilyPlayerCharacter* USuperfamilyInputReplaySubsystem::GetPlayerCharacter() const
+{
+	return Cast<ASuperfamilyPlayerCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+}
+
+void USuperfamilyInputReplaySubsystem::BeginFixedTimestep(float DeltaTime)
+{
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(DeltaTime);
+
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &USuperfamilyInputReplaySubsystem::HandlePreActorTick);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &USuperfamilyInputReplaySubsystem::HandlePostActorTick);
+}
+
+void USuperfamilyInputReplaySubsystem::EndFixedTimestep()
+{
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+}
+
+void USuperfamilyInputReplaySubsystem::HandlePreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != GetWorld())
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	++Frame;
+
+	if (State == EInputReplayState::Recording)
+	{
+		FrameMoveValue = 0.0f;
+		return;
+	}
+
+	// Whole-frame wall time is only known once the next frame starts
+	if (Metrics.Num() > 0 && FrameStartTime > 0.0)
+	{
+		Metrics.Last().FrameMs = static_cast<float>((Now - FrameStartTime) * 1000.0);
+	}
+	FrameStartTime = Now;
+	ActorTickStartTime = Now;
+
+	if (Frame >= Replay.NumFrames)
+	{
+		StopReplay();
+		return;
+	}
+
+	ApplyReplayFrame();
+}
+
+void USuperfamilyInputReplaySubsystem::HandlePostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != GetWorld())
+	{
+		return;
+	}
+
+	if (State == EInputReplayState::Recording)
+	{
+		if (FrameMoveValue != RecordedMoveValue)
+		{
+			Replay.Events.Add({ Frame, EInputReplayAction::Move, FrameMoveValue });
+			RecordedMoveValue = FrameMoveValue;
+		}
+		return;
+	}
+
+	FFrameMetrics& FrameMetrics = Metrics.AddDefaulted_GetRef();
+	FrameMetrics.ActorTickMs = static_cast<float>((FPlatformTime::Seconds() - ActorTickStartTime) * 1000.0);
+	FrameMetrics.UsedMemoryMB = static_cast<float>(FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+}
+
+void USuperfamilyInputReplaySubsystem::ApplyReplayFrame()
+{
+	ASuperfamilyPlayerCharacter* Character = GetPlayerCharacter();
+	if (!Character)
+	{
+		return;
+	}
+
+	TGuardValue<bool> InjectingGuard(bInjecting, true);
+
+	const int32 FirstEventIndex = NextEventIndex;
+	while (NextEventIndex < Replay.Events.Num() && Replay.Events[NextEventIndex].Frame <= Frame)
+	{
+		const FInputReplayEvent& Event = Replay.Events[NextEventIndex++];
+		if (Event.Action == EInputReplayAction::Move)
+		{
+			ReplayMoveValue = Event.Value;
+		}
+	}
+
+	// Move first, as Enhanced Input processes the bindings in that order
+	if (ReplayMoveValue != 0.0f)
+	{
+		Character->HandleMoveInput(FInputActionValue(ReplayMoveValue));
+	}
+
+	for (int32 EventIndex = FirstEventIndex; EventIndex < NextEventIndex; ++EventIndex)
+	{
+		switch (Replay.Events[EventIndex].Action)
+		{
+		case EInputReplayAction::Jump:
+			Character->HandleJumpInput();
+			break;
+		case EInputReplayAction::Interact:
+			Character->HandleInteractInput();
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void USuperfamilyInputReplaySubsystem::WriteMetrics() const
+{
+	TArray<float> FrameTimes;
+	FrameTimes.Reserve(Metrics.Num());
+
+	int32 Hitches = 0;
+	float PeakMemoryMB = 0.0f;
+
+	FString Csv = TEXT("Frame,FrameMs,ActorTickMs,UsedMemoryMB,Hitch\n");
+	for (int32 Index = 0; Index < Metrics.Num(); ++Index)
+	{
+		const FFrameMetrics& FrameMetrics = Metrics[Index];
+		const bool bHitch = FrameMetrics.FrameMs > HitchThresholdMs;
+		Hitches += bHitch ? 1 : 0;
+		PeakMemoryMB = FMath::Max(PeakMemoryMB, FrameMetrics.UsedMemoryMB);
+		FrameTimes.Add(FrameMetrics.FrameMs);
+
+		Csv += FString::Printf(TEXT("%d,%.3f,%.3f,%.1f,%d\n"), Index, FrameMetrics.FrameMs, FrameMetrics.ActorTickMs, FrameMetrics.UsedMemoryMB, bHitch ? 1 : 0);
+	}
+
+	const FString Filename = GetReplayDirectory() / FString::Printf(TEXT("%s-%s.csv"), *ActiveName, *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+	if (!FFileHelper::SaveStringToFile(Csv, *Filename))
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Failed to write replay metrics to %s"), *Filename);
+		return;
+	}
+
+	const SuperfamilyInputReplay::FFrameTimeSummary Summary = SuperfamilyInputReplay::Summarize(MoveTemp(FrameTimes));
+	UE_LOG(LogSuperfamily, Display, TEXT("Replay '%s' finished: %d frames, avg %.2f ms, p95 %.2f ms, max %.2f ms, %d hitches, peak %.0f MB -> %s"),
+		*ActiveName, Metrics.Num(), Summary.AverageMs, Summary.P95Ms, Summary.MaxMs, Hitches, PeakMemoryMB, *Filename);
+}
+
+// ============================================
+// Console Commands
+// ============================================
+
+#if !UE_BUILD_SHIPPING
+
+namespace SuperfamilyInputReplay
+{
+	USuperfamilyInputReplaySubsystem* GetSubsystem(UWorld* World)
+	{
+		return World ? World->GetSubsystem<USuperfamilyInputReplaySubsystem>() : nullptr;
+	}
+
+	struct FMetricsFile
+	{
+		TArray<float> FrameMs;
+		TArray<float> MemoryMB;
+		int32 Hitches = 0;
+	};
+
+	bool LoadMetrics(const FString& Name, FMetricsFile& Out)
+	{
+		FString Filename = Name;
+		if (FPaths::IsRelative(Filename))
+		{
+			Filename = USuperfamilyInputReplaySubsystem::GetReplayDirectory() / Filename;
+		}
+
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *Filename))
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Could not read %s"), *Filename);
+			return false;
+		}
+
+		// Skip the header
+		for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+		{
+			TArray<FString> Columns;
+			if (Lines[LineIndex].ParseIntoArray(Columns, TEXT(",")) < 5)
+			{
+				continue;
+			}
+			Out.FrameMs.Add(FCString::Atof(*Columns[1]));
+			Out.MemoryMB.Add(FCString::Atof(*Columns[3]));
+			Out.Hitches += FCString::Atoi(*Columns[4]);
+		}
+		return true;
+	}
+
+	void Compare(const TArray<FString>& Args)
+	{
+		FMetricsFile Baseline, Candidate;
+		if (Args.Num() < 2 || !LoadMetrics(Args[0], Baseline) || !LoadMetrics(Args[1], Candidate))
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Usage: sf.Replay.Compare <Baseline.csv> <Candidate.csv>"));
+			return;
+		}
+
+		const FFrameTimeSummary Before = Summarize(Baseline.FrameMs);
+		const FFrameTimeSummary After = Summarize(Candidate.FrameMs);
+		const float PeakBefore = Baseline.MemoryMB.Num() > 0 ? FMath::Max(Baseline.MemoryMB) : 0.0f;
+		const float PeakAfter = Candidate.MemoryMB.Num() > 0 ? FMath::Max(Candidate.MemoryMB) : 0.0f;
+
+		UE_LOG(LogSuperfamily, Display, TEXT("Replay comparison (%d vs %d frames):"), Baseline.FrameMs.Num(), Candidate.FrameMs.Num());
+		UE_LOG(LogSuperfamily, Display, TEXT("  Avg frame:   %7.2f -> %7.2f ms"), Before.AverageMs, After.AverageMs);
+		UE_LOG(LogSuperfamily, Display, TEXT("  P95 frame:   %7.2f -> %7.2f ms"), Before.P95Ms, After.P95Ms);
+		UE_LOG(LogSuperfamily, Display, TEXT("  Max frame:   %7.2f -> %7.2f ms"), Before.MaxMs, After.MaxMs);
+		UE_LOG(LogSuperfamily, Display, TEXT("  Hitches:     %7d -> %7d"), Baseline.Hitches, Candidate.Hitches);
+		UE_LOG(LogSuperfamily, Display, TEXT("  Peak memory: %7.0f -> %7.0f MB"), PeakBefore, PeakAfter);
+
+		// Same input on the same frame, so the biggest per-frame regressions point at the culprit
+		TArray<TPair<float, int32>> Regressions;
+		const int32 NumFrames = FMath::Min(Baseline.FrameMs.Num(), Candidate.FrameMs.Num());
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Regressions.Emplace(Candidate.FrameMs[Frame] - Baseline.FrameMs[Frame], Frame);
+		}
+		Regressions.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key > B.Key; });
+
+		for (int32 Index = 0; Index < FMath::Min(10, Regressions.Num()) && Regressions[Index].Key > 0.0f; ++Index)
+		{
+			const int32 Frame = Regressions[Index].Value;
+			UE_LOG(LogSuperfamily, Display, TEXT("  Frame %6d: %7.2f -> %7.2f ms (+%.2f)"),
+				Frame, Baseline.FrameMs[Frame], Candidate.FrameMs[Frame], Regressions[Index].Key);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GSuperfamilyReplayRecordCommand(
+	TEXT("sf.Replay.Record"),
+	TEXT("Record player input. For reproducible runs, record from map load with -SFRecord=<Name> instead. Usage: sf.Replay.Record <Name>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USuperfamilyInputReplaySubsystem* Subsystem = SuperfamilyInputReplay::GetSubsystem(World))
+		{
+			Subsystem->StartRecording(Args.Num() > 0 ? Args[0] : TEXT("Replay"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld GSuperfamilyReplayStopCommand(
+	TEXT("sf.Replay.Stop"),
+	TEXT("Stop the current input recording or replay"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (USuperfamilyInputReplaySubsystem* Subsystem = SuperfamilyInputReplay::GetSubsystem(World))
+		{
+			Subsystem->StopRecording();
+			Subsystem->StopReplay();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GSuperfamilyReplayPlayCommand(
+	TEXT("sf.Replay.Play"),
+	TEXT("Replay recorded input into the player character. Usage: sf.Replay.Play <Name>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		USuperfamilyInputReplaySubsystem* Subsystem = SuperfamilyInputReplay::GetSubsystem(World);
+		if (Subsystem && Args.Num() > 0)
+		{
+			Subsystem->StartReplay(Args[0]);
+		}
+	}));
+
+static FAutoConsoleCommand GSuperfamilyReplayCompareCommand(
+	TEXT("sf.Replay.Compare"),
+	TEXT("Compare two replay metric CSVs frame by frame. Usage: sf.Replay.Compare <Baseline.csv> <Candidate.csv>"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&SuperfamilyInputReplay::Compare));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,417 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Gameplay/SuperfamilyLevelStreamingSubsystem.h"
+#include "Superfamily.h"
+#include "Characters/SuperfamilyPlayerCharacter.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "Kismet/GameplayStatics.h"
+
+bool USuperfamilyLevelStreamingSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void USuperfamilyLevelStreamingSubsystem::Deinitialize()
+{
+	Deactivate();
+
+	Super::Deinitialize();
+}
+
+TStatId USuperfamilyLevelStreamingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USuperfamilyLevelStreamingSubsystem, STATGROUP_Tickables);
+}
+
+void USuperfamilyLevelStreamingSubsystem::Activate(const FLevelStreamingSettings& InSettings)
+{
+	if (bIsActive)
+	{
+		Deactivate();
+	}
+
+	Settings = InSettings;
+	ChunkStates.Reset();
+	ChunkStates.SetNum(Settings.Chunks.Num());
+	Report = FLevelStreamingReport();
+	StalledChunk = INDEX_NONE;
+	bIsActive = true;
+
+	// The chunk under the player start must be there before the first frame; the loading screen hides this.
+	// The pawn usually hasn't spawned yet, so stream for the spot it will spawn at.
+	float PlayerX, Direction, Speed;
+	if (GetPlayerMotion(PlayerX, Direction, Speed) || GetPlayerStartMotion(PlayerX, Direction, Speed))
+	{
+		UpdateStreaming(PlayerX, Direction, Speed);
+		GetWorld()->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+		UpdateStreaming(PlayerX, Direction, Speed);
+	}
+	UpdateReport();
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Level streaming active: %d chunks, %d loaded, budget %.0f MB"),
+		Settings.Chunks.Num(), Report.LoadedChunks, Settings.MemoryBudgetMB);
+}
+
+void USuperfamilyLevelStreamingSubsystem::Deactivate()
+{
+	if (!bIsActive)
+	{
+		return;
+	}
+
+	if (StalledChunk != INDEX_NONE)
+	{
+		Report.StallSeconds += static_cast<float>(FPlatformTime::Seconds() - StallStartTime);
+		StalledChunk = INDEX_NONE;
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Level streaming stopped: %d stalls (%.2fs), slowest load %.2fs"),
+		Report.StallCount, Report.StallSeconds, Report.MaxLoadSeconds);
+
+	bIsActive = false;
+}
+
+bool USuperfamilyLevelStreamingSubsystem::IsChunkReady(int32 ChunkIndex) const
+{
+	if (!ChunkStates.IsValidIndex(ChunkIndex))
+	{
+		return false;
+	}
+
+	const ULevelStreaming* Streaming = ChunkStates[ChunkIndex].Streaming.Get();
+	return Streaming && Streaming->IsLevelVisible();
+}
+
+int64 USuperfamilyLevelStreamingSubsystem::GetBudgetedMemoryBytes() const
+{
+	int64 Bytes = 0;
+	for (int32 ChunkIndex = 0; ChunkIndex < ChunkStates.Num(); ++ChunkIndex)
+	{
+		if (IsChunkReady(ChunkIndex))
+		{
+			Bytes += FMath::Max<int64>(ChunkStates[ChunkIndex].MeasuredBytes, 0);
+		}
+	}
+	return Bytes;
+}
+
+int64 USuperfamilyLevelStreamingSubsystem::TrimMemory(int64 BytesToFree)
+{
+	// Only chunks lingering behind the player, not the ones the last update wanted
+	int64 Freed = 0;
+	for (int32 ChunkIndex = 0; ChunkIndex < ChunkStates.Num() && Freed < BytesToFree; ++ChunkIndex)
+	{
+		const FChunkState& State = ChunkStates[ChunkIndex];
+		if (State.bRequested && State.LastWantedTime < LastUpdateTime)
+		{
+			Freed += IsChunkReady(ChunkIndex) ? FMath::Max<int64>(State.MeasuredBytes, 0) : 0;
+			RequestUnload(ChunkIndex);
+		}
+	}
+	return Freed;
+}
+
+void USuperfamilyLevelStreamingSubsystem::Tick(float DeltaTime)
+{
+	float PlayerX, Direction, Speed;
+	if (GetPlayerMotion(PlayerX, Direction, Speed))
+	{
+		UpdateStreaming(PlayerX, Direction, Speed);
+		UpdateStallTelemetry(PlayerX);
+		UpdateReport();
+	}
+}
+
+void USuperfamilyLevelStreamingSubsystem::UpdateStreaming(float PlayerX, float Direction, float Speed)
+{
+	const double Now = FPlatformTime::Seconds();
+	LastUpdateTime = Now;
+
+	TArray<int32> Wanted;
+	GatherWantedChunks(PlayerX, Direction, Speed, Wanted);
+
+	float WantedMemoryMB = 0.0f;
+	for (const int32 ChunkIndex : Wanted)
+	{
+		ChunkStates[ChunkIndex].LastWantedTime = Now;
+		WantedMemoryMB += GetChunkMemoryMB(ChunkIndex);
+	}
+
+	// Release first so new loads fit the budget; recently left chunks linger if there is room
+	float LingeringMemoryMB = 0.0f;
+	for (int32 ChunkIndex = 0; ChunkIndex < ChunkStates.Num(); ++ChunkIndex)
+	{
+		const FChunkState& State = ChunkStates[ChunkIndex];
+		if (!State.bRequested || Wanted.Contains(ChunkIndex))
+		{
+			continue;
+		}
+
+		const float ChunkMemoryMB = GetChunkMemoryMB(ChunkIndex);
+		const bool bExpired = Now - State.LastWantedTime >= Settings.UnloadDelaySeconds;
+		const bool bOverBudget = WantedMemoryMB + LingeringMemoryMB + ChunkMemoryMB > Settings.MemoryBudgetMB;
+		if (bExpired || bOverBudget)
+		{
+			RequestUnload(ChunkIndex);
+		}
+		else
+		{
+			LingeringMemoryMB += ChunkMemoryMB;
+		}
+	}
+
+	for (const int32 ChunkIndex : Wanted)
+	{
+		if (!ChunkStates[ChunkIndex].bRequested)
+		{
+			RequestLoad(ChunkIndex);
+		}
+	}
+
+	// Track request-to-visible time, and measure each chunk the first time it is in
+	for (int32 ChunkIndex = 0; ChunkIndex < ChunkStates.Num(); ++ChunkIndex)
+	{
+		FChunkState& State = ChunkStates[ChunkIndex];
+		if (!State.bRequested || !IsChunkReady(ChunkIndex))
+		{
+			continue;
+		}
+
+		if (State.MeasuredBytes < 0)
+		{
+			State.MeasuredBytes = GetLoadedLevelBytes(*State.Streaming);
+			UE_LOG(LogSuperfamily, Verbose, TEXT("Chunk %d measured %.1f MB (estimated %.1f MB)"),
+				ChunkIndex, State.MeasuredBytes / (1024.0 * 1024.0), Settings.Chunks[ChunkIndex].EstimatedMemoryMB);
+		}
+
+		if (State.RequestTime > 0.0)
+		{
+			const float LoadSeconds = static_cast<float>(Now - State.RequestTime);
+			Report.MaxLoadSeconds = FMath::Max(Report.MaxLoadSeconds, LoadSeconds);
+			State.RequestTime = 0.0;
+
+			UE_LOG(LogSuperfamily, Verbose, TEXT("Chunk %d ready after %.2fs"), ChunkIndex, LoadSeconds);
+		}
+	}
+
+}
+
+bool USuperfamilyLevelStreamingSubsystem::GetPlayerMotion(float& OutX, float& OutDirection, float& OutSpeed) const
+{
+	const APawn* Pawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (!Pawn)
+	{
+		return false;
+	}
+
+	const float VelocityX = Pawn->GetVelocity().X;
+	OutX = Pawn->GetActorLocation().X;
+	OutSpeed = FMath::Abs(VelocityX);
+
+	// Idle or turning: look the way the character faces
+	if (OutSpeed > 50.0f)
+	{
+		OutDirection = FMath::Sign(VelocityX);
+	}
+	else
+	{
+		const ASuperfamilyPlayerCharacter* Character = Cast<ASuperfamilyPlayerCharacter>(Pawn);
+		OutDirection = !Character || Character->IsFacingRight() ? 1.0f : -1.0f;
+	}
+	return true;
+}
+
+bool USuperfamilyLevelStreamingSubsystem::GetPlayerStartMotion(float& OutX, float& OutDirection, float& OutSpeed) const
+{
+	AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	const AActor* PlayerStart = GameMode ? GameMode->FindPlayerStart(nullptr) : nullptr;
+	if (!PlayerStart)
+	{
+		return false;
+	}
+
+	OutX = PlayerStart->GetActorLocation().X;
+	OutDirection = PlayerStart->GetActorForwardVector().X < 0.0f ? -1.0f : 1.0f;
+	OutSpeed = 0.0f;
+	return true;
+}
+
+float USuperfamilyLevelStreamingSubsystem::GetChunkMemoryMB(int32 ChunkIndex) const
+{
+	const int64 MeasuredBytes = ChunkStates[ChunkIndex].MeasuredBytes;
+	return MeasuredBytes >= 0
+		? static_cast<float>(MeasuredBytes / (1024.0 * 1024.0))
+		: Settings.Chunks[ChunkIndex].EstimatedMemoryMB;
+}
+
+void USuperfamilyLevelStreamingSubsystem::GatherWantedChunks(float PlayerX, float Direction, float Speed, TArray<int32>& OutWanted) const
+{
+	const float Ahead = FMath::Max(Settings.MinLookaheadDistance, Speed * Settings.LookaheadSeconds);
+	const float Behind = Settings.KeepBehindDistance;
+	const float WindowMin = Direction > 0.0f ? PlayerX - Behind : PlayerX - Ahead;
+	const float WindowMax = Direction > 0.0f ? PlayerX + Ahead : PlayerX + Behind;
+
+	// Urgency: distance along the direction of travel; anything behind ranks after everything ahead
+	TArray<TPair<float, int32>, TInlineAllocator<8>> Candidates;
+	for (int32 ChunkIndex = 0; ChunkIndex < Settings.Chunks.Num(); ++ChunkIndex)
+	{
+		const FLevelStreamingChunk& Chunk = Settings.Chunks[ChunkIndex];
+		if (Chunk.MaxX < WindowMin || Chunk.MinX > WindowMax)
+		{
+			continue;
+		}
+
+		const float DistanceAhead = Direction > 0.0f ? Chunk.MinX - PlayerX : PlayerX - Chunk.MaxX;
+		const float DistanceBehind = Direction > 0.0f ? PlayerX - Chunk.MaxX : Chunk.MinX - PlayerX;
+
+		float Urgency = 0.0f;
+		if (DistanceAhead > 0.0f)
+		{
+			Urgency = DistanceAhead;
+		}
+		else if (DistanceBehind > 0.0f)
+		{
+			Urgency = Ahead + DistanceBehind;
+		}
+		Candidates.Emplace(Urgency, ChunkIndex);
+	}
+	Candidates.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+
+	float MemoryMB = 0.0f;
+	for (const TPair<float, int32>& Candidate : Candidates)
+	{
+		const float ChunkMemoryMB = GetChunkMemoryMB(Candidate.Value);
+
+		// The chunk under the player is always wanted, budget or not
+		if (OutWanted.Num() > 0 && MemoryMB + ChunkMemoryMB > Settings.MemoryBudgetMB)
+		{
+			break;
+		}
+
+		MemoryMB += ChunkMemoryMB;
+		OutWanted.Add(Candidate.Value);
+	}
+}
+
+int32 USuperfamilyLevelStreamingSubsystem::FindChunkAt(float X) const
+{
+	return Settings.Chunks.IndexOfByPredicate([X](const FLevelStreamingChunk& Chunk)
+	{
+		return X >= Chunk.MinX && X <= Chunk.MaxX;
+	});
+}
+
+ULevelStreaming* USuperfamilyLevelStreamingSubsystem::FindOrCreateStreaming(int32 ChunkIndex)
+{
+	FChunkState& State = ChunkStates[ChunkIndex];
+	if (ULevelStreaming* Existing = State.Streaming.Get())
+	{
+		return Existing;
+	}
+
+	const FLevelStreamingChunk& Chunk = Settings.Chunks[ChunkIndex];
+	if (Chunk.Level.IsNull())
+	{
+		return nullptr;
+	}
+
+	// Prefer a sublevel already set up in the persistent map, otherwise add an instance
+	ULevelStreaming* Streaming = UGameplayStatics::GetStreamingLevel(this, FName(*Chunk.Level.GetLongPackageName()));
+	if (!Streaming)
+	{
+		bool bSuccess = false;
+		Streaming = ULevelStreamingDynamic::LoadLevelInstanceBySoftObjectPtr(GetWorld(), Chunk.Level, FVector::ZeroVector, FRotator::ZeroRotator, bSuccess);
+		if (!bSuccess)
+		{
+			UE_LOG(LogSuperfamily, Warning, TEXT("Could not stream chunk %d (%s)"), ChunkIndex, *Chunk.Level.ToString());
+			return nullptr;
+		}
+	}
+
+	Streaming->bShouldBlockOnLoad = false;
+	State.Streaming = Streaming;
+	return Streaming;
+}
+
+void USuperfamilyLevelStreamingSubsystem::RequestLoad(int32 ChunkIndex)
+{
+	ULevelStreaming* Streaming = FindOrCreateStreaming(ChunkIndex);
+	if (!Streaming)
+	{
+		return;
+	}
+
+	Streaming->SetShouldBeLoaded(true);
+	Streaming->SetShouldBeVisible(true);
+
+	FChunkState& State = ChunkStates[ChunkIndex];
+	State.bRequested = true;
+	State.RequestTime = Streaming->IsLevelVisible() ? 0.0 : FPlatformTime::Seconds();
+}
+
+void USuperfamilyLevelStreamingSubsystem::RequestUnload(int32 ChunkIndex)
+{
+	FChunkState& State = ChunkStates[ChunkIndex];
+	if (ULevelStreaming* Streaming = State.Streaming.Get())
+	{
+		Streaming->SetShouldBeVisible(false);
+		Streaming->SetShouldBeLoaded(false);
+	}
+
+	State.bRequested = false;
+	State.RequestTime = 0.0;
+}
+
+void USuperfamilyLevelStreamingSubsystem::UpdateStallTelemetry(float PlayerX)
+{
+	const int32 CurrentChunk = FindChunkAt(PlayerX);
+	const bool bStalled = CurrentChunk != INDEX_NONE && !IsChunkReady(CurrentChunk);
+
+	if (bStalled && StalledChunk == INDEX_NONE)
+	{
+		StalledChunk = CurrentChunk;
+		StallStartTime = FPlatformTime::Seconds();
+		++Report.StallCount;
+
+		UE_LOG(LogSuperfamily, Warning, TEXT("Chunk %d (%s) not ready at X=%.0f"),
+			CurrentChunk, *Settings.Chunks[CurrentChunk].Level.GetAssetName(), PlayerX);
+	}
+	else if (!bStalled && StalledChunk != INDEX_NONE)
+	{
+		const float StallSeconds = static_cast<float>(FPlatformTime::Seconds() - StallStartTime);
+		Report.StallSeconds += StallSeconds;
+		OnChunkStall.Broadcast(StalledChunk, StallSeconds);
+		StalledChunk = INDEX_NONE;
+	}
+}
+
+void USuperfamilyLevelStreamingSubsystem::UpdateReport()
+{
+	Report.LoadedChunks = 0;
+	Report.PendingChunks = 0;
+	Report.CommittedMemoryMB = 0.0f;
+	Report.LoadedMemoryMB = 0.0f;
+
+	for (int32 ChunkIndex = 0; ChunkIndex < ChunkStates.Num(); ++ChunkIndex)
+	{
+		if (!ChunkStates[ChunkIndex].bRequested)
+		{
+			continue;
+		}
+
+		Report.CommittedMemoryMB += GetChunkMemoryMB(ChunkIndex);
+		if (IsChunkReady(ChunkIndex))
+		{
+			++Report.LoadedChunks;
+			Report.LoadedMemoryMB += GetChunkMemoryMB(ChunkIndex);
+		}
+		else
+		{
+			++Report.PendingChunks;
+		}
+	}
+}
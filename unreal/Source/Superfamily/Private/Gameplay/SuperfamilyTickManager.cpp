@@ -0,0 +1,547 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Gameplay/SuperfamilyTickManager.h"
+#include "Superfamily.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/ActorComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+
+bool USuperfamilyTickManager::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// Only game worlds have levels worth managing
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void USuperfamilyTickManager::Deinitialize()
+{
+	Deactivate();
+
+	Super::Deinitialize();
+}
+
+TStatId USuperfamilyTickManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USuperfamilyTickManager, STATGROUP_Tickables);
+}
+
+void USuperfamilyTickManager::Activate(const FTickBudgetSettings& InSettings)
+{
+	if (bIsActive)
+	{
+		Deactivate();
+	}
+
+	Settings = InSettings;
+	Settings.ThrottleDistance = FMath::Max(Settings.ThrottleDistance, Settings.ActiveDistance);
+	Settings.ScoringBatchSize = FMath::Max(1, Settings.ScoringBatchSize);
+
+	// A class that isn't loaded has no instances in the level yet, so it can load in the background
+	TArray<FSoftObjectPath> PendingClasses;
+	ResolveClasses(PendingClasses);
+
+	UWorld* World = GetWorld();
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (ShouldAutoManage(*It))
+		{
+			AddManagedActor(*It);
+		}
+	}
+
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &USuperfamilyTickManager::HandleActorSpawned));
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &USuperfamilyTickManager::HandlePreActorTick);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &USuperfamilyTickManager::HandlePostActorTick);
+
+	Report = FTickBudgetReport();
+	ScoringCursor = 0;
+	bIsActive = true;
+
+	if (PendingClasses.Num() > 0)
+	{
+		ClassLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(PendingClasses),
+			FStreamableDelegate::CreateUObject(this, &USuperfamilyTickManager::HandleClassesLoaded));
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Tick manager active: %d actors managed"), ManagedActors.Num());
+}
+
+void USuperfamilyTickManager::Deactivate()
+{
+	if (!bIsActive)
+	{
+		return;
+	}
+
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	if (ClassLoadHandle.IsValid())
+	{
+		ClassLoadHandle->CancelHandle();
+		ClassLoadHandle.Reset();
+	}
+
+	for (FManagedActor& Managed : ManagedActors)
+	{
+		RestoreTickState(Managed);
+	}
+	for (FTickBatch& Batch : Batches)
+	{
+		for (FManagedActor& Managed : Batch.Members)
+		{
+			RestoreTickState(Managed);
+		}
+	}
+	for (FManagedActor& Managed : SpawnedBatchMembers)
+	{
+		RestoreTickState(Managed);
+	}
+	ManagedActors.Reset();
+	Batches.Reset();
+	SpawnedBatchMembers.Reset();
+	ResolvedManagedClasses.Reset();
+	ResolvedBatchedClasses.Reset();
+
+	bIsActive = false;
+}
+
+void USuperfamilyTickManager::RegisterActor(AActor* Actor)
+{
+	if (!bIsActive || !Actor)
+	{
+		return;
+	}
+
+	if (!FindManagedActor(Actor))
+	{
+		AddManagedActor(Actor);
+	}
+}
+
+void USuperfamilyTickManager::UnregisterActor(AActor* Actor)
+{
+	if (FManagedActor* Managed = FindManagedActor(Actor))
+	{
+		// Cleared entries are dropped by the next Tick, which also keeps batches stable while they tick
+		RestoreTickState(*Managed);
+		Managed->Actor.Reset();
+	}
+}
+
+USuperfamilyTickManager::FManagedActor* USuperfamilyTickManager::FindManagedActor(const AActor* Actor)
+{
+	auto IsActor = [Actor](const FManagedActor& Managed)
+	{
+		return Managed.Actor.Get() == Actor;
+	};
+
+	if (FManagedActor* Managed = ManagedActors.FindByPredicate(IsActor))
+	{
+		return Managed;
+	}
+	for (FTickBatch& Batch : Batches)
+	{
+		if (FManagedActor* Managed = Batch.Members.FindByPredicate(IsActor))
+		{
+			return Managed;
+		}
+	}
+	return SpawnedBatchMembers.FindByPredicate(IsActor);
+}
+
+void USuperfamilyTickManager::Tick(float DeltaTime)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	float CameraX = 0.0f;
+	const bool bHasCamera = GetCameraX(CameraX);
+	if (bHasCamera && ManagedActors.Num() > 0)
+	{
+		// Re-score a slice per frame; far actors changing tier a few frames late is invisible
+		const int32 Count = FMath::Min(Settings.ScoringBatchSize, ManagedActors.Num());
+		for (int32 Step = 0; Step < Count && ManagedActors.Num() > 0; ++Step)
+		{
+			if (ScoringCursor >= ManagedActors.Num())
+			{
+				ScoringCursor = 0;
+			}
+
+			FManagedActor& Managed = ManagedActors[ScoringCursor];
+			if (!Managed.Actor.IsValid())
+			{
+				ManagedActors.RemoveAtSwap(ScoringCursor);
+				continue;
+			}
+
+			const ETickSignificance NewTier = ScoreActor(Managed, CameraX);
+			if (NewTier != Managed.Tier)
+			{
+				ApplyTier(Managed, NewTier);
+			}
+			++ScoringCursor;
+		}
+	}
+
+	const double BatchStartTime = FPlatformTime::Seconds();
+	TickBatches(DeltaTime, bHasCamera, CameraX);
+	const double BatchTime = FPlatformTime::Seconds() - BatchStartTime;
+
+	Report.ActiveActors = 0;
+	Report.ThrottledActors = 0;
+	Report.DormantActors = 0;
+	Report.BatchedActors = 0;
+	auto CountTier = [this](const FManagedActor& Managed)
+	{
+		switch (Managed.Tier)
+		{
+		case ETickSignificance::Active:    ++Report.ActiveActors; break;
+		case ETickSignificance::Throttled: ++Report.ThrottledActors; break;
+		case ETickSignificance::Dormant:   ++Report.DormantActors; break;
+		}
+	};
+	for (const FManagedActor& Managed : ManagedActors)
+	{
+		CountTier(Managed);
+	}
+	for (const FTickBatch& Batch : Batches)
+	{
+		for (const FManagedActor& Managed : Batch.Members)
+		{
+			CountTier(Managed);
+		}
+		Report.BatchedActors += Batch.Members.Num();
+	}
+
+	Report.BatchTickMs = static_cast<float>(BatchTime * 1000.0);
+	Report.ManagerMs = static_cast<float>((FPlatformTime::Seconds() - StartTime - BatchTime) * 1000.0);
+}
+
+void USuperfamilyTickManager::TickBatches(float DeltaTime, bool bHasCamera, float CameraX)
+{
+	// Actors spawned while a batch ticks are held back so Members doesn't reallocate under the loop
+	bTickingBatches = true;
+
+	for (FTickBatch& Batch : Batches)
+	{
+		for (int32 Index = 0; Index < Batch.Members.Num(); ++Index)
+		{
+			FManagedActor& Managed = Batch.Members[Index];
+			AActor* Actor = Managed.Actor.Get();
+			if (!Actor)
+			{
+				Batch.Members.RemoveAtSwap(Index--);
+				continue;
+			}
+
+			// Every member is visited each frame anyway, so scoring it costs next to nothing
+			if (bHasCamera)
+			{
+				Managed.Tier = ScoreActor(Managed, CameraX);
+			}
+
+			if (Managed.Tier == ETickSignificance::Dormant)
+			{
+				// Like a re-enabled tick function, don't hand over the time spent dormant
+				Managed.PendingDeltaTime = 0.0f;
+				continue;
+			}
+
+			Managed.PendingDeltaTime += DeltaTime;
+			const float Interval = Managed.Tier == ETickSignificance::Throttled
+				? FMath::Max(Managed.OriginalTickInterval, Settings.ThrottledTickInterval)
+				: Managed.OriginalTickInterval;
+			if (Managed.PendingDeltaTime < Interval)
+			{
+				continue;
+			}
+
+			const float ActorDeltaTime = Managed.PendingDeltaTime;
+			Managed.PendingDeltaTime = 0.0f;
+
+			if (Managed.bOriginalTickEnabled && Actor->PrimaryActorTick.bCanEverTick)
+			{
+				Actor->TickActor(ActorDeltaTime, LEVELTICK_All, Actor->PrimaryActorTick);
+			}
+
+			// Components tick with their actor, at the actor's cadence
+			for (const TPair<TWeakObjectPtr<UActorComponent>, float>& Entry : Managed.TickingComponents)
+			{
+				UActorComponent* Component = Entry.Key.Get();
+				if (Component && Component->IsRegistered())
+				{
+					Component->TickComponent(ActorDeltaTime, LEVELTICK_All, &Component->PrimaryComponentTick);
+				}
+			}
+		}
+	}
+
+	bTickingBatches = false;
+
+	for (FManagedActor& Managed : SpawnedBatchMembers)
+	{
+		if (AActor* Actor = Managed.Actor.Get())
+		{
+			Batches[FindBatch(Actor)].Members.Add(MoveTemp(Managed));
+		}
+	}
+	SpawnedBatchMembers.Reset();
+}
+
+void USuperfamilyTickManager::ResolveClasses(TArray<FSoftObjectPath>& OutPendingClasses)
+{
+	for (const TSoftClassPtr<AActor>& SoftClass : Settings.ManagedClasses)
+	{
+		if (UClass* Class = SoftClass.Get())
+		{
+			ResolvedManagedClasses.AddUnique(Class);
+		}
+		else if (!SoftClass.IsNull())
+		{
+			OutPendingClasses.AddUnique(SoftClass.ToSoftObjectPath());
+		}
+	}
+
+	for (const TSoftClassPtr<AActor>& SoftClass : Settings.BatchedClasses)
+	{
+		if (UClass* Class = SoftClass.Get())
+		{
+			if (!ResolvedBatchedClasses.Contains(Class))
+			{
+				ResolvedBatchedClasses.Add(Class);
+				Batches.AddDefaulted_GetRef().Class = Class;
+			}
+		}
+		else if (!SoftClass.IsNull())
+		{
+			OutPendingClasses.AddUnique(SoftClass.ToSoftObjectPath());
+		}
+	}
+}
+
+void USuperfamilyTickManager::HandleClassesLoaded()
+{
+	ClassLoadHandle.Reset();
+	if (!bIsActive)
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> StillPending;
+	ResolveClasses(StillPending);
+	for (const FSoftObjectPath& Path : StillPending)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Tick manager could not load class %s"), *Path.ToString());
+	}
+
+	// Instances spawned between the load finishing and this callback
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		if (!FindManagedActor(*It) && ShouldAutoManage(*It))
+		{
+			AddManagedActor(*It);
+		}
+	}
+}
+
+bool USuperfamilyTickManager::ShouldAutoManage(const AActor* Actor) const
+{
+	if (!Actor || Actor->IsPendingKillPending())
+	{
+		return false;
+	}
+
+	// The player is always relevant
+	if (const APawn* Pawn = Cast<APawn>(Actor))
+	{
+		if (Pawn->IsPlayerControlled())
+		{
+			return false;
+		}
+	}
+
+	if (!Settings.ManagedActorTag.IsNone() && Actor->ActorHasTag(Settings.ManagedActorTag))
+	{
+		return true;
+	}
+
+	if (FindBatch(Actor) != INDEX_NONE)
+	{
+		return true;
+	}
+
+	for (const UClass* Class : ResolvedManagedClasses)
+	{
+		if (Actor->IsA(Class))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int32 USuperfamilyTickManager::FindBatch(const AActor* Actor) const
+{
+	return Batches.IndexOfByPredicate([Actor](const FTickBatch& Batch)
+	{
+		return Actor->IsA(Batch.Class);
+	});
+}
+
+void USuperfamilyTickManager::AddManagedActor(AActor* Actor)
+{
+	FManagedActor Managed;
+	Managed.Actor = Actor;
+	Managed.bOriginalTickEnabled = Actor->IsActorTickEnabled();
+	Managed.OriginalTickInterval = Actor->GetActorTickInterval();
+
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component && Component->IsComponentTickEnabled())
+		{
+			Managed.TickingComponents.Emplace(Component, Component->GetComponentTickInterval());
+		}
+	}
+
+	// Nothing to save on actors that never tick
+	if (!Actor->PrimaryActorTick.bCanEverTick && Managed.TickingComponents.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 BatchIndex = FindBatch(Actor);
+	if (BatchIndex == INDEX_NONE)
+	{
+		ManagedActors.Add(MoveTemp(Managed));
+		return;
+	}
+
+	// Off the tick task graph; TickBatches drives the actor and its components from here on
+	Managed.bBatched = true;
+	Actor->SetActorTickEnabled(false);
+	for (const TPair<TWeakObjectPtr<UActorComponent>, float>& Entry : Managed.TickingComponents)
+	{
+		Entry.Key->SetComponentTickEnabled(false);
+	}
+
+	if (bTickingBatches)
+	{
+		SpawnedBatchMembers.Add(MoveTemp(Managed));
+	}
+	else
+	{
+		Batches[BatchIndex].Members.Add(MoveTemp(Managed));
+	}
+}
+
+void USuperfamilyTickManager::RestoreTickState(FManagedActor& Managed)
+{
+	Managed.bBatched = false;
+	ApplyTier(Managed, ETickSignificance::Active);
+}
+
+void USuperfamilyTickManager::ApplyTier(FManagedActor& Managed, ETickSignificance NewTier)
+{
+	Managed.Tier = NewTier;
+
+	// Batched actors keep their tick functions off; TickBatches honours the tier
+	if (Managed.bBatched)
+	{
+		return;
+	}
+
+	AActor* Actor = Managed.Actor.Get();
+	if (!Actor)
+	{
+		return;
+	}
+
+	const bool bEnable = NewTier != ETickSignificance::Dormant;
+	const bool bThrottle = NewTier == ETickSignificance::Throttled;
+
+	if (Actor->PrimaryActorTick.bCanEverTick)
+	{
+		Actor->SetActorTickEnabled(bEnable && Managed.bOriginalTickEnabled);
+		Actor->SetActorTickInterval(bThrottle ? FMath::Max(Managed.OriginalTickInterval, Settings.ThrottledTickInterval) : Managed.OriginalTickInterval);
+	}
+
+	for (const TPair<TWeakObjectPtr<UActorComponent>, float>& Entry : Managed.TickingComponents)
+	{
+		if (UActorComponent* Component = Entry.Key.Get())
+		{
+			Component->SetComponentTickEnabled(bEnable);
+			Component->SetComponentTickInterval(bThrottle ? FMath::Max(Entry.Value, Settings.ThrottledTickInterval) : Entry.Value);
+		}
+	}
+}
+
+ETickSignificance USuperfamilyTickManager::ScoreActor(const FManagedActor& Managed, float CameraX) const
+{
+	const float Distance = FMath::Abs(Managed.Actor->GetActorLocation().X - CameraX);
+
+	// Moving to a cheaper tier requires clearing the hysteresis margin
+	const float ActiveLimit = Settings.ActiveDistance + (Managed.Tier == ETickSignificance::Active ? Settings.Hysteresis : 0.0f);
+	const float ThrottleLimit = Settings.ThrottleDistance + (Managed.Tier != ETickSignificance::Dormant ? Settings.Hysteresis : 0.0f);
+
+	if (Distance <= ActiveLimit)
+	{
+		return ETickSignificance::Active;
+	}
+	if (Distance <= ThrottleLimit)
+	{
+		return ETickSignificance::Throttled;
+	}
+	return ETickSignificance::Dormant;
+}
+
+bool USuperfamilyTickManager::GetCameraX(float& OutCameraX) const
+{
+	if (const APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(GetWorld(), 0))
+	{
+		OutCameraX = CameraManager->GetCameraLocation().X;
+		return true;
+	}
+	return false;
+}
+
+void USuperfamilyTickManager::HandleActorSpawned(AActor* Actor)
+{
+	if (ShouldAutoManage(Actor))
+	{
+		AddManagedActor(Actor);
+	}
+}
+
+void USuperfamilyTickManager::HandlePreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld())
+	{
+		ActorTickStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void USuperfamilyTickManager::HandlePostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != GetWorld() || ActorTickStartTime <= 0.0)
+	{
+		return;
+	}
+
+	Report.ActorTickMs = static_cast<float>((FPlatformTime::Seconds() - ActorTickStartTime) * 1000.0);
+	Report.AverageActorTickMs = FMath::Lerp(Report.AverageActorTickMs, Report.ActorTickMs, 0.05f);
+
+	if (Report.ActorTickMs > Settings.ActorTickBudgetMs)
+	{
+		++Report.FramesOverBudget;
+		UE_LOG(LogSuperfamily, Verbose, TEXT("Actor tick %.2f ms over budget %.2f ms (%d active, %d throttled, %d dormant)"),
+			Report.ActorTickMs, Settings.ActorTickBudgetMs, Report.ActiveActors, Report.ThrottledActors, Report.DormantActors);
+	}
+}
@@ -0,0 +1,537 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Gameplay/SuperfamilyVoiceOverSubsystem.h"
+#include "Superfamily.h"
+#include "Core/SuperfamilyGameInstance.h"
+#include "Core/SuperfamilyStats.h"
+#include "RNUEBridgeSubsystem.h"
+#include "AudioDevice.h"
+#include "Dom/JsonObject.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Engine.h"
+#include "Engine/StreamableManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Sound/SoundWave.h"
+
+void USuperfamilyVoiceOverSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		CultureChangedHandle = GameInstance->OnAudioCultureChanged.AddUObject(this, &USuperfamilyVoiceOverSubsystem::HandleAudioCultureChanged);
+	}
+
+	if (URNUEBridgeSubsystem* Bridge = Collection.InitializeDependency<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnMessageReceived.AddDynamic(this, &USuperfamilyVoiceOverSubsystem::HandleBridgeMessage);
+	}
+}
+
+void USuperfamilyVoiceOverSubsystem::Deinitialize()
+{
+	if (USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		GameInstance->OnAudioCultureChanged.Remove(CultureChangedHandle);
+	}
+
+	if (URNUEBridgeSubsystem* Bridge = GetGameInstance()->GetSubsystem<URNUEBridgeSubsystem>())
+	{
+		Bridge->OnMessageReceived.RemoveDynamic(this, &USuperfamilyVoiceOverSubsystem::HandleBridgeMessage);
+	}
+
+	PrefetchQueue.Reset();
+	while (Head != INDEX_NONE)
+	{
+		Evict(Head);
+	}
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// Cues
+// ============================================
+
+FSoftObjectPath USuperfamilyVoiceOverSubsystem::GetCuePath(const FString& CueID, const FString& Culture) const
+{
+	FStringFormatNamedArguments Args;
+	Args.Add(TEXT("Culture"), Culture);
+	Args.Add(TEXT("Cue"), CueID);
+	return FSoftObjectPath(FString::Format(*VoiceOverPathFormat, Args));
+}
+
+TSoftObjectPtr<USoundBase> USuperfamilyVoiceOverSubsystem::ResolveCue(const FString& CueID) const
+{
+	return TSoftObjectPtr<USoundBase>(GetCuePath(CueID, GetAudioCulture()));
+}
+
+USoundBase* USuperfamilyVoiceOverSubsystem::FindCue(const FString& CueID)
+{
+	const int32 Slot = CueID.IsEmpty() ? INDEX_NONE : FindOrLoad(CueID, false);
+	return Slot != INDEX_NONE && !Entries[Slot].bLoading ? GetSound(Entries[Slot]) : nullptr;
+}
+
+void USuperfamilyVoiceOverSubsystem::RequestCue(const FString& CueID, FOnVoiceOverReady OnReady)
+{
+	const int32 Slot = CueID.IsEmpty() ? INDEX_NONE : FindOrLoad(CueID, false);
+	if (Slot == INDEX_NONE)
+	{
+		OnReady.ExecuteIfBound(nullptr);
+		return;
+	}
+
+	FCueEntry& Entry = Entries[Slot];
+	if (Entry.bLoading)
+	{
+		Entry.Waiters.Add(MoveTemp(OnReady));
+		return;
+	}
+
+	OnReady.ExecuteIfBound(GetSound(Entry));
+}
+
+void USuperfamilyVoiceOverSubsystem::PlayCue(const FString& CueID)
+{
+	PendingPlayCue = CueID;
+	RequestCue(CueID, FOnVoiceOverReady::CreateWeakLambda(this, [this, CueID](USoundBase* Sound)
+	{
+		// A child tapping through questions only hears the last one
+		if (PendingPlayCue != CueID)
+		{
+			return;
+		}
+
+		PendingPlayCue.Reset();
+		if (Sound)
+		{
+			UGameplayStatics::PlaySound2D(GetGameInstance()->GetWorld(), Sound);
+		}
+	}));
+}
+
+// ============================================
+// Prefetch
+// ============================================
+
+void USuperfamilyVoiceOverSubsystem::PrefetchCues(const TArray<FString>& CueIDs)
+{
+	for (const FString& CueID : CueIDs)
+	{
+		if (!CueID.IsEmpty() && !SlotByCue.Contains(CueID))
+		{
+			PrefetchQueue.AddUnique(CueID);
+		}
+	}
+	PumpPrefetches();
+}
+
+void USuperfamilyVoiceOverSubsystem::PrefetchQuestions(const TArray<FQuestionData>& Questions)
+{
+	TArray<FString> CueIDs;
+	CueIDs.Reserve(Questions.Num());
+	for (const FQuestionData& Question : Questions)
+	{
+		CueIDs.Add(Question.AudioCueID);
+	}
+	PrefetchCues(CueIDs);
+}
+
+void USuperfamilyVoiceOverSubsystem::PrefetchMission(const FMissionData& Mission)
+{
+	PrefetchCues({ Mission.AudioInstructionsCue });
+}
+
+void USuperfamilyVoiceOverSubsystem::PumpPrefetches()
+{
+	// Prefetches only fill free space; evicting cached cues for later ones would just churn
+	while (PrefetchesInFlight < FMath::Max(1, MaxPrefetchesInFlight) && PrefetchQueue.Num() > 0 && ResidentBytes < GetCacheBudgetBytes())
+	{
+		const FString CueID = PrefetchQueue[0];
+		PrefetchQueue.RemoveAt(0, 1, EAllowShrinking::No);
+		FindOrLoad(CueID, true);
+	}
+}
+
+// ============================================
+// Loading
+// ============================================
+
+int32 USuperfamilyVoiceOverSubsystem::FindOrLoad(const FString& CueID, bool bPrefetch)
+{
+	if (const int32* Existing = SlotByCue.Find(CueID))
+	{
+		if (!bPrefetch)
+		{
+			Entries[*Existing].PrefetchOrder = 0;
+			Touch(*Existing);
+		}
+		return *Existing;
+	}
+
+	LLM_SCOPE_BYTAG(Superfamily);
+
+	const int32 Slot = FreeSlots.Num() > 0 ? FreeSlots.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+	FCueEntry& Entry = Entries[Slot];
+	Entry = FCueEntry();
+	Entry.CueID = CueID;
+	Entry.bPrefetch = bPrefetch;
+	SlotByCue.Add(CueID, Slot);
+
+	if (bPrefetch)
+	{
+		Entry.PrefetchOrder = ++NextPrefetchOrder;
+		InsertPrefetched(Slot);
+		++PrefetchesInFlight;
+	}
+	else
+	{
+		Touch(Slot);
+	}
+	StartLoad(Slot, GetAudioCulture());
+	return Slot;
+}
+
+void USuperfamilyVoiceOverSubsystem::StartLoad(int32 Slot, const FString& Culture)
+{
+	FCueEntry& Entry = Entries[Slot];
+	Entry.Culture = Culture;
+	Entry.bLoading = true;
+	Entry.LoadSerial = ++NextLoadSerial;
+	const uint32 LoadSerial = Entry.LoadSerial;
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(GetCuePath(Entry.CueID, Culture),
+		FStreamableDelegate::CreateUObject(this, &USuperfamilyVoiceOverSubsystem::HandleCueLoaded, Slot, LoadSerial),
+		Entry.bPrefetch ? FStreamableManager::DefaultAsyncLoadPriority : FStreamableManager::AsyncLoadHighPriority);
+
+	// The callback may already have run (and prefetched more, growing Entries)
+	if (Entries[Slot].LoadSerial != LoadSerial)
+	{
+		return;
+	}
+
+	Entries[Slot].Handle = MoveTemp(Handle);
+	if (!Entries[Slot].Handle.IsValid() && Entries[Slot].bLoading)
+	{
+		HandleCueLoaded(Slot, LoadSerial);
+	}
+}
+
+void USuperfamilyVoiceOverSubsystem::HandleCueLoaded(int32 Slot, uint32 LoadSerial)
+{
+	if (!Entries.IsValidIndex(Slot) || Entries[Slot].LoadSerial != LoadSerial || !Entries[Slot].bLoading)
+	{
+		return;
+	}
+
+	FCueEntry& Entry = Entries[Slot];
+	USoundBase* Sound = Cast<USoundBase>(GetCuePath(Entry.CueID, Entry.Culture).ResolveObject());
+	if (!Sound && !FallbackCulture.IsEmpty() && Entry.Culture != FallbackCulture)
+	{
+		UE_LOG(LogSuperfamily, Verbose, TEXT("No %s voice-over for %s; using %s"), *Entry.Culture, *Entry.CueID, *FallbackCulture);
+		StartLoad(Slot, FallbackCulture);
+		return;
+	}
+
+	Entry.bLoading = false;
+	if (Entry.bPrefetch)
+	{
+		// Upcoming, so worth more than whatever played last, but not the cue playing now
+		--PrefetchesInFlight;
+		if (Entry.PrefetchOrder != 0)
+		{
+			InsertPrefetched(Slot);
+		}
+	}
+
+	// Missing cues stay cached (as zero bytes) so asking again doesn't reload
+	if (!Sound)
+	{
+		UE_LOG(LogSuperfamily, Warning, TEXT("Voice-over cue %s not found"), *Entry.CueID);
+	}
+	else if (USoundWave* Wave = Cast<USoundWave>(Sound))
+	{
+		if (Wave->IsStreaming(nullptr))
+		{
+			// First chunk resident so playback doesn't wait on disk; waves set to retain do it themselves
+			if (Wave->GetLoadingBehavior() != ESoundWaveLoadingBehavior::RetainOnLoad)
+			{
+				Wave->RetainCompressedAudio(false);
+				Entry.bRetainedChunk = true;
+			}
+		}
+		else if (FAudioDevice* AudioDevice = GEngine ? GEngine->GetMainAudioDeviceRaw() : nullptr)
+		{
+			// Decompresses on a worker where the wave's decompression type needs it
+			AudioDevice->Precache(Wave, false);
+		}
+	}
+
+	if (Sound)
+	{
+		Entry.Bytes = Sound->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		ResidentBytes += Entry.Bytes;
+	}
+
+	// A prefetch that fills the cache pauses the queue until a cue is asked for
+	const bool bPrefetchFilledCache = Entry.bPrefetch && ResidentBytes >= GetCacheBudgetBytes();
+
+	TArray<FOnVoiceOverReady> Waiters = MoveTemp(Entry.Waiters);
+	EvictDownTo(GetCacheBudgetBytes());
+
+	for (FOnVoiceOverReady& Waiter : Waiters)
+	{
+		Waiter.ExecuteIfBound(Sound);
+	}
+
+	if (!bPrefetchFilledCache)
+	{
+		PumpPrefetches();
+	}
+}
+
+USoundBase* USuperfamilyVoiceOverSubsystem::GetSound(const FCueEntry& Entry) const
+{
+	return Entry.Handle.IsValid() ? Cast<USoundBase>(Entry.Handle->GetLoadedAsset()) : nullptr;
+}
+
+// ============================================
+// LRU
+// ============================================
+
+void USuperfamilyVoiceOverSubsystem::Touch(int32 Slot)
+{
+	if (Head == Slot)
+	{
+		return;
+	}
+
+	Unlink(Slot);
+
+	FCueEntry& Entry = Entries[Slot];
+	Entry.Next = Head;
+	if (Head != INDEX_NONE)
+	{
+		Entries[Head].Prev = Slot;
+	}
+	Head = Slot;
+
+	if (Tail == INDEX_NONE)
+	{
+		Tail = Slot;
+	}
+}
+
+void USuperfamilyVoiceOverSubsystem::InsertPrefetched(int32 Slot)
+{
+	Unlink(Slot);
+
+	const uint32 Order = Entries[Slot].PrefetchOrder;
+	if (Head == INDEX_NONE || (Entries[Head].PrefetchOrder != 0 && Entries[Head].PrefetchOrder > Order))
+	{
+		Touch(Slot);
+		return;
+	}
+
+	int32 After = Head;
+	for (int32 Next = Entries[After].Next; Next != INDEX_NONE; Next = Entries[Next].Next)
+	{
+		if (Entries[Next].PrefetchOrder == 0 || Entries[Next].PrefetchOrder > Order)
+		{
+			break;
+		}
+		After = Next;
+	}
+
+	FCueEntry& Entry = Entries[Slot];
+	Entry.Prev = After;
+	Entry.Next = Entries[After].Next;
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Slot;
+	}
+	else
+	{
+		Tail = Slot;
+	}
+	Entries[After].Next = Slot;
+}
+
+void USuperfamilyVoiceOverSubsystem::Unlink(int32 Slot)
+{
+	FCueEntry& Entry = Entries[Slot];
+	if (Entry.Prev != INDEX_NONE)
+	{
+		Entries[Entry.Prev].Next = Entry.Next;
+	}
+	else if (Head == Slot)
+	{
+		Head = Entry.Next;
+	}
+
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Entry.Prev;
+	}
+	else if (Tail == Slot)
+	{
+		Tail = Entry.Prev;
+	}
+
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+}
+
+void USuperfamilyVoiceOverSubsystem::Evict(int32 Slot)
+{
+	FCueEntry& Entry = Entries[Slot];
+
+	if (Entry.bRetainedChunk)
+	{
+		if (USoundWave* Wave = Cast<USoundWave>(GetSound(Entry)))
+		{
+			Wave->ReleaseCompressedAudio();
+		}
+	}
+
+	// Only references are dropped here; the assets go with the next regular GC
+	if (Entry.Handle.IsValid())
+	{
+		if (Entry.bLoading)
+		{
+			Entry.Handle->CancelHandle();
+		}
+		else
+		{
+			Entry.Handle->ReleaseHandle();
+		}
+	}
+
+	if (Entry.bLoading && Entry.bPrefetch)
+	{
+		--PrefetchesInFlight;
+	}
+
+	ResidentBytes -= Entry.Bytes;
+	Unlink(Slot);
+	SlotByCue.Remove(Entry.CueID);
+	Entry = FCueEntry();
+	FreeSlots.Add(Slot);
+}
+
+int64 USuperfamilyVoiceOverSubsystem::EvictDownTo(int64 Limit)
+{
+	int64 Freed = 0;
+
+	// The most recent cue is the one about to play, so it is kept even over budget
+	int32 Slot = Tail;
+	while (ResidentBytes > Limit && Slot != INDEX_NONE && Slot != Head)
+	{
+		const int32 Prev = Entries[Slot].Prev;
+		if (!Entries[Slot].bLoading)
+		{
+			Freed += Entries[Slot].Bytes;
+			Evict(Slot);
+		}
+		Slot = Prev;
+	}
+	return Freed;
+}
+
+int64 USuperfamilyVoiceOverSubsystem::TrimMemory(int64 BytesToFree)
+{
+	// Cues needed later load again on demand
+	PrefetchQueue.Reset();
+	const int64 Freed = EvictDownTo(FMath::Max<int64>(0, ResidentBytes - BytesToFree));
+	if (Freed > 0)
+	{
+		UE_LOG(LogSuperfamily, Log, TEXT("Dropped %.1f KB of voice-over cues to free memory"), Freed / 1024.0);
+	}
+	return Freed;
+}
+
+// ============================================
+// Culture
+// ============================================
+
+FString USuperfamilyVoiceOverSubsystem::GetAudioCulture() const
+{
+	const USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance());
+	return GameInstance ? GameInstance->GetAudioCulture() : FallbackCulture;
+}
+
+void USuperfamilyVoiceOverSubsystem::HandleAudioCultureChanged(const FString& Culture)
+{
+	// What was cached is what is about to be needed again, most recent first
+	TArray<FString> CachedCues;
+	TArray<TPair<FString, TArray<FOnVoiceOverReady>>> Waiting;
+	TArray<int32> Dropped;
+	for (int32 Slot = Head; Slot != INDEX_NONE; Slot = Entries[Slot].Next)
+	{
+		FCueEntry& Entry = Entries[Slot];
+
+		// A fallback cue is still the right one if the new culture has none of its own
+		FAssetData CultureAsset;
+		const bool bStillValid = Entry.Culture == Culture || (!Entry.bLoading && Entry.Culture == FallbackCulture
+			&& !(UAssetManager::IsInitialized() && UAssetManager::Get().GetAssetDataForPath(GetCuePath(Entry.CueID, Culture), CultureAsset)));
+		if (bStillValid)
+		{
+			continue;
+		}
+
+		if (Entry.Waiters.Num() > 0)
+		{
+			Waiting.Emplace(Entry.CueID, MoveTemp(Entry.Waiters));
+		}
+		else
+		{
+			CachedCues.Add(Entry.CueID);
+		}
+		Dropped.Add(Slot);
+	}
+
+	const int64 ResidentBefore = ResidentBytes;
+	for (const int32 Slot : Dropped)
+	{
+		Evict(Slot);
+	}
+
+	UE_LOG(LogSuperfamily, Log, TEXT("Audio culture now %s; dropped %d voice-over cues (%.1f KB)"),
+		*Culture, Dropped.Num(), (ResidentBefore - ResidentBytes) / 1024.0);
+
+	// Cues someone is waiting on load first, at high priority, in the new culture
+	for (TPair<FString, TArray<FOnVoiceOverReady>>& Pair : Waiting)
+	{
+		for (FOnVoiceOverReady& Waiter : Pair.Value)
+		{
+			RequestCue(Pair.Key, MoveTemp(Waiter));
+		}
+	}
+
+	CachedCues.Append(MoveTemp(PrefetchQueue));
+	PrefetchQueue.Reset();
+	PrefetchCues(CachedCues);
+}
+
+void USuperfamilyVoiceOverSubsystem::HandleBridgeMessage(const FRNUEMessage& Message)
+{
+	if (Message.Type != ERNUEMessageType::SettingsChanged)
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> Payload;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Message.Payload);
+	FString Culture;
+	if (!FJsonSerializer::Deserialize(Reader, Payload) || !Payload.IsValid() || !Payload->TryGetStringField(TEXT("audioCulture"), Culture))
+	{
+		return;
+	}
+
+	if (USuperfamilyGameInstance* GameInstance = Cast<USuperfamilyGameInstance>(GetGameInstance()))
+	{
+		GameInstance->SetAudioCulture(Culture);
+	}
+}
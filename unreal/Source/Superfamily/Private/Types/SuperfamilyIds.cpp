@@ -0,0 +1,342 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Types/SuperfamilyIds.h"
+#include "Superfamily.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+#include "Misc/SecureHash.h"
+#include "UObject/PropertyHelper.h"
+#include "UObject/PropertyTag.h"
+
+namespace SuperfamilyIds
+{
+	/** Read a possibly quoted token, as FStrProperty's text import does */
+	static bool ReadToken(const TCHAR*& Buffer, FString& OutToken)
+	{
+		const TCHAR* End = FPropertyHelpers::ReadToken(Buffer, OutToken, true);
+		if (!End)
+		{
+			return false;
+		}
+		Buffer = End;
+		return true;
+	}
+
+	/** Saves load on worker threads; the game instance collects the conversions afterwards */
+	static FCriticalSection LegacyChildIdLock;
+	static TMap<FString, FChildId> LegacyChildIdConversions;
+
+	static void ExportToken(FString& ValueStr, const FString& Token, int32 PortFlags)
+	{
+		if (PortFlags & PPF_Delimited)
+		{
+			ValueStr += TEXT("\"") + Token + TEXT("\"");
+		}
+		else
+		{
+			ValueStr += Token;
+		}
+	}
+}
+
+// ============================================
+// Registry
+// ============================================
+
+FSuperfamilyIdRegistry& FSuperfamilyIdRegistry::Questions()
+{
+	static FSuperfamilyIdRegistry Registry;
+	return Registry;
+}
+
+FSuperfamilyIdRegistry& FSuperfamilyIdRegistry::Missions()
+{
+	static FSuperfamilyIdRegistry Registry;
+	return Registry;
+}
+
+FSuperfamilyIdRegistry::FSuperfamilyIdRegistry()
+{
+	IDs.Add(FString());
+}
+
+uint32 FSuperfamilyIdRegistry::Intern(const FString& ID)
+{
+	if (ID.IsEmpty())
+	{
+		return 0;
+	}
+
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const uint32* Existing = IndexByID.Find(ID))
+		{
+			return *Existing;
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	if (const uint32* Existing = IndexByID.Find(ID))
+	{
+		return *Existing;
+	}
+
+	const uint32 Index = static_cast<uint32>(IDs.Add(ID));
+	IndexByID.Add(ID, Index);
+	return Index;
+}
+
+FString FSuperfamilyIdRegistry::Resolve(uint32 Index) const
+{
+	FReadScopeLock ReadLock(Lock);
+	return IDs.IsValidIndex(Index) ? IDs[Index] : FString();
+}
+
+int32 FSuperfamilyIdRegistry::Num() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return IDs.Num() - 1;
+}
+
+void FSuperfamilyIdRegistry::SerializeIndex(FArchive& Ar, uint32& Index)
+{
+	// Always the string, so no archive ever depends on interning order
+	FString ID;
+	if (Ar.IsLoading())
+	{
+		Ar << ID;
+		Index = Intern(ID);
+	}
+	else
+	{
+		ID = Resolve(Index);
+		Ar << ID;
+	}
+}
+
+void FSuperfamilyIdRegistry::ExportIndex(FString& ValueStr, uint32 Index, int32 PortFlags) const
+{
+	SuperfamilyIds::ExportToken(ValueStr, Resolve(Index), PortFlags);
+}
+
+bool FSuperfamilyIdRegistry::ImportIndex(const TCHAR*& Buffer, uint32& Index)
+{
+	FString ID;
+	if (!SuperfamilyIds::ReadToken(Buffer, ID))
+	{
+		return false;
+	}
+	Index = Intern(ID);
+	return true;
+}
+
+// ============================================
+// FChildId
+// ============================================
+
+FChildId FChildId::FromString(const FString& String)
+{
+	FGuid Guid;
+	FGuid::Parse(String, Guid);
+	return FChildId(Guid);
+}
+
+FChildId FChildId::FromLegacyString(const FString& LegacyID)
+{
+	static const uint8 Namespace[16] = { 0x8f, 0x7c, 0x1f, 0x0e, 0x2b, 0x6a, 0x4d, 0x3c, 0x9e, 0x51, 0x7a, 0x0b, 0x4c, 0x2d, 0x9e, 0x13 };
+
+	const FTCHARToUTF8 Name(*LegacyID);
+	FSHA1 Sha;
+	Sha.Update(Namespace, sizeof(Namespace));
+	Sha.Update(reinterpret_cast<const uint8*>(Name.Get()), Name.Length());
+	Sha.Final();
+
+	uint8 Hash[FSHA1::DigestSize];
+	Sha.GetHash(Hash);
+	Hash[6] = (Hash[6] & 0x0F) | 0x50; // Version 5
+	Hash[8] = (Hash[8] & 0x3F) | 0x80; // RFC 4122 variant
+
+	// Big-endian words, so ToString prints the UUID's hex digits in order
+	auto Word = [&Hash](int32 Offset)
+	{
+		return (static_cast<uint32>(Hash[Offset]) << 24) | (static_cast<uint32>(Hash[Offset + 1]) << 16)
+			| (static_cast<uint32>(Hash[Offset + 2]) << 8) | static_cast<uint32>(Hash[Offset + 3]);
+	};
+	return FChildId(FGuid(Word(0), Word(4), Word(8), Word(12)));
+}
+
+TMap<FString, FChildId> FChildId::TakeLegacyConversions()
+{
+	FScopeLock ScopeLock(&SuperfamilyIds::LegacyChildIdLock);
+	return MoveTemp(SuperfamilyIds::LegacyChildIdConversions);
+}
+
+bool FChildId::Serialize(FArchive& Ar)
+{
+	Ar << Guid;
+	return true;
+}
+
+bool FChildId::SerializeFromMismatchedTag(const FPropertyTag& Tag, FStructuredArchive::FSlot Slot)
+{
+	// Saves from before FChildId stored the ID as a string
+	if (Tag.Type == NAME_StrProperty)
+	{
+		FString String;
+		Slot << String;
+		*this = FromString(String);
+		if (!IsValid() && !String.IsEmpty())
+		{
+			*this = FromLegacyString(String);
+			UE_LOG(LogSuperfamily, Log, TEXT("Child ID '%s' in the save is not a GUID; loaded as %s"), *String, *ToString());
+
+			FScopeLock ScopeLock(&SuperfamilyIds::LegacyChildIdLock);
+			SuperfamilyIds::LegacyChildIdConversions.Add(String, *this);
+		}
+		return true;
+	}
+	return false;
+}
+
+bool FChildId::ExportTextItem(FString& ValueStr, const FChildId& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const
+{
+	SuperfamilyIds::ExportToken(ValueStr, IsValid() ? ToString() : FString(), PortFlags);
+	return true;
+}
+
+bool FChildId::ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText)
+{
+	FString String;
+	if (!SuperfamilyIds::ReadToken(Buffer, String))
+	{
+		return false;
+	}
+	*this = FromString(String);
+	return true;
+}
+
+// ============================================
+// FQuestionId / FMissionId
+// ============================================
+
+FQuestionId FQuestionId::FromString(const FString& String)
+{
+	FQuestionId Id;
+	Id.Index = FSuperfamilyIdRegistry::Questions().Intern(String);
+	return Id;
+}
+
+bool FQuestionId::Serialize(FArchive& Ar)
+{
+	FSuperfamilyIdRegistry::Questions().SerializeIndex(Ar, Index);
+	return true;
+}
+
+bool FQuestionId::SerializeFromMismatchedTag(const FPropertyTag& Tag, FStructuredArchive::FSlot Slot)
+{
+	// Question tables saved before QuestionID was interned
+	if (Tag.Type == NAME_StrProperty)
+	{
+		FString String;
+		Slot << String;
+		Index = FSuperfamilyIdRegistry::Questions().Intern(String);
+		return true;
+	}
+	return false;
+}
+
+bool FQuestionId::ExportTextItem(FString& ValueStr, const FQuestionId& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const
+{
+	FSuperfamilyIdRegistry::Questions().ExportIndex(ValueStr, Index, PortFlags);
+	return true;
+}
+
+bool FQuestionId::ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText)
+{
+	return FSuperfamilyIdRegistry::Questions().ImportIndex(Buffer, Index);
+}
+
+FMissionId FMissionId::FromString(const FString& String)
+{
+	FMissionId Id;
+	Id.Index = FSuperfamilyIdRegistry::Missions().Intern(String);
+	return Id;
+}
+
+bool FMissionId::Serialize(FArchive& Ar)
+{
+	FSuperfamilyIdRegistry::Missions().SerializeIndex(Ar, Index);
+	return true;
+}
+
+bool FMissionId::SerializeFromMismatchedTag(const FPropertyTag& Tag, FStructuredArchive::FSlot Slot)
+{
+	// CompletedMissions in saves from before mission IDs were interned
+	if (Tag.Type == NAME_StrProperty)
+	{
+		FString String;
+		Slot << String;
+		Index = FSuperfamilyIdRegistry::Missions().Intern(String);
+		return true;
+	}
+	return false;
+}
+
+bool FMissionId::ExportTextItem(FString& ValueStr, const FMissionId& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const
+{
+	FSuperfamilyIdRegistry::Missions().ExportIndex(ValueStr, Index, PortFlags);
+	return true;
+}
+
+bool FMissionId::ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText)
+{
+	return FSuperfamilyIdRegistry::Missions().ImportIndex(Buffer, Index);
+}
+
+// ============================================
+// FLevelKey
+// ============================================
+
+FLevelKey FLevelKey::FromString(const FString& String)
+{
+	int32 WorldID = 0;
+	int32 LevelID = 0;
+	const int32 LevelStart = String.Find(TEXT("L"), ESearchCase::CaseSensitive);
+	if (!String.StartsWith(TEXT("W"), ESearchCase::CaseSensitive) || LevelStart == INDEX_NONE
+		|| !LexTryParseString(WorldID, *String.Mid(1, LevelStart - 1))
+		|| !LexTryParseString(LevelID, *String.Mid(LevelStart + 1)))
+	{
+		return FLevelKey();
+	}
+	return FLevelKey(WorldID, LevelID);
+}
+
+bool FLevelKey::SerializeFromMismatchedTag(const FPropertyTag& Tag, FStructuredArchive::FSlot Slot)
+{
+	// LevelProgress keys in saves from before FLevelKey
+	if (Tag.Type == NAME_StrProperty)
+	{
+		FString String;
+		Slot << String;
+		*this = FromString(String);
+		return true;
+	}
+	return false;
+}
+
+bool FLevelKey::ExportTextItem(FString& ValueStr, const FLevelKey& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const
+{
+	SuperfamilyIds::ExportToken(ValueStr, ToString(), PortFlags);
+	return true;
+}
+
+bool FLevelKey::ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText)
+{
+	FString String;
+	if (!SuperfamilyIds::ReadToken(Buffer, String))
+	{
+		return false;
+	}
+	*this = FromString(String);
+	return IsValid();
+}
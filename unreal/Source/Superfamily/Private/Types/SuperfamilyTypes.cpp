@@ -0,0 +1,153 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#include "Types/SuperfamilyTypes.h"
+
+namespace SuperfamilyTypes
+{
+	/** Upper edge of the first response time bucket */
+	static constexpr float FirstBucketSeconds = 0.5f;
+
+	static void SerializePacked(FArchive& Ar, int32& Value)
+	{
+		uint32 Packed = static_cast<uint32>(FMath::Max(Value, 0));
+		Ar.SerializeIntPacked(Packed);
+		Value = static_cast<int32>(Packed);
+	}
+}
+
+// ============================================
+// FResponseTimeHistogram
+// ============================================
+
+void FResponseTimeHistogram::Add(float Seconds)
+{
+	Seconds = FMath::Max(Seconds, 0.0f);
+
+	// Bucket edges are FirstBucketSeconds * 2^(Bucket / 2)
+	int32 Bucket = 0;
+	if (Seconds > SuperfamilyTypes::FirstBucketSeconds)
+	{
+		Bucket = FMath::Min(FMath::CeilToInt(2.0f * FMath::Log2(Seconds / SuperfamilyTypes::FirstBucketSeconds)), NumBuckets - 1);
+	}
+
+	++Counts[Bucket];
+	TotalSeconds += Seconds;
+}
+
+void FResponseTimeHistogram::Merge(const FResponseTimeHistogram& Other)
+{
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		Counts[Bucket] += Other.Counts[Bucket];
+	}
+	TotalSeconds += Other.TotalSeconds;
+}
+
+int32 FResponseTimeHistogram::GetCount() const
+{
+	int32 Count = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		Count += Counts[Bucket];
+	}
+	return Count;
+}
+
+float FResponseTimeHistogram::GetMean() const
+{
+	const int32 Count = GetCount();
+	return Count > 0 ? TotalSeconds / Count : 0.0f;
+}
+
+float FResponseTimeHistogram::GetPercentile(float Percentile) const
+{
+	const int32 Count = GetCount();
+	if (Count == 0)
+	{
+		return 0.0f;
+	}
+
+	const float Target = FMath::Clamp(Percentile, 0.0f, 1.0f) * Count;
+	int32 Below = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		if (Counts[Bucket] > 0 && Below + Counts[Bucket] >= Target)
+		{
+			// Spread the bucket's answers evenly over its range
+			const float Lower = Bucket > 0 ? GetBucketUpperBound(Bucket - 1) : 0.0f;
+			const float Upper = GetBucketUpperBound(Bucket);
+			return Lower + (Upper - Lower) * FMath::Clamp((Target - Below) / Counts[Bucket], 0.0f, 1.0f);
+		}
+		Below += Counts[Bucket];
+	}
+	return GetBucketUpperBound(NumBuckets - 1);
+}
+
+float FResponseTimeHistogram::GetBucketUpperBound(int32 Bucket)
+{
+	return SuperfamilyTypes::FirstBucketSeconds * FMath::Pow(2.0f, 0.5f * FMath::Clamp(Bucket, 0, NumBuckets - 1));
+}
+
+void FResponseTimeHistogram::Serialize(FArchive& Ar)
+{
+	Ar << TotalSeconds;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		SuperfamilyTypes::SerializePacked(Ar, Counts[Bucket]);
+	}
+}
+
+// ============================================
+// FSubjectProgressTable
+// ============================================
+
+FSubjectStats FSubjectProgressTable::GetSubjectTotal(EQuestionSubject Subject) const
+{
+	FSubjectStats Total;
+	for (int32 Difficulty = 0; Difficulty < NumDifficulties; ++Difficulty)
+	{
+		Total.Merge(Get(Subject, static_cast<EDifficultyLevel>(Difficulty)));
+	}
+	return Total;
+}
+
+bool FSubjectProgressTable::Serialize(FArchive& Ar)
+{
+	static_assert(NumCells <= 32, "Cell mask is 32 bits");
+
+	uint8 Version = 1;
+	Ar << Version;
+
+	// Most children only ever see a few subject/difficulty combinations
+	uint32 UsedCells = 0;
+	if (!Ar.IsLoading())
+	{
+		for (int32 Index = 0; Index < NumCells; ++Index)
+		{
+			if (Cells[Index].QuestionsAnswered > 0 || !Cells[Index].ResponseTimes.IsEmpty())
+			{
+				UsedCells |= 1u << Index;
+			}
+		}
+	}
+	Ar.SerializeIntPacked(UsedCells);
+
+	for (int32 Index = 0; Index < NumCells; ++Index)
+	{
+		FSubjectStats& Cell = Cells[Index];
+		if (!(UsedCells & (1u << Index)))
+		{
+			if (Ar.IsLoading())
+			{
+				Cell = FSubjectStats();
+			}
+			continue;
+		}
+
+		SuperfamilyTypes::SerializePacked(Ar, Cell.QuestionsAnswered);
+		SuperfamilyTypes::SerializePacked(Ar, Cell.QuestionsCorrect);
+		Cell.ResponseTimes.Serialize(Ar);
+	}
+
+	return true;
+}
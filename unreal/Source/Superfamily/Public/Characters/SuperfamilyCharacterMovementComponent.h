@@ -0,0 +1,93 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SuperfamilyCharacterMovementComponent.generated.h"
+
+/**
+ * Character movement specialized for the 2.5D XZ plane
+ * Replaces the capsule floor sweep with vertical line traces along X, skips
+ * rotation work, and adds one-way platforms, coyote time and jump buffering.
+ * Coyote time and jump buffering are event-driven and add no ticks.
+ */
+UCLASS()
+class SUPERFAMILY_API USuperfamilyCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	USuperfamilyCharacterMovementComponent();
+
+	// ============================================
+	// Platformer Feel
+	// ============================================
+
+	/** Seconds after walking off a ledge during which a jump is still allowed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Platformer")
+	float CoyoteTime = 0.12f;
+
+	/** Seconds a jump pressed in the air is remembered and executed on landing */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Platformer")
+	float JumpBufferTime = 0.15f;
+
+	/** Use 2D line-trace floor detection instead of the stock capsule sweep */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Platformer")
+	bool bUseSimplifiedFloorCheck = true;
+
+	/** Components with this tag can be jumped through from below and dropped through */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Platformer")
+	FName OneWayPlatformTag = TEXT("OneWay");
+
+	/** True while falling within CoyoteTime of leaving the ground without jumping */
+	UFUNCTION(BlueprintPure, Category = "Character Movement: Platformer")
+	bool IsInCoyoteTime() const;
+
+	/** Remember a jump press that could not be executed yet */
+	UFUNCTION(BlueprintCallable, Category = "Character Movement: Platformer")
+	void BufferJump();
+
+	/** Returns true (and clears the buffer) if a jump was pressed within JumpBufferTime */
+	UFUNCTION(BlueprintCallable, Category = "Character Movement: Platformer")
+	bool ConsumeBufferedJump();
+
+	/** Called when a jump actually happens; ends coyote time */
+	void NotifyJumped();
+
+	/** Fall through the one-way platform the character is standing on */
+	UFUNCTION(BlueprintCallable, Category = "Character Movement: Platformer")
+	void DropThroughPlatform();
+
+	//~ Begin UCharacterMovementComponent Interface
+	virtual void ComputeFloorDist(const FVector& CapsuleLocation, float LineDistance, float SweepDistance, FFindFloorResult& OutFloorResult, float SweepRadius, const FHitResult* DownwardSweepResult = nullptr) const override;
+	virtual void PhysicsRotation(float DeltaTime) override;
+	//~ End UCharacterMovementComponent Interface
+
+protected:
+	//~ Begin UCharacterMovementComponent Interface
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+	virtual void PerformMovement(float DeltaTime) override;
+	//~ End UCharacterMovementComponent Interface
+
+private:
+	bool IsOneWayPlatform(const UPrimitiveComponent* Component) const;
+
+	/** Start passing through a one-way platform */
+	void IgnorePlatform(UPrimitiveComponent* Platform);
+
+	/** Ignore one-way platforms this move would enter from below or the side, before the move runs */
+	void IgnorePlatformsInPath(float DeltaTime);
+
+	/** Re-enable collision with platforms the capsule has cleared */
+	void RestoreClearedPlatforms();
+
+	/** World time the character last left the ground without jumping (-1 = none) */
+	float LeftGroundTime = -1.0f;
+
+	/** World time of the last buffered jump press (-1 = none) */
+	float JumpBufferedTime = -1.0f;
+
+	/** One-way platforms currently ignored by the capsule */
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> IgnoredPlatforms;
+};
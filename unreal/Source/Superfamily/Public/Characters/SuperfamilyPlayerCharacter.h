@@ -10,7 +10,9 @@ class UInputMappingContext;
 class UInputAction;
 class USpringArmComponent;
 class UCameraComponent;
+class USuperfamilyCharacterMovementComponent;
 struct FInputActionValue;
+enum class EInputReplayAction : uint8;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPlayerJumped);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCoinCollected, int32, NewTotal);
@@ -25,7 +27,7 @@ class SUPERFAMILY_API ASuperfamilyPlayerCharacter : public ACharacter
 	GENERATED_BODY()
 
 public:
-	ASuperfamilyPlayerCharacter();
+	ASuperfamilyPlayerCharacter(const FObjectInitializer& ObjectInitializer);
 
 	//~ Begin AActor Interface
 	virtual void BeginPlay() override;
@@ -36,6 +38,11 @@ public:
 	virtual void SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) override;
 	//~ End APawn Interface
 
+	//~ Begin ACharacter Interface
+	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
+	virtual void OnJumped_Implementation() override;
+	//~ End ACharacter Interface
+
 	// ============================================
 	// Movement (2.5D)
 	// ============================================
@@ -44,10 +51,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void Move2D(float AxisValue);
 
-	/** Perform a jump */
+	/** Perform a jump, or buffer it until landing if airborne */
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void PerformJump();
 
+	/** 2.5D movement component */
+	UFUNCTION(BlueprintPure, Category = "Movement")
+	USuperfamilyCharacterMovementComponent* GetSuperfamilyMovement() const;
+
 	/** Check if character is facing right */
 	UFUNCTION(BlueprintPure, Category = "Movement")
 	bool IsFacingRight() const { return bIsFacingRight; }
@@ -68,11 +79,11 @@ public:
 	// Events
 	// ============================================
 
-	/** Called when player jumps */
+	/** Called when player jumps; also published as FPlayerJumpedEvent on the event bus, batched per frame */
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnPlayerJumped OnPlayerJumped;
 
-	/** Called when a coin is collected */
+	/** Called when a coin is collected; also published as FCoinCollectedEvent on the event bus, batched per frame */
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnCoinCollected OnCoinCollected;
 
@@ -137,7 +148,17 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Camera")
 	float CameraHeightOffset = 100.0f;
 
+	//~ Begin ACharacter Interface
+	virtual bool CanJumpInternal_Implementation() const override;
+	//~ End ACharacter Interface
+
 private:
+	/** Replays drive the input handlers directly */
+	friend class USuperfamilyInputReplaySubsystem;
+
+	/** Let the input replay subsystem record or suppress an input; false = ignore it */
+	bool RouteInput(EInputReplayAction Action, float Value = 0.0f) const;
+
 	/** Handle move input */
 	void HandleMoveInput(const FInputActionValue& Value);
 
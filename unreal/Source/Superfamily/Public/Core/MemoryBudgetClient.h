@@ -0,0 +1,43 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "MemoryBudgetClient.generated.h"
+
+struct FStreamableHandle;
+class ULevelStreaming;
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class UMemoryBudgetClient : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Game instance or world subsystem whose memory counts against a USuperfamilyMemoryMonitor budget
+ * Implemented across modules (EducationSystem, RealLifeMissions) so the monitor
+ * doesn't need to know them.
+ */
+class SUPERFAMILY_API IMemoryBudgetClient
+{
+	GENERATED_BODY()
+
+public:
+	/** Budget the memory counts against, a key of the monitor's BudgetsMB */
+	virtual FName GetMemoryBudgetName() const = 0;
+
+	/** Bytes currently held */
+	virtual int64 GetBudgetedMemoryBytes() const = 0;
+
+	/** Drop cached memory that can be rebuilt, ideally at least BytesToFree; returns bytes freed */
+	virtual int64 TrimMemory(int64 BytesToFree) { return 0; }
+
+protected:
+	/** Estimated memory of the assets a streamable handle has loaded */
+	static int64 GetLoadedAssetBytes(const FStreamableHandle& Handle);
+
+	/** Estimated memory of a streamed level's world and its actors, or 0 if it isn't loaded */
+	static int64 GetLoadedLevelBytes(const ULevelStreaming& Streaming);
+};
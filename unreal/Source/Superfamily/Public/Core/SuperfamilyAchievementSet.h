@@ -0,0 +1,106 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Types/SuperfamilyTypes.h"
+#include "SuperfamilyAchievementSet.generated.h"
+
+/**
+ * Gameplay events achievements count
+ */
+UENUM(BlueprintType)
+enum class EAchievementEvent : uint8
+{
+	CoinCollected       UMETA(DisplayName = "Coin Collected"),      // Counts coins
+	LevelCompleted      UMETA(DisplayName = "Level Completed"),     // Counts completions
+	QuestionAnswered    UMETA(DisplayName = "Question Answered"),   // Counts answers
+	StreakUpdated       UMETA(DisplayName = "Streak Updated"),      // Best answer streak
+	MissionCompleted    UMETA(DisplayName = "Mission Completed")    // Counts missions
+};
+
+/**
+ * One achievement: unlocked once the total of its event, within its filters, reaches Threshold
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FAchievementDefinition
+{
+	GENERATED_BODY()
+
+	/** ID reported to RN and stored in UnlockedAchievements */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievement")
+	FName AchievementID;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievement")
+	FText DisplayName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievement")
+	EAchievementEvent Event = EAchievementEvent::LevelCompleted;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievement", meta = (ClampMin = "1"))
+	int32 Threshold = 1;
+
+	/** Only levels in this world count; 0 for any */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievement|Filter", meta = (EditCondition = "Event == EAchievementEvent::LevelCompleted", EditConditionHides))
+	int32 WorldID = 0;
+
+	/** Only completions with at least this many stars count */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievement|Filter", meta = (EditCondition = "Event == EAchievementEvent::LevelCompleted", EditConditionHides))
+	int32 MinStars = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievement|Filter", meta = (EditCondition = "Event == EAchievementEvent::QuestionAnswered", EditConditionHides))
+	bool bCorrectAnswersOnly = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievement|Filter", meta = (EditCondition = "Event == EAchievementEvent::QuestionAnswered", EditConditionHides))
+	bool bAnySubject = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievement|Filter", meta = (EditCondition = "Event == EAchievementEvent::QuestionAnswered && !bAnySubject", EditConditionHides))
+	EQuestionSubject Subject = EQuestionSubject::Rekenen;
+
+	/** Bit in FChildProfile::AchievementBits; assigned on save and never reused */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Achievement")
+	int32 StableIndex = INDEX_NONE;
+
+	/** Key of the running total this achievement reads; achievements with the same event and filters share it */
+	FString GetCounterKey() const;
+};
+
+/**
+ * Every achievement in the game
+ * Indices are handed out when the asset is saved, so removing or reordering
+ * achievements never moves another one's bit in existing saves.
+ */
+UCLASS(BlueprintType)
+class SUPERFAMILY_API USuperfamilyAchievementSet : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	//~ Begin UObject Interface
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
+	//~ End UObject Interface
+
+	//~ Begin UPrimaryDataAsset Interface
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+	//~ End UPrimaryDataAsset Interface
+
+	const TArray<FAchievementDefinition>& GetAchievements() const { return Achievements; }
+
+protected:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Achievements", meta = (TitleProperty = "AchievementID"))
+	TArray<FAchievementDefinition> Achievements;
+
+	/** Next unused stable index */
+	UPROPERTY(VisibleAnywhere, Category = "Achievements")
+	int32 NextStableIndex = 0;
+
+#if WITH_EDITOR
+	/** Give new achievements (and duplicated ones) a fresh stable index */
+	void AssignStableIndices();
+#endif
+};
@@ -0,0 +1,179 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/BitArray.h"
+#include "Core/SuperfamilyAchievementSet.h"
+#include "SuperfamilyAchievementSubsystem.generated.h"
+
+struct FCoinCollectedEvent;
+struct FQuestionAnsweredEvent;
+struct FStreakUpdatedEvent;
+struct FStreamableHandle;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAchievementUnlocked, FName, AchievementID, const FText&, DisplayName);
+
+/**
+ * Event-driven achievement evaluation
+ * The achievement set is compiled once into counters: every distinct (event,
+ * filters) combination is one running total, shared by all achievements that
+ * read it, with those achievements sorted by threshold. An event only touches
+ * the counters subscribed to its type, and a counter only looks at its next
+ * threshold, so the cost of an event doesn't grow with the number of
+ * achievements. Counters and unlocks live on the profile (AchievementCounters,
+ * AchievementBits), so totals carry across sessions.
+ *
+ * Level and mission events come from the game instance. Coins, answers and
+ * streaks come from the event bus a frame at a time: a frame's coins are one
+ * counter update and its streaks only the best one.
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API USuperfamilyAchievementSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Boot stage that loads and compiles the achievement set */
+	static const FName BootStage;
+
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	// ============================================
+	// Events
+	// ============================================
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Achievements")
+	void NotifyCoinsCollected(int32 Amount);
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Achievements")
+	void NotifyQuestionAnswered(EQuestionSubject Subject, bool bCorrect);
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Achievements")
+	void NotifyStreakUpdated(int32 Streak);
+
+	// ============================================
+	// Queries
+	// ============================================
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Achievements")
+	bool IsAchievementUnlocked(FName AchievementID) const;
+
+	/** Current total and threshold of an achievement for the active child */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Achievements")
+	bool GetAchievementProgress(FName AchievementID, int32& OutValue, int32& OutThreshold);
+
+	/** Stable index of an achievement in the set, INDEX_NONE if unknown or the set isn't loaded yet */
+	int32 GetStableIndex(FName AchievementID) const;
+
+	UPROPERTY(BlueprintAssignable, Category = "Superfamily|Achievements")
+	FOnAchievementUnlocked OnAchievementUnlocked;
+
+protected:
+	/** Achievement definitions; falls back to the first AchievementSet primary asset when unset */
+	UPROPERTY(Config)
+	TSoftObjectPtr<USuperfamilyAchievementSet> AchievementSet;
+
+private:
+	/** What an event carries, for filter checks */
+	struct FEventContext
+	{
+		int32 WorldID = 0;
+		int32 Stars = 0;
+
+		/** Best stars before this completion, INDEX_NONE if the level wasn't completed; a level counts once per counter */
+		int32 PreviousStars = INDEX_NONE;
+
+		EQuestionSubject Subject = EQuestionSubject::Rekenen;
+		bool bCorrect = false;
+	};
+
+	struct FCompiledAchievement
+	{
+		FName AchievementID;
+		FText DisplayName;
+		int32 StableIndex = INDEX_NONE;
+		int32 Threshold = 1;
+		int32 Counter = INDEX_NONE;
+	};
+
+	/** A running total and the achievements that read it */
+	struct FCounter
+	{
+		FString Key;
+		EAchievementEvent Event = EAchievementEvent::LevelCompleted;
+
+		/** Filters, copied from the first achievement with this key */
+		int32 WorldID = 0;
+		int32 MinStars = 0;
+		bool bCorrectOnly = false;
+		bool bAnySubject = true;
+		EQuestionSubject Subject = EQuestionSubject::Rekenen;
+
+		/** Achievements by ascending threshold */
+		TArray<int32> Achievements;
+
+		bool Matches(const FEventContext& Context) const;
+	};
+
+	static constexpr int32 NumEvents = static_cast<int32>(EAchievementEvent::MissionCompleted) + 1;
+
+	/** Counter values and unlock cursor of the active child */
+	struct FChildState
+	{
+		FChildId ChildID;
+		TArray<int32> Values;
+
+		/** Per counter, position in its Achievements of the first one not reached yet */
+		TArray<int32> NextAchievement;
+
+		TBitArray<> Unlocked;
+	};
+
+	void Compile(const USuperfamilyAchievementSet& Set);
+
+	/** Build the active child's state from their profile (catching up unlocks whose thresholds are already met) */
+	FChildState* GetActiveState();
+
+	void ProcessEvent(EAchievementEvent Event, const FEventContext& Context, int32 Amount);
+
+	/** Unlock every achievement of a counter whose threshold its value has reached */
+	void AdvanceCounter(FChildState& State, int32 CounterIndex);
+
+	void HandleLevelRecorded(const FChildId& ChildID, int32 WorldID, int32 LevelID, int32 Stars, int32 PreviousStars);
+	void HandleMissionRecorded(const FChildId& ChildID, const FMissionId& MissionID);
+
+	/** Drop the cached state so it is rebuilt from the profiles that replaced it */
+	void HandleProfilesApplied(const FChildId& ChildID);
+
+	void HandleCoinEvents(TConstArrayView<FCoinCollectedEvent> Events);
+	void HandleQuestionEvents(TConstArrayView<FQuestionAnsweredEvent> Events);
+	void HandleStreakEvents(TConstArrayView<FStreakUpdatedEvent> Events);
+
+	TArray<FCompiledAchievement> Achievements;
+	TArray<FCounter> Counters;
+	TArray<int32> CountersByEvent[NumEvents];
+	TMap<FName, int32> AchievementByID;
+
+	bool bCompiled = false;
+
+	/** Events from before the set was compiled, replayed once it is */
+	struct FPendingEvent
+	{
+		EAchievementEvent Event;
+		FEventContext Context;
+		int32 Amount;
+	};
+	TArray<FPendingEvent> PendingEvents;
+
+	FChildState ActiveState;
+
+	TSharedPtr<FStreamableHandle> SetHandle;
+	FDelegateHandle LevelRecordedHandle;
+	FDelegateHandle MissionRecordedHandle;
+	FDelegateHandle ProfilesAppliedHandle;
+};
@@ -0,0 +1,28 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/AssetManager.h"
+#include "SuperfamilyAssetManager.generated.h"
+
+/**
+ * Assigns cook chunks for on-demand world content
+ * Every catalogued map of a world past the install is given its world's chunk
+ * (USuperfamilyWorldContentSubsystem::GetWorldChunkId), so a chunked cook
+ * produces one pakchunkN per downloadable world. Content shared with the
+ * install stays in chunk 0.
+ */
+UCLASS()
+class SUPERFAMILY_API USuperfamilyAssetManager : public UAssetManager
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UAssetManager Interface
+	virtual void PostInitialAssetScan() override;
+	//~ End UAssetManager Interface
+
+private:
+	void AssignWorldChunks();
+};
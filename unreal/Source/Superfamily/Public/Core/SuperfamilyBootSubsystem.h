@@ -0,0 +1,178 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "SuperfamilyBootSubsystem.generated.h"
+
+class UDataTable;
+struct FStreamableHandle;
+
+/**
+ * Timing of one boot stage, relative to process start
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FBootStageTiming
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Boot")
+	FName Stage;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Boot")
+	float StartMs = 0.0f;
+
+	/** Negative while the stage is still running */
+	UPROPERTY(BlueprintReadOnly, Category = "Boot")
+	float DurationMs = -1.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Boot")
+	bool bSucceeded = false;
+};
+
+/**
+ * Startup pipeline
+ * Boot work is split into named stages with declared dependencies. Every stage
+ * starts as soon as the stages it depends on are done, so independent stages
+ * (save data, question packs, level catalog, bridge handshake) run their async
+ * work side by side. GameReady goes to the RN app once every stage that blocks
+ * it is done, including MainMenu, which the menu completes once it is up. Its
+ * payload carries the per-stage timing breakdown; stages that don't block it
+ * are reported in a StartupTimings message when the whole pipeline is done.
+ *
+ * Owners register their stages while the game instance initializes, and the
+ * game instance starts the pipeline at the end of Init.
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API USuperfamilyBootSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Reports a stage as done; must be called once, on the game thread */
+	using FStageDone = TFunction<void(bool /* bSucceeded */)>;
+
+	/** Starts a stage's work; runs on the game thread, the work itself may continue anywhere */
+	using FStageRunner = TFunction<void(FStageDone&& Done)>;
+
+	// Stages registered by the game
+	static const FName SaveDataStage;
+	static const FName ProfileSyncStage;
+	static const FName LevelCatalogStage;
+	static const FName QuestionsStage;
+	static const FName BridgeStage;
+
+	/** Completed by the main menu game mode once the menu is up, or by whichever game mode the first map has */
+	static const FName MainMenuStage;
+
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	/**
+	 * Register a stage
+	 * A stage without a runner is completed from outside with CompleteStage.
+	 * Dependencies that are never registered are ignored with a warning.
+	 */
+	void AddStage(FName Stage, TArray<FName> Dependencies, FStageRunner Runner, bool bBlocksGameReady = true);
+
+	/** Start every stage whose dependencies are met */
+	void Start();
+
+	/** Finish a stage that has no runner (ignored if it isn't running or waiting) */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Boot")
+	void CompleteStage(FName Stage, bool bSucceeded = true);
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Boot")
+	bool IsStageComplete(FName Stage) const;
+
+	/** Run Callback once Stage is done, immediately if it already is or was never registered */
+	void CallWhenStageComplete(FName Stage, TFunction<void()> Callback);
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Boot")
+	bool IsGameReady() const { return GameReadyMs >= 0.0f; }
+
+	/** Milliseconds from process start to GameReady, negative until then */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Boot")
+	float GetTimeToGameReadyMs() const { return GameReadyMs; }
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Boot")
+	TArray<FBootStageTiming> GetStageTimings() const;
+
+	/** Broadcast right after GameReady is sent */
+	FSimpleMulticastDelegate OnGameReady;
+
+protected:
+	/** Question DataTables handed to the question provider during boot */
+	UPROPERTY(Config)
+	TArray<TSoftObjectPtr<UDataTable>> QuestionPacks;
+
+	/** Longest wait for the platform glue to bind the RN transport */
+	UPROPERTY(Config)
+	float BridgeHandshakeTimeoutSeconds = 5.0f;
+
+	/** Send GameReady after this long even if blocking stages are still running */
+	UPROPERTY(Config)
+	float GameReadyTimeoutSeconds = 20.0f;
+
+private:
+	enum class EStageState : uint8
+	{
+		Waiting,
+		Running,
+		Done
+	};
+
+	struct FStage
+	{
+		FName Name;
+		TArray<FName> Dependencies;
+		FStageRunner Runner;
+		bool bBlocksGameReady = true;
+
+		/** No runner: completed with CompleteStage */
+		bool bExternal = false;
+
+		EStageState State = EStageState::Waiting;
+		bool bSucceeded = false;
+		double StartTime = 0.0;
+		double EndTime = 0.0;
+		TArray<TFunction<void()>> OnComplete;
+	};
+
+	FStage* FindStage(FName Stage);
+	const FStage* FindStage(FName Stage) const;
+
+	/** Start waiting stages whose dependencies are done */
+	void StartReadyStages();
+	void RunStage(int32 Index);
+	void FinishStage(FName Stage, bool bSucceeded);
+
+	/** Send GameReady / StartupTimings once their stages are done */
+	void CheckProgress();
+	void SendGameReady(bool bTimedOut);
+	bool TickGameReadyTimeout(float DeltaTime);
+
+	void LogTimings(const TCHAR* Milestone) const;
+	FString BuildTimingsJSON() const;
+
+	// Built-in stages
+	void RunQuestionsStage(FStageDone&& Done);
+	void RunBridgeStage(FStageDone&& Done);
+
+	TArray<FStage> Stages;
+	bool bStarted = false;
+	bool bAllStagesReported = false;
+
+	/** Process-relative times */
+	double BootStartTime = 0.0;
+	float GameReadyMs = -1.0f;
+
+	TSharedPtr<FStreamableHandle> QuestionPackHandle;
+
+	FTSTicker::FDelegateHandle GameReadyTimeoutHandle;
+	FTSTicker::FDelegateHandle BridgeHandshakeHandle;
+};
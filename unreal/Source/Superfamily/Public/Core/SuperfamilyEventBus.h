@@ -0,0 +1,277 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "Types/SuperfamilyIds.h"
+#include "Types/SuperfamilyTypes.h"
+#include "SuperfamilyEventBus.generated.h"
+
+/**
+ * Gameplay events on the bus; each payload struct names its own with EventType
+ */
+UENUM(BlueprintType)
+enum class ESuperfamilyEvent : uint8
+{
+	CoinCollected,
+	PlayerJumped,
+	QuestionAnswered,
+	StreakUpdated,
+
+	Count UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FCoinCollectedEvent
+{
+	GENERATED_BODY()
+
+	static constexpr ESuperfamilyEvent EventType = ESuperfamilyEvent::CoinCollected;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	int32 Amount = 0;
+
+	/** Coins collected this session, including these */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	int32 SessionTotal = 0;
+};
+
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FPlayerJumpedEvent
+{
+	GENERATED_BODY()
+
+	static constexpr ESuperfamilyEvent EventType = ESuperfamilyEvent::PlayerJumped;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	FVector Location = FVector::ZeroVector;
+};
+
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FQuestionAnsweredEvent
+{
+	GENERATED_BODY()
+
+	static constexpr ESuperfamilyEvent EventType = ESuperfamilyEvent::QuestionAnswered;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	FQuestionId QuestionID;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	EQuestionSubject Subject = EQuestionSubject::Rekenen;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	EDifficultyLevel Difficulty = EDifficultyLevel::Groep1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	bool bCorrect = false;
+
+	/** Seconds from showing the question to the answer */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	float ResponseTime = 0.0f;
+};
+
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FStreakUpdatedEvent
+{
+	GENERATED_BODY()
+
+	static constexpr ESuperfamilyEvent EventType = ESuperfamilyEvent::StreakUpdated;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	int32 CurrentStreak = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Event")
+	int32 MaxStreak = 0;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCoinCollectedEvents, const TArray<FCoinCollectedEvent>&, Events);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPlayerJumpedEvents, const TArray<FPlayerJumpedEvent>&, Events);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnQuestionAnsweredEvents, const TArray<FQuestionAnsweredEvent>&, Events);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStreakUpdatedEvents, const TArray<FStreakUpdatedEvent>&, Events);
+
+/**
+ * Type-erased channel, so the bus can dispatch every event type in one loop
+ */
+class FSuperfamilyEventChannelBase
+{
+public:
+	virtual ~FSuperfamilyEventChannelBase() = default;
+
+	/** Hand the queued events to the subscribers; returns how many there were */
+	virtual int32 Dispatch() = 0;
+
+	virtual void RemoveAll(const void* UserObject) = 0;
+};
+
+/**
+ * One event type's queue and subscribers
+ * Events are appended to a queue and handed to each subscriber as one span on
+ * Dispatch. Events published while dispatching go into the next batch. Both
+ * queues keep their capacity, so a steady event rate doesn't allocate.
+ */
+template<typename TEvent>
+class TSuperfamilyEventChannel final : public FSuperfamilyEventChannelBase
+{
+public:
+	using FSubscribers = TMulticastDelegate<void(TConstArrayView<TEvent>)>;
+
+	void Publish(const TEvent& Event) { Pending.Add(Event); }
+
+	FSubscribers& OnEvents() { return Subscribers; }
+
+	/** Called after the native subscribers with the same batch, for a dynamic delegate */
+	TFunction<void(const TArray<TEvent>&)> BlueprintRelay;
+
+	//~ Begin FSuperfamilyEventChannelBase Interface
+	virtual int32 Dispatch() override
+	{
+		if (Pending.Num() == 0)
+		{
+			return 0;
+		}
+
+		Swap(Pending, Dispatching);
+		Subscribers.Broadcast(Dispatching);
+		if (BlueprintRelay)
+		{
+			BlueprintRelay(Dispatching);
+		}
+
+		const int32 NumDispatched = Dispatching.Num();
+		Dispatching.Reset();
+		return NumDispatched;
+	}
+
+	virtual void RemoveAll(const void* UserObject) override { Subscribers.RemoveAll(UserObject); }
+	//~ End FSuperfamilyEventChannelBase Interface
+
+private:
+	TArray<TEvent> Pending;
+	TArray<TEvent> Dispatching;
+	FSubscribers Subscribers;
+};
+
+/**
+ * Per-frame batched gameplay events
+ * Publishers queue a typed payload, which is a struct append with no
+ * subscriber calls. Once per frame every event type with queued events is
+ * dispatched: each subscriber gets that frame's events of the type as one
+ * contiguous span. A subscriber can total coins or keep the best streak with
+ * one update instead of one per event. Event IDs are compile-time
+ * (TEvent::EventType), so finding a channel is an array index.
+ *
+ * Native code subscribes with Subscribe<TEvent>. Blueprints publish with the
+ * Publish* functions and bind the On*Events delegates, which are only
+ * broadcast when bound. Order is kept within a type, not across types.
+ */
+UCLASS()
+class SUPERFAMILY_API USuperfamilyEventBus : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	// ============================================
+	// Native
+	// ============================================
+
+	/** Queue an event for this frame's dispatch */
+	template<typename TEvent>
+	void Publish(const TEvent& Event)
+	{
+		GetChannel<TEvent>().Publish(Event);
+	}
+
+	/** Receive each frame's events of one type as a span, on frames that have any */
+	template<typename TEvent, typename UserClass>
+	FDelegateHandle Subscribe(UserClass* Object, void (UserClass::*Handler)(TConstArrayView<TEvent>))
+	{
+		return GetChannel<TEvent>().OnEvents().AddUObject(Object, Handler);
+	}
+
+	template<typename TEvent>
+	FDelegateHandle Subscribe(TDelegate<void(TConstArrayView<TEvent>)>&& Delegate)
+	{
+		return GetChannel<TEvent>().OnEvents().Add(MoveTemp(Delegate));
+	}
+
+	template<typename TEvent>
+	void Unsubscribe(FDelegateHandle Handle)
+	{
+		GetChannel<TEvent>().OnEvents().Remove(Handle);
+	}
+
+	/** Remove an object's subscriptions of every event type */
+	void UnsubscribeAll(const void* Object);
+
+	// ============================================
+	// Blueprint
+	// ============================================
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Events")
+	void PublishCoinCollected(const FCoinCollectedEvent& Event) { Publish(Event); }
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Events")
+	void PublishPlayerJumped(const FPlayerJumpedEvent& Event) { Publish(Event); }
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Events")
+	void PublishQuestionAnswered(const FQuestionAnsweredEvent& Event) { Publish(Event); }
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Events")
+	void PublishStreakUpdated(const FStreakUpdatedEvent& Event) { Publish(Event); }
+
+	UPROPERTY(BlueprintAssignable, Category = "Superfamily|Events")
+	FOnCoinCollectedEvents OnCoinCollectedEvents;
+
+	UPROPERTY(BlueprintAssignable, Category = "Superfamily|Events")
+	FOnPlayerJumpedEvents OnPlayerJumpedEvents;
+
+	UPROPERTY(BlueprintAssignable, Category = "Superfamily|Events")
+	FOnQuestionAnsweredEvents OnQuestionAnsweredEvents;
+
+	UPROPERTY(BlueprintAssignable, Category = "Superfamily|Events")
+	FOnStreakUpdatedEvents OnStreakUpdatedEvents;
+
+private:
+	static constexpr int32 NumEvents = static_cast<int32>(ESuperfamilyEvent::Count);
+
+	template<typename TEvent>
+	TSuperfamilyEventChannel<TEvent>& GetChannel()
+	{
+		static_assert(TEvent::EventType < ESuperfamilyEvent::Count, "Event payloads need an EventType below ESuperfamilyEvent::Count");
+
+		// One payload type per EventType, so the cast matches what was created
+		TUniquePtr<FSuperfamilyEventChannelBase>& Channel = Channels[static_cast<int32>(TEvent::EventType)];
+		if (!Channel.IsValid())
+		{
+			Channel = MakeUnique<TSuperfamilyEventChannel<TEvent>>();
+		}
+		return static_cast<TSuperfamilyEventChannel<TEvent>&>(*Channel);
+	}
+
+	/** Broadcast a channel's batches on its dynamic delegate whenever Blueprints have bound it */
+	template<typename TEvent, typename TDynamicDelegate>
+	void RelayToBlueprint(TDynamicDelegate& Delegate)
+	{
+		GetChannel<TEvent>().BlueprintRelay = [&Delegate](const TArray<TEvent>& Events)
+		{
+			if (Delegate.IsBound())
+			{
+				Delegate.Broadcast(Events);
+			}
+		};
+	}
+
+	bool Tick(float DeltaTime);
+
+	TUniquePtr<FSuperfamilyEventChannelBase> Channels[NumEvents];
+
+	FTSTicker::FDelegateHandle TickHandle;
+};
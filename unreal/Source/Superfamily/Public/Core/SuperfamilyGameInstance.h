@@ -4,17 +4,37 @@
 
 #include "CoreMinimal.h"
 #include "Engine/GameInstance.h"
+#include "Containers/Ticker.h"
+#include "Core/MemoryBudgetClient.h"
 #include "Types/SuperfamilyTypes.h"
 #include "SuperfamilyGameInstance.generated.h"
 
 class USuperFamilySaveGame;
+class FProgressCrdt;
+struct FProgressChangeSet;
+
+/**
+ * Profile fields tracked for delta sync with the RN app
+ */
+enum class EProfileSyncField : uint8
+{
+	None        = 0,
+	Coins       = 1 << 0,
+	TotalXP     = 1 << 1
+};
+ENUM_CLASS_FLAGS(EProfileSyncField);
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnProfileMissionRecorded, const FChildId& /* ChildID */, const FMissionId& /* MissionID */);
+DECLARE_MULTICAST_DELEGATE_FiveParams(FOnProfileLevelRecorded, const FChildId& /* ChildID */, int32 /* WorldID */, int32 /* LevelID */, int32 /* Stars */, int32 /* PreviousStars, INDEX_NONE on a first completion */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAudioCultureChanged, const FString& /* Culture */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnProfilesApplied, const FChildId& /* ChildID, unset for every profile */);
 
 /**
  * Central game instance for Superfamily
  * Manages save/load, profiles, settings, and global game state
  */
 UCLASS()
-class SUPERFAMILY_API USuperfamilyGameInstance : public UGameInstance
+class SUPERFAMILY_API USuperfamilyGameInstance : public UGameInstance, public IMemoryBudgetClient
 {
 	GENERATED_BODY()
 
@@ -26,6 +46,11 @@ public:
 	virtual void Shutdown() override;
 	//~ End UGameInstance Interface
 
+	//~ Begin IMemoryBudgetClient Interface
+	virtual FName GetMemoryBudgetName() const override { return TEXT("SaveData"); }
+	virtual int64 GetBudgetedMemoryBytes() const override { return SaveDataBytes; }
+	//~ End IMemoryBudgetClient Interface
+
 	// ============================================
 	// Profile Management
 	// ============================================
@@ -34,9 +59,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Superfamily|Profile")
 	FChildProfile GetActiveProfile() const;
 
+	/** ID of the active child profile, without copying the profile */
+	const FChildId& GetActiveChildID() const { return ActiveChildID; }
+
 	/** Set the active child profile by ID */
 	UFUNCTION(BlueprintCallable, Category = "Superfamily|Profile")
-	bool SetActiveProfile(const FString& ChildID);
+	bool SetActiveProfile(const FChildId& ChildID);
 
 	/** Get all available child profiles */
 	UFUNCTION(BlueprintCallable, Category = "Superfamily|Profile")
@@ -46,6 +74,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Superfamily|Profile")
 	bool CreateProfile(const FString& DisplayName, int32 AgeGroup);
 
+	/** Fired when profiles are replaced rather than played: a save load (every profile) or merged sync progress (one) */
+	FOnProfilesApplied OnProfilesApplied;
+
 	// ============================================
 	// Save/Load System
 	// ============================================
@@ -58,6 +89,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Superfamily|Save")
 	bool LoadGame();
 
+	/** Load the game state with the disk read off the game thread; OnLoaded runs on the game thread */
+	void LoadGameAsync(TFunction<void(bool /* bLoaded */)> OnLoaded);
+
+	/** True while an async load is in flight; saving is refused until it lands */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Save")
+	bool IsLoadingSave() const { return bSaveLoadPending; }
+
 	/** Check if a save file exists */
 	UFUNCTION(BlueprintPure, Category = "Superfamily|Save")
 	bool DoesSaveExist() const;
@@ -70,6 +108,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Superfamily|Progress")
 	void RecordLevelCompletion(int32 WorldID, int32 LevelID, int32 Stars, int32 Score, int32 Coins);
 
+	/** Fired when RecordLevelCompletion records a completion on the active profile */
+	FOnProfileLevelRecorded OnLevelRecorded;
+
 	/** Get progress for a specific level */
 	UFUNCTION(BlueprintPure, Category = "Superfamily|Progress")
 	FLevelProgress GetLevelProgress(int32 WorldID, int32 LevelID) const;
@@ -78,6 +119,30 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Superfamily|Progress")
 	bool IsLevelUnlocked(int32 WorldID, int32 LevelID) const;
 
+	/** Record a completed real-life mission (ignored if already completed) */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Progress")
+	void RecordMissionCompleted(const FMissionId& MissionID);
+
+	/** Fired when RecordMissionCompleted adds a mission to the active profile */
+	FOnProfileMissionRecorded OnMissionRecorded;
+
+	/** Unlock an achievement (ignored if already unlocked) */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Progress")
+	void UnlockAchievement(const FString& AchievementID);
+
+	/** Unlock an achievement from the achievement set by its stable index; returns false if it already was */
+	bool UnlockAchievementByIndex(int32 StableIndex, const FString& AchievementID);
+
+	/** Store an achievement counter on the active profile; written with the next save */
+	void SetAchievementCounter(const FString& CounterKey, int32 Value);
+
+	/** Add an answer to the active profile's subject table; written with the next save */
+	void RecordAnswer(EQuestionSubject Subject, EDifficultyLevel Difficulty, bool bCorrect, float ResponseTime);
+
+	/** Response time (seconds) below which Percentile (0-1) of the active child's answers in a subject fall */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Progress")
+	float GetResponseTimePercentile(EQuestionSubject Subject, float Percentile) const;
+
 	// ============================================
 	// Currency & XP
 	// ============================================
@@ -112,7 +177,25 @@ public:
 
 	/** Set audio culture */
 	UFUNCTION(BlueprintCallable, Category = "Superfamily|Settings")
-	void SetAudioCulture(const FString& Culture) { AudioCulture = Culture; }
+	void SetAudioCulture(const FString& Culture);
+
+	/** Fired when SetAudioCulture changes the culture */
+	FOnAudioCultureChanged OnAudioCultureChanged;
+
+	// ============================================
+	// Profile Sync (RN bridge)
+	// ============================================
+
+	/** Send pending profile deltas now instead of at the end of the frame */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Sync")
+	void FlushProfileDeltas();
+
+	/** Send a full profile snapshot and reset its delta state */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Sync")
+	void SendProfileSnapshot(const FChildId& ChildID);
+
+	/** Apply progress merged from other devices to a profile and save */
+	void ApplySyncedProgress(const FChildId& ChildID, const FProgressCrdt& Progress, const FProgressChangeSet& Changes);
 
 protected:
 	/** Current save game data */
@@ -121,7 +204,7 @@ protected:
 
 	/** Currently active child profile ID */
 	UPROPERTY()
-	FString ActiveChildID;
+	FChildId ActiveChildID;
 
 	/** Current audio culture for voice-overs */
 	UPROPERTY()
@@ -130,7 +213,65 @@ protected:
 	/** Save slot name */
 	static const FString SaveSlotName;
 
+	/** Serialized size of the save at the last load or save */
+	int64 SaveDataBytes = 0;
+
+	/** Async load in flight; a save now would overwrite the data being loaded */
+	bool bSaveLoadPending = false;
+
+	/** Bumped by every load, so an async load finishing after a newer one is dropped */
+	uint32 SaveLoadSerial = 0;
+
 private:
-	/** Helper to get level key string */
-	static FString GetLevelKey(int32 WorldID, int32 LevelID);
+	/** Adopt what LoadGame/LoadGameAsync loaded; LoadedGame is null if reading an existing save failed */
+	bool ApplyLoadedSave(bool bSaveExists, USaveGame* LoadedGame);
+
+	/** Tell RN which pre-GUID child ID strings now load as which IDs */
+	void SendChildIdMigrations(const TMap<FString, FChildId>& LegacyChildIDs);
+
+	/** Changes to a profile not yet sent to RN */
+	struct FProfileSyncState
+	{
+		EProfileSyncField DirtyFields = EProfileSyncField::None;
+		TSet<FLevelKey> DirtyLevels;
+		TArray<FMissionId> NewMissions;
+		TArray<FString> NewAchievements;
+
+		/** Sequence number of the last delta or snapshot sent for this profile */
+		int32 Sequence = 0;
+
+		bool HasChanges() const
+		{
+			return DirtyFields != EProfileSyncField::None || DirtyLevels.Num() > 0 || NewMissions.Num() > 0 || NewAchievements.Num() > 0;
+		}
+
+		void ClearChanges()
+		{
+			DirtyFields = EProfileSyncField::None;
+			DirtyLevels.Reset();
+			NewMissions.Reset();
+			NewAchievements.Reset();
+		}
+	};
+
+	/** Mark profile fields dirty and schedule an end-of-frame flush */
+	FProfileSyncState& MarkProfileDirty(const FChildId& ChildID, EProfileSyncField Fields = EProfileSyncField::None);
+
+	/** Build the JSON delta for a profile; returns false if nothing changed */
+	bool BuildProfileDelta(const FChildProfile& Profile, FProfileSyncState& State, FString& OutJSON) const;
+
+	/** Find a profile by ID in the current save */
+	FChildProfile* FindProfile(const FChildId& ChildID);
+
+	UFUNCTION()
+	void HandleProfileSnapshotRequested(const FString& ChildID);
+
+	/** Per-profile delta state keyed by ChildID */
+	TMap<FChildId, FProfileSyncState> ProfileSyncStates;
+
+	/** Identifies this game session; RN drops its sequence tracking when it changes */
+	FGuid SyncEpoch;
+
+	/** Pending end-of-frame delta flush */
+	FTSTicker::FDelegateHandle DeltaFlushHandle;
 };
@@ -4,8 +4,16 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "Core/SuperfamilyLevelCatalog.h"
+#include "Gameplay/BossEncounterPreloader.h"
+#include "Gameplay/SuperfamilyActorPool.h"
+#include "Gameplay/SuperfamilyLevelStreamingSubsystem.h"
+#include "Gameplay/SuperfamilyTickManager.h"
 #include "SuperfamilyGameModeBase.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnBossEncounterStarted);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLevelEnded, bool, bCompleted);
+
 /**
  * Base game mode for all Superfamily game modes
  * Provides common functionality for menu, world map, and level game modes
@@ -32,6 +40,10 @@ class SUPERFAMILY_API ASuperfamilyMainMenuGameMode : public ASuperfamilyGameMode
 
 public:
 	ASuperfamilyMainMenuGameMode();
+
+protected:
+	/** Completes the MainMenu boot stage, the last thing GameReady waits for */
+	virtual void BeginPlay() override;
 };
 
 /**
@@ -65,6 +77,10 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "Level")
 	int32 LevelID = 1;
 
+	/** Catalog entry of this level, if the map is catalogued */
+	UFUNCTION(BlueprintCallable, Category = "Level")
+	bool GetCatalogEntry(FLevelCatalogEntry& OutEntry) const;
+
 	/** Called when player completes the level */
 	UFUNCTION(BlueprintCallable, Category = "Level")
 	void OnLevelCompleted(int32 Stars, int32 Score);
@@ -73,8 +89,48 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Level")
 	void OnLevelFailed();
 
+	/** Coins picked up and available across every collectible field in the level */
+	UFUNCTION(BlueprintCallable, Category = "Level")
+	void GetLevelCoinCounts(int32& Collected, int32& Total) const;
+
+	/** Fired by OnLevelCompleted and OnLevelFailed */
+	UPROPERTY(BlueprintAssignable, Category = "Level")
+	FOnLevelEnded OnLevelEnded;
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Throttle ticks of off-screen level actors */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Performance")
+	bool bManageActorTicks = true;
+
+	/** Tick budget settings for this level */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Performance", meta = (EditCondition = "bManageActorTicks"))
+	FTickBudgetSettings TickBudget;
+
+	/** Stream the level in chunks along X instead of keeping the whole map resident */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Performance")
+	bool bStreamLevelChunks = false;
+
+	/** Chunk layout and streaming budget for this level */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Performance", meta = (EditCondition = "bStreamLevelChunks"))
+	FLevelStreamingSettings Streaming;
+
+	/** Transient actors (effects, projectiles, pickups) to pre-warm at BeginPlay */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Performance")
+	TArray<FActorPoolConfig> ActorPools;
+
+	/** The next level is a boss: start preparing its questions during the results screen.
+	  * Catalogued levels do this automatically when they start. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Boss")
+	bool bPrepareNextBoss = false;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Boss", meta = (EditCondition = "bPrepareNextBoss"))
+	FBossEncounterRequest NextBossEncounter;
+
+	/** Catalog entry resolved at BeginPlay */
+	TOptional<FLevelCatalogEntry> CatalogEntry;
 };
 
 /**
@@ -95,4 +151,47 @@ public:
 	/** Current question index */
 	UPROPERTY(BlueprintReadOnly, Category = "Boss")
 	int32 CurrentQuestionIndex = 0;
+
+	/** Subject the boss asks about */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Boss")
+	EQuestionSubject BossSubject = EQuestionSubject::Rekenen;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Boss")
+	EDifficultyLevel BossDifficulty = EDifficultyLevel::Groep1;
+
+	/** Start the fight anyway if preparation takes longer than this (seconds) */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Boss")
+	float MaxLoadGateSeconds = 10.0f;
+
+	/** True once questions and their assets are ready and the fight has begun */
+	UFUNCTION(BlueprintPure, Category = "Boss")
+	bool IsEncounterStarted() const { return bEncounterStarted; }
+
+	/** Question at CurrentQuestionIndex, from the preloaded set */
+	UFUNCTION(BlueprintCallable, Category = "Boss")
+	bool GetCurrentQuestion(FQuestionData& OutQuestion) const;
+
+	/** Move to the next question; returns false after the last one */
+	UFUNCTION(BlueprintCallable, Category = "Boss")
+	bool AdvanceQuestion();
+
+	/** Fired when the load gate opens */
+	UPROPERTY(BlueprintAssignable, Category = "Boss")
+	FOnBossEncounterStarted OnEncounterStarted;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	FBossEncounterRequest MakeEncounterRequest() const;
+
+private:
+	UFUNCTION()
+	void HandleEncounterPrepared();
+
+	void StartEncounter();
+
+	FTimerHandle LoadGateTimer;
+	double LoadGateStartTime = 0.0;
+	bool bEncounterStarted = false;
 };
@@ -0,0 +1,95 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Types/SuperfamilyTypes.h"
+#include "SuperfamilyLevelCatalog.generated.h"
+
+/**
+ * One playable level in the catalog
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FLevelCatalogEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level")
+	int32 WorldID = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level")
+	int32 LevelID = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level")
+	TSoftObjectPtr<UWorld> Map;
+
+	/** Played with ASuperfamilyBossGameMode */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level")
+	bool bIsBoss = false;
+
+	/** Subject of the level's questions */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level")
+	EQuestionSubject Subject = EQuestionSubject::Rekenen;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level")
+	EDifficultyLevel Difficulty = EDifficultyLevel::Groep1;
+
+	/** Questions asked by the boss (boss levels only) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level", meta = (EditCondition = "bIsBoss"))
+	int32 BossQuestionCount = 5;
+
+	/** Content the level needs right away, prefetched together with the map (question art, VO banks) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level")
+	TArray<FSoftObjectPath> RequiredContent;
+};
+
+/**
+ * Every level in play order, mapping world/level IDs to map packages
+ * Map entries are rebuilt from the maps under MapsDirectory whenever the asset
+ * is cooked, so a newly added L_W##_Level## map can't be missing from a build.
+ * Authored fields (subject, difficulty, content) survive a rebuild.
+ */
+UCLASS(BlueprintType)
+class SUPERFAMILY_API USuperfamilyLevelCatalog : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	//~ Begin UObject Interface
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
+	//~ End UObject Interface
+
+	//~ Begin UPrimaryDataAsset Interface
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+	//~ End UPrimaryDataAsset Interface
+
+	const FLevelCatalogEntry* FindEntry(int32 WorldID, int32 LevelID) const;
+
+	/** Entry whose map is the given package (PIE prefixes are ignored) */
+	const FLevelCatalogEntry* FindEntryByPackage(const FString& PackageName) const;
+
+	/** The level played after Entry, or null after the last one */
+	const FLevelCatalogEntry* GetNextEntry(const FLevelCatalogEntry& Entry) const;
+
+	const TArray<FLevelCatalogEntry>& GetEntries() const { return Entries; }
+
+#if WITH_EDITOR
+	/** Sync map entries with the maps on disk and sort them in play order */
+	UFUNCTION(CallInEditor, Category = "Catalog")
+	void RebuildFromMaps();
+#endif
+
+protected:
+	/** Content directory scanned for L_W##_Level## maps */
+	UPROPERTY(EditAnywhere, Category = "Catalog", meta = (ContentDir))
+	FDirectoryPath MapsDirectory;
+
+	/** Sorted by WorldID, then LevelID */
+	UPROPERTY(EditAnywhere, Category = "Catalog")
+	TArray<FLevelCatalogEntry> Entries;
+};
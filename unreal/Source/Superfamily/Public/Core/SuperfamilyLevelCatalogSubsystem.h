@@ -0,0 +1,107 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Core/MemoryBudgetClient.h"
+#include "Core/SuperfamilyLevelCatalog.h"
+#include "Gameplay/BossEncounterPreloader.h"
+#include "UObject/UObjectGlobals.h"
+#include "SuperfamilyLevelCatalogSubsystem.generated.h"
+
+struct FStreamableHandle;
+
+/**
+ * Runtime access to the level catalog
+ * Answers "which level is this / which comes next" and, while a level is
+ * played, prefetches the next level's map package and content in the
+ * background so the level-to-level transition finds them already in memory.
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API USuperfamilyLevelCatalogSubsystem : public UGameInstanceSubsystem, public IMemoryBudgetClient
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	//~ Begin IMemoryBudgetClient Interface
+	virtual FName GetMemoryBudgetName() const override { return TEXT("LevelPrefetch"); }
+	virtual int64 GetBudgetedMemoryBytes() const override;
+	virtual int64 TrimMemory(int64 BytesToFree) override;
+	//~ End IMemoryBudgetClient Interface
+
+	/** Loaded during boot; waits for the load if a map asks before it has landed */
+	const USuperfamilyLevelCatalog* GetCatalog() const;
+
+	/** Catalog entry for a loaded world, or null if it isn't catalogued */
+	const FLevelCatalogEntry* FindEntryForWorld(const UWorld* World) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Levels")
+	bool FindLevel(int32 WorldID, int32 LevelID, FLevelCatalogEntry& OutEntry) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Levels")
+	bool GetNextLevel(int32 WorldID, int32 LevelID, FLevelCatalogEntry& OutEntry) const;
+
+	/** Travel to a catalogued level, once its world's content is downloaded */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Levels")
+	bool OpenLevel(int32 WorldID, int32 LevelID);
+
+	/** Start loading the level after Current (map, required content, boss questions) */
+	void PrefetchNextLevel(const FLevelCatalogEntry& Current);
+
+	/** Boss preload request matching a catalogued boss level */
+	static FBossEncounterRequest MakeBossRequest(const FLevelCatalogEntry& Entry);
+
+protected:
+	/** Catalog asset; falls back to the first LevelCatalog primary asset when unset */
+	UPROPERTY(Config)
+	TSoftObjectPtr<USuperfamilyLevelCatalog> LevelCatalog;
+
+	/** Keep the next map resident while playing; trades memory for near-instant transitions */
+	UPROPERTY(Config)
+	bool bPrefetchNextMap = true;
+
+private:
+	/** Load the catalog asset in the background; OnLoaded runs on the game thread */
+	void LoadCatalogAsync(TFunction<void(bool /* bLoaded */)> OnLoaded);
+
+	void HandleMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+	void HandlePreLoadMap(const FString& MapName);
+	void HandlePostLoadMap(UWorld* LoadedWorld);
+	void ReleasePrefetch();
+
+	UPROPERTY()
+	TObjectPtr<USuperfamilyLevelCatalog> Catalog;
+
+	TSharedPtr<FStreamableHandle> CatalogHandle;
+
+	/** Prefetched map, held until the next map load starts */
+	UPROPERTY()
+	TObjectPtr<UPackage> PrefetchedPackage;
+
+	UPROPERTY()
+	TObjectPtr<UWorld> PrefetchedWorld;
+
+	/** Prefetched map of the map load in progress, held from PreLoadMap until PostLoadMap */
+	UPROPERTY()
+	TObjectPtr<UPackage> TravelPackage;
+
+	UPROPERTY()
+	TObjectPtr<UWorld> TravelWorld;
+
+	TSharedPtr<FStreamableHandle> PrefetchedContent;
+
+	/** Content prefetched for the level now being played, held until the next map load starts */
+	TSharedPtr<FStreamableHandle> CurrentLevelContent;
+
+	FName PrefetchingPackageName;
+	double PrefetchStartTime = 0.0;
+
+	FDelegateHandle PreLoadMapHandle;
+	FDelegateHandle PostLoadMapHandle;
+};
@@ -0,0 +1,99 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "Stats/Stats.h"
+#include "SuperfamilyMemoryMonitor.generated.h"
+
+class IMemoryBudgetClient;
+
+/**
+ * Usage of one memory budget at the last check
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FMemoryBudgetUsage
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	FName Budget;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int64 UsedBytes = 0;
+
+	/** 0 = no budget configured */
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+	int64 BudgetBytes = 0;
+};
+
+/**
+ * Keeps per-subsystem memory within configured budgets
+ * Every CheckIntervalSeconds it sums what each IMemoryBudgetClient (and the
+ * RN bridge queues) hold per budget, publishes the totals as "Budget <Name>"
+ * memory stats and csvprofile values, and when a budget is exceeded warns and
+ * asks that budget's clients to trim. When the OS reports memory pressure
+ * (Android onTrimMemory) or free memory drops below LowMemoryAvailableMB,
+ * every client trims all it can.
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API USuperfamilyMemoryMonitor : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	/** Measure and enforce budgets now */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Memory")
+	void CheckBudgets();
+
+	/** Ask every client to drop all the memory it can */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Memory")
+	void TrimAll();
+
+	/** Usage per budget as of the last check */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Memory")
+	TArray<FMemoryBudgetUsage> GetUsage() const { return Usage; }
+
+	/** Budget name of the RN bridge's queued messages */
+	static const FName BridgeBudgetName;
+
+protected:
+	/** Budget per client budget name, in MB */
+	UPROPERTY(Config)
+	TMap<FName, int32> BudgetsMB;
+
+	UPROPERTY(Config)
+	float CheckIntervalSeconds = 2.0f;
+
+	/** Trim everything when the platform reports less free memory than this (0 = off) */
+	UPROPERTY(Config)
+	int32 LowMemoryAvailableMB = 0;
+
+private:
+	bool Tick(float DeltaTime);
+	void HandlePlatformMemoryTrim();
+
+	void GatherClients(TArray<IMemoryBudgetClient*>& OutClients) const;
+	int64 GetBridgeQueuedBytes() const;
+	void PublishUsage(const FMemoryBudgetUsage& BudgetUsage);
+
+	TArray<FMemoryBudgetUsage> Usage;
+
+	/** Budgets currently over; warned about once per excursion */
+	TSet<FName> OverBudget;
+
+#if STATS
+	TMap<FName, TStatId> BudgetStats;
+#endif
+
+	FTSTicker::FDelegateHandle TickerHandle;
+	FDelegateHandle MemoryTrimHandle;
+	bool bLowMemoryTrimmed = false;
+};
@@ -0,0 +1,294 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Types/SuperfamilyIds.h"
+
+class FJsonObject;
+
+/**
+ * Profile counters kept as per-device CRDT counters
+ */
+enum class EProgressCounter : uint8
+{
+	Coins,
+	XP,
+
+	Num
+};
+
+/**
+ * A device and that device's version at which a CRDT element last changed
+ */
+struct FProgressDot
+{
+	FGuid Device;
+	uint32 Version = 0;
+
+	bool operator==(const FProgressDot& Other) const { return Version == Other.Version && Device == Other.Device; }
+	bool operator!=(const FProgressDot& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Highest version seen from every device
+ */
+struct SUPERFAMILY_API FProgressVersionVector
+{
+	TMap<FGuid, uint32> Versions;
+
+	uint32 Get(const FGuid& Device) const
+	{
+		const uint32* Version = Versions.Find(Device);
+		return Version ? *Version : 0;
+	}
+
+	bool Includes(const FProgressDot& Dot) const { return Dot.Version <= Get(Dot.Device); }
+
+	void Add(const FProgressDot& Dot);
+	void Merge(const FProgressVersionVector& Other);
+
+	TSharedRef<FJsonObject> ToJson() const;
+	static FProgressVersionVector FromJson(const FJsonObject& Object);
+
+	friend SUPERFAMILY_API FArchive& operator<<(FArchive& Ar, FProgressVersionVector& Vector);
+};
+
+/**
+ * Best result on a level; every field only grows, so two bests join by max
+ */
+struct FProgressLevelBest
+{
+	bool bCompleted = false;
+	int32 Stars = 0;
+	int32 HighScore = 0;
+	int32 Coins = 0;
+
+	/** True if every field is at least Other's */
+	bool Covers(const FProgressLevelBest& Other) const
+	{
+		return (bCompleted || !Other.bCompleted) && Stars >= Other.Stars && HighScore >= Other.HighScore && Coins >= Other.Coins;
+	}
+
+	void Join(const FProgressLevelBest& Other)
+	{
+		bCompleted |= Other.bCompleted;
+		Stars = FMath::Max(Stars, Other.Stars);
+		HighScore = FMath::Max(HighScore, Other.HighScore);
+		Coins = FMath::Max(Coins, Other.Coins);
+	}
+};
+
+/**
+ * What a merge changed, to apply to the profile
+ */
+struct FProgressChangeSet
+{
+	bool bCounterChanged[static_cast<int32>(EProgressCounter::Num)] = {};
+	TArray<FLevelKey> Levels;
+	TArray<FMissionId> Missions;
+	TArray<FString> Achievements;
+
+	bool IsEmpty() const
+	{
+		for (bool bChanged : bCounterChanged)
+		{
+			if (bChanged)
+			{
+				return false;
+			}
+		}
+		return Levels.Num() == 0 && Missions.Num() == 0 && Achievements.Num() == 0;
+	}
+};
+
+/**
+ * Progress of one child, replicated across devices without conflicts
+ *
+ * Counters are per-device: each device only grows its own added/removed pair
+ * and the value is the sum over devices, so two devices earning coins at the
+ * same time both keep them. Level bests are max-registers; completed missions
+ * and achievements are grow-only sets. Merging is a join, so deltas can be
+ * applied in any order and more than once.
+ *
+ * Every element carries the dot of its last change. A peer that has seen
+ * version vector V is missing exactly the elements whose dot V doesn't
+ * include; each device's dots are kept in a sorted log, so building that
+ * delta visits only those elements (plus log entries of elements that
+ * changed again since, which are compacted away).
+ */
+class SUPERFAMILY_API FProgressCrdt
+{
+public:
+	FProgressCrdt() = default;
+	explicit FProgressCrdt(const FGuid& InLocalDevice) : LocalDevice(InLocalDevice) {}
+
+	// ============================================
+	// Local Changes
+	// ============================================
+
+	/** Add to (positive) or take from (negative) a counter on this device */
+	void AddToCounter(EProgressCounter Counter, int64 Amount);
+
+	/**
+	 * Raise the shared baseline of a counter to at least Value
+	 * Used for totals earned before sync existed: every device seeds the same
+	 * baseline entry, which joins by max instead of adding up.
+	 */
+	void RaiseCounterBaseline(EProgressCounter Counter, int64 Value);
+
+	/** Raise the shared baseline just enough that the counter totals at least Value */
+	void RaiseCounterTotal(EProgressCounter Counter, int64 Value);
+
+	/** Join a level result into the level's best; returns false if it didn't improve anything */
+	bool RecordLevel(const FLevelKey& Level, const FProgressLevelBest& Result);
+
+	/** Returns false if the mission was already in the set */
+	bool AddMission(const FMissionId& MissionID);
+
+	/** Returns false if the achievement was already in the set */
+	bool AddAchievement(const FString& AchievementID);
+
+	// ============================================
+	// State
+	// ============================================
+
+	int64 GetCounter(EProgressCounter Counter) const { return CounterTotals[static_cast<int32>(Counter)]; }
+
+	const FProgressLevelBest* FindLevel(const FLevelKey& Level) const;
+
+	bool HasMission(const FMissionId& MissionID) const { return MissionSlots.Contains(MissionID); }
+
+	bool HasAchievement(const FString& AchievementID) const { return AchievementSlots.Contains(AchievementID); }
+
+	const FProgressVersionVector& GetVersionVector() const { return Seen; }
+
+	const FGuid& GetLocalDevice() const { return LocalDevice; }
+
+	// ============================================
+	// Sync
+	// ============================================
+
+	/** True if a peer that has seen Since is missing something */
+	bool HasChangesSince(const FProgressVersionVector& Since) const;
+
+	/**
+	 * Everything a peer that has seen Since is missing, with this side's version vector:
+	 * { "vv": {...}, "counters": [...], "levels": [...], "missions": [...], "achievements": [...] }
+	 */
+	TSharedRef<FJsonObject> BuildDelta(const FProgressVersionVector& Since) const;
+
+	/** Merge a peer's delta; O(elements in the delta). Returns false if it is malformed */
+	bool MergeDelta(const FJsonObject& Delta, FProgressChangeSet& OutChanges);
+
+	void Serialize(FArchive& Ar);
+
+private:
+	enum class EElementKind : uint8
+	{
+		Counter,
+		Level,
+		Mission,
+		Achievement
+	};
+
+	struct FCounterEntry
+	{
+		EProgressCounter Counter = EProgressCounter::Coins;
+
+		/** Device that owns the entry; invalid for the shared baseline */
+		FGuid Owner;
+
+		int64 Added = 0;
+		int64 Removed = 0;
+		FProgressDot Dot;
+	};
+
+	struct FLevelEntry
+	{
+		FLevelKey Level;
+		FProgressLevelBest Best;
+		FProgressDot Dot;
+	};
+
+	struct FMissionEntry
+	{
+		FMissionId MissionID;
+		FProgressDot Dot;
+	};
+
+	struct FAchievementEntry
+	{
+		FString AchievementID;
+		FProgressDot Dot;
+	};
+
+	/** One change of an element, in its origin device's log */
+	struct FLogEntry
+	{
+		uint32 Version = 0;
+		EElementKind Kind = EElementKind::Counter;
+		int32 Slot = INDEX_NONE;
+	};
+
+	FProgressDot NextLocalDot() const { return FProgressDot{ LocalDevice, Seen.Get(LocalDevice) + 1 }; }
+
+	const FProgressDot& GetDot(EElementKind Kind, int32 Slot) const;
+	FProgressDot& GetDot(EElementKind Kind, int32 Slot);
+
+	/** Give an element a new dot and log it */
+	void Stamp(EElementKind Kind, int32 Slot, const FProgressDot& Dot);
+
+	int32 FindOrAddCounterEntry(EProgressCounter Counter, const FGuid& Owner);
+
+	/** Join a counter entry; a result equal to neither side gets a local dot */
+	void MergeCounter(EProgressCounter Counter, const FGuid& Owner, int64 Added, int64 Removed, const FProgressDot& Dot, FProgressChangeSet& OutChanges);
+	void MergeLevel(const FLevelKey& Level, const FProgressLevelBest& Best, const FProgressDot& Dot, FProgressChangeSet& OutChanges);
+
+	/** Rebuild the logs without superseded entries */
+	void CompactLogs();
+
+	FGuid LocalDevice;
+	FProgressVersionVector Seen;
+
+	TArray<FCounterEntry> CounterEntries;
+	TMap<FGuid, int32> CounterSlots[static_cast<int32>(EProgressCounter::Num)];
+	int64 CounterTotals[static_cast<int32>(EProgressCounter::Num)] = {};
+
+	TArray<FLevelEntry> LevelEntries;
+	TMap<FLevelKey, int32> LevelSlots;
+
+	TArray<FMissionEntry> MissionEntries;
+	TMap<FMissionId, int32> MissionSlots;
+
+	TArray<FAchievementEntry> AchievementEntries;
+	TMap<FString, int32> AchievementSlots;
+
+	/** Changes per origin device, sorted by version */
+	TMap<FGuid, TArray<FLogEntry>> Logs;
+
+	/** Log entries whose element has a newer dot */
+	int32 StaleLogEntries = 0;
+};
+
+/**
+ * Stand-in for the backend's sync endpoint
+ * Keeps one replica per child and answers an exchange the way the server
+ * does: merge the device's delta, reply with what the device is missing.
+ * Used by the sf.Sync.Simulate console command and for running the game
+ * against a local server (-SFSyncLoopback).
+ */
+class SUPERFAMILY_API FProgressSyncLoopbackServer
+{
+public:
+	FProgressSyncLoopbackServer() : ServerDevice(FGuid::NewGuid()) {}
+
+	/** Merge a device's delta and return what the device is missing (judged by the delta's version vector) */
+	TSharedRef<FJsonObject> Exchange(const FChildId& ChildID, const FJsonObject& DeviceDelta);
+
+	const FProgressCrdt* FindReplica(const FChildId& ChildID) const { return Replicas.Find(ChildID); }
+
+private:
+	FGuid ServerDevice;
+	TMap<FChildId, FProgressCrdt> Replicas;
+};
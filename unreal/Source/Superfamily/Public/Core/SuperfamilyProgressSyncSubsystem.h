@@ -0,0 +1,129 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "Core/SuperfamilyProgressCrdt.h"
+#include "Types/SuperfamilyTypes.h"
+#include "SuperfamilyProgressSyncSubsystem.generated.h"
+
+struct FRNUEMessage;
+
+/**
+ * Multi-device progress sync
+ * Keeps a FProgressCrdt replica per child next to the save and exchanges
+ * deltas with the backend through RN: the game sends what the server hasn't
+ * acknowledged yet (ProgressSyncDelta), RN posts it and hands back the
+ * server's reply with what this device is missing (ProgressSyncReceived),
+ * which is merged and applied to the profile. Coins, XP, level bests,
+ * completed missions and achievements earned on another device are added to
+ * this one's instead of being overwritten by whichever device synced last.
+ *
+ * The replicas live in Saved/Sync/Progress.bin, written with every save, so
+ * this device's ID and counters outlive the session. Profiles from before
+ * sync, or whose replica was lost with the file, are seeded on first use.
+ * Their coin and XP totals wait for the server's reply and only the part its
+ * counters don't already cover becomes the shared baseline, so totals synced
+ * before aren't counted twice.
+ *
+ * -SFSyncLoopback exchanges with an in-process FProgressSyncLoopbackServer
+ * instead of RN (non-shipping builds).
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API USuperfamilyProgressSyncSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Boot stage that exchanges with the server once the save and bridge are up */
+	static const FName BootStage;
+
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	// ============================================
+	// Local Changes (call before changing the profile)
+	// ============================================
+
+	void RecordCounter(const FChildProfile& Profile, EProgressCounter Counter, int64 Amount);
+	void RecordLevel(const FChildProfile& Profile, const FLevelKey& Level, const FProgressLevelBest& Result);
+	void RecordMission(const FChildProfile& Profile, const FMissionId& MissionID);
+	void RecordAchievement(const FChildProfile& Profile, const FString& AchievementID);
+
+	// ============================================
+	// Sync
+	// ============================================
+
+	/** Exchange with the server for every known child now */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Sync")
+	void SyncNow();
+
+	/** Write the replicas to disk; called with every game save */
+	bool SaveState();
+
+	const FGuid& GetDeviceID() const { return DeviceID; }
+
+	const FProgressCrdt* FindProgress(const FChildId& ChildID) const;
+
+protected:
+	/** Seconds a local change waits before it is sent, so bursts go out together */
+	UPROPERTY(Config)
+	float PushDelaySeconds = 2.0f;
+
+	/** Seconds between exchanges that only pick up other devices' changes */
+	UPROPERTY(Config)
+	float PollIntervalSeconds = 60.0f;
+
+private:
+	struct FChildReplica
+	{
+		FProgressCrdt Progress;
+
+		/** Version vector the server last reported; deltas start from here */
+		FProgressVersionVector Acked;
+
+		/** Local changes since the last exchange */
+		bool bHasLocalChanges = false;
+
+		/** Seeded without counters; the profile's totals are raised to once the server's reply is merged */
+		bool bAwaitingBaseline = false;
+	};
+
+	/** Replica of a child, seeded from the profile if this is the first time */
+	FChildReplica& FindOrSeedReplica(const FChildProfile& Profile);
+
+	/** Local change made; sent after PushDelaySeconds, written to disk with the next save */
+	void MarkChanged(FChildReplica& Replica);
+
+	bool TickSync(float DeltaTime);
+
+	void SendExchange(const FChildId& ChildID, FChildReplica& Replica);
+
+	/** Merge the server's reply and apply what changed to the profile */
+	void ApplyServerDelta(const FChildId& ChildID, const FJsonObject& Delta);
+
+	UFUNCTION()
+	void HandleBridgeMessage(const FRNUEMessage& Message);
+
+	void LoadState();
+
+	/** Stable ID of this install */
+	FGuid DeviceID;
+
+	TMap<FChildId, FChildReplica> Replicas;
+
+	FString StatePath;
+	bool bStateDirty = false;
+
+	double NextPushTime = 0.0;
+	double NextPollTime = 0.0;
+
+	FTSTicker::FDelegateHandle TickHandle;
+
+	/** Set with -SFSyncLoopback; exchanges go here instead of to RN */
+	TUniquePtr<FProgressSyncLoopbackServer> LoopbackServer;
+};
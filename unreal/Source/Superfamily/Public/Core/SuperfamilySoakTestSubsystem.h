@@ -0,0 +1,127 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "SuperfamilySoakTestSubsystem.generated.h"
+
+/**
+ * Outcome and measurements of one level play-through
+ */
+struct FSoakRunResult
+{
+	int32 Iteration = 0;
+	int32 WorldID = 0;
+	int32 LevelID = 0;
+
+	/** Completed, Failed or TimedOut */
+	FString Result;
+
+	float LoadSeconds = 0.0f;
+	float PlaySeconds = 0.0f;
+	int32 Frames = 0;
+
+	float GameThreadAverageMs = 0.0f;
+	float GameThreadP95Ms = 0.0f;
+	float GameThreadMaxMs = 0.0f;
+
+	int32 GCCount = 0;
+	float GCTotalMs = 0.0f;
+	float GCMaxMs = 0.0f;
+
+	/** Used memory right after the map load and its garbage collection */
+	float PostLoadMemoryMB = 0.0f;
+	float MemoryHighWaterMB = 0.0f;
+
+	/** PostLoadMemoryMB minus that of the level's first iteration */
+	float LeakGrowthMB = 0.0f;
+};
+
+/**
+ * Soak test: plays every catalogued level N times with ASuperfamilyAutoplayBot
+ * and writes one CSV row per play-through (game-thread time, GC pauses, memory
+ * high-water mark, and post-load memory growth across iterations, which is
+ * what a leak looks like). Exits when done, non-zero if any run failed.
+ *
+ * Runs in a packaged or -game build instead of a commandlet, because
+ * commandlets don't tick game worlds:
+ *   Superfamily -game -nullrhi -unattended -nosound -SFSoak=<Iterations> [-SFSoakWorld=<WorldID>]
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API USuperfamilySoakTestSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+protected:
+	/** Give up on a level that hasn't ended after this long (covers a bot-less hang) */
+	UPROPERTY(Config)
+	float RunTimeoutSeconds = 600.0f;
+
+	/** Frames between used-memory samples; sampling reads OS counters */
+	UPROPERTY(Config)
+	int32 MemorySampleInterval = 30;
+
+private:
+	enum class ESoakState : uint8
+	{
+		Idle,
+		Loading,
+		Playing,
+		Ended
+	};
+
+	struct FSoakLevel
+	{
+		int32 WorldID = 0;
+		int32 LevelID = 0;
+		TSoftObjectPtr<UWorld> Map;
+	};
+
+	/** Build the level list and start playing once the catalog has loaded */
+	void StartSoak();
+
+	bool Tick(float DeltaTime);
+	void OpenNextLevel();
+	void FinishRun(const TCHAR* Result);
+	void WriteReport();
+
+	void HandlePostLoadMap(UWorld* LoadedWorld);
+	void HandleBeginFrame();
+	void HandleEndFrame();
+	void HandlePreGarbageCollect();
+	void HandlePostGarbageCollect();
+
+	UFUNCTION()
+	void HandleLevelEnded(bool bCompleted);
+
+	TArray<FSoakLevel> Levels;
+	TArray<FSoakRunResult> Results;
+	int32 Iterations = 1;
+	int32 RunIndex = INDEX_NONE;
+
+	ESoakState State = ESoakState::Idle;
+	FSoakRunResult Current;
+	TArray<float> GameThreadFrameMs;
+	double StateStartTime = 0.0;
+	double FrameStartTime = 0.0;
+	double GCStartTime = 0.0;
+
+	/** Post-load memory of each level's first iteration, keyed by index into Levels */
+	TArray<float> BaselineMemoryMB;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+	FDelegateHandle PostLoadMapHandle;
+	FDelegateHandle BeginFrameHandle;
+	FDelegateHandle EndFrameHandle;
+	FDelegateHandle PreGCHandle;
+	FDelegateHandle PostGCHandle;
+};
@@ -0,0 +1,48 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+/**
+ * Project stats, shown with "stat Superfamily"
+ * RNUEBridge sits below this module and repeats the group declaration privately,
+ * so its counters appear in the same group.
+ */
+DECLARE_STATS_GROUP(TEXT("Superfamily"), STATGROUP_Superfamily, STATCAT_Advanced);
+
+// Save and profile sync
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Save Game"), STAT_SuperfamilySaveGame, STATGROUP_Superfamily, SUPERFAMILY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load Game"), STAT_SuperfamilyLoadGame, STATGROUP_Superfamily, SUPERFAMILY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Profile Sync"), STAT_SuperfamilyProfileSync, STATGROUP_Superfamily, SUPERFAMILY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Progress Merge"), STAT_SuperfamilyProgressMerge, STATGROUP_Superfamily, SUPERFAMILY_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Save Data"), STAT_SuperfamilySaveDataMemory, STATGROUP_Superfamily, SUPERFAMILY_API);
+
+// Levels
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Level Setup"), STAT_SuperfamilyLevelSetup, STATGROUP_Superfamily, SUPERFAMILY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Level Result"), STAT_SuperfamilyLevelResult, STATGROUP_Superfamily, SUPERFAMILY_API);
+
+// Questions (EducationSystem)
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Question Set Request"), STAT_SuperfamilyQuestionSet, STATGROUP_Superfamily, SUPERFAMILY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Question Answer"), STAT_SuperfamilyQuestionAnswer, STATGROUP_Superfamily, SUPERFAMILY_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Question Pool"), STAT_SuperfamilyQuestionPoolMemory, STATGROUP_Superfamily, SUPERFAMILY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Achievement Event"), STAT_SuperfamilyAchievementEvent, STATGROUP_Superfamily, SUPERFAMILY_API);
+
+// Gameplay event bus
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Event Dispatch"), STAT_SuperfamilyEventDispatch, STATGROUP_Superfamily, SUPERFAMILY_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Events Dispatched"), STAT_SuperfamilyEventsDispatched, STATGROUP_Superfamily, SUPERFAMILY_API);
+
+/**
+ * LLM tag of the game module ("-llm", then "stat LLM")
+ * The plugins each have their own: EducationSystem, RNUEBridge, RealLifeMissions.
+ */
+LLM_DECLARE_TAG_API(Superfamily, SUPERFAMILY_API);
+
+/**
+ * csvprofile category for timings, per-frame values and events
+ * (LevelStart, LevelEnd, QuestionShown, SaveWritten) of the game and EducationSystem
+ */
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SUPERFAMILY_API, Superfamily);
@@ -0,0 +1,258 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "Types/SuperfamilyIds.h"
+#include "SuperfamilyWorldContentSubsystem.generated.h"
+
+class FJsonObject;
+class FJsonValue;
+class IHttpRequest;
+struct FChildProfile;
+
+UENUM(BlueprintType)
+enum class EWorldContentState : uint8
+{
+	/** In the install, or downloaded and mounted */
+	Ready,
+	NotInstalled,
+	Downloading,
+	Verifying,
+	/** Gave up after repeated failures; retried on the next request */
+	Failed
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnWorldContentStateChanged, int32, WorldID, EWorldContentState, State);
+
+/**
+ * Downloads, verifies and mounts per-world content chunks
+ * The first BaseInstallWorlds worlds ship in the install (chunk 0); every
+ * later world's maps are cooked into chunk N = WorldID (USuperfamilyAssetManager)
+ * and fetched from the content server:
+ *
+ *   GET {ContentBaseURL}/{Platform}/Manifest.json
+ *       { "buildId": "...", "chunks": [ { "chunkId": 2, "files": [ { "name", "size", "sha1" } ] } ] }
+ *   GET {ContentBaseURL}/{Platform}/{name}    resumed with a Range header
+ *
+ * Files land in the persistent download dir, are SHA-1 checked on a worker
+ * and the chunk's pak is mounted. A chunk cached by an earlier run is mounted
+ * without hashing it again if its files still have the size and modification
+ * time they had when they passed. A chunk the install already mounted (a build
+ * that staged every chunk) is Ready without a download.
+ *
+ * Each child's progress decides what is kept: the world they are in, plus the
+ * next one once they are PrefetchLevelsBeforeBoss levels from its boss.
+ * Finished worlds beyond KeepFinishedWorlds are unmounted and deleted, least
+ * recently played first, never while one of their maps is loaded.
+ *
+ * Uncooked builds have every world's content on disk, so worlds are Ready
+ * without downloads unless a stand-in content server is running
+ * (-SFContentServer=<Dir> or sf.Content.Serve, non-shipping builds).
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API USuperfamilyWorldContentSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Boot stage that mounts cached worlds and starts fetching the manifest */
+	static const FName BootStage;
+
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	/** Chunk a world's maps are cooked into; 0 (the install) for the first BaseInstallWorlds */
+	int32 GetWorldChunkId(int32 WorldID) const;
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Content")
+	EWorldContentState GetWorldState(int32 WorldID) const;
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Content")
+	bool IsWorldReady(int32 WorldID) const { return GetWorldState(WorldID) == EWorldContentState::Ready; }
+
+	/** Fraction of a world's chunk on disk, 1 once it is ready */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Content")
+	float GetWorldProgress(int32 WorldID) const;
+
+	/** Download, verify and mount a world; OnReady runs on the game thread (immediately if it is ready) */
+	void RequestWorld(int32 WorldID, TFunction<void(bool /* bReady */)> OnReady);
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Content")
+	void InstallWorld(int32 WorldID) { RequestWorld(WorldID, nullptr); }
+
+	/** Unmount and delete a downloaded world (not while one of its maps is loaded) */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Content")
+	bool EvictWorld(int32 WorldID);
+
+	/** Prefetch and evict worlds according to every profile's progress */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Content")
+	void UpdateWorldsForProgress();
+
+	/** Point downloads at a stand-in server and fetch its manifest; uncooked builds then download too */
+	void SetContentBaseURL(const FString& URL);
+
+	/** Log every known world's state */
+	void DumpStatus() const;
+
+	UPROPERTY(BlueprintAssignable, Category = "Superfamily|Content")
+	FOnWorldContentStateChanged OnWorldStateChanged;
+
+protected:
+	UPROPERTY(Config)
+	FString ContentBaseURL = TEXT("https://content.superfamily.nl");
+
+	/** Worlds in the install; chunks start after these */
+	UPROPERTY(Config)
+	int32 BaseInstallWorlds = 1;
+
+	/** Fetch the next world once the child's next level is this close to the boss */
+	UPROPERTY(Config)
+	int32 PrefetchLevelsBeforeBoss = 3;
+
+	/** Finished worlds kept for replaying, most recently played first */
+	UPROPERTY(Config)
+	int32 KeepFinishedWorlds = 1;
+
+	/** Consecutive failed downloads or checks before a world is marked Failed */
+	UPROPERTY(Config)
+	int32 MaxAttempts = 5;
+
+	UPROPERTY(Config)
+	float RequestTimeoutSeconds = 60.0f;
+
+private:
+	struct FChunkFile
+	{
+		FString Name;
+		int64 Size = 0;
+		FString Hash;
+
+		/** Unix modification time the file had when its hash last matched; 0 if it hasn't been checked */
+		int64 VerifiedModTime = 0;
+
+		bool operator==(const FChunkFile& Other) const { return Size == Other.Size && Name == Other.Name && Hash == Other.Hash; }
+	};
+
+	struct FWorldChunk
+	{
+		int32 WorldID = 0;
+		int32 ChunkId = 0;
+		EWorldContentState State = EWorldContentState::NotInstalled;
+
+		/** Files on disk (cache index) or being downloaded (manifest) */
+		TArray<FChunkFile> Files;
+
+		/** Every file downloaded and checked once; listed in the cache index */
+		bool bInstalled = false;
+		bool bMounted = false;
+
+		/** Files fully on disk, and bytes of the one downloading */
+		int32 FilesDone = 0;
+		int64 FileBytesReceived = 0;
+
+		/** Requested, or needed by a child's progress */
+		bool bWanted = false;
+
+		/** A download, check or mount is in flight */
+		bool bBusy = false;
+		int32 ConsecutiveFailures = 0;
+		double NextAttemptTime = 0.0;
+
+		/** Unix time its maps were last loaded, for choosing which finished world to keep */
+		int64 LastPlayed = 0;
+
+		TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> Request;
+		TSharedPtr<FArchive> DownloadStream;
+		TArray<TFunction<void(bool)>> Waiters;
+
+		/** Increments on evict so callbacks of abandoned work are ignored */
+		uint32 Serial = 0;
+
+		int64 GetTotalBytes() const;
+	};
+
+	bool Tick(float DeltaTime);
+
+	/** Take the next step for a requested world: download, check, mount */
+	void Advance(FWorldChunk& Chunk);
+
+	void DownloadNextFile(FWorldChunk& Chunk);
+	void HandleFileDownloaded(int32 WorldID, uint32 Serial, bool bSucceeded, int32 ResponseCode);
+	void StartVerify(FWorldChunk& Chunk);
+
+	/** Every file still has the size and modification time it was verified with */
+	bool IsVerifiedOnDisk(const FWorldChunk& Chunk) const;
+
+	void HandleVerified(int32 WorldID, uint32 Serial, bool bVerified);
+	bool Mount(FWorldChunk& Chunk);
+
+	/** Back off and retry; marks the world Failed once it keeps failing */
+	void OnStepFailed(FWorldChunk& Chunk, const FString& Reason);
+
+	void SetState(FWorldChunk& Chunk, EWorldContentState State);
+	void Finish(FWorldChunk& Chunk, bool bReady);
+
+	/** Delete a chunk's files and forget it was installed */
+	void DeleteChunkFiles(FWorldChunk& Chunk);
+
+	FWorldChunk& FindOrAddChunk(int32 WorldID);
+
+	/** Worlds a child is in or about to reach, judged the way IsLevelUnlocked does */
+	void CollectNeededWorlds(const FChildProfile& Profile, TSet<int32>& OutWorlds) const;
+	int32 GetBossLevelID(int32 WorldID) const;
+	bool IsWorldCatalogued(int32 WorldID) const;
+
+	void FetchManifest();
+	bool ParseManifest(const FString& JSON);
+
+	/** Files the manifest lists for a chunk, or null if the manifest isn't known or lacks it */
+	const TArray<FChunkFile>* FindManifestFiles(int32 ChunkId) const;
+
+	void LoadCacheIndex();
+	void SaveCacheIndex() const;
+
+	static bool ReadFiles(const FJsonObject& Object, TArray<FChunkFile>& OutFiles);
+	static TArray<TSharedPtr<FJsonValue>> WriteFiles(const TArray<FChunkFile>& Files);
+
+	FString GetFilePath(const FChunkFile& File) const;
+	FString GetPlatformURL() const;
+
+	void HandlePostLoadMap(UWorld* LoadedWorld);
+	void HandleLevelRecorded(const FChildId& ChildID, int32 WorldID, int32 LevelID, int32 Stars, int32 PreviousStars);
+
+	/** False in uncooked builds, where content is loose and nothing needs downloading */
+	bool UsesChunks() const { return bUsePakFiles || bStandInServer; }
+
+	TMap<int32, FWorldChunk> Worlds;
+
+	/** Chunks whose paks the install mounted at startup */
+	TSet<int32> InstallChunkIds;
+
+	/** Latest manifest: chunk ID to files */
+	TMap<int32, TArray<FChunkFile>> ManifestChunks;
+	FString ManifestBuildID;
+	bool bManifestLoaded = false;
+
+	/** Fetched from the server this session, not just read from the cache */
+	bool bManifestFresh = false;
+	bool bManifestRequestInFlight = false;
+	double NextManifestAttemptTime = 0.0;
+	int32 ManifestFailures = 0;
+
+	FString CacheDirectory;
+
+	/** World whose map is loaded now; never evicted */
+	int32 LoadedWorldID = 0;
+
+	bool bUsePakFiles = false;
+	bool bStandInServer = false;
+
+	FTSTicker::FDelegateHandle TickHandle;
+	FDelegateHandle PostLoadMapHandle;
+	FDelegateHandle LevelRecordedHandle;
+};
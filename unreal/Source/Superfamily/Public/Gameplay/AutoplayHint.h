@@ -0,0 +1,51 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AutoplayHint.generated.h"
+
+class UBillboardComponent;
+
+/**
+ * What the autoplay bot does when it reaches a hint
+ */
+UENUM(BlueprintType)
+enum class EAutoplayHintAction : uint8
+{
+	Jump        UMETA(DisplayName = "Jump"),
+	Wait        UMETA(DisplayName = "Wait"),           // Stand still, e.g. for a moving platform
+	TurnAround  UMETA(DisplayName = "Turn Around"),
+	Goal        UMETA(DisplayName = "Goal")            // The level is completed here
+};
+
+/**
+ * Marker placed in a level to tell ASuperfamilyAutoplayBot what to do at a spot
+ * the bot's own obstacle and ledge probes can't work out. Has no gameplay effect
+ * and is hidden in game; each hint triggers once per run.
+ */
+UCLASS(ClassGroup = (Superfamily), hidecategories = (Rendering, Physics, Collision, Input, LOD, Cooking, Replication))
+class SUPERFAMILY_API AAutoplayHint : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AAutoplayHint(const FObjectInitializer& ObjectInitializer);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autoplay")
+	EAutoplayHintAction Action = EAutoplayHintAction::Jump;
+
+	/** Triggers when the player is this far before the hint along X */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autoplay", meta = (ClampMin = "0"))
+	float TriggerDistance = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autoplay", meta = (ClampMin = "0", EditCondition = "Action == EAutoplayHintAction::Wait"))
+	float WaitSeconds = 1.0f;
+
+#if WITH_EDITORONLY_DATA
+private:
+	UPROPERTY()
+	TObjectPtr<UBillboardComponent> Sprite;
+#endif
+};
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Core/MemoryBudgetClient.h"
+#include "Types/SuperfamilyTypes.h"
+#include "BossEncounterPreloader.generated.h"
+
+struct FStreamableHandle;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnBossEncounterPrepared);
+
+/**
+ * Which boss question set to prepare
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FBossEncounterRequest
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
+	int32 WorldID = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
+	EQuestionSubject Subject = EQuestionSubject::Rekenen;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
+	EDifficultyLevel Difficulty = EDifficultyLevel::Groep1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
+	int32 QuestionCount = 5;
+
+	bool operator==(const FBossEncounterRequest& Other) const
+	{
+		return WorldID == Other.WorldID && Subject == Other.Subject && Difficulty == Other.Difficulty && QuestionCount == Other.QuestionCount;
+	}
+};
+
+/**
+ * How long one question took to become fully playable
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FBossQuestionTiming
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Boss")
+	FQuestionId QuestionID;
+
+	/** Audio cue and image assets loaded for the question */
+	UPROPERTY(BlueprintReadOnly, Category = "Boss")
+	int32 AssetCount = 0;
+
+	/** From the question set arriving to its assets being resident */
+	UPROPERTY(BlueprintReadOnly, Category = "Boss")
+	float PrepareSeconds = 0.0f;
+};
+
+/**
+ * Fetches a boss encounter's full question set and async-loads every audio
+ * cue and image up front, so asking a question never waits on content.
+ * Lives on the game instance so a level's results screen can start preparing
+ * the boss before the boss map loads; the boss game mode gates the fight on it.
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API UBossEncounterPreloader : public UGameInstanceSubsystem, public IMemoryBudgetClient
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	//~ Begin IMemoryBudgetClient Interface
+	virtual FName GetMemoryBudgetName() const override { return TEXT("QuestionContent"); }
+	virtual int64 GetBudgetedMemoryBytes() const override;
+	virtual int64 TrimMemory(int64 BytesToFree) override;
+	//~ End IMemoryBudgetClient Interface
+
+	/** Start preparing; repeated calls for the same request are no-ops */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Boss")
+	void Prepare(const FBossEncounterRequest& Request);
+
+	/** Drop the prepared questions and let their assets unload */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Boss")
+	void Release();
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Boss")
+	bool IsPrepared(const FBossEncounterRequest& Request) const { return bIsPrepared && Request == CurrentRequest; }
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Boss")
+	bool IsPreparing(const FBossEncounterRequest& Request) const { return bIsPreparing && Request == CurrentRequest; }
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Boss")
+	TArray<FQuestionData> GetQuestions() const { return Questions; }
+
+	/** Prepared question by index, without copying the set */
+	const FQuestionData* GetQuestion(int32 Index) const { return Questions.IsValidIndex(Index) ? &Questions[Index] : nullptr; }
+
+	/** Per-question preparation times of the current set */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Boss")
+	TArray<FBossQuestionTiming> GetQuestionTimings() const { return Timings; }
+
+	/** Resolve a question's AudioCueID to its sound asset in the current audio culture */
+	FSoftObjectPath GetAudioCuePath(const FString& AudioCueID) const;
+
+	/** Fired once the question set and all its assets are loaded */
+	UPROPERTY(BlueprintAssignable, Category = "Superfamily|Boss")
+	FOnBossEncounterPrepared OnPrepared;
+
+private:
+	void HandleQuestionsReceived(TArray<FQuestionData>&& InQuestions);
+	void HandleQuestionAssetsLoaded(int32 QuestionIndex, int32 Serial);
+	void FinishIfComplete();
+
+	FBossEncounterRequest CurrentRequest;
+	TArray<FQuestionData> Questions;
+	TArray<FBossQuestionTiming> Timings;
+
+	/** Keep the loaded assets resident until Release */
+	TArray<TSharedPtr<FStreamableHandle>> Handles;
+
+	/** Increments on Release so callbacks from an abandoned request are ignored */
+	int32 RequestSerial = 0;
+
+	int32 PendingQuestions = 0;
+	double PrepareStartTime = 0.0;
+	double QuestionsReceivedTime = 0.0;
+	bool bIsPreparing = false;
+	bool bIsPrepared = false;
+};
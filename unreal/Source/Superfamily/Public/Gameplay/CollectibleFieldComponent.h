@@ -0,0 +1,97 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "CollectibleFieldComponent.generated.h"
+
+class ASuperfamilyPlayerCharacter;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnFieldCoinsCollected, const TArray<FVector>&, CoinLocations);
+
+/**
+ * A field of coins rendered as instances of one static mesh
+ * Pickups are resolved by querying a 2D (XZ) spatial hash against the player
+ * capsule once per frame instead of one overlap component per coin.
+ * Collected instances are hidden in a single batched render update per frame.
+ */
+UCLASS(ClassGroup = (Superfamily), meta = (BlueprintSpawnableComponent))
+class SUPERFAMILY_API UCollectibleFieldComponent : public UInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCollectibleFieldComponent(const FObjectInitializer& ObjectInitializer);
+
+	//~ Begin UActorComponent Interface
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	//~ End UActorComponent Interface
+
+	/** Add a coin at a world location (runtime-spawned fields) */
+	UFUNCTION(BlueprintCallable, Category = "Collectibles")
+	int32 AddCoin(const FVector& WorldLocation);
+
+	/** Bring back every collected coin, e.g. on level restart */
+	UFUNCTION(BlueprintCallable, Category = "Collectibles")
+	void ResetField();
+
+	/** Coins in this field */
+	UFUNCTION(BlueprintPure, Category = "Collectibles")
+	int32 GetTotalCoins() const { return CoinLocations.Num(); }
+
+	/** Coins picked up from this field */
+	UFUNCTION(BlueprintPure, Category = "Collectibles")
+	int32 GetCollectedCoins() const { return CollectedCount; }
+
+	/** Fired once per frame with the locations of coins picked up that frame */
+	UPROPERTY(BlueprintAssignable, Category = "Collectibles")
+	FOnFieldCoinsCollected OnCoinsCollected;
+
+protected:
+	/** Value passed to CollectCoin for each coin */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collectibles")
+	int32 CoinValue = 1;
+
+	/** Pickup radius around each coin, added to the capsule radius */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collectibles")
+	float PickupRadius = 40.0f;
+
+	/** Spatial hash cell size (world units, X and Z) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collectibles")
+	float CellSize = 256.0f;
+
+private:
+	static uint64 GetCellKey(int32 CellX, int32 CellZ)
+	{
+		return (uint64(uint32(CellX)) << 32) | uint64(uint32(CellZ));
+	}
+
+	void RebuildSpatialHash();
+	void AddToSpatialHash(int32 CoinIndex);
+
+	/** Coins overlapping the player's capsule this frame */
+	void QueryPickups(const ASuperfamilyPlayerCharacter* Player, TArray<int32>& OutCoinIndices) const;
+
+	/** Hide the collected instances in one render update */
+	void HideInstances(const TArray<int32>& CoinIndices);
+
+	/** World location per instance, in instance order */
+	TArray<FVector> CoinLocations;
+
+	/** Instance transforms before hiding, for ResetField */
+	TArray<FTransform> OriginalTransforms;
+
+	/** One bit per instance */
+	TBitArray<> CollectedFlags;
+	int32 CollectedCount = 0;
+
+	/** Packed (X, Z) cell -> uncollected coin indices */
+	TMap<uint64, TArray<int32>> SpatialHash;
+
+	TWeakObjectPtr<ASuperfamilyPlayerCharacter> CachedPlayer;
+
+	/** Skip the query while the player stands still */
+	FVector LastQueryLocation = FVector(TNumericLimits<float>::Max());
+};
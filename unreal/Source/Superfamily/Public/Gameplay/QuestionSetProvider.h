@@ -0,0 +1,36 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "Types/SuperfamilyTypes.h"
+#include "QuestionSetProvider.generated.h"
+
+class UDataTable;
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class UQuestionSetProvider : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Source of question sets for gameplay code
+ * Implemented by UQuestionManager (EducationSystem), which depends on this
+ * module and so can't be referenced from here directly.
+ */
+class SUPERFAMILY_API IQuestionSetProvider
+{
+	GENERATED_BODY()
+
+public:
+	/** Fetch up to Count questions; OnReady may run immediately or later on the game thread */
+	virtual void RequestQuestionSet(EQuestionSubject Subject, EDifficultyLevel Difficulty, int32 Count, TFunction<void(TArray<FQuestionData>&&)> OnReady) = 0;
+
+	/** Record an answer as if the player gave it; returns whether it was correct */
+	virtual bool SubmitQuestionAnswer(const FQuestionId& QuestionID, int32 AnswerIndex, float ResponseTime) = 0;
+
+	/** Add the questions of a question pack DataTable loaded during boot */
+	virtual void AddQuestionPack(UDataTable* QuestionTable) = 0;
+};
@@ -0,0 +1,150 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "SuperfamilyActorPool.generated.h"
+
+UINTERFACE(MinimalAPI, BlueprintType)
+class UPooledActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Optional reset hooks for pooled actors
+ * BeginPlay only runs once per actor, so per-use setup belongs in OnAcquiredFromPool.
+ */
+class SUPERFAMILY_API IPooledActor
+{
+	GENERATED_BODY()
+
+public:
+	/** Handed out again: reset state (velocity, timers, counters) here */
+	UFUNCTION(BlueprintNativeEvent, Category = "Superfamily|Pool")
+	void OnAcquiredFromPool();
+
+	/** Parked: stop timers and release references here */
+	UFUNCTION(BlueprintNativeEvent, Category = "Superfamily|Pool")
+	void OnReturnedToPool();
+};
+
+/**
+ * Pool to pre-warm for a level, set on the level game mode
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FActorPoolConfig
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pool")
+	TSoftClassPtr<AActor> ActorClass;
+
+	/** Actors spawned and parked at level BeginPlay */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pool", meta = (ClampMin = "0"))
+	int32 PrewarmCount = 8;
+
+	/** Parked actors kept at most; extra releases are destroyed (0 = unlimited) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pool", meta = (ClampMin = "0"))
+	int32 MaxPooled = 0;
+};
+
+/**
+ * Usage counters for one pooled class
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FActorPoolStats
+{
+	GENERATED_BODY()
+
+	/** Acquires served from parked actors */
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 Hits = 0;
+
+	/** Acquires that had to spawn */
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 Misses = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 Available = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 InUse = 0;
+
+	/** Highest InUse seen; a good PrewarmCount */
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 PeakInUse = 0;
+};
+
+USTRUCT()
+struct FActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> Available;
+
+	int32 MaxPooled = 0;
+	FActorPoolStats Stats;
+};
+
+/**
+ * Reuses transient gameplay actors (effects, projectiles, popping coins,
+ * reward stars, question bubbles) instead of spawning and destroying them.
+ * Parked actors are hidden, collision-free, tick-free and have their
+ * auto-activating components deactivated; acquiring one allocates nothing.
+ */
+UCLASS()
+class SUPERFAMILY_API USuperfamilyActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	/** Spawn and park actors for each configured class */
+	void Prewarm(const TArray<FActorPoolConfig>& Configs);
+
+	/** Spawn and park Count more actors of a class */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Pool")
+	void PrewarmClass(TSubclassOf<AActor> ActorClass, int32 Count, int32 MaxPooled = 0);
+
+	/** Take a parked actor (or spawn one if none are left) and place it at Transform */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Pool", meta = (DeterminesOutputType = "ActorClass"))
+	AActor* Acquire(TSubclassOf<AActor> ActorClass, const FTransform& Transform);
+
+	template<typename T>
+	T* Acquire(const FTransform& Transform, TSubclassOf<AActor> ActorClass = T::StaticClass())
+	{
+		return CastChecked<T>(Acquire(ActorClass, Transform), ECastCheckedType::NullAllowed);
+	}
+
+	/** Park an acquired actor; actors not from a pool are destroyed */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Pool")
+	void Release(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Pool")
+	FActorPoolStats GetStats(TSubclassOf<AActor> ActorClass) const;
+
+	/** Log hits, misses and peaks for every pool */
+	void LogStats() const;
+
+private:
+	AActor* SpawnPooledActor(UClass* ActorClass);
+	void Park(AActor* Actor);
+	void Unpark(AActor* Actor, const FTransform& Transform);
+
+	UFUNCTION()
+	void HandlePooledActorDestroyed(AActor* DestroyedActor);
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FActorPool> Pools;
+
+	/** Actors handed out and not yet released */
+	TSet<TObjectKey<AActor>> InUseActors;
+};
@@ -0,0 +1,109 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "Types/SuperfamilyTypes.h"
+#include "SuperfamilyAutoplayBot.generated.h"
+
+class AAutoplayHint;
+class ASuperfamilyBossGameMode;
+class ASuperfamilyPlayerCharacter;
+class IQuestionSetProvider;
+
+/**
+ * Plays a level unattended: runs the player character through Move2D/PerformJump,
+ * jumping over obstacles and gaps found by short traces and following any
+ * AAutoplayHint markers, answers questions through the question provider and
+ * ends the level via OnLevelCompleted/OnLevelFailed.
+ *
+ * The bot drives the pawn the player controller already possesses rather than
+ * possessing it, so camera, pickups and streaming keep following player 0.
+ */
+UCLASS(Config = Game, NotBlueprintable)
+class SUPERFAMILY_API ASuperfamilyAutoplayBot : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ASuperfamilyAutoplayBot(const FObjectInitializer& ObjectInitializer);
+
+	//~ Begin AActor Interface
+	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+	//~ End AActor Interface
+
+	/** Start autoplay in World, or return the bot already running there */
+	static ASuperfamilyAutoplayBot* StartAutoplay(UWorld* World);
+
+	/** True while a bot plays the level; question UI should call AnswerQuestion instead of waiting for input */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Autoplay", meta = (WorldContext = "WorldContextObject"))
+	static bool IsAutoplayActive(const UObject* WorldContextObject);
+
+	/** Pick and submit an answer (correct with AnswerAccuracy probability); returns the chosen index */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Autoplay")
+	int32 AnswerQuestion(const FQuestionData& Question);
+
+	/** The bot has ended the level */
+	bool IsFinished() const { return bFinished; }
+
+protected:
+	/** Share of questions answered correctly */
+	UPROPERTY(Config)
+	float AnswerAccuracy = 0.8f;
+
+	/** Simulated thinking time per boss question */
+	UPROPERTY(Config)
+	float AnswerDelaySeconds = 1.5f;
+
+	/** Fail the level if it isn't finished after this long */
+	UPROPERTY(Config)
+	float LevelTimeoutSeconds = 300.0f;
+
+	/** Fail the level if the player makes no progress for this long */
+	UPROPERTY(Config)
+	float StuckTimeoutSeconds = 10.0f;
+
+	/** How far past the capsule to look for walls and gaps */
+	UPROPERTY(Config)
+	float ProbeDistance = 80.0f;
+
+	/** A drop deeper than this below the feet counts as a gap to jump */
+	UPROPERTY(Config)
+	float GapDepth = 300.0f;
+
+private:
+	void TickPlatforming(ASuperfamilyPlayerCharacter& Character, float DeltaSeconds);
+	void TickBoss(ASuperfamilyBossGameMode& BossMode, float DeltaSeconds);
+
+	/** Trigger the hint ahead of the character, if any; returns true to jump */
+	bool ApplyHints(const ASuperfamilyPlayerCharacter& Character);
+
+	bool IsPathBlocked(const ASuperfamilyPlayerCharacter& Character) const;
+	bool IsGapAhead(const ASuperfamilyPlayerCharacter& Character) const;
+
+	void Finish(bool bCompleted);
+
+	IQuestionSetProvider* FindQuestionProvider() const;
+
+	/** Level hints sorted by X */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<AAutoplayHint>> Hints;
+
+	TBitArray<> TriggeredHints;
+
+	/** Seeded from the map name so runs of a level answer identically */
+	FRandomStream AnswerStream;
+
+	float Direction = 1.0f;
+	float WaitRemaining = 0.0f;
+	float ElapsedSeconds = 0.0f;
+	float StuckSeconds = 0.0f;
+	float AnswerCooldown = 0.0f;
+
+	int32 QuestionsAnswered = 0;
+	int32 QuestionsCorrect = 0;
+
+	bool bFinished = false;
+};
@@ -0,0 +1,173 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SuperfamilyInputReplaySubsystem.generated.h"
+
+class ASuperfamilyPlayerCharacter;
+
+/**
+ * Player input streams that can be recorded and replayed
+ */
+UENUM(BlueprintType)
+enum class EInputReplayAction : uint8
+{
+	Move        UMETA(DisplayName = "Move"),        // Value = axis, recorded on change
+	Jump        UMETA(DisplayName = "Jump"),
+	Interact    UMETA(DisplayName = "Interact")
+};
+
+UENUM(BlueprintType)
+enum class EInputReplayState : uint8
+{
+	Idle,
+	Recording,
+	Replaying
+};
+
+/**
+ * One recorded input, keyed by the frame it was applied on
+ */
+struct FInputReplayEvent
+{
+	int32 Frame = 0;
+	EInputReplayAction Action = EInputReplayAction::Move;
+	float Value = 0.0f;
+
+	friend FArchive& operator<<(FArchive& Ar, FInputReplayEvent& Event);
+};
+
+/**
+ * A recorded play-through: everything needed to drive the same level again
+ */
+struct FInputReplay
+{
+	FString MapName;
+	int32 RandomSeed = 0;
+	float FixedDeltaTime = 1.0f / 60.0f;
+	int32 NumFrames = 0;
+	TArray<FInputReplayEvent> Events;
+
+	bool SaveToFile(const FString& Filename);
+	bool LoadFromFile(const FString& Filename);
+
+private:
+	void Serialize(FArchive& Ar);
+};
+
+/**
+ * Records the Move/Jump/Interact input that reaches ASuperfamilyPlayerCharacter
+ * and replays it frame-for-frame under a fixed timestep.
+ * Each replay frame logs wall time, actor tick time and memory to a CSV so two
+ * runs of the same recording can be compared frame by frame (sf.Replay.Compare).
+ *
+ * Headless replay:
+ *   Superfamily <Map> -game -nullrhi -unattended -SFReplay=<Name> -SFReplayExit
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API USuperfamilyInputReplaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	//~ Begin UWorldSubsystem Interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	//~ End UWorldSubsystem Interface
+
+	/** Start recording player input; the world switches to a fixed timestep */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Replay")
+	void StartRecording(const FString& Name);
+
+	/** Stop recording and write Saved/Replays/<Name>.sfreplay */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Replay")
+	void StopRecording();
+
+	/** Replay Saved/Replays/<Name>.sfreplay into the local player character */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Replay")
+	bool StartReplay(const FString& Name);
+
+	/** Stop replaying and write the frame metrics CSV */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Replay")
+	void StopReplay();
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Replay")
+	EInputReplayState GetState() const { return State; }
+
+	/**
+	 * Called by the player character for every input it handles.
+	 * Records the input while recording; returns false for live input
+	 * while a replay is driving the character.
+	 */
+	bool FilterInput(const ASuperfamilyPlayerCharacter* Character, EInputReplayAction Action, float Value);
+
+	/** Directory recordings and metrics are written to */
+	static FString GetReplayDirectory();
+
+protected:
+	/** Fixed timestep used while recording (replays use the recorded one) */
+	UPROPERTY(Config)
+	float RecordingFixedDeltaTime = 1.0f / 60.0f;
+
+	/** Replay frames longer than this count as hitches (ms) */
+	UPROPERTY(Config)
+	float HitchThresholdMs = 33.3f;
+
+private:
+	struct FFrameMetrics
+	{
+		float FrameMs = 0.0f;
+		float ActorTickMs = 0.0f;
+		float UsedMemoryMB = 0.0f;
+	};
+
+	ASuperfamilyPlayerCharacter* GetPlayerCharacter() const;
+
+	void BeginFixedTimestep(float DeltaTime);
+	void EndFixedTimestep();
+
+	void HandlePreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void HandlePostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	/** Feed this frame's recorded events into the character */
+	void ApplyReplayFrame();
+
+	void WriteMetrics() const;
+
+	EInputReplayState State = EInputReplayState::Idle;
+	FString ActiveName;
+	FInputReplay Replay;
+
+	/** Frame index since recording/replay started */
+	int32 Frame = -1;
+
+	/** Move axis seen this frame while recording, and the last one written */
+	float FrameMoveValue = 0.0f;
+	float RecordedMoveValue = 0.0f;
+
+	/** Replay: next event to apply and the held move axis */
+	int32 NextEventIndex = 0;
+	float ReplayMoveValue = 0.0f;
+
+	/** True while the subsystem itself is calling the character's input handlers */
+	bool bInjecting = false;
+
+	/** Quit once the replay finishes (-SFReplayExit) */
+	bool bExitWhenDone = false;
+
+	TArray<FFrameMetrics> Metrics;
+	double FrameStartTime = 0.0;
+	double ActorTickStartTime = 0.0;
+
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+
+	FDelegateHandle PreActorTickHandle;
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,209 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Core/MemoryBudgetClient.h"
+#include "SuperfamilyLevelStreamingSubsystem.generated.h"
+
+class ULevelStreaming;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnLevelChunkStall, int32, ChunkIndex, float, StallSeconds);
+
+/**
+ * One streamed slice of a side-scrolling level, covering [MinX, MaxX]
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FLevelStreamingChunk
+{
+	GENERATED_BODY()
+
+	/** Sublevel holding this slice's geometry and actors */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	TSoftObjectPtr<UWorld> Level;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float MinX = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float MaxX = 0.0f;
+
+	/** Memory assumed for this chunk until it has been loaded and measured once */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float EstimatedMemoryMB = 48.0f;
+};
+
+/**
+ * Per-level streaming configuration, owned by the level game mode
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FLevelStreamingSettings
+{
+	GENERATED_BODY()
+
+	/** Chunks along X; may overlap, need not be sorted */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	TArray<FLevelStreamingChunk> Chunks;
+
+	/** Load chunks the player will reach within this many seconds at their current speed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float LookaheadSeconds = 2.0f;
+
+	/** Minimum distance loaded ahead, also used while standing still (facing direction) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float MinLookaheadDistance = 2000.0f;
+
+	/** Distance kept loaded behind the player */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float KeepBehindDistance = 1000.0f;
+
+	/** Chunks left behind stay loaded this long in case the player turns around */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float UnloadDelaySeconds = 3.0f;
+
+	/** Total memory of loaded chunks; chunks furthest ahead are skipped to stay under it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float MemoryBudgetMB = 192.0f;
+};
+
+/**
+ * Snapshot of the streaming state and stall telemetry
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FLevelStreamingReport
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	int32 LoadedChunks = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	int32 PendingChunks = 0;
+
+	/** Memory of every chunk loaded or loading; measured for chunks loaded before, estimated otherwise */
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	float CommittedMemoryMB = 0.0f;
+
+	/** Measured memory of the chunks loaded now */
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	float LoadedMemoryMB = 0.0f;
+
+	/** Times the player reached a chunk that wasn't visible yet */
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	int32 StallCount = 0;
+
+	/** Total time spent in chunks that weren't visible yet */
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	float StallSeconds = 0.0f;
+
+	/** Slowest request-to-visible time so far */
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	float MaxLoadSeconds = 0.0f;
+};
+
+/**
+ * Streams the chunks of a side-scrolling level along X
+ * Loads ahead of the player based on velocity (or facing while idle), unloads
+ * chunks left behind and keeps the total under a memory budget. A chunk's
+ * memory is measured when it first becomes visible; until then its
+ * EstimatedMemoryMB stands in. Activated by ASuperfamilyLevelGameMode.
+ */
+UCLASS()
+class SUPERFAMILY_API USuperfamilyLevelStreamingSubsystem : public UTickableWorldSubsystem, public IMemoryBudgetClient
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return bIsActive; }
+	//~ End FTickableGameObject Interface
+
+	//~ Begin IMemoryBudgetClient Interface
+	virtual FName GetMemoryBudgetName() const override { return TEXT("LevelChunks"); }
+	virtual int64 GetBudgetedMemoryBytes() const override;
+	virtual int64 TrimMemory(int64 BytesToFree) override;
+	//~ End IMemoryBudgetClient Interface
+
+	/** Start streaming; the chunk at the player start is loaded before returning */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Streaming")
+	void Activate(const FLevelStreamingSettings& InSettings);
+
+	/** Stop streaming; loaded chunks stay loaded */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Streaming")
+	void Deactivate();
+
+	/** True once the chunk is loaded and visible */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Streaming")
+	bool IsChunkReady(int32 ChunkIndex) const;
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Streaming")
+	FLevelStreamingReport GetReport() const { return Report; }
+
+	/** Fired when a stall ends, with how long the player waited on the chunk */
+	UPROPERTY(BlueprintAssignable, Category = "Superfamily|Streaming")
+	FOnLevelChunkStall OnChunkStall;
+
+private:
+	struct FChunkState
+	{
+		TWeakObjectPtr<ULevelStreaming> Streaming;
+
+		/** Load has been requested and not released */
+		bool bRequested = false;
+
+		/** World time the load was requested, until it became visible (0 = not pending) */
+		double RequestTime = 0.0;
+
+		/** Last world time the chunk was inside the wanted window */
+		double LastWantedTime = 0.0;
+
+		/** Memory of the chunk's level the last time it was loaded (-1 = never measured) */
+		int64 MeasuredBytes = -1;
+	};
+
+	/** Player X, travel direction (+1/-1) and speed along X */
+	bool GetPlayerMotion(float& OutX, float& OutDirection, float& OutSpeed) const;
+
+	/** Motion of a player about to spawn at the level's player start */
+	bool GetPlayerStartMotion(float& OutX, float& OutDirection, float& OutSpeed) const;
+
+	/** Load and unload chunks for a player at PlayerX; telemetry is left to the caller */
+	void UpdateStreaming(float PlayerX, float Direction, float Speed);
+
+	/** Measured memory if the chunk has been loaded before, otherwise its estimate */
+	float GetChunkMemoryMB(int32 ChunkIndex) const;
+
+	/** Chunk indices to keep loaded, most urgent first, trimmed to the memory budget */
+	void GatherWantedChunks(float PlayerX, float Direction, float Speed, TArray<int32>& OutWanted) const;
+
+	int32 FindChunkAt(float X) const;
+	ULevelStreaming* FindOrCreateStreaming(int32 ChunkIndex);
+
+	void RequestLoad(int32 ChunkIndex);
+	void RequestUnload(int32 ChunkIndex);
+
+	void UpdateStallTelemetry(float PlayerX);
+	void UpdateReport();
+
+	FLevelStreamingSettings Settings;
+	TArray<FChunkState> ChunkStates;
+
+	FLevelStreamingReport Report;
+
+	/** Chunk the player is stalled on (INDEX_NONE = none) and since when */
+	int32 StalledChunk = INDEX_NONE;
+	double StallStartTime = 0.0;
+
+	/** Time of the last UpdateStreaming */
+	double LastUpdateTime = 0.0;
+
+	bool bIsActive = false;
+};
@@ -0,0 +1,236 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SuperfamilyTickManager.generated.h"
+
+struct FStreamableHandle;
+
+/**
+ * Tick tier assigned from an actor's distance to the camera along the scroll axis
+ */
+UENUM(BlueprintType)
+enum class ETickSignificance : uint8
+{
+	Active      UMETA(DisplayName = "Active"),      // On screen: ticks every frame
+	Throttled   UMETA(DisplayName = "Throttled"),   // Just off screen: ticks at a reduced interval
+	Dormant     UMETA(DisplayName = "Dormant")      // Far away: tick disabled
+};
+
+/**
+ * Per-level tick budget configuration, owned by the level game mode
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FTickBudgetSettings
+{
+	GENERATED_BODY()
+
+	/** Actors within this X distance of the camera tick every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick Budget")
+	float ActiveDistance = 1500.0f;
+
+	/** Actors within this X distance tick at ThrottledTickInterval; beyond it they go dormant */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick Budget")
+	float ThrottleDistance = 4000.0f;
+
+	/** Tick interval for throttled actors (seconds) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick Budget")
+	float ThrottledTickInterval = 0.1f;
+
+	/** Extra distance an actor must cross before moving to a cheaper tier (prevents flapping) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick Budget")
+	float Hysteresis = 200.0f;
+
+	/** Actors re-scored per frame; the rest keep their tier until their turn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick Budget")
+	int32 ScoringBatchSize = 64;
+
+	/** Actor tick time per frame above which the frame counts as over budget (ms) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick Budget")
+	float ActorTickBudgetMs = 4.0f;
+
+	/** Classes whose instances are managed automatically (e.g. BP_Collectible_Coin) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick Budget")
+	TArray<TSoftClassPtr<AActor>> ManagedClasses;
+
+	/** Actors with this tag are managed automatically */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick Budget")
+	FName ManagedActorTag = TEXT("ManagedTick");
+
+	/**
+	 * Classes whose instances are managed and ticked by the manager in one loop
+	 * per class instead of each by its own tick function. Batched actors tick
+	 * after the regular tick groups, so only list classes that don't depend on
+	 * a tick group or tick prerequisites (e.g. coins, decorative props).
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick Budget")
+	TArray<TSoftClassPtr<AActor>> BatchedClasses;
+};
+
+/**
+ * Snapshot of the tick manager's last frame
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FTickBudgetReport
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Tick Budget")
+	int32 ActiveActors = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Tick Budget")
+	int32 ThrottledActors = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Tick Budget")
+	int32 DormantActors = 0;
+
+	/** Actors ticked by the manager's batches (also counted in their tier) */
+	UPROPERTY(BlueprintReadOnly, Category = "Tick Budget")
+	int32 BatchedActors = 0;
+
+	/** Time spent ticking all actors in the world last frame (ms) */
+	UPROPERTY(BlueprintReadOnly, Category = "Tick Budget")
+	float ActorTickMs = 0.0f;
+
+	/** Smoothed ActorTickMs */
+	UPROPERTY(BlueprintReadOnly, Category = "Tick Budget")
+	float AverageActorTickMs = 0.0f;
+
+	/** Time the manager itself spent scoring last frame (ms) */
+	UPROPERTY(BlueprintReadOnly, Category = "Tick Budget")
+	float ManagerMs = 0.0f;
+
+	/** Time spent ticking batched actors last frame (ms) */
+	UPROPERTY(BlueprintReadOnly, Category = "Tick Budget")
+	float BatchTickMs = 0.0f;
+
+	/** Frames since activation where ActorTickMs exceeded the budget */
+	UPROPERTY(BlueprintReadOnly, Category = "Tick Budget")
+	int32 FramesOverBudget = 0;
+};
+
+/**
+ * Level-scoped tick manager for side-scrolling levels
+ * Scores registered actors by their X distance to the camera and enables,
+ * throttles or disables their ticks. Instances of BatchedClasses are taken off
+ * the tick task graph and ticked by the manager, one class at a time.
+ * Activated by ASuperfamilyLevelGameMode.
+ */
+UCLASS()
+class SUPERFAMILY_API USuperfamilyTickManager : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return bIsActive; }
+	//~ End FTickableGameObject Interface
+
+	/** Start managing ticks with the given settings; gathers matching actors already in the level */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Tick Budget")
+	void Activate(const FTickBudgetSettings& InSettings);
+
+	/** Stop managing and restore every actor's original tick state */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Tick Budget")
+	void Deactivate();
+
+	/** Manage an actor that doesn't match ManagedClasses / ManagedActorTag */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Tick Budget")
+	void RegisterActor(AActor* Actor);
+
+	/** Stop managing an actor and restore its tick state */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|Tick Budget")
+	void UnregisterActor(AActor* Actor);
+
+	/** Last frame's tier counts and tick cost */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Tick Budget")
+	FTickBudgetReport GetReport() const { return Report; }
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|Tick Budget")
+	bool IsActive() const { return bIsActive; }
+
+private:
+	struct FManagedActor
+	{
+		TWeakObjectPtr<AActor> Actor;
+		ETickSignificance Tier = ETickSignificance::Active;
+
+		/** Tick state before the manager took over */
+		bool bOriginalTickEnabled = true;
+		float OriginalTickInterval = 0.0f;
+
+		/** Components that were ticking at registration, with their original interval */
+		TArray<TPair<TWeakObjectPtr<UActorComponent>, float>> TickingComponents;
+
+		/** Ticked by a batch rather than its own tick functions */
+		bool bBatched = false;
+
+		/** Batched: time since the manager last ticked it */
+		float PendingDeltaTime = 0.0f;
+	};
+
+	/** Instances of one batched class, ticked back to back */
+	struct FTickBatch
+	{
+		TObjectPtr<UClass> Class;
+		TArray<FManagedActor> Members;
+	};
+
+	/** Resolve the configured classes that are loaded; the rest go to OutPendingClasses */
+	void ResolveClasses(TArray<FSoftObjectPath>& OutPendingClasses);
+	void HandleClassesLoaded();
+
+	bool ShouldAutoManage(const AActor* Actor) const;
+	FManagedActor* FindManagedActor(const AActor* Actor);
+	int32 FindBatch(const AActor* Actor) const;
+	void AddManagedActor(AActor* Actor);
+	void ApplyTier(FManagedActor& Managed, ETickSignificance NewTier);
+	void RestoreTickState(FManagedActor& Managed);
+	void TickBatches(float DeltaTime, bool bHasCamera, float CameraX);
+	ETickSignificance ScoreActor(const FManagedActor& Managed, float CameraX) const;
+	bool GetCameraX(float& OutCameraX) const;
+
+	void HandleActorSpawned(AActor* Actor);
+	void HandlePreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void HandlePostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	FTickBudgetSettings Settings;
+
+	UPROPERTY()
+	TArray<TObjectPtr<UClass>> ResolvedManagedClasses;
+
+	TArray<FManagedActor> ManagedActors;
+
+	/** Resolved BatchedClasses; holds the classes referenced by Batches */
+	UPROPERTY()
+	TArray<TObjectPtr<UClass>> ResolvedBatchedClasses;
+
+	TArray<FTickBatch> Batches;
+
+	/** Configured classes that weren't loaded at activation */
+	TSharedPtr<FStreamableHandle> ClassLoadHandle;
+
+	/** Batched actors spawned by a batch's own tick, added to their batch after it */
+	TArray<FManagedActor> SpawnedBatchMembers;
+	bool bTickingBatches = false;
+
+	/** Round-robin cursor for batched scoring */
+	int32 ScoringCursor = 0;
+
+	FTickBudgetReport Report;
+	double ActorTickStartTime = 0.0;
+	bool bIsActive = false;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle PreActorTickHandle;
+	FDelegateHandle PostActorTickHandle;
+};
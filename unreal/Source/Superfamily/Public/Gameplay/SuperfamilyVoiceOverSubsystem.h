@@ -0,0 +1,174 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Core/MemoryBudgetClient.h"
+#include "Types/SuperfamilyTypes.h"
+#include "SuperfamilyVoiceOverSubsystem.generated.h"
+
+class USoundBase;
+struct FRNUEMessage;
+struct FStreamableHandle;
+
+DECLARE_DELEGATE_OneParam(FOnVoiceOverReady, USoundBase* /* Sound, null if the cue doesn't exist */);
+
+/**
+ * Voice-over bank for non-readers
+ * Resolves cue IDs (FQuestionData::AudioCueID, FMissionData::AudioInstructionsCue)
+ * to sound assets of the game instance's audio culture and keeps the ones in
+ * use in a byte-budgeted LRU. Cues stream in asynchronously and are primed for
+ * playback (first streamed chunk retained, or decompression started) as soon as
+ * they land, so only the active culture's recently used and upcoming cues are
+ * ever resident. Question sets and started missions are prefetched: landed
+ * prefetches sit behind the cue playing now in the order they were asked for,
+ * and prefetching pauses while the cache is full.
+ *
+ * A culture switch drops the cache without waiting on anything: in-flight loads
+ * are cancelled and the handles released for the regular GC to collect, then
+ * the cues that were cached are prefetched again in the new culture. Cues
+ * already in the new culture, or in the fallback culture it has no cue for, stay.
+ */
+UCLASS(Config = Game)
+class SUPERFAMILY_API USuperfamilyVoiceOverSubsystem : public UGameInstanceSubsystem, public IMemoryBudgetClient
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	//~ Begin IMemoryBudgetClient Interface
+	virtual FName GetMemoryBudgetName() const override { return TEXT("VoiceOver"); }
+	virtual int64 GetBudgetedMemoryBytes() const override { return ResidentBytes; }
+	virtual int64 TrimMemory(int64 BytesToFree) override;
+	//~ End IMemoryBudgetClient Interface
+
+	// ============================================
+	// Cues
+	// ============================================
+
+	/** Sound asset of a cue in a culture */
+	FSoftObjectPath GetCuePath(const FString& CueID, const FString& Culture) const;
+
+	/** Sound asset of a cue in the current audio culture */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|VoiceOver")
+	TSoftObjectPtr<USoundBase> ResolveCue(const FString& CueID) const;
+
+	/** The cue if it is resident; otherwise starts loading it and returns null */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|VoiceOver")
+	USoundBase* FindCue(const FString& CueID);
+
+	/** Load a cue at high priority; OnReady runs immediately if it is resident */
+	void RequestCue(const FString& CueID, FOnVoiceOverReady OnReady);
+
+	/** Play a cue as soon as it is resident; a later PlayCue supersedes one still loading */
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|VoiceOver")
+	void PlayCue(const FString& CueID);
+
+	// ============================================
+	// Prefetch
+	// ============================================
+
+	UFUNCTION(BlueprintCallable, Category = "Superfamily|VoiceOver")
+	void PrefetchCues(const TArray<FString>& CueIDs);
+
+	void PrefetchQuestions(const TArray<FQuestionData>& Questions);
+	void PrefetchMission(const FMissionData& Mission);
+
+protected:
+	/** Sound asset of a cue; {Culture} and {Cue} are replaced */
+	UPROPERTY(Config)
+	FString VoiceOverPathFormat = TEXT("/Game/Superfamily/Audio/VO/{Culture}/{Cue}.{Cue}");
+
+	/** Culture whose cue is used when the current one has none */
+	UPROPERTY(Config)
+	FString FallbackCulture = TEXT("nl");
+
+	/** Resident cues beyond this are evicted, least recently used first */
+	UPROPERTY(Config)
+	int32 CacheBudgetKB = 8192;
+
+	/** Prefetches loading at once; the rest wait so they can't crowd out a cue about to play */
+	UPROPERTY(Config)
+	int32 MaxPrefetchesInFlight = 4;
+
+private:
+	struct FCueEntry
+	{
+		FString CueID;
+		FString Culture;
+		TSharedPtr<FStreamableHandle> Handle;
+		TArray<FOnVoiceOverReady> Waiters;
+		int64 Bytes = 0;
+
+		/** Identifies the load in flight, so a slot reused meanwhile ignores its callback */
+		uint32 LoadSerial = 0;
+
+		/** First streamed chunk retained by us, so ours to release */
+		bool bRetainedChunk = false;
+		bool bLoading = false;
+		bool bPrefetch = false;
+
+		/** Position of a prefetch in the order asked for; 0 once the cue has been asked for itself */
+		uint32 PrefetchOrder = 0;
+
+		/** LRU neighbours; Prev is more recently used */
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+	};
+
+	/** Entry of a cue, created and loading if it wasn't cached */
+	int32 FindOrLoad(const FString& CueID, bool bPrefetch);
+	void StartLoad(int32 Slot, const FString& Culture);
+	void HandleCueLoaded(int32 Slot, uint32 LoadSerial);
+	void PumpPrefetches();
+
+	USoundBase* GetSound(const FCueEntry& Entry) const;
+
+	void Touch(int32 Slot);
+
+	/** Link a prefetch behind the head and the prefetches before it */
+	void InsertPrefetched(int32 Slot);
+
+	void Unlink(int32 Slot);
+	void Evict(int32 Slot);
+
+	int64 GetCacheBudgetBytes() const { return static_cast<int64>(CacheBudgetKB) * 1024; }
+
+	/** Evict from the LRU end until resident bytes are within Limit; returns bytes freed */
+	int64 EvictDownTo(int64 Limit);
+
+	void HandleAudioCultureChanged(const FString& Culture);
+
+	/** SettingsChanged from RN carries the parent's audioCulture choice */
+	UFUNCTION()
+	void HandleBridgeMessage(const FRNUEMessage& Message);
+
+	FString GetAudioCulture() const;
+
+	TArray<FCueEntry> Entries;
+	TArray<int32> FreeSlots;
+	TMap<FString, int32> SlotByCue;
+
+	/** Most and least recently used entries */
+	int32 Head = INDEX_NONE;
+	int32 Tail = INDEX_NONE;
+
+	/** Cue IDs waiting for a prefetch slot */
+	TArray<FString> PrefetchQueue;
+	int32 PrefetchesInFlight = 0;
+	uint32 NextPrefetchOrder = 0;
+
+	int64 ResidentBytes = 0;
+
+	uint32 NextLoadSerial = 0;
+
+	/** Cue the last PlayCue asked for */
+	FString PendingPlayCue;
+
+	FDelegateHandle CultureChangedHandle;
+};
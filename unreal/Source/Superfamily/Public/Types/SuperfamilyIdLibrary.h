@@ -0,0 +1,45 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "Types/SuperfamilyIds.h"
+#include "SuperfamilyIdLibrary.generated.h"
+
+/**
+ * Blueprint conversions for the ID structs, whose contents aren't exposed as properties
+ */
+UCLASS()
+class SUPERFAMILY_API USuperfamilyIdLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/** Child ID from its GUID string; invalid if the string isn't a GUID */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|IDs")
+	static FChildId MakeChildId(const FString& ChildID) { return FChildId::FromString(ChildID); }
+
+	/** Question ID from its catalog string */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|IDs")
+	static FQuestionId MakeQuestionId(const FString& QuestionID) { return FQuestionId::FromString(QuestionID); }
+
+	/** Mission ID from its catalog string */
+	UFUNCTION(BlueprintPure, Category = "Superfamily|IDs")
+	static FMissionId MakeMissionId(const FString& MissionID) { return FMissionId::FromString(MissionID); }
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|IDs", meta = (DisplayName = "To String (Child ID)", CompactNodeTitle = "->", BlueprintAutocast))
+	static FString Conv_ChildIdToString(const FChildId& ChildID) { return ChildID.IsValid() ? ChildID.ToString() : FString(); }
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|IDs", meta = (DisplayName = "To String (Question ID)", CompactNodeTitle = "->", BlueprintAutocast))
+	static FString Conv_QuestionIdToString(const FQuestionId& QuestionID) { return QuestionID.ToString(); }
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|IDs", meta = (DisplayName = "To String (Mission ID)", CompactNodeTitle = "->", BlueprintAutocast))
+	static FString Conv_MissionIdToString(const FMissionId& MissionID) { return MissionID.ToString(); }
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|IDs", meta = (DisplayName = "Is Valid (Child ID)"))
+	static bool IsValidChildId(const FChildId& ChildID) { return ChildID.IsValid(); }
+
+	UFUNCTION(BlueprintPure, Category = "Superfamily|IDs", meta = (DisplayName = "Equal (Child ID)", CompactNodeTitle = "==", Keywords = "== equal"))
+	static bool EqualEqual_ChildIdChildId(const FChildId& A, const FChildId& B) { return A == B; }
+};
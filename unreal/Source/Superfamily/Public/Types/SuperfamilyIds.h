@@ -0,0 +1,235 @@
+// Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+#include "HAL/CriticalSection.h"
+#include "SuperfamilyIds.generated.h"
+
+struct FPropertyTag;
+
+/**
+ * Interns the string IDs of one catalog (questions, missions) as dense 32-bit indices
+ * Indices are only meaningful inside this process: saves, JSON and bridge
+ * payloads always carry the string, converted by the ID types below.
+ * Index 0 is the empty ID.
+ */
+class SUPERFAMILY_API FSuperfamilyIdRegistry
+{
+public:
+	static FSuperfamilyIdRegistry& Questions();
+	static FSuperfamilyIdRegistry& Missions();
+
+	/** Index of an ID, interning it on first use */
+	uint32 Intern(const FString& ID);
+
+	/** String of an interned index; empty for 0 or an unknown index */
+	FString Resolve(uint32 Index) const;
+
+	/** Number of interned IDs, for memory reporting */
+	int32 Num() const;
+
+	// Conversions shared by the ID types
+	void SerializeIndex(FArchive& Ar, uint32& Index);
+	void ExportIndex(FString& ValueStr, uint32 Index, int32 PortFlags) const;
+	bool ImportIndex(const TCHAR*& Buffer, uint32& Index);
+
+private:
+	FSuperfamilyIdRegistry();
+
+	/** Interning happens on workers too (question packs, CMS loads) */
+	mutable FRWLock Lock;
+	TMap<FString, uint32> IndexByID;
+	TArray<FString> IDs;
+};
+
+/**
+ * Child profile ID
+ * A GUID, compared and hashed as 16 bytes. Older saves and RN use its
+ * string form (EGuidFormats::Digits), which FromString and the JSON
+ * conversions accept. Saves from before GUIDs may hold any string; those
+ * load as FromLegacyString of it.
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FChildId
+{
+	GENERATED_BODY()
+
+	FChildId() = default;
+	explicit FChildId(const FGuid& InGuid) : Guid(InGuid) {}
+
+	static FChildId NewId() { return FChildId(FGuid::NewGuid()); }
+
+	/** Parse an ID from RN or a legacy save; invalid if the string isn't a GUID */
+	static FChildId FromString(const FString& String);
+
+	/**
+	 * Name-based ID of a pre-GUID child ID string: the RFC 4122 version 5 UUID of its UTF-8 bytes
+	 * in namespace 8f7c1f0e-2b6a-4d3c-9e51-7a0b4c2d9e13, so RN can derive the same ID
+	 */
+	static FChildId FromLegacyString(const FString& LegacyID);
+
+	/** Legacy strings converted while loading saves since the last call, with the IDs they became */
+	static TMap<FString, FChildId> TakeLegacyConversions();
+
+	bool IsValid() const { return Guid.IsValid(); }
+	FString ToString() const { return Guid.ToString(EGuidFormats::Digits); }
+
+	bool operator==(const FChildId& Other) const { return Guid == Other.Guid; }
+	bool operator!=(const FChildId& Other) const { return Guid != Other.Guid; }
+	friend uint32 GetTypeHash(const FChildId& Id) { return GetTypeHash(Id.Guid); }
+
+	bool Serialize(FArchive& Ar);
+	bool SerializeFromMismatchedTag(const FPropertyTag& Tag, FStructuredArchive::FSlot Slot);
+	bool ExportTextItem(FString& ValueStr, const FChildId& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const;
+	bool ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText);
+
+private:
+	UPROPERTY()
+	FGuid Guid;
+};
+
+template<>
+struct TStructOpsTypeTraits<FChildId> : public TStructOpsTypeTraitsBase2<FChildId>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithStructuredSerializeFromMismatchedTag = true,
+		WithExportTextItem = true,
+		WithImportTextItem = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+/**
+ * Question ID, interned in FSuperfamilyIdRegistry::Questions()
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FQuestionId
+{
+	GENERATED_BODY()
+
+	FQuestionId() = default;
+
+	static FQuestionId FromString(const FString& String);
+
+	bool IsValid() const { return Index != 0; }
+	FString ToString() const { return FSuperfamilyIdRegistry::Questions().Resolve(Index); }
+
+	bool operator==(const FQuestionId& Other) const { return Index == Other.Index; }
+	bool operator!=(const FQuestionId& Other) const { return Index != Other.Index; }
+	friend uint32 GetTypeHash(const FQuestionId& Id) { return Id.Index; }
+
+	bool Serialize(FArchive& Ar);
+	bool SerializeFromMismatchedTag(const FPropertyTag& Tag, FStructuredArchive::FSlot Slot);
+	bool ExportTextItem(FString& ValueStr, const FQuestionId& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const;
+	bool ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText);
+
+private:
+	uint32 Index = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FQuestionId> : public TStructOpsTypeTraitsBase2<FQuestionId>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithStructuredSerializeFromMismatchedTag = true,
+		WithExportTextItem = true,
+		WithImportTextItem = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+/**
+ * Real-life mission ID, interned in FSuperfamilyIdRegistry::Missions()
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FMissionId
+{
+	GENERATED_BODY()
+
+	FMissionId() = default;
+
+	static FMissionId FromString(const FString& String);
+
+	bool IsValid() const { return Index != 0; }
+	FString ToString() const { return FSuperfamilyIdRegistry::Missions().Resolve(Index); }
+
+	bool operator==(const FMissionId& Other) const { return Index == Other.Index; }
+	bool operator!=(const FMissionId& Other) const { return Index != Other.Index; }
+	friend uint32 GetTypeHash(const FMissionId& Id) { return Id.Index; }
+
+	bool Serialize(FArchive& Ar);
+	bool SerializeFromMismatchedTag(const FPropertyTag& Tag, FStructuredArchive::FSlot Slot);
+	bool ExportTextItem(FString& ValueStr, const FMissionId& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const;
+	bool ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText);
+
+private:
+	uint32 Index = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMissionId> : public TStructOpsTypeTraitsBase2<FMissionId>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithStructuredSerializeFromMismatchedTag = true,
+		WithExportTextItem = true,
+		WithImportTextItem = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+/**
+ * Level of a world, packed as (WorldID << 16) | LevelID
+ * Its text form is the "W{World}L{Level}" key older saves and RN use.
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FLevelKey
+{
+	GENERATED_BODY()
+
+	FLevelKey() = default;
+	FLevelKey(int32 WorldID, int32 LevelID)
+		: Packed((static_cast<uint32>(WorldID) << 16) | (static_cast<uint32>(LevelID) & 0xFFFF))
+	{
+	}
+
+	/** Parse "W{World}L{Level}"; invalid if malformed */
+	static FLevelKey FromString(const FString& String);
+
+	int32 GetWorldID() const { return static_cast<int32>(Packed >> 16); }
+	int32 GetLevelID() const { return static_cast<int32>(Packed & 0xFFFF); }
+	bool IsValid() const { return Packed != 0; }
+	FString ToString() const { return FString::Printf(TEXT("W%dL%d"), GetWorldID(), GetLevelID()); }
+
+	bool operator==(const FLevelKey& Other) const { return Packed == Other.Packed; }
+	bool operator!=(const FLevelKey& Other) const { return Packed != Other.Packed; }
+	friend uint32 GetTypeHash(const FLevelKey& Key) { return Key.Packed; }
+
+	bool Serialize(FArchive& Ar) { Ar << Packed; return true; }
+	bool SerializeFromMismatchedTag(const FPropertyTag& Tag, FStructuredArchive::FSlot Slot);
+	bool ExportTextItem(FString& ValueStr, const FLevelKey& DefaultValue, UObject* Parent, int32 PortFlags, UObject* ExportRootScope) const;
+	bool ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText);
+
+private:
+	uint32 Packed = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FLevelKey> : public TStructOpsTypeTraitsBase2<FLevelKey>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithStructuredSerializeFromMismatchedTag = true,
+		WithExportTextItem = true,
+		WithImportTextItem = true,
+		WithIdenticalViaEquality = true
+	};
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Types/SuperfamilyIds.h"
 #include "SuperfamilyTypes.generated.h"
 
 /**
@@ -81,7 +82,7 @@ struct SUPERFAMILY_API FQuestionData
 	GENERATED_BODY()
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Question")
-	FString QuestionID;
+	FQuestionId QuestionID;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Question")
 	EQuestionSubject Subject;
@@ -127,7 +128,7 @@ struct SUPERFAMILY_API FMissionData
 	GENERATED_BODY()
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission")
-	FString MissionID;
+	FMissionId MissionID;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission")
 	FText Title;
@@ -199,7 +200,8 @@ struct SUPERFAMILY_API FLevelProgress
 };
 
 /**
- * Subject progress for tracking educational advancement
+ * Per-subject totals of saves from before FSubjectProgressTable
+ * Only read to migrate FChildProfile::SubjectProgress.
  */
 USTRUCT(BlueprintType)
 struct SUPERFAMILY_API FSubjectProgress
@@ -228,6 +230,119 @@ struct SUPERFAMILY_API FSubjectProgress
 	}
 };
 
+/**
+ * Distribution of answer response times
+ * Log-scale buckets, each sqrt(2) wider than the last: bucket 0 holds answers
+ * up to 0.5s, bucket 14 up to 64s, the last one everything slower. Adding is
+ * O(1), two histograms merge by adding counts, and a percentile is accurate
+ * to within one bucket (about 20%).
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FResponseTimeHistogram
+{
+	GENERATED_BODY()
+
+	static constexpr int32 NumBuckets = 16;
+
+	UPROPERTY(SaveGame)
+	int32 Counts[NumBuckets] = {};
+
+	UPROPERTY(SaveGame, BlueprintReadOnly, Category = "Progress")
+	float TotalSeconds = 0.0f;
+
+	void Add(float Seconds);
+	void Merge(const FResponseTimeHistogram& Other);
+
+	int32 GetCount() const;
+	float GetMean() const;
+
+	/** Response time below which Percentile (0-1) of the answers fall; 0 if empty */
+	float GetPercentile(float Percentile) const;
+
+	/** Upper edge of a bucket in seconds; the last bucket is open-ended */
+	static float GetBucketUpperBound(int32 Bucket);
+
+	bool IsEmpty() const { return GetCount() == 0; }
+
+	void Serialize(FArchive& Ar);
+};
+
+/**
+ * Answers in one subject at one difficulty
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FSubjectStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(SaveGame, BlueprintReadOnly, Category = "Progress")
+	int32 QuestionsAnswered = 0;
+
+	UPROPERTY(SaveGame, BlueprintReadOnly, Category = "Progress")
+	int32 QuestionsCorrect = 0;
+
+	UPROPERTY(SaveGame, BlueprintReadOnly, Category = "Progress")
+	FResponseTimeHistogram ResponseTimes;
+
+	void Merge(const FSubjectStats& Other)
+	{
+		QuestionsAnswered += Other.QuestionsAnswered;
+		QuestionsCorrect += Other.QuestionsCorrect;
+		ResponseTimes.Merge(Other.ResponseTimes);
+	}
+};
+
+/**
+ * Answer statistics of a child, one cell per subject and difficulty
+ * Saved with a compact native serializer: a mask of the cells in use, then
+ * their counters and histogram buckets as packed integers.
+ */
+USTRUCT(BlueprintType)
+struct SUPERFAMILY_API FSubjectProgressTable
+{
+	GENERATED_BODY()
+
+	static constexpr int32 NumSubjects = static_cast<int32>(EQuestionSubject::Engels) + 1;
+	static constexpr int32 NumDifficulties = static_cast<int32>(EDifficultyLevel::Groep4) + 1;
+	static constexpr int32 NumCells = NumSubjects * NumDifficulties;
+
+	/** Indexed by subject * NumDifficulties + difficulty */
+	UPROPERTY(SaveGame)
+	FSubjectStats Cells[NumCells];
+
+	static int32 GetCellIndex(EQuestionSubject Subject, EDifficultyLevel Difficulty)
+	{
+		const int32 SubjectIndex = FMath::Clamp(static_cast<int32>(Subject), 0, NumSubjects - 1);
+		const int32 DifficultyIndex = FMath::Clamp(static_cast<int32>(Difficulty), 0, NumDifficulties - 1);
+		return SubjectIndex * NumDifficulties + DifficultyIndex;
+	}
+
+	FSubjectStats& Get(EQuestionSubject Subject, EDifficultyLevel Difficulty) { return Cells[GetCellIndex(Subject, Difficulty)]; }
+	const FSubjectStats& Get(EQuestionSubject Subject, EDifficultyLevel Difficulty) const { return Cells[GetCellIndex(Subject, Difficulty)]; }
+
+	void RecordAnswer(EQuestionSubject Subject, EDifficultyLevel Difficulty, bool bCorrect, float ResponseTime)
+	{
+		FSubjectStats& Stats = Get(Subject, Difficulty);
+		++Stats.QuestionsAnswered;
+		Stats.QuestionsCorrect += bCorrect ? 1 : 0;
+		Stats.ResponseTimes.Add(ResponseTime);
+	}
+
+	/** All difficulties of a subject merged */
+	FSubjectStats GetSubjectTotal(EQuestionSubject Subject) const;
+
+	bool Serialize(FArchive& Ar);
+};
+
+template<>
+struct TStructOpsTypeTraits<FSubjectProgressTable> : public TStructOpsTypeTraitsBase2<FSubjectProgressTable>
+{
+	enum
+	{
+		WithSerializer = true
+	};
+};
+
 /**
  * Child profile data for save system
  */
@@ -237,7 +352,7 @@ struct SUPERFAMILY_API FChildProfile
 	GENERATED_BODY()
 
 	UPROPERTY(SaveGame, BlueprintReadWrite, Category = "Profile")
-	FString ChildID;
+	FChildId ChildID;
 
 	UPROPERTY(SaveGame, BlueprintReadWrite, Category = "Profile")
 	FString DisplayName;
@@ -261,17 +376,30 @@ struct SUPERFAMILY_API FChildProfile
 	UPROPERTY(SaveGame, BlueprintReadWrite, Category = "Profile")
 	FDateTime LastPlayedDate;
 
-	/** Level progress keyed by "W{World}L{Level}" format */
+	/** Level progress by level; keys are "W{World}L{Level}" in JSON */
 	UPROPERTY(SaveGame, BlueprintReadWrite, Category = "Profile")
-	TMap<FString, FLevelProgress> LevelProgress;
+	TMap<FLevelKey, FLevelProgress> LevelProgress;
 
-	/** Subject progress keyed by subject enum name */
-	UPROPERTY(SaveGame, BlueprintReadWrite, Category = "Profile")
+	/** Answer counts and response times by subject and difficulty */
+	UPROPERTY(SaveGame, BlueprintReadOnly, Category = "Profile")
+	FSubjectProgressTable Subjects;
+
+	/** Subject totals of older saves, folded into Subjects on load */
+	UPROPERTY(SaveGame)
 	TMap<FString, FSubjectProgress> SubjectProgress;
 
 	UPROPERTY(SaveGame, BlueprintReadWrite, Category = "Profile")
-	TArray<FString> CompletedMissions;
+	TArray<FMissionId> CompletedMissions;
 
+	/** Unlocked achievement IDs in unlock order, for RN and UI; membership checks use AchievementBits */
 	UPROPERTY(SaveGame, BlueprintReadWrite, Category = "Profile")
 	TArray<FString> UnlockedAchievements;
+
+	/** Unlocked achievements by stable index (USuperfamilyAchievementSet), 32 per word */
+	UPROPERTY(SaveGame)
+	TArray<uint32> AchievementBits;
+
+	/** Running totals behind achievement rules, keyed by counter */
+	UPROPERTY(SaveGame)
+	TMap<FString, int32> AchievementCounters;
 };
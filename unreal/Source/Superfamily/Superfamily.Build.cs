@@ -47,9 +47,26 @@ public class Superfamily : ModuleRules
 			PrivateDependencyModuleNames.Add("Launch");
 		}
 
-		// Uncomment when plugins are ready
+		// Level catalog rebuilds its map list from the asset registry when cooked
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("AssetRegistry");
+		}
+
+		PrivateDependencyModuleNames.Add("RNUEBridge");
+
+		// Downloaded world chunks are mounted as paks
+		PrivateDependencyModuleNames.Add("PakFile");
+
+		// Stand-in content server for exercising world downloads
+		if (Target.Configuration != UnrealTargetConfiguration.Shipping)
+		{
+			PrivateDependencyModuleNames.Add("HTTPServer");
+		}
+
+		// EducationSystem and RealLifeMissions depend on this module for types,
+		// so referencing them from here would create a cycle
 		// PrivateDependencyModuleNames.Add("EducationSystem");
 		// PrivateDependencyModuleNames.Add("RealLifeMissions");
-		// PrivateDependencyModuleNames.Add("RNUEBridge");
 	}
 }
@@ -1,10 +1,29 @@
 // Copyright (c) 2024 Superfamily B.V. All Rights Reserved.
 
 #include "Superfamily.h"
+#include "Core/SuperfamilyStats.h"
 #include "Modules/ModuleManager.h"
 
 DEFINE_LOG_CATEGORY(LogSuperfamily);
 
+LLM_DEFINE_TAG(Superfamily);
+
+DEFINE_STAT(STAT_SuperfamilySaveGame);
+DEFINE_STAT(STAT_SuperfamilyLoadGame);
+DEFINE_STAT(STAT_SuperfamilyProfileSync);
+DEFINE_STAT(STAT_SuperfamilyProgressMerge);
+DEFINE_STAT(STAT_SuperfamilySaveDataMemory);
+DEFINE_STAT(STAT_SuperfamilyLevelSetup);
+DEFINE_STAT(STAT_SuperfamilyLevelResult);
+DEFINE_STAT(STAT_SuperfamilyQuestionSet);
+DEFINE_STAT(STAT_SuperfamilyQuestionAnswer);
+DEFINE_STAT(STAT_SuperfamilyQuestionPoolMemory);
+DEFINE_STAT(STAT_SuperfamilyAchievementEvent);
+DEFINE_STAT(STAT_SuperfamilyEventDispatch);
+DEFINE_STAT(STAT_SuperfamilyEventsDispatched);
+
+CSV_DEFINE_CATEGORY_MODULE(SUPERFAMILY_API, Superfamily, true);
+
 void FSuperfamilyModule::StartupModule()
 {
 	UE_LOG(LogSuperfamily, Log, TEXT("Superfamily module starting up"));